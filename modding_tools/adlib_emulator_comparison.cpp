@@ -0,0 +1,378 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <data/game_traits.hpp>
+#include <data/sound_ids.hpp>
+#include <engine/imf_player.hpp>
+#include <loader/audio_package.hpp>
+#include <loader/resource_loader.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+using namespace rigel;
+
+constexpr auto PI = 3.14159265358979323846;
+constexpr auto SAMPLE_RATE = 44100;
+constexpr auto SPECTRUM_SIZE = 2048;
+
+
+struct RenderResult {
+  std::vector<std::int16_t> mSamples;
+  double mSeconds = 0.0;
+};
+
+
+struct Comparison {
+  double mSignalToNoise = 0.0;
+  double mLevelDifference = 0.0;
+  double mSpectralDistance = 0.0;
+};
+
+
+struct Totals {
+  double mAudioSeconds = 0.0;
+  double mDbOplSeconds = 0.0;
+  double mFastSeconds = 0.0;
+  double mWorstSpectralDistance = 0.0;
+};
+
+
+void printUsage() {
+  std::cout <<
+R"(Usage:
+  AdlibEmulatorComparison <game path>
+
+Renders all songs (*.IMF files) and Adlib sound effects found in the given
+game directory with both the DBOPL and the fast OPL2 emulator, and reports
+how much the results differ as well as how long rendering took.
+
+Per item, three error metrics are printed:
+
+SNR      - signal to noise ratio in dB, treating the difference between the
+           two renderings as noise. Very sensitive to tiny phase differences.
+Level    - difference in overall loudness (RMS) in dB
+Spectral - mean log-spectral distance in dB, comparing magnitude spectra of
+           2048 sample frames. Insensitive to phase, closer to what's audible.
+)";
+}
+
+
+template <typename Callback>
+RenderResult timedRender(Callback&& render) {
+  using Clock = std::chrono::high_resolution_clock;
+
+  RenderResult result;
+  const auto start = Clock::now();
+  result.mSamples = render();
+  result.mSeconds =
+    std::chrono::duration<double>(Clock::now() - start).count();
+  return result;
+}
+
+
+RenderResult renderSong(
+  const data::Song& song,
+  const data::AdlibEmulatorType emulatorType
+) {
+  auto totalDelay = std::size_t{0};
+  for (const auto& command : song) {
+    totalDelay += command.delay;
+  }
+
+  const auto numSamples =
+    totalDelay * SAMPLE_RATE / data::GameTraits::musicPlaybackRate;
+
+  return timedRender([&]() {
+    engine::ImfPlayer player{SAMPLE_RATE};
+    player.setEmulatorType(emulatorType);
+    player.playSong(data::Song{song});
+
+    std::vector<std::int16_t> samples(numSamples);
+    player.render(samples.data(), samples.size());
+    return samples;
+  });
+}
+
+
+RenderResult renderSound(
+  const loader::AudioPackage& package,
+  const data::SoundId id,
+  const data::AdlibEmulatorType emulatorType
+) {
+  return timedRender([&]() {
+    auto buffer = package.loadAdlibSound(id, SAMPLE_RATE, emulatorType);
+    return std::vector<std::int16_t>(
+      buffer.mSamples.begin(), buffer.mSamples.end());
+  });
+}
+
+
+void fft(std::vector<std::complex<double>>& values) {
+  const auto size = values.size();
+
+  for (auto i = std::size_t{1}, j = std::size_t{0}; i < size; ++i) {
+    auto bit = size >> 1;
+    for (; j & bit; bit >>= 1) {
+      j ^= bit;
+    }
+    j ^= bit;
+
+    if (i < j) {
+      std::swap(values[i], values[j]);
+    }
+  }
+
+  for (auto length = std::size_t{2}; length <= size; length <<= 1) {
+    const auto angle = -2.0 * PI / static_cast<double>(length);
+    const auto rootOfUnity = std::polar(1.0, angle);
+
+    for (auto start = std::size_t{0}; start < size; start += length) {
+      auto factor = std::complex<double>{1.0};
+      for (auto k = std::size_t{0}; k < length / 2; ++k) {
+        const auto even = values[start + k];
+        const auto odd = values[start + k + length / 2] * factor;
+        values[start + k] = even + odd;
+        values[start + k + length / 2] = even - odd;
+        factor *= rootOfUnity;
+      }
+    }
+  }
+}
+
+
+std::vector<double> powerSpectrum(
+  const std::vector<std::int16_t>& samples,
+  const std::size_t offset
+) {
+  std::vector<std::complex<double>> values(SPECTRUM_SIZE);
+  for (auto i = 0; i < SPECTRUM_SIZE; ++i) {
+    // Hann window
+    const auto window =
+      0.5 - 0.5 * std::cos(2.0 * PI * i / (SPECTRUM_SIZE - 1));
+    values[i] = samples[offset + i] * window;
+  }
+
+  fft(values);
+
+  std::vector<double> result(SPECTRUM_SIZE / 2);
+  for (auto i = 0u; i < result.size(); ++i) {
+    result[i] = std::norm(values[i]);
+  }
+
+  return result;
+}
+
+
+double spectralDistance(
+  const std::vector<std::int16_t>& reference,
+  const std::vector<std::int16_t>& candidate
+) {
+  // Bins below this power are treated as silence, to avoid huge differences
+  // in dB between two very quiet signals.
+  constexpr auto POWER_FLOOR = 1.0e3;
+
+  auto sum = 0.0;
+  auto numFrames = 0;
+
+  for (
+    auto offset = std::size_t{0};
+    offset + SPECTRUM_SIZE <= reference.size();
+    offset += SPECTRUM_SIZE
+  ) {
+    const auto referenceSpectrum = powerSpectrum(reference, offset);
+    const auto candidateSpectrum = powerSpectrum(candidate, offset);
+
+    auto squaredDifferences = 0.0;
+    for (auto i = 0u; i < referenceSpectrum.size(); ++i) {
+      const auto difference =
+        10.0 * std::log10(
+          (referenceSpectrum[i] + POWER_FLOOR) /
+          (candidateSpectrum[i] + POWER_FLOOR));
+      squaredDifferences += difference * difference;
+    }
+
+    sum += std::sqrt(squaredDifferences / referenceSpectrum.size());
+    ++numFrames;
+  }
+
+  return numFrames > 0 ? sum / numFrames : 0.0;
+}
+
+
+Comparison compare(
+  const std::vector<std::int16_t>& reference,
+  const std::vector<std::int16_t>& candidate
+) {
+  const auto numSamples = std::min(reference.size(), candidate.size());
+
+  auto referencePower = 0.0;
+  auto candidatePower = 0.0;
+  auto errorPower = 0.0;
+  for (auto i = 0u; i < numSamples; ++i) {
+    const auto error = double(reference[i]) - candidate[i];
+    referencePower += double(reference[i]) * reference[i];
+    candidatePower += double(candidate[i]) * candidate[i];
+    errorPower += error * error;
+  }
+
+  const auto toDb = [](const double ratio) {
+    return 10.0 * std::log10(std::max(ratio, 1.0e-12));
+  };
+
+  Comparison result;
+  result.mSignalToNoise = errorPower > 0.0
+    ? toDb(referencePower / errorPower)
+    : std::numeric_limits<double>::infinity();
+  result.mLevelDifference = candidatePower > 0.0 && referencePower > 0.0
+    ? toDb(candidatePower / referencePower)
+    : 0.0;
+  result.mSpectralDistance = spectralDistance(reference, candidate);
+  return result;
+}
+
+
+void report(
+  const std::string& name,
+  const RenderResult& dbOplResult,
+  const RenderResult& fastResult,
+  Totals& totals
+) {
+  const auto comparison = compare(dbOplResult.mSamples, fastResult.mSamples);
+
+  std::cout
+    << std::left << std::setw(16) << name << std::right << std::fixed
+    << std::setprecision(1)
+    << std::setw(8) << comparison.mSignalToNoise
+    << std::setw(8) << comparison.mLevelDifference
+    << std::setw(10) << comparison.mSpectralDistance
+    << std::setw(10) << dbOplResult.mSeconds * 1000.0
+    << std::setw(10) << fastResult.mSeconds * 1000.0 << '\n';
+
+  totals.mAudioSeconds +=
+    dbOplResult.mSamples.size() / static_cast<double>(SAMPLE_RATE);
+  totals.mDbOplSeconds += dbOplResult.mSeconds;
+  totals.mFastSeconds += fastResult.mSeconds;
+  totals.mWorstSpectralDistance =
+    std::max(totals.mWorstSpectralDistance, comparison.mSpectralDistance);
+}
+
+
+void printHeader() {
+  std::cout
+    << std::left << std::setw(16) << "Name" << std::right
+    << std::setw(8) << "SNR"
+    << std::setw(8) << "Level"
+    << std::setw(10) << "Spectral"
+    << std::setw(10) << "DBOPL ms"
+    << std::setw(10) << "Fast ms" << '\n';
+}
+
+}
+
+
+int main(int argc, char** argv) {
+  namespace fs = std::filesystem;
+
+  if (argc < 2) {
+    printUsage();
+    return 1;
+  }
+
+  try {
+    auto gamePathString = std::string{argv[1]};
+    if (gamePathString.back() != '/') {
+      gamePathString += '/';
+    }
+
+    const auto gamePath = fs::u8path(gamePathString);
+    const auto resources = loader::ResourceLoader{gamePathString};
+    const auto audioPackage = loader::AudioPackage{
+      resources.file(loader::AudioPackage::AUDIO_DICT_FILE),
+      resources.file(loader::AudioPackage::AUDIO_DATA_FILE)};
+
+    std::vector<std::string> songNames;
+    for (const auto& entry : fs::directory_iterator(gamePath)) {
+      auto extension = entry.path().extension().u8string();
+      std::transform(
+        extension.begin(),
+        extension.end(),
+        extension.begin(),
+        [](const unsigned char c) {
+          return static_cast<char>(std::toupper(c));
+        });
+      if (extension == ".IMF") {
+        songNames.push_back(entry.path().filename().u8string());
+      }
+    }
+    std::sort(songNames.begin(), songNames.end());
+
+    Totals totals;
+
+    std::cout << "== Songs ==\n\n";
+    printHeader();
+    for (const auto& name : songNames) {
+      const auto song = resources.loadMusic(name);
+      report(
+        name,
+        renderSong(song, data::AdlibEmulatorType::DBOPL),
+        renderSong(song, data::AdlibEmulatorType::Fast),
+        totals);
+    }
+
+    std::cout << "\n== Sound effects ==\n\n";
+    printHeader();
+    data::forEachSoundId([&](const data::SoundId id) {
+      // The Adlib package only contains the first 34 sounds
+      if (static_cast<int>(id) >= 34) {
+        return;
+      }
+
+      report(
+        "Sound " + std::to_string(static_cast<int>(id) + 1),
+        renderSound(audioPackage, id, data::AdlibEmulatorType::DBOPL),
+        renderSound(audioPackage, id, data::AdlibEmulatorType::Fast),
+        totals);
+    });
+
+    std::cout
+      << std::fixed << std::setprecision(2)
+      << "\nRendered " << totals.mAudioSeconds << " s of audio per emulator"
+      << "\nDBOPL: " << totals.mDbOplSeconds * 1000.0 << " ms"
+      << "\nFast: " << totals.mFastSeconds * 1000.0 << " ms"
+      << "\nSpeed ratio: " << totals.mDbOplSeconds / totals.mFastSeconds
+      << "x\nWorst spectral distance: " << totals.mWorstSpectralDistance
+      << " dB\n";
+  } catch (const std::exception& ex) {
+    std::cerr << "ERROR: " << ex.what() << '\n';
+    return 1;
+  }
+
+  return 0;
+}
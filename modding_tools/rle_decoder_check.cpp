@@ -0,0 +1,149 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <data/game_traits.hpp>
+#include <loader/level_loader.hpp>
+#include <loader/resource_loader.hpp>
+#include <loader/rle_compression.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+
+namespace {
+
+using namespace rigel;
+
+constexpr auto LEVEL_HEADER_SIZE = 47u;
+constexpr auto NUM_ITERATIONS = 100;
+
+const char EPISODE_PREFIXES[] = {'L', 'M', 'N', 'O'};
+
+
+void printUsage() {
+  std::cout <<
+R"(Usage:
+  RleDecoderCheck <game path>
+
+Decodes the masked tile bits of all levels found in the given game directory
+with both the byte-wise and the bulk RLE decoder, verifies that the results
+are identical, and reports how long decoding took.
+)";
+}
+
+
+/** Returns the RLE compressed masked tile bits section of a level file */
+loader::ByteBuffer extractMaskedTileBits(const loader::ByteBuffer& levelData) {
+  const auto header = loader::parseLevelHeader(levelData);
+  const auto actorListSize = header.mNumActorWords / 3u * 3u * 2u;
+  const auto sizeOffset = LEVEL_HEADER_SIZE + actorListSize + 2u +
+    data::GameTraits::mapDataWords * 2u;
+
+  loader::LeStreamReader reader(
+    levelData.begin() + sizeOffset, levelData.end());
+  const auto size = reader.readU16();
+  const auto start = reader.currentIter();
+  reader.skipBytes(size);
+
+  return loader::ByteBuffer(start, start + size);
+}
+
+
+template<typename Callable>
+double measure(Callable&& decode) {
+  using Clock = std::chrono::high_resolution_clock;
+
+  const auto start = Clock::now();
+  for (int i = 0; i < NUM_ITERATIONS; ++i) {
+    decode();
+  }
+  return std::chrono::duration<double, std::micro>(
+    Clock::now() - start).count() / NUM_ITERATIONS;
+}
+
+}
+
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printUsage();
+    return 1;
+  }
+
+  try {
+    auto gamePath = std::string{argv[1]};
+    if (gamePath.back() != '/') {
+      gamePath += '/';
+    }
+
+    const auto resources = loader::ResourceLoader{gamePath};
+
+    auto numLevels = 0;
+    auto numMismatches = 0;
+
+    for (const auto prefix : EPISODE_PREFIXES) {
+      for (int level = 1; level <= 8; ++level) {
+        const auto name = prefix + std::to_string(level) + ".MNI";
+        if (!resources.hasFile(name)) {
+          continue;
+        }
+
+        const auto stream = extractMaskedTileBits(resources.file(name));
+
+        loader::ByteBuffer byteWiseResult;
+        const auto byteWiseTime = measure([&]() {
+          byteWiseResult.clear();
+          loader::LeStreamReader reader(stream);
+          loader::decompressRle(reader, [&](const std::uint8_t value) {
+            byteWiseResult.push_back(value);
+          });
+        });
+
+        loader::ByteBuffer bulkResult(byteWiseResult.size());
+        auto decodingResult = loader::RleDecodingResult{};
+        const auto bulkTime = measure([&]() {
+          decodingResult = loader::decompressRleInto(
+            stream.data(), stream.size(), bulkResult.data(), bulkResult.size());
+        });
+
+        const auto matches =
+          decodingResult.mStatus == loader::RleDecodingResult::Status::Ok &&
+          decodingResult.mDecodedSize == byteWiseResult.size() &&
+          bulkResult == byteWiseResult;
+
+        std::cout
+          << name << ": " << stream.size() << " -> " << byteWiseResult.size()
+          << " bytes, byte-wise " << byteWiseTime << " us, bulk " << bulkTime
+          << " us" << (matches ? "" : " - MISMATCH") << '\n';
+
+        ++numLevels;
+        if (!matches) {
+          ++numMismatches;
+        }
+      }
+    }
+
+    std::cout
+      << "\nChecked " << numLevels << " levels, " << numMismatches
+      << " mismatches\n";
+    return numMismatches == 0 ? 0 : 1;
+  } catch (const std::exception& ex) {
+    std::cerr << "ERROR: " << ex.what() << '\n';
+    return 1;
+  }
+}
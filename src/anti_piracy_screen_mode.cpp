@@ -27,7 +27,10 @@ namespace rigel {
 
 AntiPiracyScreenMode::AntiPiracyScreenMode(Context context)
   : mContext(context)
-  , mTexture(context.mpRenderer, context.mpResources->loadAntiPiracyImage())
+  , mTexture(
+      context.mpRenderer,
+      context.mpResources->loadAntiPiracyImage(),
+      renderer::TextureCategory::FullScreenImage)
 {
 }
 
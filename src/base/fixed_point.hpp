@@ -0,0 +1,172 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+
+namespace rigel::base {
+
+/** Signed fixed-point number with a compile-time number of fractional bits
+ *
+ * All arithmetic is done on integers, so results are bit-identical on every
+ * compiler and platform. Values can be implicitly constructed from any
+ * arithmetic type, which makes it possible to write constants as regular
+ * literals (e.g. `0.5f`). Float literals are converted by truncation, so they
+ * should be exactly representable with the given number of fractional bits.
+ *
+ * Converting back to an integer (via static_cast) truncates towards zero,
+ * matching the behavior of casting a float to an integer type.
+ */
+template<int FractionalBits>
+class FixedPoint {
+public:
+  using Storage = std::int32_t;
+
+  static constexpr auto FRACTIONAL_BITS = FractionalBits;
+  static constexpr auto ONE = Storage{1} << FractionalBits;
+
+  constexpr FixedPoint() noexcept = default;
+
+  template<
+    typename T,
+    typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+  constexpr FixedPoint(const T value) noexcept
+    : mRaw(toRaw(value))
+  {
+  }
+
+  static constexpr FixedPoint fromRaw(const Storage raw) noexcept {
+    auto result = FixedPoint{};
+    result.mRaw = raw;
+    return result;
+  }
+
+  constexpr Storage raw() const noexcept {
+    return mRaw;
+  }
+
+  template<
+    typename T,
+    typename = std::enable_if_t<
+      std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+  explicit constexpr operator T() const noexcept {
+    return static_cast<T>(mRaw / ONE);
+  }
+
+  constexpr float toFloat() const noexcept {
+    return static_cast<float>(mRaw) / ONE;
+  }
+
+  constexpr FixedPoint operator-() const noexcept {
+    return fromRaw(-mRaw);
+  }
+
+  constexpr FixedPoint& operator+=(const FixedPoint rhs) noexcept {
+    mRaw += rhs.mRaw;
+    return *this;
+  }
+
+  constexpr FixedPoint& operator-=(const FixedPoint rhs) noexcept {
+    mRaw -= rhs.mRaw;
+    return *this;
+  }
+
+  friend constexpr FixedPoint operator+(
+    FixedPoint lhs,
+    const FixedPoint rhs
+  ) noexcept {
+    return lhs += rhs;
+  }
+
+  friend constexpr FixedPoint operator-(
+    FixedPoint lhs,
+    const FixedPoint rhs
+  ) noexcept {
+    return lhs -= rhs;
+  }
+
+  // Only scaling by integers is supported, since it's exact. Multiplying
+  // by a float would silently go through the float -> fixed conversion
+  // otherwise.
+  template<
+    typename T,
+    typename = std::enable_if_t<std::is_integral_v<T>>>
+  friend constexpr FixedPoint operator*(
+    const FixedPoint lhs,
+    const T factor
+  ) noexcept {
+    return fromRaw(lhs.mRaw * static_cast<Storage>(factor));
+  }
+
+  friend constexpr bool operator==(
+    const FixedPoint lhs,
+    const FixedPoint rhs
+  ) noexcept {
+    return lhs.mRaw == rhs.mRaw;
+  }
+
+  friend constexpr bool operator!=(
+    const FixedPoint lhs,
+    const FixedPoint rhs
+  ) noexcept {
+    return lhs.mRaw != rhs.mRaw;
+  }
+
+  friend constexpr bool operator<(
+    const FixedPoint lhs,
+    const FixedPoint rhs
+  ) noexcept {
+    return lhs.mRaw < rhs.mRaw;
+  }
+
+  friend constexpr bool operator<=(
+    const FixedPoint lhs,
+    const FixedPoint rhs
+  ) noexcept {
+    return lhs.mRaw <= rhs.mRaw;
+  }
+
+  friend constexpr bool operator>(
+    const FixedPoint lhs,
+    const FixedPoint rhs
+  ) noexcept {
+    return lhs.mRaw > rhs.mRaw;
+  }
+
+  friend constexpr bool operator>=(
+    const FixedPoint lhs,
+    const FixedPoint rhs
+  ) noexcept {
+    return lhs.mRaw >= rhs.mRaw;
+  }
+
+private:
+  template<typename T>
+  static constexpr Storage toRaw(const T value) noexcept {
+    if constexpr (std::is_integral_v<T>) {
+      return static_cast<Storage>(value) * ONE;
+    } else {
+      return static_cast<Storage>(value * ONE);
+    }
+  }
+
+  Storage mRaw = 0;
+};
+
+}
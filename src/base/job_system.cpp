@@ -0,0 +1,351 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "job_system.hpp"
+
+#include <stdexcept>
+
+
+namespace rigel::base {
+
+namespace {
+
+struct WorkerIdentity {
+  const JobSystem* mpSystem = nullptr;
+  int mIndex = -1;
+};
+
+thread_local WorkerIdentity tCurrentWorker;
+
+}
+
+
+int defaultWorkerCount() {
+#ifdef __EMSCRIPTEN__
+  return 0;
+#else
+  const auto numHardwareThreads =
+    static_cast<int>(std::thread::hardware_concurrency());
+  return std::max(numHardwareThreads - 1, 0);
+#endif
+}
+
+
+JobSystem::JobSystem(const int numWorkers)
+  : mMainThreadId(std::this_thread::get_id())
+{
+  assert(numWorkers >= 0);
+
+  const auto numQueues = std::max(numWorkers, 1);
+  for (auto i = 0; i < numQueues; ++i) {
+    mQueues.push_back(std::make_unique<Queue>());
+  }
+
+  mWorkers.reserve(numWorkers);
+  for (auto i = 0; i < numWorkers; ++i) {
+    mWorkers.emplace_back([this, i]() { workerMain(i); });
+  }
+}
+
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(mStateMutex);
+    mStopRequested = true;
+  }
+  mStateChanged.notify_all();
+
+  for (auto& worker : mWorkers) {
+    worker.join();
+  }
+}
+
+
+JobHandle JobSystem::submit(
+  std::function<void()> task,
+  const std::vector<JobHandle>& dependencies
+) {
+  auto pJob = std::make_shared<detail::Job>(std::move(task));
+
+  for (const auto& dependency : dependencies) {
+    if (!dependency.mpJob) {
+      continue;
+    }
+
+    auto& dependencyJob = *dependency.mpJob;
+    std::lock_guard<std::mutex> lock(dependencyJob.mMutex);
+    if (!dependencyJob.mIsDone) {
+      ++pJob->mPendingDependencies;
+      dependencyJob.mDependents.push_back(pJob);
+    }
+  }
+
+  // The job starts out with one pending dependency, which keeps it from
+  // being scheduled while we are still registering the actual dependencies
+  // above.
+  releaseDependency(pJob);
+
+  return JobHandle{std::move(pJob)};
+}
+
+
+void JobSystem::wait(const JobHandle& job) {
+  if (!job.mpJob) {
+    return;
+  }
+
+  while (!job.isDone()) {
+    if (tryRunOneJob()) {
+      continue;
+    }
+
+    if (isSingleThreaded()) {
+      throw std::logic_error(
+        "Waiting for job which can never run (dependency cycle?)");
+    }
+
+    waitForStateChange([&]() { return job.isDone() || mNumQueuedJobs > 0; });
+  }
+
+  if (job.mpJob->mpError) {
+    std::rethrow_exception(job.mpJob->mpError);
+  }
+}
+
+
+void JobSystem::waitAll(const std::vector<JobHandle>& jobs) {
+  std::exception_ptr pFirstError;
+
+  for (const auto& job : jobs) {
+    try {
+      wait(job);
+    } catch (...) {
+      if (!pFirstError) {
+        pFirstError = std::current_exception();
+      }
+    }
+  }
+
+  if (pFirstError) {
+    std::rethrow_exception(pFirstError);
+  }
+}
+
+
+void JobSystem::continueOnMainThread(
+  const JobHandle& job,
+  std::function<void()> continuation,
+  const ContinuationOrder order
+) {
+  std::lock_guard<std::mutex> lock(mContinuationsMutex);
+  mContinuations.push_back({job, std::move(continuation), order});
+}
+
+
+int JobSystem::runMainThreadContinuations() {
+  assert(std::this_thread::get_id() == mMainThreadId);
+
+  if (isSingleThreaded()) {
+    while (tryRunOneJob()) {
+    }
+  }
+
+  std::vector<std::function<void()>> readyContinuations;
+  {
+    std::lock_guard<std::mutex> lock(mContinuationsMutex);
+
+    auto blockedBySubmissionOrder = false;
+    auto iPending = mContinuations.begin();
+    while (iPending != mContinuations.end()) {
+      const auto isSubmissionOrdered =
+        iPending->mOrder == ContinuationOrder::Submission;
+      const auto canRun = iPending->mJob.isDone() &&
+        !(isSubmissionOrdered && blockedBySubmissionOrder);
+
+      if (canRun) {
+        readyContinuations.push_back(std::move(iPending->mContinuation));
+        iPending = mContinuations.erase(iPending);
+      } else {
+        blockedBySubmissionOrder =
+          blockedBySubmissionOrder || isSubmissionOrdered;
+        ++iPending;
+      }
+    }
+  }
+
+  // Continuations might register new continuations, so we must not hold the
+  // lock while running them.
+  for (const auto& continuation : readyContinuations) {
+    continuation();
+  }
+
+  return static_cast<int>(readyContinuations.size());
+}
+
+
+bool JobSystem::hasPendingContinuations() const {
+  std::lock_guard<std::mutex> lock(mContinuationsMutex);
+  return !mContinuations.empty();
+}
+
+
+void JobSystem::releaseDependency(const JobPtr& pJob) {
+  if (--pJob->mPendingDependencies == 0) {
+    schedule(pJob);
+  }
+}
+
+
+void JobSystem::schedule(JobPtr pJob) {
+  const auto workerIndex = currentWorkerIndex();
+  const auto queueIndex = workerIndex >= 0
+    ? workerIndex
+    : static_cast<int>(mNextQueue++ % mQueues.size());
+
+  {
+    auto& queue = *mQueues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mMutex);
+    queue.mJobs.push_back(std::move(pJob));
+  }
+
+  ++mNumQueuedJobs;
+  notifyStateChanged();
+}
+
+
+bool JobSystem::tryRunOneJob() {
+  const auto workerIndex = currentWorkerIndex();
+
+  JobPtr pJob;
+  if (workerIndex >= 0) {
+    pJob = tryTakeJob(workerIndex, true);
+  }
+
+  const auto numQueues = static_cast<int>(mQueues.size());
+  for (auto i = 1; !pJob && i <= numQueues; ++i) {
+    const auto victimIndex = (std::max(workerIndex, 0) + i) % numQueues;
+    if (victimIndex != workerIndex) {
+      pJob = tryTakeJob(victimIndex, false);
+    }
+  }
+
+  if (!pJob) {
+    return false;
+  }
+
+  execute(pJob);
+  return true;
+}
+
+
+auto JobSystem::tryTakeJob(const int queueIndex, const bool fromBack)
+  -> JobPtr
+{
+  auto& queue = *mQueues[queueIndex];
+  std::lock_guard<std::mutex> lock(queue.mMutex);
+
+  if (queue.mJobs.empty()) {
+    return nullptr;
+  }
+
+  JobPtr pJob;
+  if (fromBack) {
+    pJob = std::move(queue.mJobs.back());
+    queue.mJobs.pop_back();
+  } else {
+    pJob = std::move(queue.mJobs.front());
+    queue.mJobs.pop_front();
+  }
+
+  --mNumQueuedJobs;
+  return pJob;
+}
+
+
+void JobSystem::execute(const JobPtr& pJob) {
+  try {
+    pJob->mTask();
+  } catch (...) {
+    pJob->mpError = std::current_exception();
+  }
+
+  // Release anything captured by the task right away, instead of keeping it
+  // alive for as long as there are handles referring to the job.
+  pJob->mTask = nullptr;
+
+  std::vector<JobPtr> dependents;
+  {
+    std::lock_guard<std::mutex> lock(pJob->mMutex);
+    pJob->mIsDone = true;
+    dependents.swap(pJob->mDependents);
+  }
+
+  for (const auto& pDependent : dependents) {
+    releaseDependency(pDependent);
+  }
+
+  notifyStateChanged();
+}
+
+
+void JobSystem::waitForStateChange(const std::function<bool()>& condition) {
+  std::unique_lock<std::mutex> lock(mStateMutex);
+
+  // Announcing that we are about to sleep before checking the condition
+  // guarantees that we don't miss a notification, see notifyStateChanged().
+  ++mNumSleeping;
+  mStateChanged.wait(lock, condition);
+  --mNumSleeping;
+}
+
+
+void JobSystem::notifyStateChanged() {
+  // Notifying is relatively expensive, so we skip it if nobody is waiting.
+  // Taking the lock makes sure that a thread which has checked its wait
+  // condition is actually waiting before we notify.
+  if (mNumSleeping > 0) {
+    { std::lock_guard<std::mutex> lock(mStateMutex); }
+    mStateChanged.notify_all();
+  }
+}
+
+
+void JobSystem::workerMain(const int index) {
+  tCurrentWorker = {this, index};
+
+  for (;;) {
+    if (tryRunOneJob()) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mStateMutex);
+    if (mStopRequested && mNumQueuedJobs == 0) {
+      return;
+    }
+
+    ++mNumSleeping;
+    mStateChanged.wait(
+      lock, [this]() { return mStopRequested || mNumQueuedJobs > 0; });
+    --mNumSleeping;
+  }
+}
+
+
+int JobSystem::currentWorkerIndex() const {
+  return tCurrentWorker.mpSystem == this ? tCurrentWorker.mIndex : -1;
+}
+
+}
@@ -0,0 +1,265 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace rigel::base {
+
+namespace detail {
+
+struct Job {
+  explicit Job(std::function<void()> task)
+    : mTask(std::move(task))
+  {
+  }
+
+  std::function<void()> mTask;
+  std::atomic<int> mPendingDependencies{1};
+  std::atomic<bool> mIsDone{false};
+  std::exception_ptr mpError;
+
+  std::mutex mMutex;
+  std::vector<std::shared_ptr<Job>> mDependents;
+};
+
+}
+
+
+/** Refers to a job submitted to a JobSystem
+ *
+ * Can be used for waiting on the job, or as a dependency of other jobs.
+ * A default constructed handle refers to no job, and counts as done.
+ */
+class JobHandle {
+public:
+  JobHandle() = default;
+
+  bool isDone() const {
+    return !mpJob || mpJob->mIsDone;
+  }
+
+private:
+  friend class JobSystem;
+
+  explicit JobHandle(std::shared_ptr<detail::Job> pJob)
+    : mpJob(std::move(pJob))
+  {
+  }
+
+  std::shared_ptr<detail::Job> mpJob;
+};
+
+
+/** Number of worker threads to use by default
+ *
+ * One less than the number of hardware threads, since the main thread
+ * also takes part in running jobs while it waits. On Emscripten, this is
+ * always 0.
+ */
+int defaultWorkerCount();
+
+
+/** Runs jobs on a fixed pool of worker threads
+ *
+ * Each worker has its own job queue. Jobs submitted from a worker go into
+ * that worker's queue, and are executed in LIFO order by the worker itself.
+ * Idle workers steal jobs from the other queues, oldest first. Threads
+ * waiting for a job via wait() also execute jobs in the meantime, so it's
+ * safe to wait from within a job.
+ *
+ * A job can depend on other jobs. It is only started once all of its
+ * dependencies are done.
+ *
+ * Results can be handed back to the main thread (the thread which created
+ * the JobSystem) via continueOnMainThread(). The main thread needs to call
+ * runMainThreadContinuations() regularly for these to be executed.
+ *
+ * With a worker count of 0, the job system operates in single-threaded mode:
+ * Jobs are then only executed on the main thread, in the order they became
+ * ready, while waiting for a job or running continuations. This is meant for
+ * platforms without thread support (Emscripten), and for debugging.
+ *
+ * If a job throws an exception, it still counts as done. The exception is
+ * rethrown when waiting for the job.
+ */
+class JobSystem {
+public:
+  enum class ContinuationOrder {
+    /** Run after all previously registered continuations of this order */
+    Submission,
+
+    /** Run as soon as the job is done */
+    Completion
+  };
+
+  explicit JobSystem(int numWorkers = defaultWorkerCount());
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  JobHandle submit(
+    std::function<void()> task,
+    const std::vector<JobHandle>& dependencies = {});
+
+  /** Block until job is done, executing other jobs in the meantime
+   *
+   * Rethrows the job's exception, if any.
+   */
+  void wait(const JobHandle& job);
+
+  /** Wait for all given jobs, then rethrow the first exception (if any) */
+  void waitAll(const std::vector<JobHandle>& jobs);
+
+  /** Invoke callback for each index in [begin, end), in parallel
+   *
+   * The range is split into chunks of grainSize indices each, which are
+   * processed as separate jobs. Returns once all indices have been
+   * processed. In single-threaded mode, all indices are processed in
+   * ascending order on the calling thread.
+   */
+  template <typename Callback>
+  void parallelFor(int begin, int end, Callback&& callback, int grainSize = 1);
+
+  /** Run continuation on the main thread once job is done
+   *
+   * With ContinuationOrder::Submission, continuations run in the order they
+   * were registered, regardless of which job finishes first. This gives
+   * deterministic results even if jobs complete in varying order.
+   */
+  void continueOnMainThread(
+    const JobHandle& job,
+    std::function<void()> continuation,
+    ContinuationOrder order = ContinuationOrder::Submission);
+
+  /** Execute continuations of finished jobs
+   *
+   * Must be called on the main thread. In single-threaded mode, also
+   * executes all jobs which are ready to run.
+   *
+   * Returns the number of continuations executed.
+   */
+  int runMainThreadContinuations();
+
+  bool hasPendingContinuations() const;
+
+  int workerCount() const {
+    return static_cast<int>(mWorkers.size());
+  }
+
+  bool isSingleThreaded() const {
+    return mWorkers.empty();
+  }
+
+private:
+  using JobPtr = std::shared_ptr<detail::Job>;
+
+  struct Queue {
+    std::mutex mMutex;
+    std::deque<JobPtr> mJobs;
+  };
+
+  struct PendingContinuation {
+    JobHandle mJob;
+    std::function<void()> mContinuation;
+    ContinuationOrder mOrder;
+  };
+
+  void releaseDependency(const JobPtr& pJob);
+  void schedule(JobPtr pJob);
+  bool tryRunOneJob();
+  JobPtr tryTakeJob(int queueIndex, bool fromBack);
+  void execute(const JobPtr& pJob);
+  void waitForStateChange(const std::function<bool()>& condition);
+  void notifyStateChanged();
+  void workerMain(int index);
+  int currentWorkerIndex() const;
+
+  std::vector<std::unique_ptr<Queue>> mQueues;
+  std::atomic<int> mNumQueuedJobs{0};
+  std::atomic<unsigned> mNextQueue{0};
+
+  std::mutex mStateMutex;
+  std::condition_variable mStateChanged;
+  std::atomic<int> mNumSleeping{0};
+  bool mStopRequested = false;
+
+  mutable std::mutex mContinuationsMutex;
+  std::deque<PendingContinuation> mContinuations;
+
+  std::thread::id mMainThreadId;
+  std::vector<std::thread> mWorkers;
+};
+
+
+template <typename Callback>
+void JobSystem::parallelFor(
+  const int begin,
+  const int end,
+  Callback&& callback,
+  const int grainSize
+) {
+  assert(grainSize > 0);
+
+  const auto processRange = [&callback](const int first, const int last) {
+    for (auto i = first; i < last; ++i) {
+      callback(i);
+    }
+  };
+
+  if (isSingleThreaded() || end - begin <= grainSize) {
+    processRange(begin, end);
+    return;
+  }
+
+  std::vector<JobHandle> jobs;
+  jobs.reserve((end - begin) / grainSize);
+  for (auto first = begin + grainSize; first < end; first += grainSize) {
+    const auto last = std::min(first + grainSize, end);
+    jobs.push_back(
+      submit([&processRange, first, last]() { processRange(first, last); }));
+  }
+
+  // The jobs reference our local state, so we must not leave before they
+  // are done - even if processing the first chunk fails.
+  try {
+    processRange(begin, begin + grainSize);
+  } catch (...) {
+    try {
+      waitAll(jobs);
+    } catch (...) {
+    }
+
+    throw;
+  }
+
+  waitAll(jobs);
+}
+
+}
@@ -19,6 +19,7 @@
 #include "base/spatial_types.hpp"
 #include "data/game_session_data.hpp"
 
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <utility>
@@ -31,7 +32,14 @@ struct CommandLineOptions {
   std::optional<data::GameSessionId> mLevelToJumpTo;
   bool mSkipIntro = false;
   bool mDebugModeEnabled = false;
+  bool mUseRenderThread = false;
+  std::optional<std::size_t> mTextureMemoryBudgetMb;
+  bool mRejectTexturesOverBudget = false;
   std::optional<base::Vector> mPlayerPosition;
+  std::optional<float> mHitchThresholdMs;
+  std::string mHitchReportToReplay;
+  std::string mComparisonOptionOverrides;
+  bool mExitAfterStartup = false;
 };
 
 }
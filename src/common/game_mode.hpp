@@ -66,6 +66,15 @@ struct GameMode {
   virtual std::unique_ptr<GameMode> updateAndRender(
     engine::TimeDelta dt,
     const std::vector<SDL_Event>& events) = 0;
+
+  /** Called after game assets have been reloaded in place
+   *
+   * Modes which hold on to data created from assets should re-enter their
+   * current state here, so that the changes become visible. The default
+   * does nothing, which is fine for modes that load what they need on
+   * demand.
+   */
+  virtual void handleAssetReload() {}
 };
 
 
@@ -0,0 +1,79 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "startup_timeline.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+
+namespace rigel {
+
+StartupTimeline::StartupTimeline()
+  : mStartTime(Clock::now())
+  , mEndOfLastPhase(mStartTime)
+{
+}
+
+
+void StartupTimeline::completePhase(const char* name) {
+  addPhase(name, mEndOfLastPhase, Clock::now());
+}
+
+
+double StartupTimeline::totalMs() const {
+  return msSinceStart(mEndOfLastPhase);
+}
+
+
+void StartupTimeline::print(std::ostream& stream) const {
+  const auto flagsGuard = base::defer(
+    [&stream, flags = stream.flags()]() { stream.flags(flags); });
+
+  stream << "Startup timeline (start + duration, in ms):\n";
+  stream << std::fixed << std::setprecision(2);
+
+  for (const auto& phase : mPhases) {
+    stream
+      << std::setw(10) << phase.mStartMs << " + "
+      << std::setw(9) << phase.mDurationMs << "  "
+      << phase.mName << '\n';
+  }
+
+  stream << "Total startup time: " << totalMs() << " ms\n";
+}
+
+
+void StartupTimeline::addPhase(
+  const char* name,
+  const Clock::time_point start,
+  const Clock::time_point end
+) {
+  mPhases.push_back(Phase{
+    name,
+    msSinceStart(start),
+    std::chrono::duration<double, std::milli>(end - start).count()});
+  mEndOfLastPhase = std::max(mEndOfLastPhase, end);
+}
+
+
+double StartupTimeline::msSinceStart(const Clock::time_point timePoint) const {
+  return
+    std::chrono::duration<double, std::milli>(timePoint - mStartTime).count();
+}
+
+}
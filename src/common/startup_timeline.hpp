@@ -0,0 +1,102 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/defer.hpp"
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace rigel {
+
+/** Records how long the individual phases of starting up the game take
+ *
+ * Time is measured from the construction of the timeline. Phases can either
+ * be recorded by wrapping the code in question with measure(), or by calling
+ * completePhase() once a phase is done, which attributes all time since the
+ * end of the previously recorded phase to it.
+ */
+class StartupTimeline {
+public:
+  using Clock = std::chrono::high_resolution_clock;
+
+  struct Phase {
+    std::string mName;
+    double mStartMs;
+    double mDurationMs;
+  };
+
+  StartupTimeline();
+
+  /** Invoke func, record it as a phase, and return its result
+   *
+   * Since the result is returned as is, this can also be used to initialize
+   * objects which are neither copyable nor movable.
+   */
+  template <typename Func>
+  decltype(auto) measure(const char* name, Func&& func) {
+    const auto start = Clock::now();
+    auto recordPhase = base::defer([&, this]() {
+      addPhase(name, start, Clock::now());
+    });
+    return func();
+  }
+
+  void completePhase(const char* name);
+
+  const std::vector<Phase>& phases() const {
+    return mPhases;
+  }
+
+  /** Time from construction until the end of the last recorded phase */
+  double totalMs() const;
+
+  void print(std::ostream& stream) const;
+
+private:
+  void addPhase(
+    const char* name,
+    Clock::time_point start,
+    Clock::time_point end);
+
+  double msSinceStart(Clock::time_point timePoint) const;
+
+  Clock::time_point mStartTime;
+  Clock::time_point mEndOfLastPhase;
+  std::vector<Phase> mPhases;
+};
+
+
+/** Like StartupTimeline::measure, but tolerates a null timeline */
+template <typename Func>
+decltype(auto) measureStartupPhase(
+  StartupTimeline* pTimeline,
+  const char* name,
+  Func&& func
+) {
+  if (pTimeline) {
+    return pTimeline->measure(name, std::forward<Func>(func));
+  }
+
+  return func();
+}
+
+}
@@ -0,0 +1,194 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "timing_comparison.hpp"
+
+#include "base/defer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+
+namespace rigel {
+
+namespace {
+
+// Two-sided 95% quantile of the standard normal distribution
+constexpr auto Z_95 = 1.96;
+
+
+double medianOfSorted(const std::vector<double>& values) {
+  const auto middle = values.size() / 2;
+  return values.size() % 2 == 0
+    ? (values[middle - 1] + values[middle]) / 2.0
+    : values[middle];
+}
+
+
+double median(std::vector<double> values) {
+  std::sort(values.begin(), values.end());
+  return medianOfSorted(values);
+}
+
+}
+
+
+TimingDelta comparePairedTimings(
+  const std::vector<double>& samplesA,
+  const std::vector<double>& samplesB
+) {
+  if (samplesA.size() != samplesB.size()) {
+    throw std::invalid_argument("Timing samples must be given in pairs");
+  }
+
+  if (samplesA.empty()) {
+    throw std::invalid_argument("No timing samples given");
+  }
+
+  const auto numSamples = samplesA.size();
+
+  std::vector<double> differences;
+  differences.reserve(numSamples);
+  std::transform(
+    samplesA.begin(),
+    samplesA.end(),
+    samplesB.begin(),
+    std::back_inserter(differences),
+    [](const double a, const double b) { return b - a; });
+  std::sort(differences.begin(), differences.end());
+
+  // The number of differences below the true median follows a binomial
+  // distribution with p = 0.5. Using its normal approximation, the k-th
+  // smallest and k-th largest difference bound the median with 95%
+  // confidence. k is a 1-based rank. For very few samples, this degrades
+  // to the full range.
+  const auto n = static_cast<double>(numSamples);
+  const auto k = static_cast<std::size_t>(
+    std::max(1.0, std::floor((n - Z_95 * std::sqrt(n)) / 2.0)));
+
+  TimingDelta result;
+  result.mNumSamples = numSamples;
+  result.mMedianA = median(samplesA);
+  result.mMedianB = median(samplesB);
+  result.mMedianDifference = medianOfSorted(differences);
+  result.mLowerBound = differences[k - 1];
+  result.mUpperBound = differences[numSamples - k];
+  return result;
+}
+
+
+TimingComparison::TimingComparison(std::string nameA, std::string nameB)
+  : mNameA(std::move(nameA))
+  , mNameB(std::move(nameB))
+{
+}
+
+
+void TimingComparison::addSamples(
+  const std::string& measurement,
+  const double sampleA,
+  const double sampleB
+) {
+  auto iMeasurement = std::find_if(
+    mMeasurements.begin(),
+    mMeasurements.end(),
+    [&](const Measurement& candidate) {
+      return candidate.mName == measurement;
+    });
+  if (iMeasurement == mMeasurements.end()) {
+    mMeasurements.push_back(Measurement{measurement, {}, {}});
+    iMeasurement = std::prev(mMeasurements.end());
+  }
+
+  iMeasurement->mSamplesA.push_back(sampleA);
+  iMeasurement->mSamplesB.push_back(sampleB);
+}
+
+
+TimingDelta TimingComparison::delta(const std::string& measurement) const {
+  const auto& entry = find(measurement);
+  return comparePairedTimings(entry.mSamplesA, entry.mSamplesB);
+}
+
+
+void TimingComparison::print(std::ostream& stream) const {
+  const auto flagsGuard = base::defer(
+    [&stream, flags = stream.flags()]() { stream.flags(flags); });
+
+  stream
+    << "Median timings in ms, delta is " << mNameB << " - " << mNameA
+    << " with 95% confidence interval (* = significant):\n";
+  stream << std::fixed << std::setprecision(3);
+
+  stream
+    << std::setw(20) << "" << std::setw(12) << mNameA
+    << std::setw(12) << mNameB << std::setw(12) << "delta" << '\n';
+
+  for (const auto& measurement : mMeasurements) {
+    const auto result =
+      comparePairedTimings(measurement.mSamplesA, measurement.mSamplesB);
+
+    stream
+      << std::left << std::setw(20) << measurement.mName << std::right
+      << std::setw(12) << result.mMedianA
+      << std::setw(12) << result.mMedianB
+      << std::setw(12) << result.mMedianDifference
+      << "  [" << result.mLowerBound << ", " << result.mUpperBound << ']';
+
+    if (result.mMedianA > 0.0) {
+      stream
+        << std::setprecision(1) << "  "
+        << std::showpos << result.mMedianDifference / result.mMedianA * 100.0
+        << std::noshowpos << '%' << std::setprecision(3);
+    }
+
+    if (result.isSignificant()) {
+      stream << " *";
+    }
+
+    stream << '\n';
+  }
+
+  if (!mMeasurements.empty()) {
+    stream
+      << "Based on " << mMeasurements.front().mSamplesA.size()
+      << " pairs of samples\n";
+  }
+}
+
+
+auto TimingComparison::find(const std::string& measurement) const
+  -> const Measurement&
+{
+  const auto iMeasurement = std::find_if(
+    mMeasurements.begin(),
+    mMeasurements.end(),
+    [&](const Measurement& candidate) {
+      return candidate.mName == measurement;
+    });
+  if (iMeasurement == mMeasurements.end()) {
+    throw std::invalid_argument("Unknown measurement: " + measurement);
+  }
+
+  return *iMeasurement;
+}
+
+}
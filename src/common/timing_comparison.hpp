@@ -0,0 +1,97 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+namespace rigel {
+
+/** Difference between two configurations for one kind of timing
+ *
+ * All times are in milliseconds. The difference is always B - A, so a
+ * negative value means that B is faster.
+ */
+struct TimingDelta {
+  std::size_t mNumSamples = 0;
+  double mMedianA = 0.0;
+  double mMedianB = 0.0;
+
+  /** Median of the per-sample differences, plus 95% confidence interval */
+  double mMedianDifference = 0.0;
+  double mLowerBound = 0.0;
+  double mUpperBound = 0.0;
+
+  /** True if the confidence interval doesn't include zero */
+  bool isSignificant() const {
+    return mLowerBound > 0.0 || mUpperBound < 0.0;
+  }
+};
+
+
+/** Compare paired timing samples of two configurations
+ *
+ * Sample i of A and sample i of B must have been measured doing the same
+ * work, e.g. running the same logic update. Looking at the per-pair
+ * differences instead of comparing the two sets of samples as a whole
+ * removes most of the variation coming from the workload itself.
+ *
+ * The medians and confidence interval are distribution-free (based on the
+ * sign test), so that a few outliers like a hitch caused by the OS can't
+ * skew the result.
+ *
+ * Throws an exception if the sample counts don't match, or are zero.
+ */
+TimingDelta comparePairedTimings(
+  const std::vector<double>& samplesA,
+  const std::vector<double>& samplesB);
+
+
+/** Collects paired timing samples for multiple named measurements */
+class TimingComparison {
+public:
+  TimingComparison(std::string nameA, std::string nameB);
+
+  /** Add a pair of samples, creating the measurement on first use */
+  void addSamples(
+    const std::string& measurement,
+    double sampleA,
+    double sampleB);
+
+  TimingDelta delta(const std::string& measurement) const;
+
+  /** Print a table with one row per measurement, in order of creation */
+  void print(std::ostream& stream) const;
+
+private:
+  struct Measurement {
+    std::string mName;
+    std::vector<double> mSamplesA;
+    std::vector<double> mSamplesB;
+  };
+
+  const Measurement& find(const std::string& measurement) const;
+
+  std::string mNameA;
+  std::string mNameB;
+  std::vector<Measurement> mMeasurements;
+};
+
+}
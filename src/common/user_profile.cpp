@@ -28,6 +28,7 @@ RIGEL_RESTORE_WARNINGS
 
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 
 
 namespace rigel {
@@ -83,6 +84,18 @@ NLOHMANN_JSON_SERIALIZE_ENUM(WindowMode, {
   {WindowMode::Windowed, "Windowed"},
 })
 
+
+NLOHMANN_JSON_SERIALIZE_ENUM(BackgroundMode, {
+  {BackgroundMode::Pause, "Pause"},
+  {BackgroundMode::LowRefreshRate, "LowRefreshRate"},
+})
+
+
+NLOHMANN_JSON_SERIALIZE_ENUM(AdlibEmulatorType, {
+  {AdlibEmulatorType::DBOPL, "DBOPL"},
+  {AdlibEmulatorType::Fast, "Fast"},
+})
+
 }
 
 
@@ -193,10 +206,14 @@ nlohmann::json serialize(const data::GameOptions& options) {
   serialized["enableFpsLimit"] = options.mEnableFpsLimit;
   serialized["maxFps"] = options.mMaxFps;
   serialized["showFpsCounter"] = options.mShowFpsCounter;
+  serialized["backgroundMode"] = options.mBackgroundMode;
+  serialized["enableIndexedColorTextures"] =
+    options.mEnableIndexedColorTextures;
   serialized["musicVolume"] = options.mMusicVolume;
   serialized["soundVolume"] = options.mSoundVolume;
   serialized["musicOn"] = options.mMusicOn;
   serialized["soundOn"] = options.mSoundOn;
+  serialized["adlibEmulatorType"] = options.mAdlibEmulatorType;
   serialized["widescreenModeOn"] = options.mWidescreenModeOn;
   return serialized;
 }
@@ -337,10 +354,14 @@ data::GameOptions deserialize<data::GameOptions>(const nlohmann::json& json) {
   extractValueIfExists("enableFpsLimit", result.mEnableFpsLimit, json);
   extractValueIfExists("maxFps", result.mMaxFps, json);
   extractValueIfExists("showFpsCounter", result.mShowFpsCounter, json);
+  extractValueIfExists("backgroundMode", result.mBackgroundMode, json);
+  extractValueIfExists(
+    "enableIndexedColorTextures", result.mEnableIndexedColorTextures, json);
   extractValueIfExists("musicVolume", result.mMusicVolume, json);
   extractValueIfExists("soundVolume", result.mSoundVolume, json);
   extractValueIfExists("musicOn", result.mMusicOn, json);
   extractValueIfExists("soundOn", result.mSoundOn, json);
+  extractValueIfExists("adlibEmulatorType", result.mAdlibEmulatorType, json);
   extractValueIfExists("widescreenModeOn", result.mWidescreenModeOn, json);
 
 
@@ -552,4 +573,33 @@ UserProfile loadOrCreateUserProfile() {
   return profile;
 }
 
+
+data::GameOptions withOptionOverrides(
+  const data::GameOptions& options,
+  const std::string& overridesJson
+) {
+  const auto overrides = nlohmann::json::parse(overridesJson);
+  if (!overrides.is_object()) {
+    throw std::invalid_argument("Option overrides must be a JSON object");
+  }
+
+  auto serialized = serialize(options);
+  for (const auto& [key, value] : overrides.items()) {
+    if (!serialized.contains(key)) {
+      throw std::invalid_argument("Unknown option: " + key);
+    }
+
+    auto& current = serialized[key];
+    const auto isSameKind = current.type() == value.type() ||
+      (current.is_number() && value.is_number());
+    if (!isSameKind) {
+      throw std::invalid_argument("Wrong type of value for option: " + key);
+    }
+
+    current = value;
+  }
+
+  return deserialize<data::GameOptions>(serialized);
+}
+
 }
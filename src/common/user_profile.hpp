@@ -97,6 +97,17 @@ void importOriginalGameProfileData(
 /** Loads existing profile if found, creates a new one otherwise. */
 UserProfile loadOrCreateUserProfile();
 
+/** Return a copy of the given options, with some values replaced
+ *
+ * The replacements are given as a JSON object, using the same keys as the
+ * options stored in the profile file, e.g. `{"widescreenModeOn": true}`.
+ * Throws an exception if the string is not a valid JSON object, or contains
+ * keys which don't name an option.
+ */
+data::GameOptions withOptionOverrides(
+  const data::GameOptions& options,
+  const std::string& overridesJson);
+
 
 /** Return path for storing preferences
  *
@@ -49,6 +49,39 @@ enum class WindowMode {
 #endif
 
 
+/** What to do while the window doesn't have focus
+ *
+ * Pause stops running the game entirely until the window becomes active
+ * again. LowRefreshRate keeps the game running, but only renders a few
+ * frames per second to reduce CPU and GPU usage. Audio keeps playing in both
+ * cases. A minimized or hidden window always pauses the game.
+ *
+ * Neither applies when running in a web browser: Blocking or waiting would
+ * stall the browser's main loop, which already throttles pages that are
+ * not visible.
+ */
+enum class BackgroundMode {
+  Pause,
+  LowRefreshRate
+};
+
+constexpr auto DEFAULT_BACKGROUND_MODE = BackgroundMode::LowRefreshRate;
+
+
+/** Which OPL2 emulator to use for music and Adlib sound effects
+ *
+ * DBOPL is the emulator from DOSBox, which emulates the entire chip. Fast
+ * only covers the features actually used by the game, see
+ * loader/fast_opl2.hpp.
+ */
+enum class AdlibEmulatorType {
+  DBOPL,
+  Fast
+};
+
+constexpr auto DEFAULT_ADLIB_EMULATOR_TYPE = AdlibEmulatorType::DBOPL;
+
+
 /** Data-model for user-configurable options/settings
  *
  * This struct contains everything that can be configured by the user in
@@ -75,12 +108,18 @@ struct GameOptions {
   bool mEnableFpsLimit = true; // Only relevant when mEnableVsync == false
   int mMaxFps = 60; // Only relevant when mEnableFpsLimit == true
   bool mShowFpsCounter = false;
+  BackgroundMode mBackgroundMode = DEFAULT_BACKGROUND_MODE;
+
+  // Keep tile sets and sprites as palette indices on the GPU, instead of
+  // expanding them to RGBA. Takes effect on next level load.
+  bool mEnableIndexedColorTextures = false;
 
   // Sound
   float mMusicVolume = MUSIC_VOLUME_DEFAULT;
   float mSoundVolume = SOUND_VOLUME_DEFAULT;
   bool mMusicOn = true;
   bool mSoundOn = true;
+  AdlibEmulatorType mAdlibEmulatorType = DEFAULT_ADLIB_EMULATOR_TYPE;
 
   // Enhancements
   bool mWidescreenModeOn = false;
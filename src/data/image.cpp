@@ -16,6 +16,7 @@
 
 #include "image.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
 
@@ -83,4 +84,44 @@ void Image::insertImage(
 }
 
 
+IndexedImage::IndexedImage(
+  IndexedPixelBuffer&& pixels,
+  const std::size_t width,
+  const std::size_t height
+)
+  : mPixels(std::move(pixels))
+  , mWidth(width)
+  , mHeight(height)
+{
+}
+
+
+IndexedImage::IndexedImage(
+  const std::size_t width,
+  const std::size_t height
+)
+  : IndexedImage(IndexedPixelBuffer(width*height, 0), width, height)
+{
+}
+
+
+void IndexedImage::insertImage(
+  const size_t x,
+  const size_t y,
+  const IndexedImage& image
+) {
+  if (x + image.width() > mWidth || y + image.height() > mHeight) {
+    throw invalid_argument("Source image doesn't fit");
+  }
+
+  for (size_t row=0; row<image.height(); ++row) {
+    const auto sourceStart = image.mPixels.begin() + row*image.width();
+    copy(
+      sourceStart,
+      sourceStart + image.width(),
+      mPixels.begin() + x + (y+row)*mWidth);
+  }
+}
+
+
 }
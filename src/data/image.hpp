@@ -19,6 +19,7 @@
 #include "base/color.hpp"
 
 #include <cstdint>
+#include <variant>
 #include <vector>
 
 
@@ -27,6 +28,9 @@ namespace rigel::data {
 using Pixel = rigel::base::Color;
 using PixelBuffer = std::vector<Pixel>;
 
+using IndexedPixel = std::uint8_t;
+using IndexedPixelBuffer = std::vector<IndexedPixel>;
+
 
 /** Simple technology-agnostic image data holder.
  *
@@ -64,4 +68,53 @@ private:
 };
 
 
+/** Image storing indices into a 16-color palette instead of colors
+ *
+ * All of the original game's graphics are 16-color EGA images, so they can
+ * be represented with a quarter of the memory needed for an Image.
+ *
+ * The lower 4 bits of each pixel hold the color index. Values of
+ * MASKED_PIXEL_FLAG and above are reserved for masked (i.e. transparent)
+ * pixels.
+ */
+class IndexedImage {
+public:
+  static constexpr IndexedPixel COLOR_INDEX_MASK = 0x0F;
+  static constexpr IndexedPixel MASKED_PIXEL_FLAG = 0x10;
+
+  IndexedImage(
+    IndexedPixelBuffer&& pixels,
+    std::size_t width,
+    std::size_t height);
+  IndexedImage(std::size_t width, std::size_t height);
+
+  const IndexedPixelBuffer& pixelData() const {
+    return mPixels;
+  }
+
+  std::size_t width() const {
+    return mWidth;
+  }
+
+  std::size_t height() const {
+    return mHeight;
+  }
+
+  void insertImage(std::size_t x, std::size_t y, const IndexedImage& image);
+
+private:
+  IndexedPixelBuffer mPixels;
+  std::size_t mWidth;
+  std::size_t mHeight;
+};
+
+
+/** Image which is either in RGBA or indexed format
+ *
+ * Graphics from the game's data files can be kept in indexed format, but
+ * replacement images (e.g. PNG files for actor sprites) are always RGBA.
+ */
+using AnyImage = std::variant<Image, IndexedImage>;
+
+
 }
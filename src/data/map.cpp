@@ -74,10 +74,60 @@ void Map::clearSection(
   const int width,
   const int height
 ) {
-  for (auto row = y; row < y+height; ++row) {
-    for (auto col = x; col < x + width; ++col) {
-      setTileAt(0, col, row, 0);
-      setTileAt(1, col, row, 0);
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  checkSectionBounds(x, y, width, height);
+
+  for (auto layer = 0; layer < int(mLayers.size()); ++layer) {
+    for (auto row = y; row < y + height; ++row) {
+      const auto start = rowStart(layer, x, row);
+      fill(start, start + width, TileIndex{0});
+    }
+  }
+}
+
+
+void Map::copySection(
+  const base::Rect<int>& source,
+  const base::Vector& destination
+) {
+  const auto width = source.size.width;
+  const auto height = source.size.height;
+
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+
+  checkSectionBounds(source.left(), source.top(), width, height);
+  checkSectionBounds(destination.x, destination.y, width, height);
+
+  const auto copyRow = [&](const int layer, const int row) {
+    const auto sourceStart =
+      rowStart(layer, source.left(), source.top() + row);
+    const auto targetStart =
+      rowStart(layer, destination.x, destination.y + row);
+
+    // Source and target can only overlap when they are on the same map row
+    if (targetStart < sourceStart) {
+      copy(sourceStart, sourceStart + width, targetStart);
+    } else {
+      copy_backward(sourceStart, sourceStart + width, targetStart + width);
+    }
+  };
+
+  for (auto layer = 0; layer < int(mLayers.size()); ++layer) {
+    // When moving down, start with the lower-most row so that source rows
+    // aren't overwritten before they have been copied - and vice versa.
+    if (destination.y > source.top()) {
+      for (auto row = height - 1; row >= 0; --row) {
+        copyRow(layer, row);
+      }
+    } else {
+      for (auto row = 0; row < height; ++row) {
+        copyRow(layer, row);
+      }
     }
   }
 }
@@ -166,4 +216,28 @@ map::TileIndex& Map::tileRefAt(
 }
 
 
+void Map::checkSectionBounds(
+  const int x,
+  const int y,
+  const int width,
+  const int height
+) const {
+  if (x < 0 || x + width > this->width()) {
+    throw invalid_argument("Section exceeds map horizontally");
+  }
+  if (y < 0 || y + height > this->height()) {
+    throw invalid_argument("Section exceeds map vertically");
+  }
+}
+
+
+vector<map::TileIndex>::iterator Map::rowStart(
+  const int layer,
+  const int x,
+  const int y
+) {
+  return mLayers[layer].begin() + (x + y * width());
+}
+
+
 }
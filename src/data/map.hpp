@@ -62,8 +62,20 @@ public:
     return static_cast<int>(mHeightInTiles);
   }
 
+  /** Set all tiles in the given section to 0, on both layers */
   void clearSection(int x, int y, int width, int height);
 
+  /** Copy a section of tiles to another position, on both layers
+   *
+   * Source and destination may overlap, the result is the same as if the
+   * source had been copied to a temporary buffer first. Tiles are copied
+   * row by row, so large sections are much cheaper to move than when using
+   * setTileAt() for each tile.
+   */
+  void copySection(
+    const base::Rect<int>& source,
+    const base::Vector& destination);
+
   const TileAttributeDict& attributeDict() const;
   TileAttributes attributes(int x, int y) const;
 
@@ -73,6 +85,9 @@ private:
   const TileIndex& tileRefAt(int layer, int x, int y) const;
   TileIndex& tileRefAt(int layer, int x, int y);
 
+  void checkSectionBounds(int x, int y, int width, int height) const;
+  std::vector<TileIndex>::iterator rowStart(int layer, int x, int y);
+
 private:
   using TileArray = std::vector<TileIndex>;
   std::array<TileArray, 2> mLayers;
@@ -91,7 +106,7 @@ struct LevelData {
     std::optional<base::Rect<int>> mAssignedArea;
   };
 
-  Image mTileSetImage;
+  IndexedImage mTileSetImage;
   Image mBackdropImage;
   std::optional<Image> mSecondaryBackdropImage;
 
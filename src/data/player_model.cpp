@@ -20,12 +20,18 @@
 
 #include <algorithm>
 #include <cassert>
+#include <type_traits>
 
 
 namespace rigel::data {
 
+static_assert(std::is_trivially_copyable_v<PlayerModel>);
+
+
 PlayerModel::PlayerModel()
-  : mWeapon(WeaponType::Normal)
+  : mCollectedLetters()
+  , mInventory()
+  , mWeapon(WeaponType::Normal)
   , mScore(0)
   , mAmmo(MAX_AMMO)
   , mHealth(MAX_HEALTH)
@@ -34,11 +40,13 @@ PlayerModel::PlayerModel()
 
 
 PlayerModel::PlayerModel(const SavedGame& save)
-  : mTutorialMessages(save.mTutorialMessagesAlreadySeen)
+  : mCollectedLetters()
+  , mInventory()
   , mWeapon(save.mWeapon)
   , mScore(save.mScore)
   , mAmmo(save.mAmmo)
   , mHealth(MAX_HEALTH)
+  , mTutorialMessages(save.mTutorialMessagesAlreadySeen)
 {
 }
 
@@ -49,9 +57,21 @@ PlayerModel::CheckpointState PlayerModel::makeCheckpoint() const {
 
 
 void PlayerModel::restoreFromCheckpoint(const CheckpointState& state) {
-  mHealth = std::max(2, state.mHealth);
-  mWeapon = state.mWeapon;
-  mAmmo = state.mAmmo;
+  setHealth(std::max(2, state.mHealth));
+  setWeaponAndAmmo(state.mWeapon, state.mAmmo);
+}
+
+
+void PlayerModel::restoreFromSnapshot(const PlayerModel& snapshot) {
+  auto generations = mGenerations;
+  ++generations.mScore;
+  ++generations.mAmmo;
+  ++generations.mHealth;
+  ++generations.mInventory;
+  ++generations.mLetters;
+
+  *this = snapshot;
+  mGenerations = generations;
 }
 
 
@@ -61,7 +81,11 @@ int PlayerModel::score() const {
 
 
 void PlayerModel::giveScore(const int amount) {
-  mScore = std::clamp(mScore + amount, 0, MAX_SCORE);
+  const auto newScore = std::clamp(mScore + amount, 0, MAX_SCORE);
+  if (newScore != mScore) {
+    mScore = newScore;
+    ++mGenerations.mScore;
+  }
 }
 
 
@@ -87,14 +111,15 @@ bool PlayerModel::currentWeaponConsumesAmmo() const {
 
 
 void PlayerModel::switchToWeapon(const WeaponType type) {
-  mWeapon = type;
-  mAmmo = currentMaxAmmo();
+  const auto maxAmmo =
+    type == WeaponType::FlameThrower ? MAX_AMMO_FLAME_THROWER : MAX_AMMO;
+  setWeaponAndAmmo(type, maxAmmo);
 }
 
 
 void PlayerModel::useAmmo() {
   if (currentWeaponConsumesAmmo()) {
-    --mAmmo;
+    setWeaponAndAmmo(mWeapon, mAmmo - 1);
     if (mAmmo <= 0) {
       switchToWeapon(WeaponType::Normal);
     }
@@ -104,7 +129,7 @@ void PlayerModel::useAmmo() {
 
 void PlayerModel::setAmmo(int amount) {
   assert(amount >= 0 && amount <= currentMaxAmmo());
-  mAmmo = amount;
+  setWeaponAndAmmo(mWeapon, amount);
 }
 
 
@@ -124,49 +149,68 @@ bool PlayerModel::isDead() const {
 
 
 void PlayerModel::takeDamage(const int amount) {
-  mHealth = std::clamp(mHealth - amount, 0, MAX_HEALTH);
+  setHealth(std::clamp(mHealth - amount, 0, MAX_HEALTH));
 }
 
 
 void PlayerModel::takeFatalDamage() {
-  mHealth = 0;
+  setHealth(0);
 }
 
 
 void PlayerModel::giveHealth(const int amount) {
-  mHealth = std::clamp(mHealth + amount, 0, MAX_HEALTH);
+  setHealth(std::clamp(mHealth + amount, 0, MAX_HEALTH));
 }
 
 
-const std::vector<InventoryItemType>& PlayerModel::inventory() const {
-  return mInventory;
+base::ArrayView<InventoryItemType> PlayerModel::inventory() const {
+  return {mInventory.data(), static_cast<std::uint32_t>(mInventorySize)};
 }
 
 
 bool PlayerModel::hasItem(const InventoryItemType type) const {
   using namespace std;
 
-  return find(begin(mInventory), end(mInventory), type) != end(mInventory);
+  const auto items = inventory();
+  return find(begin(items), end(items), type) != end(items);
 }
 
 
-void PlayerModel::giveItem(InventoryItemType type) {
-  mInventory.push_back(type);
+bool PlayerModel::isInventoryFull() const {
+  return mInventorySize >= MAX_INVENTORY_SIZE;
+}
+
+
+bool PlayerModel::giveItem(InventoryItemType type) {
+  if (isInventoryFull()) {
+    return false;
+  }
+
+  mInventory[mInventorySize] = type;
+  ++mInventorySize;
+  ++mGenerations.mInventory;
+  return true;
 }
 
 
 void PlayerModel::removeItem(const InventoryItemType type) {
   using namespace std;
 
-  auto iItem = find(begin(mInventory), end(mInventory), type);
-  if (iItem != end(mInventory)) {
-    mInventory.erase(iItem);
+  const auto iBegin = begin(mInventory);
+  const auto iEnd = iBegin + mInventorySize;
+  const auto iItem = find(iBegin, iEnd, type);
+  if (iItem != iEnd) {
+    copy(next(iItem), iEnd, iItem);
+    --mInventorySize;
+    ++mGenerations.mInventory;
   }
 }
 
 
-const std::vector<CollectableLetterType>& PlayerModel::collectedLetters() const {
-  return mCollectedLetters;
+base::ArrayView<CollectableLetterType> PlayerModel::collectedLetters() const {
+  return {
+    mCollectedLetters.data(),
+    static_cast<std::uint32_t>(mNumCollectedLetters)};
 }
 
 
@@ -174,16 +218,23 @@ PlayerModel::LetterCollectionState PlayerModel::addLetter(
   const CollectableLetterType type
 ) {
   using L = CollectableLetterType;
-  static std::vector<L> sExpectedOrder = {
+  static constexpr std::array<L, NUM_COLLECTABLE_LETTERS> EXPECTED_ORDER{
     L::N, L::U, L::K, L::E, L::M};
 
+  // Collecting more letters than there are in the expected sequence can
+  // never result in the right order.
+  if (mNumCollectedLetters == NUM_COLLECTABLE_LETTERS) {
+    return LetterCollectionState::WrongOrder;
+  }
 
-  mCollectedLetters.push_back(type);
+  mCollectedLetters[mNumCollectedLetters] = type;
+  ++mNumCollectedLetters;
+  ++mGenerations.mLetters;
 
-  if (mCollectedLetters.size() < 5) {
+  if (mNumCollectedLetters < NUM_COLLECTABLE_LETTERS) {
     return LetterCollectionState::Incomplete;
   } else {
-    return mCollectedLetters == sExpectedOrder
+    return mCollectedLetters == EXPECTED_ORDER
       ? LetterCollectionState::InOrder
       : LetterCollectionState::WrongOrder;
   }
@@ -191,9 +242,17 @@ PlayerModel::LetterCollectionState PlayerModel::addLetter(
 
 
 void PlayerModel::resetForNewLevel() {
-  mHealth = MAX_HEALTH;
-  mCollectedLetters.clear();
-  mInventory.clear();
+  setHealth(MAX_HEALTH);
+
+  if (mNumCollectedLetters != 0) {
+    mNumCollectedLetters = 0;
+    ++mGenerations.mLetters;
+  }
+
+  if (mInventorySize != 0) {
+    mInventorySize = 0;
+    ++mGenerations.mInventory;
+  }
 }
 
 
@@ -206,4 +265,21 @@ const TutorialMessageState& PlayerModel::tutorialMessages() const {
   return mTutorialMessages;
 }
 
+
+void PlayerModel::setHealth(const int health) {
+  if (health != mHealth) {
+    mHealth = health;
+    ++mGenerations.mHealth;
+  }
+}
+
+
+void PlayerModel::setWeaponAndAmmo(const WeaponType weapon, const int ammo) {
+  if (weapon != mWeapon || ammo != mAmmo) {
+    mWeapon = weapon;
+    mAmmo = ammo;
+    ++mGenerations.mAmmo;
+  }
+}
+
 }
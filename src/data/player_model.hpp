@@ -16,9 +16,11 @@
 
 #pragma once
 
+#include "base/array_view.hpp"
 #include "data/tutorial_messages.hpp"
 
-#include <vector>
+#include <array>
+#include <cstdint>
 
 
 namespace rigel::data {
@@ -26,7 +28,7 @@ namespace rigel::data {
 struct SavedGame;
 
 
-enum class InventoryItemType {
+enum class InventoryItemType : std::int8_t {
   CircuitBoard,
   BlueKey,
   RapidFire,
@@ -35,7 +37,7 @@ enum class InventoryItemType {
 };
 
 
-enum class CollectableLetterType {
+enum class CollectableLetterType : std::int8_t {
   N,
   U,
   K,
@@ -57,9 +59,36 @@ constexpr auto MAX_AMMO = 32;
 constexpr auto MAX_AMMO_FLAME_THROWER = 64;
 constexpr auto MAX_HEALTH = 9;
 
+// The HUD has room for 6 items. Items given to the player while the
+// inventory is full are dropped.
+constexpr auto MAX_INVENTORY_SIZE = 6;
+constexpr auto NUM_COLLECTABLE_LETTERS = 5;
 
+
+/** Holds all player state which persists across deaths and checkpoints
+ *
+ * The model is trivially copyable (and small), so taking a snapshot of it for
+ * a level restart is just a memcpy.
+ *
+ * Each aspect of the model has a change generation counter, which is
+ * incremented every time the corresponding value(s) change. Consumers like
+ * the HUD can remember the generations they've last seen, and skip work when
+ * a generation is unchanged.
+ */
 class PlayerModel {
 public:
+  // Unsigned, since the counters are expected to wrap around eventually.
+  // Generations should only ever be compared for equality.
+  using Generation = std::uint32_t;
+
+  struct ChangeGenerations {
+    Generation mScore = 0;
+    Generation mAmmo = 0; // also includes the current weapon
+    Generation mHealth = 0;
+    Generation mInventory = 0;
+    Generation mLetters = 0;
+  };
+
   struct CheckpointState {
     WeaponType mWeapon;
     int mAmmo;
@@ -78,6 +107,13 @@ public:
   CheckpointState makeCheckpoint() const;
   void restoreFromCheckpoint(const CheckpointState& state);
 
+  /** Replace all state with that of the given snapshot
+   *
+   * Unlike plain assignment, this keeps the change generations moving
+   * forward, so that consumers are guaranteed to notice the change.
+   */
+  void restoreFromSnapshot(const PlayerModel& snapshot);
+
   int score() const;
   void giveScore(int amount);
 
@@ -98,12 +134,19 @@ public:
   void takeFatalDamage();
   void giveHealth(int amount);
 
-  const std::vector<InventoryItemType>& inventory() const;
+  base::ArrayView<InventoryItemType> inventory() const;
   bool hasItem(const InventoryItemType type) const;
-  void giveItem(InventoryItemType type);
+  bool isInventoryFull() const;
+
+  /** Add item to the inventory
+   *
+   * Returns false and leaves the inventory unchanged if it already holds
+   * MAX_INVENTORY_SIZE items.
+   */
+  bool giveItem(InventoryItemType type);
   void removeItem(const InventoryItemType type);
 
-  const std::vector<CollectableLetterType>& collectedLetters() const;
+  base::ArrayView<CollectableLetterType> collectedLetters() const;
   LetterCollectionState addLetter(CollectableLetterType type);
 
   void resetForNewLevel();
@@ -111,14 +154,24 @@ public:
   TutorialMessageState& tutorialMessages();
   const TutorialMessageState& tutorialMessages() const;
 
+  const ChangeGenerations& changeGenerations() const {
+    return mGenerations;
+  }
+
 private:
-  std::vector<CollectableLetterType> mCollectedLetters;
-  std::vector<InventoryItemType> mInventory;
-  TutorialMessageState mTutorialMessages;
+  void setHealth(int health);
+  void setWeaponAndAmmo(WeaponType weapon, int ammo);
+
+  std::array<CollectableLetterType, NUM_COLLECTABLE_LETTERS> mCollectedLetters;
+  std::array<InventoryItemType, MAX_INVENTORY_SIZE> mInventory;
+  std::int8_t mNumCollectedLetters = 0;
+  std::int8_t mInventorySize = 0;
   WeaponType mWeapon;
   int mScore;
   int mAmmo;
   int mHealth;
+  TutorialMessageState mTutorialMessages;
+  ChangeGenerations mGenerations;
 };
 
 }
@@ -39,6 +39,7 @@ ImfPlayer::ImfPlayer(const int sampleRate)
   , mSongSwitchPending(false)
 {
   mVolume.store(1.0f);
+  mEmulatorType.store(mEmulator.type());
 }
 
 
@@ -56,7 +57,14 @@ void ImfPlayer::setVolume(const float volume) {
 }
 
 
+void ImfPlayer::setEmulatorType(const data::AdlibEmulatorType type) {
+  mEmulatorType.store(type);
+}
+
+
 void ImfPlayer::render(std::int16_t* pBuffer, std::size_t samplesRequired) {
+  mEmulator.setType(mEmulatorType.load());
+
   if (mSongSwitchPending && mAudioLock.try_lock()) {
     mSongData = std::move(mNextSongData);
     mSongSwitchPending = false;
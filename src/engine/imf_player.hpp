@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "data/game_options.hpp"
 #include "data/song.hpp"
 #include "loader/adlib_emulator.hpp"
 
@@ -33,6 +34,7 @@ public:
 
   void playSong(data::Song&& song);
   void setVolume(const float volume);
+  void setEmulatorType(data::AdlibEmulatorType type);
 
   void render(std::int16_t* pBuffer, std::size_t samplesRequired);
 
@@ -47,6 +49,7 @@ private:
   int mSampleRate;
 
   std::atomic<float> mVolume;
+  std::atomic<data::AdlibEmulatorType> mEmulatorType;
   std::atomic<bool> mSongSwitchPending;
 };
 
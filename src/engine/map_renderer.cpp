@@ -22,6 +22,7 @@
 
 #include <cfenv>
 #include <iostream>
+#include <variant>
 
 
 namespace rigel::engine {
@@ -113,14 +114,24 @@ MapRenderer::MapRenderer(
   : mpRenderer(pRenderer)
   , mpMap(pMap)
   , mTileSetTexture(
-      renderer::OwningTexture(pRenderer, renderData.mTileSetImage),
+      std::visit(
+        [pRenderer](const auto& image) {
+          return renderer::OwningTexture(
+            pRenderer, image, renderer::TextureCategory::Map);
+        },
+        renderData.mTileSetImage),
       pRenderer)
-  , mBackdropTexture(mpRenderer, renderData.mBackdropImage)
+  , mBackdropTexture(
+      mpRenderer,
+      renderData.mBackdropImage,
+      renderer::TextureCategory::Map)
   , mScrollMode(renderData.mBackdropScrollMode)
 {
   if (renderData.mSecondaryBackdropImage) {
     mAlternativeBackdropTexture = renderer::OwningTexture(
-      mpRenderer, *renderData.mSecondaryBackdropImage);
+      mpRenderer,
+      *renderData.mSecondaryBackdropImage,
+      renderer::TextureCategory::Map);
   }
 }
 
@@ -37,7 +37,10 @@ public:
     {
     }
 
-    data::Image mTileSetImage;
+    // Loaded levels provide an indexed tile set. Callers may replace it with
+    // an RGBA version before creating the MapRenderer, the texture is created
+    // from whichever kind of image is present.
+    data::AnyImage mTileSetImage;
     data::Image mBackdropImage;
     std::optional<data::Image> mSecondaryBackdropImage;
     data::map::BackdropScrollMode mBackdropScrollMode;
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "base/array_view.hpp"
+#include "base/fixed_point.hpp"
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "engine/base_components.hpp"
@@ -28,12 +29,21 @@ RIGEL_RESTORE_WARNINGS
 
 namespace rigel::engine {
 
+/** Scalar type used for all world motion
+ *
+ * Velocities in the game are always small multiples of 0.5, but are
+ * truncated to whole pixels when applied. Fixed-point keeps this exact and
+ * deterministic across platforms, without relying on float semantics.
+ */
+using MotionValue = base::FixedPoint<8>;
+using Velocity = base::Point<MotionValue>;
+
 
 namespace components {
 
 namespace parameter_aliases {
 
-using Velocity = base::Point<float>;
+using engine::Velocity;
 using GravityAffected = bool;
 using IgnoreCollisions = bool;
 using ResetAfterSequence = bool;
@@ -45,7 +55,7 @@ using EnableX = bool;
 
 struct MovingBody {
   MovingBody(
-    const base::Point<float> velocity,
+    const Velocity velocity,
     const bool gravityAffected,
     const bool ignoreCollisions = false
   )
@@ -55,7 +65,7 @@ struct MovingBody {
   {
   }
 
-  base::Point<float> mVelocity;
+  Velocity mVelocity;
   bool mGravityAffected;
 
   /** When set, the body will move through walls, but collision events will
@@ -81,7 +91,7 @@ struct SolidBody {};
 
 
 struct MovementSequence {
-  using VelocityList = base::ArrayView<base::Point<float>>;
+  using VelocityList = base::ArrayView<Velocity>;
 
   explicit MovementSequence(
     const VelocityList& velocities,
@@ -36,16 +36,16 @@ using components::WorldPosition;
 
 namespace {
 
-base::Point<float> updateMovementSequence(
+Velocity updateMovementSequence(
   entityx::Entity entity,
-  const base::Point<float>& velocity
+  const Velocity& velocity
 ) {
   auto& sequence = *entity.component<MovementSequence>();
   if (sequence.mCurrentStep >= sequence.mVelocites.size()) {
     if (sequence.mResetVelocityAfterSequence) {
       const auto resetVelocity = sequence.mEnableX ?
-        base::Point<float>{} :
-        base::Point<float>{velocity.x, 0.0f};
+        Velocity{} :
+        Velocity{velocity.x, 0};
       entity.remove<MovementSequence>();
       return resetVelocity;
     }
@@ -169,7 +169,7 @@ void PhysicsSystem::applyPhysics(
   const auto result =
     moveVertically(*mpCollisionChecker, entity, movementY);
   if (result != MovementResult::Completed) {
-    body.mVelocity.y = 0.0f;
+    body.mVelocity.y = 0;
   }
 
   const auto targetPosition =
@@ -227,11 +227,11 @@ void PhysicsSystem::receive(
 }
 
 
-float PhysicsSystem::applyGravity(
+MotionValue PhysicsSystem::applyGravity(
   const BoundingBox& bbox,
-  const float currentVelocity
+  const MotionValue currentVelocity
 ) {
-  if (currentVelocity == 0.0f) {
+  if (currentVelocity == 0) {
     if (mpCollisionChecker->isOnSolidGround(bbox)) {
       return currentVelocity;
     }
@@ -96,9 +96,9 @@ private:
     components::MovingBody& body,
     components::WorldPosition& position,
     const components::BoundingBox& collisionRect);
-  float applyGravity(
+  MotionValue applyGravity(
     const components::BoundingBox& bbox,
-    float currentVelocity);
+    MotionValue currentVelocity);
 
 private:
   std::vector<entityx::Entity> mPhysicsObjectsForPhase2;
@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <tuple>
 
 
 namespace ex = entityx;
@@ -63,6 +64,76 @@ void advanceAnimation(Sprite& sprite, AnimationLoop& animated) {
   sprite.mFramesToRender[animated.mRenderSlot] = newFrameNr;
 }
 
+
+// Size of a cell in the sprite index, in pixels
+constexpr auto SPRITE_INDEX_CELL_SIZE = 16 * data::GameTraits::tileSize;
+
+
+/** Area covered by a sprite frame in pixels, relative to the given position
+ *
+ * The position is in tiles.
+ */
+base::Rect<int> spriteFrameRect(
+  const SpriteFrame& frame,
+  const base::Vector& position
+) {
+  // World-space tile positions refer to a sprite's bottom left tile,
+  // but we need its top left corner for drawing.
+  const auto heightTiles = data::pixelsToTiles(frame.mImage.height());
+  const auto topLeft = position - base::Vector(0, heightTiles - 1);
+  const auto topLeftPx = data::tileVectorToPixelVector(topLeft);
+  const auto drawOffsetPx = data::tileVectorToPixelVector(
+    frame.mDrawOffset);
+
+  return {
+    topLeftPx + drawOffsetPx,
+    {frame.mImage.width(), frame.mImage.height()}};
+}
+
+
+std::optional<base::Rect<int>> worldSpaceSpriteBounds(
+  const entityx::Entity entity,
+  const Sprite& sprite,
+  const WorldPosition& position
+) {
+  std::optional<base::Rect<int>> bounds;
+
+  for (const auto baseFrameIndex : sprite.mFramesToRender) {
+    if (baseFrameIndex == IGNORE_RENDER_SLOT) {
+      continue;
+    }
+
+    const auto frameIndex =
+      virtualToRealFrame(baseFrameIndex, *sprite.mpDrawData, entity);
+    const auto frameRect =
+      spriteFrameRect(sprite.mpDrawData->mFrames[frameIndex], position);
+
+    if (bounds) {
+      const auto topLeft = base::Vector{
+        std::min(bounds->left(), frameRect.left()),
+        std::min(bounds->top(), frameRect.top())};
+      const auto bottomRight = base::Vector{
+        std::max(bounds->right(), frameRect.right()),
+        std::max(bounds->bottom(), frameRect.bottom())};
+      bounds = base::makeRect(topLeft, bottomRight + base::Vector{1, 1});
+    } else {
+      bounds = frameRect;
+    }
+  }
+
+  return bounds;
+}
+
+
+void sortByEntityIndex(std::vector<entityx::Entity>& entities) {
+  std::sort(
+    entities.begin(),
+    entities.end(),
+    [](const entityx::Entity lhs, const entityx::Entity rhs) {
+      return lhs.id().index() < rhs.id().index();
+    });
+}
+
 }
 
 
@@ -147,15 +218,7 @@ void drawSpriteFrame(
   const base::Vector& position,
   renderer::Renderer* pRenderer
 ) {
-  // World-space tile positions refer to a sprite's bottom left tile,
-  // but we need its top left corner for drawing.
-  const auto heightTiles = data::pixelsToTiles(frame.mImage.height());
-  const auto topLeft = position - base::Vector(0, heightTiles - 1);
-  const auto topLeftPx = data::tileVectorToPixelVector(topLeft);
-  const auto drawOffsetPx = data::tileVectorToPixelVector(
-    frame.mDrawOffset);
-
-  frame.mImage.render(pRenderer, topLeftPx + drawOffsetPx);
+  frame.mImage.render(pRenderer, spriteFrameRect(frame, position).topLeft);
 }
 
 
@@ -177,10 +240,14 @@ struct RenderingSystem::SpriteData {
   {
   }
 
+  // Sprites with the same draw order are drawn in order of entity index.
+  // This is the order in which the entity manager iterates entities, and
+  // keeps the result independent of which sprites were culled.
   bool operator<(const SpriteData& rhs) const {
     return
-      std::tie(mDrawTopMost, mDrawOrder) <
-      std::tie(rhs.mDrawTopMost, rhs.mDrawOrder);
+      std::make_tuple(mDrawTopMost, mDrawOrder, mEntity.id().index()) <
+      std::make_tuple(
+        rhs.mDrawTopMost, rhs.mDrawOrder, rhs.mEntity.id().index());
   }
 
   entityx::Entity mEntity;
@@ -204,10 +271,50 @@ RenderingSystem::RenderingSystem(
       pRenderer->maxWindowSize().height)
   , mMapRenderer(pRenderer, pMap, std::move(mapRenderData))
   , mpCameraPosition(pCameraPosition)
+  , mSpriteIndex(
+      data::tileExtentsToPixelExtents({pMap->width(), pMap->height()}),
+      SPRITE_INDEX_CELL_SIZE)
+  , mTileDebrisIndex(
+      data::tileExtentsToPixelExtents({pMap->width(), pMap->height()}),
+      SPRITE_INDEX_CELL_SIZE)
 {
 }
 
 
+void RenderingSystem::updateSpriteBounds(ex::EntityManager& es) {
+  using game_logic::components::TileDebris;
+
+  mSpriteIndex.clear();
+  mTileDebrisIndex.clear();
+  mUnboundedSprites.clear();
+
+  es.each<Sprite, WorldPosition>([this](
+    ex::Entity entity,
+    const Sprite& sprite,
+    const WorldPosition& pos
+  ) {
+    // Custom render functions can draw anything anywhere, so we can't know
+    // their bounds
+    if (entity.has_component<CustomRenderFunc>()) {
+      mUnboundedSprites.push_back(entity);
+    } else if (const auto bounds = worldSpaceSpriteBounds(entity, sprite, pos))
+    {
+      mSpriteIndex.insert(entity, *bounds);
+    }
+  });
+
+  es.each<TileDebris, WorldPosition>(
+    [this](ex::Entity entity, const TileDebris&, const WorldPosition& pos) {
+      mTileDebrisIndex.insert(
+        entity,
+        {data::tileVectorToPixelVector(pos),
+         data::tileExtentsToPixelExtents({1, 1})});
+    });
+
+  mSpriteBoundsValid = true;
+}
+
+
 void RenderingSystem::update(
   ex::EntityManager& es,
   const std::optional<base::Color>& backdropFlashColor,
@@ -216,17 +323,58 @@ void RenderingSystem::update(
   using namespace std;
   using game_logic::components::TileDebris;
 
-  // Collect sprites, then order by draw index
+  if (!mSpriteBoundsValid) {
+    updateSpriteBounds(es);
+  }
+
+  // Sprites are rendered into the whole in-game viewport, parts of which
+  // might be covered by the HUD. To make sure that culling never changes
+  // what's visible, use whichever area is larger.
+  const auto viewPortSizePx = data::tileExtentsToPixelExtents(viewPortSize);
+  const auto visibleArea = base::Rect<int>{
+    data::tileVectorToPixelVector(*mpCameraPosition),
+    {
+      std::max(
+        viewPortSizePx.width, data::GameTraits::inGameViewPortSize.width),
+      std::max(
+        viewPortSizePx.height, data::GameTraits::inGameViewPortSize.height)
+    }};
+
+  // Collect visible sprites, then order by draw index
+  mVisibleEntities.clear();
+  mSpriteIndex.query(visibleArea, mVisibleEntities);
+
+  mSpriteStatistics = {};
+  mSpriteStatistics.mIndexed = mSpriteIndex.size() + mUnboundedSprites.size();
+  mSpriteStatistics.mCollected = mVisibleEntities.size();
+
+  mVisibleEntities.insert(
+    mVisibleEntities.end(),
+    mUnboundedSprites.begin(),
+    mUnboundedSprites.end());
+
   vector<SpriteData> spritesByDrawOrder;
-  es.each<Sprite, WorldPosition>([&spritesByDrawOrder](
-    ex::Entity entity,
-    Sprite& sprite,
-    const WorldPosition& pos
-  ) {
+  spritesByDrawOrder.reserve(mVisibleEntities.size());
+  for (auto entity : mVisibleEntities) {
+    // The index might be out of date if entities were removed or modified
+    // outside of the game logic update
+    if (
+      !entity.valid() ||
+      !entity.has_component<Sprite>() ||
+      !entity.has_component<WorldPosition>()
+    ) {
+      continue;
+    }
+
     const auto drawTopMost = entity.has_component<DrawTopMost>();
-    spritesByDrawOrder.emplace_back(entity, &sprite, drawTopMost, pos);
-  });
+    spritesByDrawOrder.emplace_back(
+      entity,
+      entity.component<const Sprite>().get(),
+      drawTopMost,
+      *entity.component<const WorldPosition>());
+  }
   sort(begin(spritesByDrawOrder), end(spritesByDrawOrder));
+  mSpriteStatistics.mSorted = spritesByDrawOrder.size();
 
   const auto firstTopMostIt = find_if(
     begin(spritesByDrawOrder),
@@ -237,17 +385,28 @@ void RenderingSystem::update(
     renderer::RenderTargetTexture::Binder bindRenderTarget(mRenderTarget, mpRenderer);
 
     // Render
-    if (backdropFlashColor) {
-      mpRenderer->setOverlayColor(*backdropFlashColor);
-      mMapRenderer.renderBackdrop(*mpCameraPosition, viewPortSize);
-      mpRenderer->setOverlayColor({});
-    } else {
-      mMapRenderer.renderBackdrop(*mpCameraPosition, viewPortSize);
+    {
+      const auto phase =
+        renderer::beginRenderPhase(mpRenderer, renderer::RenderPhase::Backdrop);
+
+      if (backdropFlashColor) {
+        mpRenderer->setOverlayColor(*backdropFlashColor);
+        mMapRenderer.renderBackdrop(*mpCameraPosition, viewPortSize);
+        mpRenderer->setOverlayColor({});
+      } else {
+        mMapRenderer.renderBackdrop(*mpCameraPosition, viewPortSize);
+      }
     }
 
-    mMapRenderer.renderBackground(*mpCameraPosition, viewPortSize);
+    {
+      const auto phase = renderer::beginRenderPhase(
+        mpRenderer, renderer::RenderPhase::MapLayers);
+      mMapRenderer.renderBackground(*mpCameraPosition, viewPortSize);
+    }
 
     // behind foreground
+    const auto phase =
+      renderer::beginRenderPhase(mpRenderer, renderer::RenderPhase::Sprites);
     for (auto it = spritesByDrawOrder.begin(); it != firstTopMostIt; ++it) {
       renderSprite(*it);
     }
@@ -260,23 +419,57 @@ void RenderingSystem::update(
     mRenderTarget.render(mpRenderer, 0, 0);
   }
 
-  renderWaterEffectAreas(es);
+  {
+    const auto phase = renderer::beginRenderPhase(
+      mpRenderer, renderer::RenderPhase::WaterEffects);
+    renderWaterEffectAreas(es);
+  }
 
-  mMapRenderer.renderForeground(*mpCameraPosition, viewPortSize);
+  {
+    const auto phase =
+      renderer::beginRenderPhase(mpRenderer, renderer::RenderPhase::MapLayers);
+    mMapRenderer.renderForeground(*mpCameraPosition, viewPortSize);
+  }
 
   // top most
-  for (auto it = firstTopMostIt; it != spritesByDrawOrder.end(); ++it) {
-    renderSprite(*it);
+  {
+    const auto phase =
+      renderer::beginRenderPhase(mpRenderer, renderer::RenderPhase::Sprites);
+    for (auto it = firstTopMostIt; it != spritesByDrawOrder.end(); ++it) {
+      renderSprite(*it);
+    }
   }
 
-  mSpritesRendered = spritesByDrawOrder.size();
+  mSpriteStatistics.mDrawn = count_if(
+    begin(spritesByDrawOrder),
+    end(spritesByDrawOrder),
+    [](const SpriteData& data) { return data.mpSprite->mShow; });
 
 
   // tile debris
-  es.each<TileDebris, WorldPosition>(
-    [this](ex::Entity, const TileDebris& debris, const WorldPosition& pos) {
-      mMapRenderer.renderSingleTile(debris.mTileIndex, pos, *mpCameraPosition);
-    });
+  const auto phase =
+    renderer::beginRenderPhase(mpRenderer, renderer::RenderPhase::MapLayers);
+
+  // Keep the order of iterating over all debris entities, in case some of
+  // them overlap
+  mVisibleEntities.clear();
+  mTileDebrisIndex.query(visibleArea, mVisibleEntities);
+  sortByEntityIndex(mVisibleEntities);
+
+  for (auto entity : mVisibleEntities) {
+    if (
+      !entity.valid() ||
+      !entity.has_component<TileDebris>() ||
+      !entity.has_component<WorldPosition>()
+    ) {
+      continue;
+    }
+
+    mMapRenderer.renderSingleTile(
+      entity.component<const TileDebris>()->mTileIndex,
+      *entity.component<const WorldPosition>(),
+      *mpCameraPosition);
+  }
 }
 
 
@@ -20,6 +20,7 @@
 #include "base/warnings.hpp"
 #include "engine/base_components.hpp"
 #include "engine/map_renderer.hpp"
+#include "engine/spatial_entity_index.hpp"
 #include "engine/timing.hpp"
 #include "engine/visual_components.hpp"
 #include "renderer/renderer.hpp"
@@ -52,9 +53,29 @@ void updateAnimatedSprites(entityx::EntityManager& es);
  * Also renders the map using a engine::MapRenderer. Map and sprite rendering
  * are handled by the same system so that draw-order can be done properly
  * (e.g. some sprites are rendered behind certain tiles, others before etc.)
+ *
+ * To avoid looking at all sprites in the level every frame, the system keeps
+ * a spatial index of sprite bounds. The index is rebuilt on the first
+ * update() after invalidateSpriteBounds() has been called, which should
+ * happen whenever entities might have moved, animated, or been created or
+ * destroyed - i.e. once per game logic update.
  */
 class RenderingSystem {
 public:
+  struct SpriteStatistics {
+    // Sprites in the spatial index, i.e. all sprites in the level
+    std::size_t mIndexed = 0;
+
+    // Sprites returned by looking up the view area in the index
+    std::size_t mCollected = 0;
+
+    // Sprites sorted by draw order. Also includes sprites with a custom
+    // render function, which are never culled.
+    std::size_t mSorted = 0;
+
+    std::size_t mDrawn = 0;
+  };
+
   RenderingSystem(
     const base::Vector* pCameraPosition,
     renderer::Renderer* pRenderer,
@@ -71,6 +92,14 @@ public:
     }
   }
 
+  /** Mark spatial index of sprites as outdated
+   *
+   * Should be called after running game logic.
+   */
+  void invalidateSpriteBounds() {
+    mSpriteBoundsValid = false;
+  }
+
   /** Render everything. Can be called at full frame rate. */
   void update(
     entityx::EntityManager& es,
@@ -85,12 +114,13 @@ public:
     mMapRenderer.updateBackdropAutoScrolling(dt);
   }
 
-  std::size_t spritesRendered() const {
-    return mSpritesRendered;
+  const SpriteStatistics& spriteStatistics() const {
+    return mSpriteStatistics;
   }
 
 private:
   struct SpriteData;
+  void updateSpriteBounds(entityx::EntityManager& es);
   void renderSprite(const SpriteData& data) const;
   void renderWaterEffectAreas(entityx::EntityManager& es);
 
@@ -100,7 +130,13 @@ private:
   MapRenderer mMapRenderer;
   const base::Vector* mpCameraPosition;
   int mWaterAnimStep = 0;
-  std::size_t mSpritesRendered = 0;
+
+  SpatialEntityIndex mSpriteIndex;
+  SpatialEntityIndex mTileDebrisIndex;
+  std::vector<entityx::Entity> mUnboundedSprites;
+  std::vector<entityx::Entity> mVisibleEntities;
+  bool mSpriteBoundsValid = false;
+  SpriteStatistics mSpriteStatistics;
 };
 
 }
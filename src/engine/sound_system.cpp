@@ -23,6 +23,7 @@
 
 #include <speex/speex_resampler.h>
 
+#include <algorithm>
 #include <cassert>
 #include <utility>
 
@@ -35,13 +36,9 @@ using SoundHandle = SoundSystem::SoundHandle;
 const auto SAMPLE_RATE = 44100;
 const auto BUFFER_SIZE = 2048;
 
-
-sdl_utils::Ptr<Mix_Chunk> createMixChunk(data::AudioBuffer& buffer) {
-  const auto bufferSize = buffer.mSamples.size() * sizeof(data::Sample);
-  return sdl_utils::Ptr<Mix_Chunk>(
-    Mix_QuickLoad_RAW(reinterpret_cast<Uint8*>(buffer.mSamples.data()),
-    static_cast<Uint32>(bufferSize)));
-}
+// Upper limit for sound effects converted to the output sample rate. When
+// exceeded, the least recently played sounds are dropped again.
+const auto CONVERTED_SOUNDS_BUDGET = std::size_t{4 * 1024 * 1024};
 
 
 data::AudioBuffer resampleAudio(
@@ -80,7 +77,7 @@ data::AudioBuffer resampleAudio(
 
 void appendRampToZero(data::AudioBuffer& buffer) {
   // Roughly 10 ms of linear ramp
-  const auto rampLength = (SAMPLE_RATE / 100);
+  const auto rampLength = (buffer.mSampleRate / 100);
 
   buffer.mSamples.reserve(buffer.mSamples.size() + rampLength - 1);
   const auto lastSample = buffer.mSamples.back();
@@ -92,17 +89,87 @@ void appendRampToZero(data::AudioBuffer& buffer) {
   }
 }
 
+
+void prepareForPlayback(data::AudioBuffer& buffer) {
+  if (!buffer.mSamples.empty() && buffer.mSamples.back() != 0) {
+    // Prevent clicks/pops with samples that don't return to 0 at the end
+    // by adding a small linear ramp leading back to zero.
+    appendRampToZero(buffer);
+  }
+}
+
+
+bool needsFormatConversion() {
+  return MIX_DEFAULT_FORMAT != AUDIO_S16LSB;
+}
+
+
+data::AudioBuffer convertToOutputFormat(
+  const data::AudioBuffer& original,
+  const int outputSampleRate
+) {
+  auto buffer = original.mSampleRate != outputSampleRate
+    ? resampleAudio(original, outputSampleRate)
+    : original;
+  prepareForPlayback(buffer);
+
+#if MIX_DEFAULT_FORMAT != AUDIO_S16LSB
+  SDL_AudioCVT conversionSpecs;
+  SDL_BuildAudioCVT(
+    &conversionSpecs,
+    AUDIO_S16LSB, 1, buffer.mSampleRate,
+    MIX_DEFAULT_FORMAT, 1, outputSampleRate);
+
+  conversionSpecs.len = static_cast<int>(
+    buffer.mSamples.size() * 2);
+  std::vector<data::Sample> tempBuffer(
+    conversionSpecs.len * conversionSpecs.len_mult);
+  conversionSpecs.buf = reinterpret_cast<Uint8*>(tempBuffer.data());
+  std::copy(
+    buffer.mSamples.begin(), buffer.mSamples.end(), tempBuffer.begin());
+
+  SDL_ConvertAudio(&conversionSpecs);
+
+  data::AudioBuffer convertedBuffer{outputSampleRate};
+  convertedBuffer.mSamples.insert(
+    convertedBuffer.mSamples.end(),
+    tempBuffer.begin(),
+    tempBuffer.begin() + conversionSpecs.len_cvt);
+  return convertedBuffer;
+#else
+  return buffer;
+#endif
+}
+
+
+std::size_t sizeInBytes(const data::AudioBuffer& buffer) {
+  return buffer.mSamples.size() * sizeof(data::Sample);
+}
+
+
+int querySampleRate() {
+  int sampleRate = 0;
+  Uint16 format = 0;
+  int numChannels = 0;
+  if (!Mix_QuerySpec(&sampleRate, &format, &numChannels)) {
+    return SAMPLE_RATE;
+  }
+
+  return sampleRate;
+}
+
 }
 
 
-SoundSystem::SoundSystem()
-  : mpMusicPlayer(std::make_unique<ImfPlayer>(SAMPLE_RATE))
-{
+SoundSystem::SoundSystem() {
   sdl_utils::check(Mix_OpenAudio(
       SAMPLE_RATE,
       MIX_DEFAULT_FORMAT,
       1, // mono
       BUFFER_SIZE));
+  mSampleRate = querySampleRate();
+  mpMusicPlayer = std::make_unique<ImfPlayer>(mSampleRate);
+
   Mix_HookMusic(
     [](void* pUserData, Uint8* pOutBuffer, int bytesRequired) {
       auto pPlayer = static_cast<ImfPlayer*>(pUserData);
@@ -132,56 +199,114 @@ SoundSystem::~SoundSystem() {
 }
 
 
-SoundHandle SoundSystem::addSound(const data::AudioBuffer& original) {
-  auto buffer = resampleAudio(original, SAMPLE_RATE);
-  if (buffer.mSamples.back() != 0) {
-    // Prevent clicks/pops with samples that don't return to 0 at the end
-    // by adding a small linear ramp leading back to zero.
-    appendRampToZero(buffer);
+SoundHandle SoundSystem::addSound(data::AudioBuffer buffer) {
+  assert(mNextHandle < MAX_CONCURRENT_SOUNDS);
+
+  const auto assignedHandle = mNextHandle++;
+  assignBuffer(assignedHandle, std::move(buffer));
+  return assignedHandle;
+}
+
+
+void SoundSystem::replaceSound(
+  const SoundHandle handle,
+  data::AudioBuffer buffer
+) {
+  assert(handle < mNextHandle);
+
+  auto& sound = mSounds[handle];
+  Mix_HaltChannel(handle);
+  sound.mpMixChunk.reset();
+
+  auto& statistics = mMemoryStatistics;
+  statistics.mNativeBytes -= sizeInBytes(sound.mBuffer);
+  statistics.mConvertedBytes -= sizeInBytes(sound.mConvertedBuffer);
+  sound.mConvertedBuffer = {};
+
+  assignBuffer(handle, std::move(buffer));
+}
+
+
+void SoundSystem::assignBuffer(
+  const SoundHandle handle,
+  data::AudioBuffer buffer
+) {
+  auto& sound = mSounds[handle];
+  sound.mBuffer = std::move(buffer);
+  sound.mNeedsConversion =
+    sound.mBuffer.mSampleRate != mSampleRate || needsFormatConversion();
+
+  if (!sound.mNeedsConversion) {
+    prepareForPlayback(sound.mBuffer);
+    createMixChunk(sound, sound.mBuffer);
   }
 
-#if MIX_DEFAULT_FORMAT != AUDIO_S16LSB
-  SDL_AudioSpec originalSoundSpec{
-    buffer.mSampleRate,
-    AUDIO_S16LSB,
-    1,
-    0, 0, 0, 0, nullptr};
-  SDL_AudioCVT conversionSpecs;
-  SDL_BuildAudioCVT(
-    &conversionSpecs,
-    AUDIO_S16LSB, 1, buffer.mSampleRate,
-    MIX_DEFAULT_FORMAT, 1, SAMPLE_RATE);
+  mMemoryStatistics.mNativeBytes += sizeInBytes(sound.mBuffer);
+}
 
-  conversionSpecs.len = static_cast<int>(
-    buffer.mSamples.size() * 2);
-  std::vector<data::Sample> tempBuffer(
-    conversionSpecs.len * conversionSpecs.len_mult);
-  conversionSpecs.buf = reinterpret_cast<Uint8*>(tempBuffer.data());
-  std::copy(
-    buffer.mSamples.begin(), buffer.mSamples.end(), tempBuffer.begin());
 
-  SDL_ConvertAudio(&conversionSpecs);
+void SoundSystem::convertSound(const SoundHandle handle) {
+  auto& sound = mSounds[handle];
 
-  data::AudioBuffer convertedBuffer{SAMPLE_RATE};
-  convertedBuffer.mSamples.insert(
-    convertedBuffer.mSamples.end(),
-    tempBuffer.begin(),
-    tempBuffer.begin() + conversionSpecs.len_cvt);
-  return addConvertedSound(convertedBuffer);
-#else
-  return addConvertedSound(buffer);
-#endif
+  auto converted = convertToOutputFormat(sound.mBuffer, mSampleRate);
+  const auto convertedSize = sizeInBytes(converted);
+  evictConvertedSounds(convertedSize);
+
+  sound.mConvertedBuffer = std::move(converted);
+  createMixChunk(sound, sound.mConvertedBuffer);
+
+  auto& statistics = mMemoryStatistics;
+  statistics.mConvertedBytes += convertedSize;
+  statistics.mPeakConvertedBytes =
+    std::max(statistics.mPeakConvertedBytes, statistics.mConvertedBytes);
+  ++statistics.mNumConversions;
 }
 
 
-SoundHandle SoundSystem::addConvertedSound(data::AudioBuffer buffer) {
-  assert(mNextHandle < MAX_CONCURRENT_SOUNDS);
+void SoundSystem::evictConvertedSounds(const std::size_t bytesNeeded) {
+  auto& statistics = mMemoryStatistics;
+
+  while (statistics.mConvertedBytes + bytesNeeded > CONVERTED_SOUNDS_BUDGET) {
+    // Each sound plays on the channel matching its handle, so a sound which
+    // is still playing can be recognized by looking at its channel.
+    LoadedSound* pLeastRecentlyPlayed = nullptr;
+    for (auto handle = 0; handle < mNextHandle; ++handle) {
+      auto& candidate = mSounds[handle];
+      const auto isEvictable =
+        candidate.mNeedsConversion &&
+        candidate.mpMixChunk &&
+        !Mix_Playing(handle);
+      if (
+        isEvictable &&
+        (!pLeastRecentlyPlayed ||
+         candidate.mLastPlayed < pLeastRecentlyPlayed->mLastPlayed)
+      ) {
+        pLeastRecentlyPlayed = &candidate;
+      }
+    }
 
-  const auto assignedHandle = mNextHandle++;
-  auto& sound = mSounds[assignedHandle];
-  sound.mBuffer = std::move(buffer);
-  sound.mpMixChunk = createMixChunk(sound.mBuffer);
-  return assignedHandle;
+    if (!pLeastRecentlyPlayed) {
+      // Everything is currently playing, we have to go over budget
+      return;
+    }
+
+    pLeastRecentlyPlayed->mpMixChunk.reset();
+    statistics.mConvertedBytes -=
+      sizeInBytes(pLeastRecentlyPlayed->mConvertedBuffer);
+    pLeastRecentlyPlayed->mConvertedBuffer = {};
+  }
+}
+
+
+void SoundSystem::createMixChunk(
+  LoadedSound& sound,
+  data::AudioBuffer& buffer
+) {
+  const auto bufferSize = buffer.mSamples.size() * sizeof(data::Sample);
+  sound.mpMixChunk = sdl_utils::Ptr<Mix_Chunk>(
+    Mix_QuickLoad_RAW(reinterpret_cast<Uint8*>(buffer.mSamples.data()),
+    static_cast<Uint32>(bufferSize)));
+  Mix_VolumeChunk(sound.mpMixChunk.get(), mSdlSoundVolume);
 }
 
 
@@ -195,9 +320,16 @@ void SoundSystem::stopMusic() const {
 }
 
 
-void SoundSystem::playSound(const SoundHandle handle) const {
-  assert(handle < int(mSounds.size()));
-  Mix_PlayChannel(handle, mSounds[handle].mpMixChunk.get(), 0);
+void SoundSystem::playSound(const SoundHandle handle) {
+  assert(handle < mNextHandle);
+
+  auto& sound = mSounds[handle];
+  if (!sound.mpMixChunk) {
+    convertSound(handle);
+  }
+
+  sound.mLastPlayed = ++mPlayCounter;
+  Mix_PlayChannel(handle, sound.mpMixChunk.get(), 0);
 }
 
 
@@ -212,13 +344,18 @@ void SoundSystem::setMusicVolume(const float volume) {
 }
 
 
+void SoundSystem::setAdlibEmulatorType(const data::AdlibEmulatorType type) {
+  mpMusicPlayer->setEmulatorType(type);
+}
+
+
 void SoundSystem::setSoundVolume(const float volume) {
-  const auto sdlVolume = static_cast<int>(
+  mSdlSoundVolume = static_cast<int>(
     std::clamp(volume, 0.0f, 1.0f) * MIX_MAX_VOLUME);
 
   for (auto& sound : mSounds) {
     if (sound.mpMixChunk) {
-      Mix_VolumeChunk(sound.mpMixChunk.get(), sdlVolume);
+      Mix_VolumeChunk(sound.mpMixChunk.get(), mSdlSoundVolume);
     }
   }
 }
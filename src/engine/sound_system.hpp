@@ -17,10 +17,13 @@
 #pragma once
 
 #include "data/audio_buffer.hpp"
+#include "data/game_options.hpp"
 #include "data/song.hpp"
 #include "sdl_utils/ptr.hpp"
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <unordered_map>
 
@@ -30,6 +33,19 @@ namespace rigel::engine {
 class ImfPlayer;
 
 
+/** Memory used for sound effect sample data */
+struct SoundMemoryStatistics {
+  /** Sounds as given to addSound(), at their original sample rate */
+  std::size_t mNativeBytes = 0;
+
+  /** Sounds converted to the output sample rate, currently cached */
+  std::size_t mConvertedBytes = 0;
+  std::size_t mPeakConvertedBytes = 0;
+
+  int mNumConversions = 0;
+};
+
+
 class SoundSystem {
 public:
   using SoundHandle = int;
@@ -37,30 +53,70 @@ public:
   SoundSystem();
   ~SoundSystem();
 
-  SoundHandle addSound(const data::AudioBuffer& buffer);
+  /** Register a sound effect for playback
+   *
+   * Sounds are kept at their original sample rate. Conversion to the output
+   * rate happens when a sound is first played. Converted sounds are cached,
+   * but dropped again when the cache exceeds its memory budget. Sounds which
+   * already have the output rate (see sampleRate()) are used as-is.
+   */
+  SoundHandle addSound(data::AudioBuffer buffer);
+
+  /** Exchange the audio data of a previously added sound
+   *
+   * If the sound is currently playing, it is stopped.
+   */
+  void replaceSound(SoundHandle handle, data::AudioBuffer buffer);
 
   void playSong(data::Song&& song);
   void stopMusic() const;
 
-  void playSound(SoundHandle handle) const;
+  void playSound(SoundHandle handle);
   void stopSound(SoundHandle handle) const;
 
   void setMusicVolume(float volume);
   void setSoundVolume(float volume);
 
+  /** Select emulator used for music playback
+   *
+   * Adlib sound effects are rendered by the resource loader, they need to be
+   * reloaded and passed to replaceSound() to make use of a different
+   * emulator.
+   */
+  void setAdlibEmulatorType(data::AdlibEmulatorType type);
+
+  /** Sample rate of the audio output device */
+  int sampleRate() const {
+    return mSampleRate;
+  }
+
+  SoundMemoryStatistics memoryStatistics() const {
+    return mMemoryStatistics;
+  }
+
 private:
   static const int MAX_CONCURRENT_SOUNDS = 64;
 
   struct LoadedSound {
     data::AudioBuffer mBuffer;
+    data::AudioBuffer mConvertedBuffer;
     sdl_utils::Ptr<Mix_Chunk> mpMixChunk;
+    std::uint64_t mLastPlayed = 0;
+    bool mNeedsConversion = false;
   };
 
-  SoundHandle addConvertedSound(data::AudioBuffer buffer);
+  void convertSound(SoundHandle handle);
+  void evictConvertedSounds(std::size_t bytesNeeded);
+  void assignBuffer(SoundHandle handle, data::AudioBuffer buffer);
+  void createMixChunk(LoadedSound& sound, data::AudioBuffer& buffer);
 
   std::unique_ptr<ImfPlayer> mpMusicPlayer;
   std::array<LoadedSound, MAX_CONCURRENT_SOUNDS> mSounds;
   SoundHandle mNextHandle = 0;
+  SoundMemoryStatistics mMemoryStatistics;
+  std::uint64_t mPlayCounter = 0;
+  int mSampleRate;
+  int mSdlSoundVolume = MIX_MAX_VOLUME;
 };
 
 }
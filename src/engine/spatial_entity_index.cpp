@@ -0,0 +1,125 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spatial_entity_index.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace rigel::engine {
+
+namespace {
+
+int divideRoundingUp(const int value, const int divisor) {
+  return (value + divisor - 1) / divisor;
+}
+
+}
+
+
+SpatialEntityIndex::SpatialEntityIndex(
+  const base::Extents& coveredArea,
+  const int cellSize
+)
+  : mCellSize(cellSize)
+  , mWidthInCells(std::max(divideRoundingUp(coveredArea.width, cellSize), 1))
+  , mHeightInCells(
+      std::max(divideRoundingUp(coveredArea.height, cellSize), 1))
+{
+  assert(cellSize > 0);
+  mCells.resize(mWidthInCells * mHeightInCells);
+}
+
+
+void SpatialEntityIndex::clear() {
+  // Keep the cells' capacity, the index is typically refilled with a similar
+  // set of entities right away
+  for (auto& cell : mCells) {
+    cell.clear();
+  }
+
+  mSize = 0;
+}
+
+
+void SpatialEntityIndex::insert(
+  entityx::Entity entity,
+  const base::Rect<int>& bounds
+) {
+  if (bounds.size.width <= 0 || bounds.size.height <= 0) {
+    return;
+  }
+
+  const auto firstCell = cellFor(bounds.topLeft);
+  const auto lastCell = cellFor(bounds.bottomRight());
+
+  for (auto y = firstCell.y; y <= lastCell.y; ++y) {
+    for (auto x = firstCell.x; x <= lastCell.x; ++x) {
+      mCells[x + y * mWidthInCells].push_back(Entry{entity, bounds});
+    }
+  }
+
+  ++mSize;
+}
+
+
+void SpatialEntityIndex::query(
+  const base::Rect<int>& area,
+  std::vector<entityx::Entity>& result
+) const {
+  if (area.size.width <= 0 || area.size.height <= 0) {
+    return;
+  }
+
+  const auto firstCell = cellFor(area.topLeft);
+  const auto lastCell = cellFor(area.bottomRight());
+
+  for (auto y = firstCell.y; y <= lastCell.y; ++y) {
+    for (auto x = firstCell.x; x <= lastCell.x; ++x) {
+      for (const auto& entry : mCells[x + y * mWidthInCells]) {
+        if (!entry.mBounds.intersects(area)) {
+          continue;
+        }
+
+        // An entity spanning multiple cells is found in each of them. Only
+        // report it from the first cell which is shared by the entity's
+        // bounds and the queried area.
+        const auto entryFirstCell = cellFor(entry.mBounds.topLeft);
+        const auto isFirstSharedCell =
+          x == std::max(entryFirstCell.x, firstCell.x) &&
+          y == std::max(entryFirstCell.y, firstCell.y);
+        if (isFirstSharedCell) {
+          result.push_back(entry.mEntity);
+        }
+      }
+    }
+  }
+}
+
+
+base::Vector SpatialEntityIndex::cellFor(const base::Vector& position) const {
+  // Negative coordinates need to round towards negative infinity, but those
+  // end up in the first row/column anyway due to clamping.
+  const auto x = position.x >= 0 ? position.x / mCellSize : 0;
+  const auto y = position.y >= 0 ? position.y / mCellSize : 0;
+  return {
+    std::min(x, mWidthInCells - 1),
+    std::min(y, mHeightInCells - 1)
+  };
+}
+
+}
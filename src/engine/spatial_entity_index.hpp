@@ -0,0 +1,80 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/spatial_types.hpp"
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+namespace rigel::engine {
+
+/** Looks up entities by their bounds
+ *
+ * Space is divided into square cells, and each entity is stored in every
+ * cell its bounds overlap. Queries only need to look at the cells
+ * overlapping the queried area, instead of at every entity. Bounds can use
+ * any unit, as long as it's the same for cell size, bounds and queries.
+ *
+ * The index covers a fixed area starting at the origin. Bounds outside of
+ * that area still work correctly, they are stored in the nearest cells
+ * along the edges.
+ *
+ * The index does not observe entities. Whenever entities move or change
+ * size, it needs to be cleared and filled again.
+ */
+class SpatialEntityIndex {
+public:
+  SpatialEntityIndex(const base::Extents& coveredArea, int cellSize);
+
+  void clear();
+  void insert(entityx::Entity entity, const base::Rect<int>& bounds);
+
+  /** Append all entities whose bounds intersect the given area to result
+   *
+   * Each entity is reported only once, even if its bounds overlap multiple
+   * cells. The order of results is unspecified.
+   */
+  void query(
+    const base::Rect<int>& area,
+    std::vector<entityx::Entity>& result) const;
+
+  std::size_t size() const {
+    return mSize;
+  }
+
+private:
+  struct Entry {
+    entityx::Entity mEntity;
+    base::Rect<int> mBounds;
+  };
+
+  base::Vector cellFor(const base::Vector& position) const;
+
+  std::vector<std::vector<Entry>> mCells;
+  int mCellSize;
+  int mWidthInCells;
+  int mHeightInCells;
+  std::size_t mSize = 0;
+};
+
+}
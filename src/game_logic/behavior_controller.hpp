@@ -17,14 +17,18 @@
 #pragma once
 
 #include "base/warnings.hpp"
+#include "engine/physical_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
-#include <memory>
+#include <cassert>
+#include <cstddef>
+#include <new>
 #include <type_traits>
+#include <utility>
 
 namespace rigel::engine::events {
   struct CollidedWithWorld;
@@ -80,7 +84,7 @@ std::enable_if_t<detail::hasOnHit<T>::value> behaviorControllerOnHit(
   T& self,
   GlobalDependencies& dependencies,
   GlobalState& state,
-  const base::Point<float>& inflictorVelocity,
+  const engine::Velocity& inflictorVelocity,
   entityx::Entity entity
 ) {
   self.onHit(dependencies, state, inflictorVelocity, entity);
@@ -92,7 +96,7 @@ std::enable_if_t<!detail::hasOnHit<T>::value> behaviorControllerOnHit(
   T&,
   GlobalDependencies&,
   GlobalState&,
-  const base::Point<float>&,
+  const engine::Velocity&,
   entityx::Entity
 ) {
 }
@@ -103,7 +107,7 @@ std::enable_if_t<detail::hasOnKilled<T>::value> behaviorControllerOnKilled(
   T& self,
   GlobalDependencies& dependencies,
   GlobalState& state,
-  const base::Point<float>& inflictorVelocity,
+  const engine::Velocity& inflictorVelocity,
   entityx::Entity entity
 ) {
   self.onKilled(dependencies, state, inflictorVelocity, entity);
@@ -115,7 +119,7 @@ std::enable_if_t<!detail::hasOnKilled<T>::value> behaviorControllerOnKilled(
   T&,
   GlobalDependencies&,
   GlobalState& state,
-  const base::Point<float>&,
+  const engine::Velocity&,
   entityx::Entity
 ) {
 }
@@ -146,12 +150,79 @@ behaviorControllerOnCollision(
 }
 
 
+/** Type-erased holder for behavior controllers
+ *
+ * Any type providing an update() function with the right signature can be
+ * stored. onHit(), onKilled() and onCollision() are optional.
+ *
+ * Controllers are stored by value. Types which are small enough live directly
+ * inside the BehaviorController, without any heap allocation. Larger ones are
+ * placed on the heap, but still owned exclusively. Copying a
+ * BehaviorController creates an independent copy of the controller's state.
+ *
+ * Instead of RTTI, the address of a per-type table of operations serves as
+ * type id for get().
+ */
 class BehaviorController {
 public:
-  template<typename T>
+  // Large enough for all controllers currently in the game
+  static constexpr auto INLINE_STORAGE_SIZE = std::size_t{32};
+
+  template<
+    typename T,
+    typename = std::enable_if_t<
+      !std::is_same_v<std::decay_t<T>, BehaviorController>>>
   explicit BehaviorController(T controller)
-    : mpSelf(std::make_shared<Model<T>>(std::move(controller)))
+    : mpOperations(&OPERATIONS_FOR<T>)
   {
+    if constexpr (isStoredInline<T>()) {
+      new (&mStorage) T(std::move(controller));
+    } else {
+      new (&mStorage) T*(new T(std::move(controller)));
+    }
+  }
+
+  BehaviorController(const BehaviorController& other)
+    : mpOperations(other.mpOperations)
+  {
+    if (mpOperations) {
+      mpOperations->mCopyConstruct(other.mStorage, mStorage);
+    }
+  }
+
+  BehaviorController(BehaviorController&& other) noexcept
+    : mpOperations(other.mpOperations)
+  {
+    if (mpOperations) {
+      mpOperations->mMoveConstruct(other.mStorage, mStorage);
+      other.mpOperations = nullptr;
+    }
+  }
+
+  BehaviorController& operator=(const BehaviorController& other) {
+    if (this != &other) {
+      auto copy = other;
+      *this = std::move(copy);
+    }
+
+    return *this;
+  }
+
+  BehaviorController& operator=(BehaviorController&& other) noexcept {
+    if (this != &other) {
+      reset();
+
+      if (other.mpOperations) {
+        other.mpOperations->mMoveConstruct(other.mStorage, mStorage);
+        mpOperations = std::exchange(other.mpOperations, nullptr);
+      }
+    }
+
+    return *this;
+  }
+
+  ~BehaviorController() {
+    reset();
   }
 
   void update(
@@ -160,25 +231,30 @@ public:
     const bool isOnScreen,
     entityx::Entity entity
   ) {
-    mpSelf->update(dependencies, state, isOnScreen, entity);
+    assert(mpOperations);
+    mpOperations->mUpdate(mStorage, dependencies, state, isOnScreen, entity);
   }
 
   void onHit(
     GlobalDependencies& dependencies,
     GlobalState& state,
-    const base::Point<float>& inflictorVelocity,
+    const engine::Velocity& inflictorVelocity,
     entityx::Entity entity
   ) {
-    mpSelf->onHit(dependencies, state, inflictorVelocity, entity);
+    assert(mpOperations);
+    mpOperations->mOnHit(
+      mStorage, dependencies, state, inflictorVelocity, entity);
   }
 
   void onKilled(
     GlobalDependencies& dependencies,
     GlobalState& state,
-    const base::Point<float>& inflictorVelocity,
+    const engine::Velocity& inflictorVelocity,
     entityx::Entity entity
   ) {
-    mpSelf->onKilled(dependencies, state, inflictorVelocity, entity);
+    assert(mpOperations);
+    mpOperations->mOnKilled(
+      mStorage, dependencies, state, inflictorVelocity, entity);
   }
 
   void onCollision(
@@ -187,106 +263,182 @@ public:
     const engine::events::CollidedWithWorld& event,
     entityx::Entity entity
   ) {
-    mpSelf->onCollision(dependencies, state, event, entity);
+    assert(mpOperations);
+    mpOperations->mOnCollision(mStorage, dependencies, state, event, entity);
   }
 
   template<typename T>
   T& get() {
-    auto pSelf = mpSelf.get();
-    return dynamic_cast<Model<T>*>(pSelf)->mData;
+    assert(mpOperations == &OPERATIONS_FOR<T>);
+    return Model<T>::self(mStorage);
+  }
+
+  template<typename T>
+  const T& get() const {
+    assert(mpOperations == &OPERATIONS_FOR<T>);
+    return Model<T>::self(const_cast<Storage&>(mStorage));
+  }
+
+  template<typename T>
+  static constexpr bool isStoredInline() {
+    return
+      sizeof(T) <= INLINE_STORAGE_SIZE &&
+      alignof(T) <= alignof(Storage) &&
+      std::is_nothrow_move_constructible_v<T>;
   }
 
 private:
-  struct Concept {
-    virtual ~Concept() = default;
+  using Storage = std::aligned_storage_t<INLINE_STORAGE_SIZE, alignof(void*)>;
 
-    virtual void update(
+  struct Operations {
+    void (*mUpdate)(
+      Storage& self,
       GlobalDependencies& dependencies,
       GlobalState& state,
       bool isOnScreen,
-      entityx::Entity entity) = 0;
+      entityx::Entity entity);
 
-    virtual void onHit(
+    void (*mOnHit)(
+      Storage& self,
       GlobalDependencies& dependencies,
       GlobalState& state,
-      const base::Point<float>& inflictorVelocity,
-      entityx::Entity entity) = 0;
+      const engine::Velocity& inflictorVelocity,
+      entityx::Entity entity);
 
-    virtual void onKilled(
+    void (*mOnKilled)(
+      Storage& self,
       GlobalDependencies& dependencies,
       GlobalState& state,
-      const base::Point<float>& inflictorVelocity,
-      entityx::Entity entity) = 0;
+      const engine::Velocity& inflictorVelocity,
+      entityx::Entity entity);
 
-    virtual void onCollision(
+    void (*mOnCollision)(
+      Storage& self,
       GlobalDependencies& dependencies,
       GlobalState& state,
       const engine::events::CollidedWithWorld& event,
-      entityx::Entity entity) = 0;
+      entityx::Entity entity);
+
+    void (*mCopyConstruct)(const Storage& source, Storage& destination);
+    void (*mMoveConstruct)(Storage& source, Storage& destination);
+    void (*mDestroy)(Storage& self);
   };
 
   template<typename T>
-  struct Model : public Concept {
-    explicit Model(T data_)
-      : mData(std::move(data_))
-    {
+  struct Model {
+    static T& self(Storage& storage) {
+      if constexpr (isStoredInline<T>()) {
+        return *std::launder(reinterpret_cast<T*>(&storage));
+      } else {
+        return **std::launder(reinterpret_cast<T**>(&storage));
+      }
     }
 
-    void update(
+    static void update(
+      Storage& storage,
       GlobalDependencies& dependencies,
       GlobalState& state,
-      bool isOnScreen,
+      const bool isOnScreen,
       entityx::Entity entity
-    ) override {
+    ) {
       updateBehaviorController(
-        mData,
+        self(storage),
         dependencies,
         state,
         isOnScreen,
         entity);
     }
 
-    void onHit(
+    static void onHit(
+      Storage& storage,
       GlobalDependencies& dependencies,
       GlobalState& state,
-      const base::Point<float>& inflictorVelocity,
+      const engine::Velocity& inflictorVelocity,
       entityx::Entity entity
-    ) override {
+    ) {
       behaviorControllerOnHit(
-        mData,
+        self(storage),
         dependencies,
         state,
         inflictorVelocity,
         entity);
     }
 
-    void onKilled(
+    static void onKilled(
+      Storage& storage,
       GlobalDependencies& dependencies,
       GlobalState& state,
-      const base::Point<float>& inflictorVelocity,
+      const engine::Velocity& inflictorVelocity,
       entityx::Entity entity
-    ) override {
+    ) {
       behaviorControllerOnKilled(
-        mData,
+        self(storage),
         dependencies,
         state,
         inflictorVelocity,
         entity);
     }
 
-    void onCollision(
+    static void onCollision(
+      Storage& storage,
       GlobalDependencies& dependencies,
       GlobalState& state,
       const engine::events::CollidedWithWorld& event,
       entityx::Entity entity
-    ) override {
-      behaviorControllerOnCollision(mData, dependencies, state, event, entity);
+    ) {
+      behaviorControllerOnCollision(
+        self(storage), dependencies, state, event, entity);
     }
 
-    T mData;
+    static void copyConstruct(const Storage& source, Storage& destination) {
+      const auto& sourceObject = self(const_cast<Storage&>(source));
+      if constexpr (isStoredInline<T>()) {
+        new (&destination) T(sourceObject);
+      } else {
+        new (&destination) T*(new T(sourceObject));
+      }
+    }
+
+    static void moveConstruct(Storage& source, Storage& destination) {
+      if constexpr (isStoredInline<T>()) {
+        new (&destination) T(std::move(self(source)));
+        self(source).~T();
+      } else {
+        // Heap-allocated objects don't need to be moved, we only transfer
+        // ownership
+        new (&destination) T*(&self(source));
+      }
+    }
+
+    static void destroy(Storage& storage) {
+      if constexpr (isStoredInline<T>()) {
+        self(storage).~T();
+      } else {
+        delete &self(storage);
+      }
+    }
   };
 
-  std::shared_ptr<Concept> mpSelf;
+  template<typename T>
+  static constexpr Operations OPERATIONS_FOR{
+    &Model<T>::update,
+    &Model<T>::onHit,
+    &Model<T>::onKilled,
+    &Model<T>::onCollision,
+    &Model<T>::copyConstruct,
+    &Model<T>::moveConstruct,
+    &Model<T>::destroy
+  };
+
+  void reset() {
+    if (mpOperations) {
+      mpOperations->mDestroy(mStorage);
+      mpOperations = nullptr;
+    }
+  }
+
+  const Operations* mpOperations;
+  Storage mStorage;
 };
 
 }
@@ -27,12 +27,14 @@ namespace rigel::game_logic {
 BehaviorControllerSystem::BehaviorControllerSystem(
   GlobalDependencies dependencies,
   Player* pPlayer,
+  PlayerContext* pPlayerContext,
   const base::Vector* pCameraPosition,
   data::map::Map* pMap
 )
   : mDependencies(dependencies)
   , mGlobalState(
       pPlayer,
+      pPlayerContext,
       pCameraPosition,
       pMap,
       &mPerFrameState)
@@ -38,6 +38,7 @@ public:
   explicit BehaviorControllerSystem(
     GlobalDependencies dependencies,
     Player* pPlayer,
+    PlayerContext* pPlayerContext,
     const base::Vector* pCameraPosition,
     data::map::Map* pMap);
 
@@ -18,6 +18,7 @@
 
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
+#include "engine/physical_components.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/Entity.h>
@@ -120,13 +121,13 @@ namespace events {
 
 struct ShootableDamaged {
   entityx::Entity mEntity;
-  base::Point<float> mInflictorVelocity;
+  engine::Velocity mInflictorVelocity;
 };
 
 
 struct ShootableKilled {
   entityx::Entity mEntity;
-  base::Point<float> mInflictorVelocity;
+  engine::Velocity mInflictorVelocity;
 };
 
 }
@@ -42,7 +42,7 @@ namespace {
 auto extractVelocity(entityx::Entity entity) {
   return entity.has_component<MovingBody>()
     ? entity.component<MovingBody>()->mVelocity
-    : base::Point<float>{};
+    : engine::Velocity{};
 }
 
 }
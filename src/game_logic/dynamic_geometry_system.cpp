@@ -40,7 +40,7 @@ namespace {
 
 constexpr auto GEOMETRY_FALL_SPEED = 2;
 
-const base::Point<float> TILE_DEBRIS_MOVEMENT_SEQUENCE[] = {
+const engine::Velocity TILE_DEBRIS_MOVEMENT_SEQUENCE[] = {
   {0.0f, -3.0f},
   {0.0f, -3.0f},
   {0.0f, -2.0f},
@@ -81,7 +81,7 @@ void spawnTileDebris(
   debris.assign<AutoDestroy>(AutoDestroy::afterTimeout(80));
   debris.assign<TileDebris>(TileDebris{tileIndex});
   debris.assign<MovingBody>(
-    Velocity{static_cast<float>(velocityX), 0.0f},
+    Velocity{velocityX, 0},
     GravityAffected{false},
     IgnoreCollisions{true});
   debris.assign<MovementSequence>(movement);
@@ -139,24 +139,9 @@ void moveTileRows(
   const base::Rect<int>& mapSection,
   data::map::Map& map
 ) {
-  const auto startX = mapSection.left();
-  const auto startY = mapSection.top();
-  const auto width = mapSection.size.width;
-  const auto height = mapSection.size.height;
-
-  for (int layer = 0; layer < 2; ++layer) {
-    for (int row = 0; row < height; ++row) {
-      for (int col = 0; col < width; ++col) {
-        const auto x = startX + col;
-        const auto sourceY = startY + (height - row - 1);
-        const auto targetY = sourceY + 1;
-
-        map.setTileAt(layer, x, targetY, map.tileAt(layer, x, sourceY));
-      }
-    }
-  }
-
-  map.clearSection(startX, startY, width, 1);
+  map.copySection(mapSection, mapSection.topLeft + base::Vector{0, 1});
+  map.clearSection(
+    mapSection.left(), mapSection.top(), mapSection.size.width, 1);
 }
 
 
@@ -26,6 +26,7 @@
 #include "game_logic/damage_components.hpp"
 #include "game_logic/entity_factory.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/player_context.hpp"
 
 #include <optional>
 
@@ -61,10 +62,11 @@ bool playerInNoticeableRange(
 bool playerVisible(
   components::BlueGuard& state,
   const WorldPosition& myPosition,
-  const Player& player
+  const Player& player,
+  const PlayerContext& playerContext
 ) {
-  const auto playerX = player.position().x;
-  const auto playerY = player.position().y;
+  const auto playerX = playerContext.position().x;
+  const auto playerY = playerContext.position().y;
   const auto facingLeft = state.mOrientation == Orientation::Left;
 
   const auto hasLineOfSightHorizontal =
@@ -76,7 +78,7 @@ bool playerVisible(
 
   return
     player.isInRegularState() &&
-    !player.isCloaked() &&
+    !playerContext.isCloaked() &&
     hasLineOfSightHorizontal &&
     hasLineOfSightVertical;
 }
@@ -95,6 +97,7 @@ base::Vector offsetForShot(const components::BlueGuard& state) {
 
 BlueGuardSystem::BlueGuardSystem(
   const Player* pPlayer,
+  const PlayerContext* pPlayerContext,
   CollisionChecker* pCollisionChecker,
   EntityFactory* pEntityFactory,
   IGameServiceProvider* pServiceProvider,
@@ -102,6 +105,7 @@ BlueGuardSystem::BlueGuardSystem(
   entityx::EventManager& events
 )
   : mpPlayer(pPlayer)
+  , mpPlayerContext(pPlayerContext)
   , mpCollisionChecker(pCollisionChecker)
   , mpEntityFactory(pEntityFactory)
   , mpServiceProvider(pServiceProvider)
@@ -122,7 +126,7 @@ void BlueGuardSystem::update(entityx::EntityManager& es) {
     ) {
       if (state.mTypingOnTerminal) {
         const auto noticesPlayer =
-          playerInNoticeableRange(position, mpPlayer->position());
+          playerInNoticeableRange(position, mpPlayerContext->position());
 
         if (noticesPlayer) {
           stopTyping(state, sprite, position);
@@ -169,6 +173,8 @@ void BlueGuardSystem::stopTyping(
   state.mTypingOnTerminal = false;
   state.mOneStepWalkedSinceTypingStop = false;
 
+  // Also invoked when the guard is shot, outside of the A.I. update, so
+  // this can't rely on the player context being current.
   const auto playerX = mpPlayer->orientedPosition().x;
   state.mOrientation = position.x <= playerX
     ? Orientation::Right
@@ -195,13 +201,13 @@ void BlueGuardSystem::updateGuard(
   // fulfilled.
   const auto canAttack =
     state.mOneStepWalkedSinceTypingStop &&
-    playerVisible(state, position, *mpPlayer);
+    playerVisible(state, position, *mpPlayer, *mpPlayerContext);
 
   if (canAttack) {
     // Change stance if necessary
     if (state.mStanceChangeCountdown <= 0) {
-      const auto playerCrouched = mpPlayer->isCrouching();
-      const auto playerBelow = mpPlayer->position().y > position.y;
+      const auto playerCrouched = mpPlayerContext->isCrouching();
+      const auto playerBelow = mpPlayerContext->position().y > position.y;
       state.mIsCrouched = playerCrouched || playerBelow;
 
       if (state.mIsCrouched) {
@@ -32,6 +32,7 @@ namespace engine::components { struct Sprite; }
 namespace game_logic {
   class EntityFactory;
   class Player;
+  class PlayerContext;
 }
 namespace game_logic::events { struct ShootableDamaged; }
 
@@ -70,6 +71,7 @@ class BlueGuardSystem : public entityx::Receiver<BlueGuardSystem> {
 public:
   BlueGuardSystem(
     const Player* pPlayer,
+    const PlayerContext* pPlayerContext,
     engine::CollisionChecker* pCollisionChecker,
     EntityFactory* pEntityFactory,
     IGameServiceProvider* pServiceProvider,
@@ -93,6 +95,7 @@ private:
 
 private:
   const Player* mpPlayer;
+  const PlayerContext* mpPlayerContext;
   engine::CollisionChecker* mpCollisionChecker;
   EntityFactory* mpEntityFactory;
   IGameServiceProvider* mpServiceProvider;
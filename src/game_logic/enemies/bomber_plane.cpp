@@ -150,7 +150,7 @@ void BomberPlane::update(
 void BomberPlane::onKilled(
   GlobalDependencies&,
   GlobalState&,
-  const base::Point<float>&,
+  const engine::Velocity&,
   entityx::Entity
 ) {
   if (mBombSprite) {
@@ -191,7 +191,7 @@ void BigBomb::update(
 void BigBomb::onKilled(
   GlobalDependencies& d,
   GlobalState&,
-  const base::Point<float>&,
+  const engine::Velocity&,
   entityx::Entity entity
 ) {
   // When shot while in the air, a slightly different series of explosions is
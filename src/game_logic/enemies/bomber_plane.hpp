@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "engine/physical_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 
 #include <variant>
@@ -49,7 +50,7 @@ struct BomberPlane {
   void onKilled(
     GlobalDependencies& dependencies,
     GlobalState& state,
-    const base::Point<float>& inflictorVelocity,
+    const engine::Velocity& inflictorVelocity,
     entityx::Entity entity);
 
   State mState;
@@ -67,7 +68,7 @@ struct BigBomb {
   void onKilled(
     GlobalDependencies& dependencies,
     GlobalState& state,
-    const base::Point<float>& inflictorVelocity,
+    const engine::Velocity& inflictorVelocity,
     entityx::Entity entity);
 
   void onCollision(
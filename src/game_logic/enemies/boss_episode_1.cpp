@@ -28,7 +28,7 @@
 #include "engine/visual_components.hpp"
 #include "game_logic/damage_components.hpp"
 #include "game_logic/entity_factory.hpp"
-#include "game_logic/player.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -54,7 +54,7 @@ void BossEpisode1::update(
 
   auto& position = *entity.component<WorldPosition>();
   auto& body = *entity.component<MovingBody>();
-  auto& playerPos = s.mpPlayer->position();
+  const auto& playerPos = s.mpPlayerContext->position();
 
   auto startSlammingDown = [&, this]() {
     const auto isTouchingGround = d.mpCollisionChecker->isOnSolidGround(
@@ -184,7 +184,7 @@ void BossEpisode1::onCollision(
 void BossEpisode1::onKilled(
   GlobalDependencies& d,
   GlobalState&,
-  const base::Point<float>&,
+  const engine::Velocity&,
   entityx::Entity entity
 ) {
   using engine::components::MovingBody;
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "engine/base_components.hpp"
+#include "engine/physical_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 
 #include <variant>
@@ -88,7 +89,7 @@ struct BossEpisode1 {
   void onKilled(
     GlobalDependencies& dependencies,
     GlobalState& state,
-    const base::Point<float>& inflictorVelocity,
+    const engine::Velocity& inflictorVelocity,
     entityx::Entity entity);
 
   boss_episode_1::State mState;
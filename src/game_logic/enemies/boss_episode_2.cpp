@@ -32,7 +32,7 @@ namespace rigel::game_logic::behaviors {
 
 namespace {
 
-constexpr auto FLY_RIGHT_MOVEMENT_SEQ = std::array<base::Point<float>, 39>{{
+constexpr auto FLY_RIGHT_MOVEMENT_SEQ = std::array<engine::Velocity, 39>{{
   {0.0f, 1.0f},
   {0.0f, 1.0f},
   {1.0f, 2.0f},
@@ -79,7 +79,7 @@ template <typename Sequence>
 constexpr auto invertHorizontalDirection(const Sequence& sequence) {
   auto invertedSequence = sequence;
   for (auto& elem : invertedSequence) {
-    elem.x *= -1.0f;
+    elem.x = -elem.x;
   }
   return invertedSequence;
 }
@@ -91,7 +91,7 @@ constexpr auto FLY_LEFT_MOVEMENT_SEQ =
 int FLY_RIGHT_ANIM_SEQ[] = { 2, 2, 3 };
 int FLY_LEFT_ANIM_SEQ[] = { 4, 4, 5 };
 
-constexpr auto JUMP_RIGHT_MOVEMENT_SEQ = std::array<base::Point<float>, 9>{{
+constexpr auto JUMP_RIGHT_MOVEMENT_SEQ = std::array<engine::Velocity, 9>{{
   {0.0f, -2.0f},
   {0.0f, -2.0f},
   {1.0f, -2.0f},
@@ -253,7 +253,7 @@ void BossEpisode2::onCollision(
 void BossEpisode2::onKilled(
   GlobalDependencies& d,
   GlobalState&,
-  const base::Point<float>&,
+  const engine::Velocity&,
   entityx::Entity entity
 ) {
   mDestructionPending = true;
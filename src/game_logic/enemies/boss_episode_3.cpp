@@ -25,7 +25,7 @@
 #include "game_logic/damage_components.hpp"
 #include "game_logic/entity_factory.hpp"
 #include "game_logic/global_dependencies.hpp"
-#include "game_logic/player.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace ec = rigel::engine::components;
@@ -68,7 +68,7 @@ void BossEpisode3::update(
   }
 
   auto& position = *entity.component<ec::WorldPosition>();
-  const auto& playerPos = s.mpPlayer->orientedPosition();
+  const auto& playerPos = s.mpPlayerContext->orientedPosition();
 
   // Move towards player
   const auto vecToPlayer =
@@ -86,7 +86,7 @@ void BossEpisode3::update(
     s.mpPerFrameState->mIsOddFrame &&
     d.mpRandomGenerator->gen() % 2 != 0
   ) {
-    const auto playerBbox = s.mpPlayer->worldSpaceHitBox();
+    const auto& playerBbox = s.mpPlayerContext->worldSpaceHitBox();
     for (const auto& area : ATTACK_AREAS) {
       auto attackRangeBbox =
         engine::toWorldSpace(*entity.component<ec::BoundingBox>(), position);
@@ -107,7 +107,7 @@ void BossEpisode3::update(
 void BossEpisode3::onKilled(
   GlobalDependencies& d,
   GlobalState&,
-  const base::Point<float>&,
+  const engine::Velocity&,
   entityx::Entity entity
 ) {
   d.mpEvents->emit(rigel::events::BossDestroyed{entity});
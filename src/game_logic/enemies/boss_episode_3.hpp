@@ -18,6 +18,7 @@
 
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
+#include "engine/physical_components.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
@@ -42,7 +43,7 @@ struct BossEpisode3 {
   void onKilled(
     GlobalDependencies&,
     GlobalState&,
-    const base::Point<float>&,
+    const engine::Velocity&,
     entityx::Entity entity);
 
   bool mHasBeenSighted = false;
@@ -27,7 +27,7 @@
 #include "game_logic/damage_components.hpp"
 #include "game_logic/entity_factory.hpp"
 #include "game_logic/global_dependencies.hpp"
-#include "game_logic/player.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -51,7 +51,7 @@ void BossEpisode4::update(
 
   auto& position = *entity.component<WorldPosition>();
   //auto& sprite = *entity.component<Sprite>();
-  const auto& playerPos = s.mpPlayer->orientedPosition();
+  const auto& playerPos = s.mpPlayerContext->orientedPosition();
 
   auto moveTowardsPlayer = [&]() {
     if (!s.mpPerFrameState->mIsOddFrame) {
@@ -98,7 +98,7 @@ void BossEpisode4::update(
 void BossEpisode4::onKilled(
   GlobalDependencies& d,
   GlobalState&,
-  const base::Point<float>&,
+  const engine::Velocity&,
   entityx::Entity entity
 ) {
   d.mpEvents->emit(rigel::events::BossDestroyed{entity});
@@ -117,7 +117,7 @@ void BossEpisode4Projectile::update(
 
   auto& position = *entity.component<WorldPosition>();
   const auto& bbox = *entity.component<BoundingBox>();
-  const auto& playerPos = s.mpPlayer->orientedPosition();
+  const auto& playerPos = s.mpPlayerContext->orientedPosition();
 
   if (mFramesElapsed < 8) {
     ++mFramesElapsed;
@@ -129,7 +129,7 @@ void BossEpisode4Projectile::update(
   }
 
   const auto worldSpaceBbox = engine::toWorldSpace(bbox, position);
-  if (s.mpPlayer->worldSpaceHitBox().intersects(worldSpaceBbox)) {
+  if (s.mpPlayerContext->isTouching(worldSpaceBbox)) {
     // TODO: Eliminate duplication with code in effects_system.cpp
     const auto randomChoice = d.mpRandomGenerator->gen();
     const auto soundId = randomChoice % 2 == 0
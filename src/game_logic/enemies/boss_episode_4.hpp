@@ -18,6 +18,7 @@
 
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
+#include "engine/physical_components.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
@@ -43,7 +44,7 @@ struct BossEpisode4 {
   void onKilled(
     GlobalDependencies& d,
     GlobalState&,
-    const base::Point<float>&,
+    const engine::Velocity&,
     entityx::Entity entity);
 
   int mCoolDownFrames = 0;
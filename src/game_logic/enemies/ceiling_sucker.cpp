@@ -21,6 +21,7 @@
 #include "engine/physical_components.hpp"
 #include "engine/sprite_tools.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -51,12 +52,12 @@ void CeilingSucker::update(
 
   const auto& position = *entity.component<engine::components::WorldPosition>();
   const auto& bbox = *entity.component<engine::components::BoundingBox>();
-  const auto& playerPos = s.mpPlayer->position();
+  const auto& playerPos = s.mpPlayerContext->position();
 
   const auto worldBbox = toWorldSpace(bbox, position);
 
   auto touchingPlayer = [&]() {
-    return worldBbox.intersects(s.mpPlayer->worldSpaceHitBox());
+    return s.mpPlayerContext->isTouching(worldBbox);
   };
 
   base::match(mState,
@@ -95,6 +96,7 @@ void CeilingSucker::update(
       ++state.mFramesElapsed;
       if (state.mFramesElapsed == 19) {
         s.mpPlayer->position().x = position.x;
+        s.mpPlayerContext->update();
         s.mpPlayer->setFree();
         s.mpPlayer->takeDamage(1);
       }
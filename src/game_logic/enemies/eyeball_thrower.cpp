@@ -22,6 +22,7 @@
 #include "engine/sprite_tools.hpp"
 #include "game_logic/entity_factory.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -45,7 +46,7 @@ void EyeballThrower::update(
   using namespace eyeball_thrower;
 
   const auto& position = *entity.component<WorldPosition>();
-  const auto& playerPos = s.mpPlayer->orientedPosition();
+  const auto& playerPos = s.mpPlayerContext->orientedPosition();
 
   auto& orientation = *entity.component<Orientation>();
   auto& animationFrame = entity.component<Sprite>()->mFramesToRender[0];
@@ -54,7 +55,7 @@ void EyeballThrower::update(
     // TODO: Extract helper function centerToCenterDistance()
 
     // [playerpos] Using orientation-independent position here
-    const auto playerX = s.mpPlayer->position().x;
+    const auto playerX = s.mpPlayerContext->position().x;
     const auto playerCenterX = playerX + PLAYER_WIDTH/2;
     const auto myCenterX = position.x + EYEBALL_THROWER_WIDTH/2;
     const auto centerToCenterDistance = std::abs(playerCenterX - myCenterX);
@@ -24,6 +24,7 @@
 #include "game_logic/actor_tag.hpp"
 #include "game_logic/damage_components.hpp"
 #include "game_logic/entity_factory.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace rigel::game_logic::ai {
@@ -46,11 +47,11 @@ constexpr auto TELEPORT_ANIMATION_END_FRAME =
 
 
 HoverBotSystem::HoverBotSystem(
-  entityx::Entity player,
+  const PlayerContext* pPlayerContext,
   engine::CollisionChecker* pCollisionChecker,
   EntityFactory* pEntityFactory
 )
-  : mPlayer(player)
+  : mpPlayerContext(pPlayerContext)
   , mpCollisionChecker(pCollisionChecker)
   , mpEntityFactory(pEntityFactory)
 {
@@ -127,7 +128,7 @@ void HoverBotSystem::update(entityx::EntityManager& es) {
           engine::walk(*mpCollisionChecker, entity, state.mOrientation);
 
           // TODO: use wonky player position (orientation dependent)
-          const auto& playerPosition = *mPlayer.component<WorldPosition>();
+          const auto& playerPosition = mpPlayerContext->position();
           const auto playerIsLeft = position.x > playerPosition.x;
           const auto playerIsRight = position.x < playerPosition.x;
           if (
@@ -34,7 +34,7 @@ namespace {
 
 constexpr auto FLY_SPEED = 2;
 
-constexpr base::Point<float> JUMP_ARC[] = {
+constexpr engine::Velocity JUMP_ARC[] = {
   {0.0f, -2.0f},
   {0.0f, -2.0f},
   {0.0f, -1.0f},
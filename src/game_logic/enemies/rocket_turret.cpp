@@ -22,6 +22,7 @@
 #include "engine/visual_components.hpp"
 #include "game_logic/damage_components.hpp"
 #include "game_logic/entity_factory.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace rigel::game_logic::ai {
@@ -66,11 +67,11 @@ auto determineOrientation(
 
 
 RocketTurretSystem::RocketTurretSystem(
-  entityx::Entity player,
+  const PlayerContext* pPlayerContext,
   EntityFactory* pEntityFactory,
   IGameServiceProvider* pServiceProvider
 )
-  : mPlayer(player)
+  : mpPlayerContext(pPlayerContext)
   , mpEntityFactory(pEntityFactory)
   , mpServiceProvider(pServiceProvider)
 {
@@ -78,7 +79,7 @@ RocketTurretSystem::RocketTurretSystem(
 
 
 void RocketTurretSystem::update(entityx::EntityManager& es) {
-  const auto& playerPosition = *mPlayer.component<WorldPosition>();
+  const auto& playerPosition = mpPlayerContext->position();
 
   es.each<components::RocketTurret, WorldPosition, Sprite, Active>(
     [this, &playerPosition](
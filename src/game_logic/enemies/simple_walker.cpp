@@ -18,6 +18,7 @@
 
 #include "engine/movement.hpp"
 #include "engine/visual_components.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace rigel::game_logic::ai {
@@ -31,17 +32,17 @@ using namespace engine::orientation;
 
 
 SimpleWalkerSystem::SimpleWalkerSystem(
-  entityx::Entity player,
+  const PlayerContext* pPlayerContext,
   engine::CollisionChecker* pCollisionChecker
 )
-  : mPlayer(player)
+  : mpPlayerContext(pPlayerContext)
   , mpCollisionChecker(pCollisionChecker)
 {
 }
 
 
 void SimpleWalkerSystem::update(entityx::EntityManager& es) {
-  const auto& playerPosition = *mPlayer.component<WorldPosition>();
+  const auto& playerPosition = mpPlayerContext->position();
 
   es.each<components::SimpleWalker, Sprite, WorldPosition, Active>(
     [this, &playerPosition](
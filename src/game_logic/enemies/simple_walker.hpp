@@ -27,6 +27,7 @@ RIGEL_RESTORE_WARNINGS
 
 
 namespace rigel::engine { class CollisionChecker; }
+namespace rigel::game_logic { class PlayerContext; }
 
 
 namespace rigel::game_logic::ai {
@@ -55,13 +56,13 @@ struct SimpleWalker {
 class SimpleWalkerSystem {
 public:
   SimpleWalkerSystem(
-    entityx::Entity player,
+    const PlayerContext* pPlayerContext,
     engine::CollisionChecker* pCollisionChecker);
 
   void update(entityx::EntityManager& es);
 
 private:
-  entityx::Entity mPlayer;
+  const PlayerContext* mpPlayerContext;
   engine::CollisionChecker* mpCollisionChecker;
   bool mIsOddFrame = false;
 };
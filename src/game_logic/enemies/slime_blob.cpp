@@ -26,7 +26,7 @@
 #include "engine/visual_components.hpp"
 #include "game_logic/damage_components.hpp"
 #include "game_logic/entity_factory.hpp"
-#include "game_logic/player.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace rigel::game_logic::ai {
@@ -74,13 +74,13 @@ void configureSlimeContainer(entityx::Entity entity) {
 
 
 SlimeBlobSystem::SlimeBlobSystem(
-  const Player* pPlayer,
+  const PlayerContext* pPlayerContext,
   CollisionChecker* pCollisionChecker,
   EntityFactory* pEntityFactory,
   engine::RandomNumberGenerator* pRandomGenerator,
   entityx::EventManager& events
 )
-  : mpPlayer(pPlayer)
+  : mpPlayerContext(pPlayerContext)
   , mpCollisionChecker(pCollisionChecker)
   , mpEntityFactory(pEntityFactory)
   , mpRandomGenerator(pRandomGenerator)
@@ -135,7 +135,7 @@ void SlimeBlobSystem::update(entityx::EntityManager& es) {
     ) {
       using namespace components::detail;
 
-      const auto playerPosition = mpPlayer->orientedPosition();
+      const auto& playerPosition = mpPlayerContext->orientedPosition();
       base::match(blobState.mState,
         [&](OnGround& state) {
           // Animate walking
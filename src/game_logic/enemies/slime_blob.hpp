@@ -30,7 +30,7 @@ namespace rigel::engine { class CollisionChecker; }
 namespace rigel::engine { class RandomNumberGenerator; }
 namespace rigel::game_logic {
   class EntityFactory;
-  class Player;
+  class PlayerContext;
 }
 namespace rigel::game_logic::events {
   struct ShootableKilled;
@@ -90,7 +90,7 @@ void configureSlimeContainer(entityx::Entity entity);
 class SlimeBlobSystem : public entityx::Receiver<SlimeBlobSystem> {
 public:
   SlimeBlobSystem(
-    const Player* pPlayer,
+    const PlayerContext* pPlayerContext,
     engine::CollisionChecker* pCollisionChecker,
     EntityFactory* pEntityFactory,
     engine::RandomNumberGenerator* pRandomGenerator,
@@ -100,7 +100,7 @@ public:
   void receive(const events::ShootableKilled& event);
 
 private:
-  const Player* mpPlayer;
+  const PlayerContext* mpPlayerContext;
   engine::CollisionChecker* mpCollisionChecker;
   EntityFactory* mpEntityFactory;
   engine::RandomNumberGenerator* mpRandomGenerator;
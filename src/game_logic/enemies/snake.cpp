@@ -26,6 +26,7 @@
 #include "game_logic/damage_components.hpp"
 #include "game_logic/effect_components.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -122,6 +123,7 @@ void Snake::update(
 
     if (s.mpPerFrameState->mIsOddFrame) {
       playerPos.x += movementValue();
+      s.mpPlayerContext->update();
       walk();
     }
   };
@@ -148,6 +150,7 @@ void Snake::update(
       ++state.mFramesElapsed;
       if (state.mFramesElapsed == 6) {
         playerPos.x += 2;
+        s.mpPlayerContext->update();
         mState = SwallowedPlayer{};
         walkWhilePlayerSwallowed();
       }
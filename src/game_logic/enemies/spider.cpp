@@ -24,6 +24,7 @@
 #include "game_logic/damage_components.hpp"
 #include "game_logic/enemies/simple_walker.hpp"
 #include "game_logic/entity_factory.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace rigel::game_logic::ai {
@@ -115,12 +116,14 @@ void walkOnFloor(components::Spider& self, entityx::Entity entity) {
 
 SpiderSystem::SpiderSystem(
   Player* pPlayer,
+  const PlayerContext* pPlayerContext,
   CollisionChecker* pCollisionChecker,
   engine::RandomNumberGenerator* pRandomGenerator,
   IEntityFactory* pEntityFactory,
   entityx::EventManager& events
 )
   : mpPlayer(pPlayer)
+  , mpPlayerContext(pPlayerContext)
   , mpCollisionChecker(pCollisionChecker)
   , mpRandomGenerator(pRandomGenerator)
   , mpEntityFactory(pEntityFactory)
@@ -143,8 +146,8 @@ void SpiderSystem::update(entityx::EntityManager& es) {
       const Active&
     ) {
       const auto worldSpaceBox = engine::toWorldSpace(bbox, position);
-      const auto& playerPosition = mpPlayer->orientedPosition();
-      const auto playerOrientation = mpPlayer->orientation();
+      const auto& playerPosition = mpPlayerContext->orientedPosition();
+      const auto playerOrientation = mpPlayerContext->orientation();
 
       auto tryClingToPlayer = [&, this](const SpiderClingPosition clingPos) {
         if (
@@ -157,7 +160,7 @@ void SpiderSystem::update(entityx::EntityManager& es) {
 
         mpPlayer->attachSpider(clingPos);
         self.mState = State::ClingingToPlayer;
-        self.mPreviousPlayerOrientation = mpPlayer->orientation();
+        self.mPreviousPlayerOrientation = playerOrientation;
         self.mClingPosition = clingPos;
 
         engine::removeSafely<ai::components::SimpleWalker>(entity);
@@ -173,7 +176,7 @@ void SpiderSystem::update(entityx::EntityManager& es) {
       };
 
       auto isTouchingPlayer = [&, this]() {
-        return worldSpaceBox.intersects(mpPlayer->worldSpaceHitBox());
+        return mpPlayerContext->isTouching(worldSpaceBox);
       };
 
       auto detachAndDestroy = [&, this]() {
@@ -29,7 +29,10 @@ namespace rigel {
 
 namespace engine { class CollisionChecker; }
 namespace engine { class RandomNumberGenerator; }
-namespace game_logic { struct IEntityFactory; }
+namespace game_logic {
+  struct IEntityFactory;
+  class PlayerContext;
+}
 
 }
 
@@ -61,6 +64,7 @@ class SpiderSystem : public entityx::Receiver<SpiderSystem> {
 public:
   SpiderSystem(
     Player* pPlayer,
+    const PlayerContext* pPlayerContext,
     engine::CollisionChecker* pCollisionChecker,
     engine::RandomNumberGenerator* pRandomGenerator,
     IEntityFactory* pEntityFactory,
@@ -71,6 +75,7 @@ public:
 
 private:
   Player* mpPlayer;
+  const PlayerContext* mpPlayerContext;
   engine::CollisionChecker* mpCollisionChecker;
   engine::RandomNumberGenerator* mpRandomGenerator;
   IEntityFactory* mpEntityFactory;
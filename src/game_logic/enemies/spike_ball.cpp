@@ -31,7 +31,7 @@ using namespace engine::components;
 
 namespace {
 
-base::Point<float> JUMP_ARC[] = {
+engine::Velocity JUMP_ARC[] = {
   {0.0f, -2.0f},
   {0.0f, -2.0f},
   {0.0f, -1.0f},
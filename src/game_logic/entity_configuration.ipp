@@ -36,7 +36,7 @@ const auto EFFECT_DRAW_ORDER = MUZZLE_FLASH_DRAW_ORDER + 1;
 
 const auto SCORE_NUMBER_LIFE_TIME = 60;
 
-const base::Point<float> SCORE_NUMBER_MOVE_SEQUENCE[] = {
+const engine::Velocity SCORE_NUMBER_MOVE_SEQUENCE[] = {
   {0.0f, -1.0f},
   {0.0f, -1.0f},
   {0.0f, -1.0f},
@@ -82,14 +82,14 @@ const int HINT_GLOBE_ANIMATION[] = {
 };
 
 
-base::Point<float> directionToVector(const ProjectileDirection direction) {
+engine::Velocity directionToVector(const ProjectileDirection direction) {
   const auto isNegative =
     direction == ProjectileDirection::Left ||
     direction == ProjectileDirection::Up;
-  const auto value = isNegative ? -1.0f : 1.0f;
+  const auto value = isNegative ? -1 : 1;
 
-  using Vec = base::Point<float>;
-  return isHorizontal(direction) ? Vec{value, 0.0f} : Vec{0.0f, value};
+  using Vec = engine::Velocity;
+  return isHorizontal(direction) ? Vec{value, 0} : Vec{0, value};
 }
 
 
@@ -150,23 +150,23 @@ ActorID actorIdForProjectile(
 }
 
 
-float speedForProjectileType(const ProjectileType type) {
+int speedForProjectileType(const ProjectileType type) {
   switch (type) {
     case ProjectileType::PlayerLaserShot:
     case ProjectileType::PlayerFlameShot:
-      return 5.0f;
+      return 5;
 
     case ProjectileType::ReactorDebris:
     case ProjectileType::PlayerShipLaserShot:
-      return 3.0f;
+      return 3;
       break;
 
     case ProjectileType::EnemyRocket:
     case ProjectileType::EnemyBossRocket:
-      return 1.0f;
+      return 1;
 
     default:
-      return 2.0f;
+      return 2;
   }
 }
 
@@ -78,9 +78,12 @@
 #include "game_logic/interactive/tile_burner.hpp"
 #include "game_logic/player/ship.hpp"
 #include "game_logic/trigger_components.hpp"
+#include "loader/palette.hpp"
 
 #include <tuple>
+#include <type_traits>
 #include <utility>
+#include <variant>
 
 
 namespace ex = entityx;
@@ -129,7 +132,7 @@ auto toPlayerProjectileType(const ProjectileType type) {
 }
 
 
-const base::Point<float> FLY_RIGHT[] = {
+const engine::Velocity FLY_RIGHT[] = {
   {3.0f, 0.0f},
   {3.0f, 0.0f},
   {3.0f, 0.0f},
@@ -143,7 +146,7 @@ const base::Point<float> FLY_RIGHT[] = {
 };
 
 
-const base::Point<float> FLY_UPPER_RIGHT[] = {
+const engine::Velocity FLY_UPPER_RIGHT[] = {
   {3.0f, -3.0f},
   {2.0f, -2.0f},
   {2.0f, -1.0f},
@@ -157,7 +160,7 @@ const base::Point<float> FLY_UPPER_RIGHT[] = {
 };
 
 
-const base::Point<float> FLY_UP[] = {
+const engine::Velocity FLY_UP[] = {
   {0.0f, -3.0f},
   {0.0f, -2.0f},
   {0.0f, -2.0f},
@@ -171,7 +174,7 @@ const base::Point<float> FLY_UP[] = {
 };
 
 
-const base::Point<float> FLY_UPPER_LEFT[] = {
+const engine::Velocity FLY_UPPER_LEFT[] = {
   {-3.0f, -3.0f},
   {-2.0f, -2.0f},
   {-2.0f, -1.0f},
@@ -185,7 +188,7 @@ const base::Point<float> FLY_UPPER_LEFT[] = {
 };
 
 
-const base::Point<float> FLY_LEFT[] = {
+const engine::Velocity FLY_LEFT[] = {
   {-3.0f, 0.0f},
   {-3.0f, 0.0f},
   {-3.0f, 0.0f},
@@ -199,7 +202,7 @@ const base::Point<float> FLY_LEFT[] = {
 };
 
 
-const base::Point<float> FLY_DOWN[] = {
+const engine::Velocity FLY_DOWN[] = {
   {0.0f, 1.0f},
   {0.0f, 2.0f},
   {0.0f, 2.0f},
@@ -213,7 +216,7 @@ const base::Point<float> FLY_DOWN[] = {
 };
 
 
-const base::Point<float> SWIRL_AROUND[] = {
+const engine::Velocity SWIRL_AROUND[] = {
   {-2.0f, 1.0f},
   {-2.0f, 1.0f},
   {-2.0f, 1.0f},
@@ -227,7 +230,7 @@ const base::Point<float> SWIRL_AROUND[] = {
 };
 
 
-const base::ArrayView<base::Point<float>> MOVEMENT_SEQUENCES[] = {
+const base::ArrayView<engine::Velocity> MOVEMENT_SEQUENCES[] = {
   FLY_RIGHT,
   FLY_UPPER_RIGHT,
   FLY_UP,
@@ -239,10 +242,29 @@ const base::ArrayView<base::Point<float>> MOVEMENT_SEQUENCES[] = {
 
 
 auto createFrameDrawData(
-  const loader::ActorData::Frame& frameData,
-  renderer::Renderer* pRenderer
+  const loader::IndexedActorData::Frame& frameData,
+  renderer::Renderer* pRenderer,
+  const bool useIndexedColors
 ) {
-  auto texture = renderer::OwningTexture{pRenderer, frameData.mFrameImage};
+  const auto createTexture = [&](const auto& image) {
+    return renderer::OwningTexture{
+      pRenderer, image, renderer::TextureCategory::Sprites};
+  };
+
+  auto texture = std::visit(
+    [&](const auto& image) {
+      using ImageT = std::decay_t<decltype(image)>;
+
+      if constexpr (std::is_same_v<ImageT, data::IndexedImage>) {
+        if (!useIndexedColors) {
+          return createTexture(
+            loader::applyPalette(image, loader::INGAME_PALETTE));
+        }
+      }
+
+      return createTexture(image);
+    },
+    frameData.mFrameImage);
   return engine::SpriteFrame{std::move(texture), frameData.mDrawOffset};
 }
 
@@ -250,8 +272,9 @@ auto createFrameDrawData(
 void applyTweaks(
   std::vector<engine::SpriteFrame>& frames,
   const ActorID actorId,
-  const std::vector<loader::ActorData>& actorParts,
-  renderer::Renderer* pRenderer
+  const std::vector<loader::IndexedActorData>& actorParts,
+  renderer::Renderer* pRenderer,
+  const bool useIndexedColors
 ) {
   // Some sprites in the game have offsets that would require more complicated
   // code to draw them correctly. To simplify that, we adjust the offsets once
@@ -310,10 +333,12 @@ void applyTweaks(
     //  10, 11: exhaust flames, facing right
     frames.insert(
       frames.begin() + 8,
-      createFrameDrawData(actorParts[2].mFrames[0], pRenderer));
+      createFrameDrawData(
+        actorParts[2].mFrames[0], pRenderer, useIndexedColors));
     frames.insert(
       frames.begin() + 9,
-      createFrameDrawData(actorParts[2].mFrames[1], pRenderer));
+      createFrameDrawData(
+        actorParts[2].mFrames[1], pRenderer, useIndexedColors));
 
     frames[8].mDrawOffset.x += 1;
     frames[9].mDrawOffset.x += 1;
@@ -416,10 +441,12 @@ base::ArrayView<int> frameMapForActor(const ActorID actorId) {
 
 SpriteFactory::SpriteFactory(
   renderer::Renderer* pRenderer,
-  const ActorImagePackage* pSpritePackage
+  const ActorImagePackage* pSpritePackage,
+  const bool useIndexedColors
 )
   : mpRenderer(pRenderer)
   , mpSpritePackage(pSpritePackage)
+  , mUseIndexedColors(useIndexedColors)
 {
 }
 
@@ -436,7 +463,7 @@ Sprite SpriteFactory::createSprite(const ActorID mainId) {
     const auto actorPartIds = actorIDListForActor(mainId);
     const auto actorParts = utils::transformed(actorPartIds,
       [&](const ActorID partId) {
-        return mpSpritePackage->loadActor(partId);
+        return mpSpritePackage->loadIndexedActor(partId);
       });
 
     for (const auto& actorData : actorParts) {
@@ -444,7 +471,7 @@ Sprite SpriteFactory::createSprite(const ActorID mainId) {
 
       for (const auto& frameData : actorData.mFrames) {
         drawData.mFrames.emplace_back(
-          createFrameDrawData(frameData, mpRenderer));
+          createFrameDrawData(frameData, mpRenderer, mUseIndexedColors));
       }
 
       framesToRender.push_back(lastFrameCount);
@@ -455,7 +482,8 @@ Sprite SpriteFactory::createSprite(const ActorID mainId) {
     drawData.mVirtualToRealFrameMap = frameMapForActor(mainId);
     drawData.mDrawOrder = adjustedDrawOrder(mainId, lastDrawOrder);
 
-    applyTweaks(drawData.mFrames, mainId, actorParts, mpRenderer);
+    applyTweaks(
+      drawData.mFrames, mainId, actorParts, mpRenderer, mUseIndexedColors);
 
     iData = mSpriteDataCache.emplace(
       mainId,
@@ -92,13 +92,24 @@ inline bool isHorizontal(const ProjectileDirection direction) {
 
 class SpriteFactory {
 public:
+  /** Create sprite factory
+   *
+   * If useIndexedColors is true, sprite frames are uploaded as indexed
+   * textures (see renderer::Renderer::createTexture()), except for frames
+   * coming from replacement images.
+   */
   SpriteFactory(
     renderer::Renderer* pRenderer,
-    const loader::ActorImagePackage* pSpritePackage);
+    const loader::ActorImagePackage* pSpritePackage,
+    bool useIndexedColors = false);
 
   engine::components::Sprite createSprite(data::ActorID id);
   base::Rect<int> actorFrameRect(data::ActorID id, int frame) const;
 
+  bool usesIndexedColors() const {
+    return mUseIndexedColors;
+  }
+
 private:
   struct SpriteData {
     engine::SpriteDrawData mDrawData;
@@ -107,6 +118,7 @@ private:
 
   renderer::Renderer* mpRenderer;
   const loader::ActorImagePackage* mpSpritePackage;
+  bool mUseIndexedColors;
   std::unordered_map<data::ActorID, SpriteData> mSpriteDataCache;
 };
 
@@ -16,6 +16,7 @@
 
 #include "game_world.hpp"
 
+#include "base/defer.hpp"
 #include "common/game_service_provider.hpp"
 #include "common/user_profile.hpp"
 #include "data/game_options.hpp"
@@ -38,7 +39,11 @@
 
 #include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <iostream>
+#include <tuple>
 
 
 namespace rigel::game_logic {
@@ -111,6 +116,24 @@ constexpr auto HEALTH_BAR_START_PX = base::Vector{data::tilesToPixels(5), 0};
 
 constexpr auto HUD_WIDTH = 6;
 
+constexpr auto HITCH_REPORTS_DIRECTORY = "hitch_reports";
+
+
+std::optional<HitchRecorder> createHitchRecorder(
+  const IGameServiceProvider& serviceProvider
+) {
+  const auto& maybeThreshold =
+    serviceProvider.commandLineOptions().mHitchThresholdMs;
+  if (!maybeThreshold) {
+    return std::nullopt;
+  }
+
+  // Fall back to the working directory if there is no preferences path
+  const auto basePath =
+    createOrGetPreferencesPath().value_or(std::filesystem::path{});
+  return HitchRecorder{*maybeThreshold, basePath / HITCH_REPORTS_DIRECTORY};
+}
+
 
 void drawBossHealthBar(
   const int health,
@@ -286,12 +309,20 @@ GameWorld::WorldState::WorldState(
   mBackdropSwitchCondition = loadedLevel.mBackdropSwitchCondition;
   mLevelMusicFile = loadedLevel.mMusicFile;
 
+  auto mapRenderData =
+    engine::MapRenderer::MapRenderData{std::move(loadedLevel)};
+  if (!pSpriteFactory->usesIndexedColors()) {
+    mapRenderData.mTileSetImage = loader::applyPalette(
+      std::get<data::IndexedImage>(mapRenderData.mTileSetImage),
+      loader::INGAME_PALETTE);
+  }
+
   mpSystems = std::make_unique<IngameSystems>(
     sessionId,
     playerEntity,
     pPlayerModel,
     &mMap,
-    engine::MapRenderer::MapRenderData{std::move(loadedLevel)},
+    std::move(mapRenderData),
     pServiceProvider,
     &mEntityFactory,
     &mRandomGenerator,
@@ -300,7 +331,7 @@ GameWorld::WorldState::WorldState(
     pRenderer,
     mEntities,
     eventManager,
-    *pResources);
+    loader::loadHintMessages(pResources->fileAsText("HELP.MNI")));
 
   if (loadedLevel.mEarthquake) {
     mEarthQuakeEffect = EarthQuakeEffect{
@@ -312,6 +343,62 @@ GameWorld::WorldState::WorldState(
 GameWorld::WorldState::~WorldState() = default;
 
 
+bool GameplayStateSnapshot::operator==(
+  const GameplayStateSnapshot& other
+) const {
+  return
+    std::tie(
+      mPlayerPosition,
+      mPlayerOrientation,
+      mPlayerHealth,
+      mScore,
+      mAmmo,
+      mNumEntities,
+      mEntityPositionsHash,
+      mLevelFinished,
+      mPlayerDied) ==
+    std::tie(
+      other.mPlayerPosition,
+      other.mPlayerOrientation,
+      other.mPlayerHealth,
+      other.mScore,
+      other.mAmmo,
+      other.mNumEntities,
+      other.mEntityPositionsHash,
+      other.mLevelFinished,
+      other.mPlayerDied);
+}
+
+
+std::ostream& operator<<(
+  std::ostream& stream,
+  const GameplayStateSnapshot& snapshot
+) {
+  const auto facingLeft =
+    snapshot.mPlayerOrientation == engine::components::Orientation::Left;
+
+  stream
+    << "player at " << snapshot.mPlayerPosition.x << ','
+    << snapshot.mPlayerPosition.y << " facing "
+    << (facingLeft ? "left" : "right")
+    << ", health " << snapshot.mPlayerHealth
+    << ", score " << snapshot.mScore
+    << ", ammo " << snapshot.mAmmo
+    << ", " << snapshot.mNumEntities << " entities (positions hash "
+    << snapshot.mEntityPositionsHash << ')';
+
+  if (snapshot.mLevelFinished) {
+    stream << ", level finished";
+  }
+
+  if (snapshot.mPlayerDied) {
+    stream << ", player died";
+  }
+
+  return stream;
+}
+
+
 GameWorld::GameWorld(
   data::PlayerModel* pPlayerModel,
   const data::GameSessionId& sessionId,
@@ -327,7 +414,10 @@ GameWorld::GameWorld(
   , mpOptions(&context.mpUserProfile->mOptions)
   , mpResources(context.mpResources)
   , mSessionId(sessionId)
-  , mSpriteFactory(context.mpRenderer, &context.mpResources->mActorImagePackage)
+  , mSpriteFactory(
+      context.mpRenderer,
+      &context.mpResources->mActorImagePackage,
+      mpOptions->mEnableIndexedColorTextures)
   , mPlayerModelAtLevelStart(*mpPlayerModel)
   , mHudRenderer(
       sessionId.mLevel + 1,
@@ -335,6 +425,7 @@ GameWorld::GameWorld(
       *context.mpResources,
       context.mpUiSpriteSheet)
   , mMessageDisplay(mpServiceProvider, context.mpUiRenderer)
+  , mHitchRecorder(createHitchRecorder(*mpServiceProvider))
 {
   mEventManager.subscribe<rigel::events::CheckPointActivated>(*this);
   mEventManager.subscribe<rigel::events::ExitReached>(*this);
@@ -360,6 +451,8 @@ GameWorld::GameWorld(
     updateGameLogic({});
   }
 
+  startHitchCapture(playerPositionOverride);
+
   if (showWelcomeMessage) {
     mMessageDisplay.setMessage(data::Messages::WelcomeToDukeNukem2);
   }
@@ -375,6 +468,15 @@ GameWorld::GameWorld(
   auto after = high_resolution_clock::now();
   std::cout << "Level load time: " <<
     duration<double>(after - before).count() * 1000.0 << " ms\n";
+
+  const auto textureMemory = mpRenderer->textureMemoryStatistics();
+  std::cout << "Level texture memory ("
+    << (mSpriteFactory.usesIndexedColors() ? "indexed" : "RGBA")
+    << " colors): map "
+    << textureMemory[renderer::TextureCategory::Map].mBytes / 1024
+    << " KiB, sprites "
+    << textureMemory[renderer::TextureCategory::Sprites].mBytes / 1024
+    << " KiB\n";
 }
 
 
@@ -541,7 +643,38 @@ void GameWorld::loadLevel() {
 }
 
 
+void GameWorld::startHitchCapture(
+  const std::optional<base::Vector> playerPositionOverride
+) {
+  if (mHitchRecorder) {
+    mHitchRecorder->beginLevel(
+      mSessionId,
+      mPlayerModelAtLevelStart,
+      playerPositionOverride,
+      viewPortSize());
+  }
+}
+
+
+base::Extents GameWorld::viewPortSize() const {
+  if (
+    mpOptions->mWidescreenModeOn && renderer::canUseWidescreenMode(mpRenderer)
+  ) {
+    const auto info = renderer::determineWidescreenViewPort(mpRenderer);
+    return {
+      info.mWidthTiles - HUD_WIDTH,
+      data::GameTraits::mapViewPortSize.height};
+  }
+
+  return data::GameTraits::mapViewPortSize;
+}
+
+
 void GameWorld::updateGameLogic(const PlayerInput& input) {
+  using namespace std::chrono;
+
+  const auto before = high_resolution_clock::now();
+
   mpState->mBackdropFlashColor = std::nullopt;
   mpState->mScreenFlashColor = std::nullopt;
 
@@ -564,16 +697,15 @@ void GameWorld::updateGameLogic(const PlayerInput& input) {
     mpState->mBossDeathAnimationStartPending = false;
   }
 
-  if (
-    mpOptions->mWidescreenModeOn && renderer::canUseWidescreenMode(mpRenderer)
-  ) {
-    const auto info = renderer::determineWidescreenViewPort(mpRenderer);
-    const auto viewPortSize = base::Extents{
-      info.mWidthTiles - HUD_WIDTH,
-      data::GameTraits::mapViewPortSize.height};
-    mpState->mpSystems->update(input, mpState->mEntities, viewPortSize);
-  } else {
-    mpState->mpSystems->update(input, mpState->mEntities, data::GameTraits::mapViewPortSize);
+  mpState->mpSystems->update(input, mpState->mEntities, viewPortSize());
+
+  if (mHitchRecorder) {
+    mHitchRecorder->recordUpdate(
+      input,
+      duration<float, std::milli>(high_resolution_clock::now() - before)
+        .count(),
+      mpState->mpSystems->lastUpdateTimings(),
+      static_cast<std::uint32_t>(mpState->mEntities.size()));
   }
 }
 
@@ -582,6 +714,13 @@ void GameWorld::render() {
   const auto widescreenModeOn =
     mpOptions->mWidescreenModeOn && renderer::canUseWidescreenMode(mpRenderer);
 
+  // The world, HUD and top row draw lots of sprites with interleaved
+  // textures. Letting the renderer reorder them saves many batches.
+  mpRenderer->setDrawCommandReorderingEnabled(true);
+  const auto reorderingGuard = base::defer([this]() {
+    mpRenderer->setDrawCommandReorderingEnabled(false);
+  });
+
   auto drawWorld = [this](const base::Extents& viewPortSize) {
     if (!mpState->mScreenFlashColor) {
       mpState->mpSystems->render(
@@ -592,6 +731,9 @@ void GameWorld::render() {
   };
 
   auto drawTopRow = [&, this]() {
+    const auto phase =
+      renderer::beginRenderPhase(mpRenderer, renderer::RenderPhase::Hud);
+
     if (mpState->mActiveBossEntity) {
       using game_logic::components::Shootable;
 
@@ -613,6 +755,9 @@ void GameWorld::render() {
   };
 
   auto drawHud = [&, this]() {
+    const auto phase =
+      renderer::beginRenderPhase(mpRenderer, renderer::RenderPhase::Hud);
+
     const auto radarDots =
       collectRadarDots(mpState->mEntities, mpState->mpSystems->player().position());
     mHudRenderer.render(*mpPlayerModel, radarDots);
@@ -656,6 +801,48 @@ void GameWorld::processEndOfFrameActions() {
 }
 
 
+void GameWorld::recordFrameTimings(
+  const engine::TimeDelta frameDelta,
+  const engine::TimeDelta frameWorkTime
+) {
+  if (mHitchRecorder) {
+    mHitchRecorder->recordFrame(
+      static_cast<float>(frameDelta * 1000.0),
+      static_cast<float>(frameWorkTime * 1000.0));
+  }
+}
+
+
+GameplayStateSnapshot GameWorld::gameplayState() const {
+  const auto& player = mpState->mpSystems->player();
+
+  // Entity ids and iteration order are deterministic as well, so the order
+  // of positions is part of the state that needs to match
+  auto positionsHash = std::size_t{17};
+  mpState->mEntities.each<WorldPosition>(
+    [&](entityx::Entity, const WorldPosition& position) {
+      positionsHash = positionsHash * 31 + std::hash<int>{}(position.x);
+      positionsHash = positionsHash * 31 + std::hash<int>{}(position.y);
+    });
+
+  return GameplayStateSnapshot{
+    player.position(),
+    player.orientation(),
+    mpPlayerModel->health(),
+    mpPlayerModel->score(),
+    mpPlayerModel->ammo(),
+    mpState->mEntities.size(),
+    positionsHash,
+    mpState->mLevelFinished,
+    mpState->mPlayerDied};
+}
+
+
+const UpdateStageTimings& GameWorld::lastUpdateTimings() const {
+  return mpState->mpSystems->lastUpdateTimings();
+}
+
+
 void GameWorld::onReactorDestroyed(const base::Vector& position) {
   mpState->mScreenFlashColor = loader::INGAME_PALETTE[7];
   mpState->mEntityFactory.createProjectile(
@@ -746,8 +933,9 @@ void GameWorld::handlePlayerDeath() {
 void GameWorld::restartLevel() {
   mpServiceProvider->fadeOutScreen();
 
-  *mpPlayerModel = mPlayerModelAtLevelStart;
+  mpPlayerModel->restoreFromSnapshot(mPlayerModelAtLevelStart);
   loadLevel();
+  startHitchCapture(std::nullopt);
 
   if (mpState->mRadarDishCounter.radarDishesPresent()) {
     mMessageDisplay.setMessage(data::Messages::FindAllRadars);
@@ -816,6 +1004,60 @@ void GameWorld::showTutorialMessage(const data::TutorialMessageId id) {
 void GameWorld::printDebugText(std::ostream& stream) const {
   mpState->mpSystems->printDebugText(stream);
   stream << "Entities: " << mpState->mEntities.size() << '\n';
+
+  const auto reorderingStats = mpRenderer->lastFrameReorderingStats();
+  stream
+    << "Sprite batches: " << reorderingStats.mBatchesInOrder
+    << " (reordered: " << reorderingStats.mBatchesReordered << ")\n";
+
+  using renderer::FlushReason;
+  using renderer::RenderPhase;
+
+  const auto frameStatistics = mpRenderer->lastFrameStatistics();
+  const auto total = frameStatistics.total();
+  stream
+    << "Draw calls: " << total.mDrawCalls
+    << ", vertices: " << total.mVertices << '\n'
+    << "Binds: " << total.mTextureBinds
+    << ", uniforms: " << total.mUniformUpdates
+    << ", target switches: " << total.mRenderTargetSwitches << '\n';
+
+  stream << "Flushes:";
+  for (int i = 0; i < renderer::NUM_FLUSH_REASONS; ++i) {
+    const auto reason = static_cast<FlushReason>(i);
+    if (const auto count = total.flushes(reason)) {
+      stream << ' ' << renderer::flushReasonName(reason) << ": " << count;
+    }
+  }
+  stream << '\n';
+
+  stream << "Draw calls by phase:";
+  for (int i = 0; i < renderer::NUM_RENDER_PHASES; ++i) {
+    const auto phase = static_cast<RenderPhase>(i);
+    if (const auto count = frameStatistics[phase].mDrawCalls) {
+      stream << ' ' << renderer::renderPhaseName(phase) << ": " << count;
+    }
+  }
+  stream << '\n';
+
+  using renderer::TextureCategory;
+
+  const auto textureMemory = mpRenderer->textureMemoryStatistics();
+  const auto toKb = [](const std::size_t bytes) { return bytes / 1024; };
+  stream
+    << "Textures: " << textureMemory.mTotal.mTextureCount << ", "
+    << toKb(textureMemory.mTotal.mBytes) << " KB (peak "
+    << toKb(textureMemory.mTotal.mPeakBytes) << " KB)\n";
+  for (int i = 0; i < renderer::NUM_TEXTURE_CATEGORIES; ++i) {
+    const auto category = static_cast<TextureCategory>(i);
+    const auto& usage = textureMemory[category];
+    if (usage.mPeakBytes > 0) {
+      stream
+        << "  " << renderer::textureCategoryName(category) << ": "
+        << usage.mTextureCount << ", " << toKb(usage.mBytes) << " KB (peak "
+        << toKb(usage.mPeakBytes) << " KB)\n";
+    }
+  }
 }
 
 }
@@ -29,6 +29,7 @@
 #include "game_logic/damage_components.hpp"
 #include "game_logic/earth_quake_effect.hpp"
 #include "game_logic/entity_factory.hpp"
+#include "game_logic/hitch_recorder.hpp"
 #include "game_logic/input.hpp"
 #include "game_logic/interactive/enemy_radar.hpp"
 #include "game_logic/player/components.hpp"
@@ -39,6 +40,7 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
 #include <iosfwd>
 #include <optional>
 #include <vector>
@@ -52,6 +54,35 @@ namespace rigel::game_logic {
 class IngameSystems;
 
 
+/** Summary of a world's gameplay state, for checking that worlds are in sync
+ *
+ * Two worlds running the same level with the same input are expected to
+ * produce identical snapshots after every update, regardless of options
+ * which only affect presentation.
+ */
+struct GameplayStateSnapshot {
+  base::Vector mPlayerPosition;
+  engine::components::Orientation mPlayerOrientation;
+  int mPlayerHealth;
+  int mScore;
+  int mAmmo;
+  std::size_t mNumEntities;
+  std::size_t mEntityPositionsHash;
+  bool mLevelFinished;
+  bool mPlayerDied;
+
+  bool operator==(const GameplayStateSnapshot& other) const;
+  bool operator!=(const GameplayStateSnapshot& other) const {
+    return !(*this == other);
+  }
+};
+
+
+std::ostream& operator<<(
+  std::ostream& stream,
+  const GameplayStateSnapshot& snapshot);
+
+
 class GameWorld : public entityx::Receiver<GameWorld> {
 public:
   GameWorld(
@@ -82,10 +113,25 @@ public:
   void render();
   void processEndOfFrameActions();
 
+  /** Feed timings of the current frame to hitch capture, if enabled
+   *
+   * Must be called once per frame, after processEndOfFrameActions().
+   */
+  void recordFrameTimings(
+    engine::TimeDelta frameDelta,
+    engine::TimeDelta frameWorkTime);
+
+  GameplayStateSnapshot gameplayState() const;
+
+  /** Per-stage timings of the most recent call to updateGameLogic() */
+  const UpdateStageTimings& lastUpdateTimings() const;
+
   friend class rigel::GameRunner;
 
 private:
   void loadLevel();
+  void startHitchCapture(std::optional<base::Vector> playerPositionOverride);
+  base::Extents viewPortSize() const;
 
   void onReactorDestroyed(const base::Vector& position);
   void updateReactorDestructionEvent();
@@ -169,6 +215,7 @@ private:
   std::optional<CheckpointData> mActivatedCheckpoint;
   ui::HudRenderer mHudRenderer;
   ui::IngameMessageDisplay mMessageDisplay;
+  std::optional<HitchRecorder> mHitchRecorder;
 
   std::unique_ptr<WorldState> mpState;
 };
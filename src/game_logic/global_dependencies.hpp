@@ -42,6 +42,7 @@ namespace rigel {
   namespace game_logic {
     struct IEntityFactory;
     class Player;
+    class PlayerContext;
   }
 }
 
@@ -70,11 +71,13 @@ struct PerFrameState {
 struct GlobalState {
   GlobalState(
     Player* pPlayer,
+    PlayerContext* pPlayerContext,
     const base::Vector* pCameraPosition,
     data::map::Map* pMap,
     const PerFrameState* pPerFrameState
   )
     : mpPlayer(pPlayer)
+    , mpPlayerContext(pPlayerContext)
     , mpCameraPosition(pCameraPosition)
     , mpMap(pMap)
     , mpPerFrameState(pPerFrameState)
@@ -82,6 +85,7 @@ struct GlobalState {
   }
 
   Player* mpPlayer;
+  PlayerContext* mpPlayerContext;
   const base::Vector* mpCameraPosition;
   data::map::Map* mpMap;
   const PerFrameState* mpPerFrameState;
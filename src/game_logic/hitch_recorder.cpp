@@ -0,0 +1,376 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hitch_recorder.hpp"
+
+#include "common/json_utils.hpp"
+#include "data/player_model.hpp"
+#include "loader/file_utils.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+
+namespace rigel::game_logic {
+
+namespace {
+
+constexpr auto REPORT_FORMAT_VERSION = 1;
+
+constexpr auto INPUT_LEFT = 1 << 0;
+constexpr auto INPUT_RIGHT = 1 << 1;
+constexpr auto INPUT_UP = 1 << 2;
+constexpr auto INPUT_DOWN = 1 << 3;
+constexpr auto INPUT_INTERACT_PRESSED = 1 << 4;
+constexpr auto INPUT_INTERACT_TRIGGERED = 1 << 5;
+constexpr auto INPUT_JUMP_PRESSED = 1 << 6;
+constexpr auto INPUT_JUMP_TRIGGERED = 1 << 7;
+constexpr auto INPUT_FIRE_PRESSED = 1 << 8;
+constexpr auto INPUT_FIRE_TRIGGERED = 1 << 9;
+constexpr auto TICK_ENDS_FRAME = 1 << 10;
+
+
+int encodeInput(const PlayerInput& input) {
+  const auto bitIf = [](const bool condition, const int bit) {
+    return condition ? bit : 0;
+  };
+
+  return
+    bitIf(input.mLeft, INPUT_LEFT) |
+    bitIf(input.mRight, INPUT_RIGHT) |
+    bitIf(input.mUp, INPUT_UP) |
+    bitIf(input.mDown, INPUT_DOWN) |
+    bitIf(input.mInteract.mIsPressed, INPUT_INTERACT_PRESSED) |
+    bitIf(input.mInteract.mWasTriggered, INPUT_INTERACT_TRIGGERED) |
+    bitIf(input.mJump.mIsPressed, INPUT_JUMP_PRESSED) |
+    bitIf(input.mJump.mWasTriggered, INPUT_JUMP_TRIGGERED) |
+    bitIf(input.mFire.mIsPressed, INPUT_FIRE_PRESSED) |
+    bitIf(input.mFire.mWasTriggered, INPUT_FIRE_TRIGGERED);
+}
+
+
+PlayerInput decodeInput(const int bits) {
+  PlayerInput input;
+  input.mLeft = bits & INPUT_LEFT;
+  input.mRight = bits & INPUT_RIGHT;
+  input.mUp = bits & INPUT_UP;
+  input.mDown = bits & INPUT_DOWN;
+  input.mInteract.mIsPressed = bits & INPUT_INTERACT_PRESSED;
+  input.mInteract.mWasTriggered = bits & INPUT_INTERACT_TRIGGERED;
+  input.mJump.mIsPressed = bits & INPUT_JUMP_PRESSED;
+  input.mJump.mWasTriggered = bits & INPUT_JUMP_TRIGGERED;
+  input.mFire.mIsPressed = bits & INPUT_FIRE_PRESSED;
+  input.mFire.mWasTriggered = bits & INPUT_FIRE_TRIGGERED;
+  return input;
+}
+
+
+nlohmann::json serialize(const LevelReplayData& replayData) {
+  using json = nlohmann::json;
+
+  const auto& playerModel = replayData.mPlayerModelAtLevelStart;
+
+  auto tutorialMessages = json::array();
+  for (int i = 0; i < data::NUM_TUTORIAL_MESSAGES; ++i) {
+    const auto id = static_cast<data::TutorialMessageId>(i);
+    if (playerModel.mTutorialMessagesAlreadySeen.hasBeenShown(id)) {
+      tutorialMessages.push_back(id);
+    }
+  }
+
+  auto ticks = json::array();
+  for (const auto& tick : replayData.mTicks) {
+    ticks.push_back(
+      encodeInput(tick.mInput) | (tick.mEndsFrame ? TICK_ENDS_FRAME : 0));
+  }
+
+  json serialized;
+  serialized["episode"] = replayData.mSessionId.mEpisode;
+  serialized["level"] = replayData.mSessionId.mLevel;
+  serialized["difficulty"] = replayData.mSessionId.mDifficulty;
+  serialized["playerModel"] = json{
+    {"tutorialMessagesAlreadySeen", tutorialMessages},
+    {"weapon", playerModel.mWeapon},
+    {"ammo", playerModel.mAmmo},
+    {"score", playerModel.mScore}};
+  serialized["playerPositionOverride"] = replayData.mPlayerPositionOverride
+    ? json::array({
+        replayData.mPlayerPositionOverride->x,
+        replayData.mPlayerPositionOverride->y})
+    : json();
+  serialized["viewPortSize"] = json::array({
+    replayData.mViewPortSize.width,
+    replayData.mViewPortSize.height});
+  serialized["ticks"] = std::move(ticks);
+  return serialized;
+}
+
+
+LevelReplayData deserializeReplayData(const nlohmann::json& json) {
+  LevelReplayData result;
+  result.mSessionId = data::GameSessionId{
+    json.at("episode").get<int>(),
+    json.at("level").get<int>(),
+    json.at("difficulty").get<data::Difficulty>()};
+
+  auto& playerModel = result.mPlayerModelAtLevelStart;
+  const auto& serializedModel = json.at("playerModel");
+  playerModel.mSessionId = result.mSessionId;
+  for (const auto& id : serializedModel.at("tutorialMessagesAlreadySeen")) {
+    playerModel.mTutorialMessagesAlreadySeen.markAsShown(
+      id.get<data::TutorialMessageId>());
+  }
+  playerModel.mWeapon = serializedModel.at("weapon").get<data::WeaponType>();
+  playerModel.mAmmo = serializedModel.at("ammo").get<int>();
+  playerModel.mScore = serializedModel.at("score").get<int>();
+
+  const auto& positionOverride = json.at("playerPositionOverride");
+  if (!positionOverride.is_null()) {
+    result.mPlayerPositionOverride = base::Vector{
+      positionOverride.at(0).get<int>(),
+      positionOverride.at(1).get<int>()};
+  }
+
+  const auto& viewPortSize = json.at("viewPortSize");
+  result.mViewPortSize = base::Extents{
+    viewPortSize.at(0).get<int>(),
+    viewPortSize.at(1).get<int>()};
+
+  for (const auto& tick : json.at("ticks")) {
+    const auto bits = tick.get<int>();
+    result.mTicks.push_back(
+      RecordedTick{decodeInput(bits), (bits & TICK_ENDS_FRAME) != 0});
+  }
+
+  return result;
+}
+
+
+nlohmann::json serialize(const TickTimings& timings) {
+  auto stageTimes = nlohmann::json::object();
+  for (auto i = std::size_t{0}; i < NUM_UPDATE_STAGES; ++i) {
+    stageTimes[updateStageName(static_cast<UpdateStage>(i))] =
+      timings.mStageTimesMs[i];
+  }
+
+  return nlohmann::json{
+    {"tick", timings.mTickNumber},
+    {"timeMs", timings.mUpdateTimeMs},
+    {"stagesMs", stageTimes},
+    {"entities", timings.mNumEntities},
+    {"input", encodeInput(timings.mInput)}};
+}
+
+
+nlohmann::json serialize(const FrameTimings& timings) {
+  return nlohmann::json{
+    {"firstTick", timings.mFirstTickNumber},
+    {"numTicks", timings.mNumTicks},
+    {"deltaMs", timings.mFrameDeltaMs},
+    {"workTimeMs", timings.mWorkTimeMs}};
+}
+
+
+template <typename T>
+nlohmann::json serialize(const std::vector<T>& entries) {
+  auto serialized = nlohmann::json::array();
+  for (const auto& entry : entries) {
+    serialized.push_back(serialize(entry));
+  }
+
+  return serialized;
+}
+
+}
+
+
+template <typename T>
+HitchRecorder::History<T>::History(const std::size_t capacity)
+  : mCapacity(capacity)
+{
+  mEntries.reserve(capacity);
+}
+
+
+template <typename T>
+void HitchRecorder::History<T>::push(const T& entry) {
+  if (mEntries.size() < mCapacity) {
+    mEntries.push_back(entry);
+  } else {
+    mEntries[mNextIndex] = entry;
+  }
+
+  mNextIndex = (mNextIndex + 1) % mCapacity;
+}
+
+
+template <typename T>
+std::vector<T> HitchRecorder::History<T>::inChronologicalOrder() const {
+  if (mEntries.size() < mCapacity) {
+    return mEntries;
+  }
+
+  auto result = std::vector<T>{};
+  result.reserve(mEntries.size());
+  result.insert(
+    result.end(), mEntries.begin() + mNextIndex, mEntries.end());
+  result.insert(
+    result.end(), mEntries.begin(), mEntries.begin() + mNextIndex);
+  return result;
+}
+
+
+HitchRecorder::HitchRecorder(
+  const float thresholdMs,
+  std::filesystem::path outputDirectory
+)
+  : mThresholdMs(thresholdMs)
+  , mOutputDirectory(std::move(outputDirectory))
+  , mTickHistory(TICK_HISTORY_SIZE)
+  , mFrameHistory(FRAME_HISTORY_SIZE)
+{
+}
+
+
+void HitchRecorder::beginLevel(
+  const data::GameSessionId& sessionId,
+  const data::PlayerModel& playerModel,
+  const std::optional<base::Vector>& playerPositionOverride,
+  const base::Extents& viewPortSize
+) {
+  mReplayData.mSessionId = sessionId;
+  mReplayData.mPlayerModelAtLevelStart = data::SavedGame{
+    sessionId,
+    playerModel.tutorialMessages(),
+    "",
+    playerModel.weapon(),
+    playerModel.ammo(),
+    playerModel.score()};
+  mReplayData.mPlayerPositionOverride = playerPositionOverride;
+  mReplayData.mViewPortSize = viewPortSize;
+  mReplayData.mTicks.clear();
+
+  mFirstTickOfFrame = 0;
+  mLevelStarted = true;
+}
+
+
+void HitchRecorder::recordUpdate(
+  const PlayerInput& input,
+  const float updateTimeMs,
+  const UpdateStageTimings& stageTimesMs,
+  const std::uint32_t numEntities
+) {
+  if (!mLevelStarted) {
+    return;
+  }
+
+  const auto tickNumber =
+    static_cast<std::uint32_t>(mReplayData.mTicks.size());
+  mReplayData.mTicks.push_back(RecordedTick{input});
+  mTickHistory.push(
+    TickTimings{tickNumber, updateTimeMs, stageTimesMs, numEntities, input});
+
+  if (mUpdatesUntilNextReport > 0) {
+    --mUpdatesUntilNextReport;
+  }
+
+  checkForHitch(updateTimeMs, "update");
+}
+
+
+void HitchRecorder::recordFrame(
+  const float frameDeltaMs,
+  const float workTimeMs
+) {
+  if (!mLevelStarted) {
+    return;
+  }
+
+  const auto numTicks =
+    static_cast<std::uint32_t>(mReplayData.mTicks.size()) - mFirstTickOfFrame;
+  if (numTicks > 0) {
+    mReplayData.mTicks.back().mEndsFrame = true;
+  }
+
+  mFrameHistory.push(
+    FrameTimings{mFirstTickOfFrame, numTicks, frameDeltaMs, workTimeMs});
+  mFirstTickOfFrame = static_cast<std::uint32_t>(mReplayData.mTicks.size());
+
+  checkForHitch(workTimeMs, "frame");
+}
+
+
+void HitchRecorder::checkForHitch(
+  const float durationMs,
+  const char* pSource
+) {
+  if (durationMs > mThresholdMs && mUpdatesUntilNextReport == 0) {
+    writeReport(durationMs, pSource);
+    mUpdatesUntilNextReport = TICK_HISTORY_SIZE;
+  }
+}
+
+
+void HitchRecorder::writeReport(const float durationMs, const char* pSource) {
+  using namespace std::chrono;
+
+  nlohmann::json report;
+  report["version"] = REPORT_FORMAT_VERSION;
+  report["trigger"] = nlohmann::json{
+    {"source", pSource},
+    {"durationMs", durationMs},
+    {"thresholdMs", mThresholdMs}};
+  report["replay"] = serialize(mReplayData);
+  report["updates"] = serialize(mTickHistory.inChronologicalOrder());
+  report["frames"] = serialize(mFrameHistory.inChronologicalOrder());
+
+  const auto timeStamp =
+    duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+  const auto fileName = "hitch_" + std::to_string(timeStamp) + "_" +
+    std::to_string(mReplayData.mTicks.size()) + ".json";
+  const auto filePath = mOutputDirectory / fileName;
+
+  // Failing to write a report shouldn't take down the game
+  try {
+    std::filesystem::create_directories(mOutputDirectory);
+
+    const auto text = report.dump(2);
+    loader::saveToFile(loader::ByteBuffer(text.begin(), text.end()), filePath);
+    mWrittenReports.push_back(filePath);
+
+    std::cout << "Hitch of " << durationMs << " ms (" << pSource
+      << "), report written to " << filePath.u8string() << '\n';
+  } catch (const std::exception& error) {
+    std::cerr << "Failed to write hitch report: " << error.what() << '\n';
+  }
+}
+
+
+LevelReplayData loadHitchReplayData(const std::filesystem::path& reportFile) {
+  const auto report =
+    nlohmann::json::parse(loader::asText(loader::loadFile(reportFile)));
+
+  if (report.at("version").get<int>() != REPORT_FORMAT_VERSION) {
+    throw std::invalid_argument("Unsupported hitch report version");
+  }
+
+  return deserializeReplayData(report.at("replay"));
+}
+
+}
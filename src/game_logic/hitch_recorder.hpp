@@ -0,0 +1,169 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/spatial_types.hpp"
+#include "data/game_session_data.hpp"
+#include "data/saved_game.hpp"
+#include "game_logic/input.hpp"
+#include "game_logic/update_timings.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+namespace rigel::data { class PlayerModel; }
+
+
+namespace rigel::game_logic {
+
+/** Input for a single logic update, as needed for replaying it */
+struct RecordedTick {
+  PlayerInput mInput;
+
+  /** True if end-of-frame processing ran right after this update
+   *
+   * GameWorld::processEndOfFrameActions() handles things like player death
+   * and level exit. A replay has to run it at the same points as the
+   * original session to stay in sync.
+   */
+  bool mEndsFrame = false;
+};
+
+
+/** Everything needed to deterministically replay a level up to some point
+ *
+ * Levels always start out the same for a given session id and player model,
+ * so the recorded input since level start is enough to reproduce the exact
+ * state at any later point. The player model is stored in the same form as
+ * a saved game, since that's what carries over into a new level.
+ */
+struct LevelReplayData {
+  data::GameSessionId mSessionId;
+  data::SavedGame mPlayerModelAtLevelStart;
+  std::optional<base::Vector> mPlayerPositionOverride;
+  base::Extents mViewPortSize;
+  std::vector<RecordedTick> mTicks;
+};
+
+
+struct TickTimings {
+  std::uint32_t mTickNumber = 0;
+  float mUpdateTimeMs = 0.0f;
+  UpdateStageTimings mStageTimesMs{};
+  std::uint32_t mNumEntities = 0;
+  PlayerInput mInput;
+};
+
+
+struct FrameTimings {
+  std::uint32_t mFirstTickNumber = 0;
+  std::uint32_t mNumTicks = 0;
+  float mFrameDeltaMs = 0.0f;
+  float mWorkTimeMs = 0.0f;
+};
+
+
+/** Captures timing history, and writes it to a file when a hitch occurs
+ *
+ * Keeps the last few seconds of per-frame and per-update timings in memory,
+ * plus the input recorded since the start of the current level. Whenever a
+ * logic update or a frame takes longer than the configured threshold, all
+ * of that is written to a JSON report file in the output directory. The
+ * report can be loaded via loadHitchReplayData(), to replay the moments
+ * before the hitch.
+ *
+ * After writing a report, another one is only written once the history has
+ * been completely replaced, so that a sustained slowdown doesn't flood the
+ * output directory.
+ */
+class HitchRecorder {
+public:
+  // 5 seconds worth of history at 15 logic updates per second. Frames are
+  // kept for the same time span at up to 120 FPS.
+  static constexpr auto TICK_HISTORY_SIZE = std::size_t{75};
+  static constexpr auto FRAME_HISTORY_SIZE = std::size_t{600};
+
+  HitchRecorder(float thresholdMs, std::filesystem::path outputDirectory);
+
+  /** Start recording a new level
+   *
+   * Discards the input recorded so far. Updates are ignored until this has
+   * been called for the first time.
+   */
+  void beginLevel(
+    const data::GameSessionId& sessionId,
+    const data::PlayerModel& playerModel,
+    const std::optional<base::Vector>& playerPositionOverride,
+    const base::Extents& viewPortSize);
+
+  void recordUpdate(
+    const PlayerInput& input,
+    float updateTimeMs,
+    const UpdateStageTimings& stageTimesMs,
+    std::uint32_t numEntities);
+
+  /** Record end of frame, must be called after end-of-frame processing */
+  void recordFrame(float frameDeltaMs, float workTimeMs);
+
+  const LevelReplayData& replayData() const {
+    return mReplayData;
+  }
+
+  const std::vector<std::filesystem::path>& writtenReports() const {
+    return mWrittenReports;
+  }
+
+private:
+  template <typename T>
+  struct History {
+    explicit History(std::size_t capacity);
+
+    void push(const T& entry);
+    std::vector<T> inChronologicalOrder() const;
+
+    std::vector<T> mEntries;
+    std::size_t mCapacity;
+    std::size_t mNextIndex = 0;
+  };
+
+  void checkForHitch(float durationMs, const char* pSource);
+  void writeReport(float durationMs, const char* pSource);
+
+  float mThresholdMs;
+  std::filesystem::path mOutputDirectory;
+
+  LevelReplayData mReplayData;
+  History<TickTimings> mTickHistory;
+  History<FrameTimings> mFrameHistory;
+  std::uint32_t mFirstTickOfFrame = 0;
+  std::size_t mUpdatesUntilNextReport = 0;
+  bool mLevelStarted = false;
+  std::vector<std::filesystem::path> mWrittenReports;
+};
+
+
+/** Load replay data from a report written by HitchRecorder
+ *
+ * Throws an exception if the file can't be read, or is not a valid report.
+ */
+LevelReplayData loadHitchReplayData(const std::filesystem::path& reportFile);
+
+}
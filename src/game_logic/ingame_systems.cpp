@@ -24,9 +24,11 @@
 #include "game_logic/interactive/force_field.hpp"
 #include "renderer/upscaling_utils.hpp"
 
+#include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <utility>
 
 namespace rigel::game_logic {
 
@@ -60,7 +62,7 @@ IngameSystems::IngameSystems(
   renderer::Renderer* pRenderer,
   entityx::EntityManager& entities,
   entityx::EventManager& eventManager,
-  const loader::ResourceLoader& resources
+  data::LevelHints levelHints
 )
   : mPlayer(
       playerEntity,
@@ -72,6 +74,7 @@ IngameSystems::IngameSystems(
       pEntityFactory,
       &eventManager,
       pRandomGenerator)
+  , mPlayerContext(&mPlayer)
   , mCamera(&mPlayer, *pMap, eventManager)
   , mParticles(pRandomGenerator, pRenderer)
   , mRenderingSystem(
@@ -88,7 +91,7 @@ IngameSystems::IngameSystems(
       pServiceProvider,
       pEntityFactory,
       &eventManager,
-      resources)
+      std::move(levelHints))
   , mPlayerDamageSystem(&mPlayer)
   , mPlayerProjectileSystem(
       pEntityFactory,
@@ -118,17 +121,18 @@ IngameSystems::IngameSystems(
   , mItemContainerSystem(&entities, pCollisionChecker, eventManager)
   , mBlueGuardSystem(
       &mPlayer,
+      &mPlayerContext,
       const_cast<engine::CollisionChecker*>(pCollisionChecker),
       pEntityFactory,
       pServiceProvider,
       pRandomGenerator,
       eventManager)
   , mHoverBotSystem(
-      playerEntity,
+      &mPlayerContext,
       const_cast<engine::CollisionChecker*>(pCollisionChecker),
       pEntityFactory)
   , mLaserTurretSystem(
-      playerEntity,
+      &mPlayerContext,
       pPlayerModel,
       pEntityFactory,
       pRandomGenerator,
@@ -142,19 +146,20 @@ IngameSystems::IngameSystems(
       &mParticles,
       pRandomGenerator,
       eventManager)
-  , mRocketTurretSystem(playerEntity, pEntityFactory, pServiceProvider)
+  , mRocketTurretSystem(&mPlayerContext, pEntityFactory, pServiceProvider)
   , mSimpleWalkerSystem(
-      playerEntity,
+      &mPlayerContext,
       const_cast<engine::CollisionChecker*>(pCollisionChecker))
   , mSlidingDoorSystem(playerEntity, pServiceProvider)
   , mSlimeBlobSystem(
-      &mPlayer,
+      &mPlayerContext,
       const_cast<engine::CollisionChecker*>(pCollisionChecker),
       pEntityFactory,
       pRandomGenerator,
       eventManager)
   , mSpiderSystem(
       &mPlayer,
+      &mPlayerContext,
       const_cast<engine::CollisionChecker*>(pCollisionChecker),
       pRandomGenerator,
       pEntityFactory,
@@ -170,6 +175,7 @@ IngameSystems::IngameSystems(
         &entities,
         &eventManager},
       &mPlayer,
+      &mPlayerContext,
       &mCamera.position(),
       pMap)
   , mpRandomGenerator(pRandomGenerator)
@@ -188,12 +194,23 @@ void IngameSystems::update(
   entityx::EntityManager& es,
   const base::Extents& viewPortSize
 ) {
+  using Clock = std::chrono::high_resolution_clock;
+
+  auto stageStart = Clock::now();
+  const auto finishStage = [&](const UpdateStage stage) {
+    const auto now = Clock::now();
+    mLastUpdateTimings[static_cast<std::size_t>(stage)] =
+      std::chrono::duration<float, std::milli>(now - stageStart).count();
+    stageStart = now;
+  };
+
   // ----------------------------------------------------------------------
   // Animation update
   // ----------------------------------------------------------------------
   mRenderingSystem.updateAnimatedMapTiles();
   engine::updateAnimatedSprites(es);
   interaction::animateForceFields(es, *mpRandomGenerator, *mpServiceProvider);
+  finishStage(UpdateStage::Animation);
 
   // ----------------------------------------------------------------------
   // Player update, camera, mark active entities
@@ -203,16 +220,19 @@ void IngameSystems::update(
   mPlayer.update(input);
   mCamera.update(input, viewPortSize);
   engine::markActiveEntities(es, mCamera.position(), viewPortSize);
+  finishStage(UpdateStage::Player);
 
   // ----------------------------------------------------------------------
   // Player related logic update
   // ----------------------------------------------------------------------
   mElevatorSystem.update(es);
   mRadarComputerSystem.update(es);
+  finishStage(UpdateStage::PlayerRelatedLogic);
 
   // ----------------------------------------------------------------------
   // A.I. logic update
   // ----------------------------------------------------------------------
+  mPlayerContext.update();
   mBlueGuardSystem.update(es);
   mHoverBotSystem.update(es);
   mLaserTurretSystem.update(es);
@@ -225,6 +245,7 @@ void IngameSystems::update(
   mSpiderSystem.update(es);
   mSpikeBallSystem.update(es);
   mBehaviorControllerSystem.update(es, input, viewPortSize);
+  finishStage(UpdateStage::Ai);
 
   // ----------------------------------------------------------------------
   // Physics and other updates
@@ -249,6 +270,9 @@ void IngameSystems::update(
   mPhysicsSystem.updatePhase2(es);
 
   mParticles.update();
+
+  mRenderingSystem.invalidateSpriteBounds();
+  finishStage(UpdateStage::PhysicsAndOther);
 }
 
 
@@ -265,7 +289,13 @@ void IngameSystems::render(
     const auto saved = renderer::setupDefaultState(mpRenderer);
 
     mpRenderer->clear({0, 0, 0, 0});
-    mParticles.render(mCamera.position());
+
+    {
+      const auto phase = renderer::beginRenderPhase(
+        mpRenderer, renderer::RenderPhase::Particles);
+      mParticles.render(mCamera.position());
+    }
+
     mDebuggingSystem.update(es, viewPortSize);
   }
 
@@ -288,6 +318,7 @@ void IngameSystems::restartFromCheckpoint(
 ) {
   mPlayer.position() = checkpointPosition;
   mPlayer.resetAfterRespawn();
+  mRenderingSystem.invalidateSpriteBounds();
 }
 
 
@@ -300,6 +331,13 @@ void IngameSystems::printDebugText(std::ostream& stream) const {
   stream
     << "Scroll: " << vec2String(mCamera.position(), 4) << '\n'
     << "Player: " << vec2String(mPlayer.position(), 4) << '\n';
+
+  const auto& spriteStats = mRenderingSystem.spriteStatistics();
+  stream
+    << "Sprites: " << spriteStats.mIndexed
+    << ", collected: " << spriteStats.mCollected
+    << ", sorted: " << spriteStats.mSorted
+    << ", drawn: " << spriteStats.mDrawn << '\n';
 }
 
 }
@@ -46,6 +46,8 @@
 #include "game_logic/player/damage_system.hpp"
 #include "game_logic/player/interaction_system.hpp"
 #include "game_logic/player/projectile_system.hpp"
+#include "game_logic/player_context.hpp"
+#include "game_logic/update_timings.hpp"
 
 #include <iosfwd>
 
@@ -57,7 +59,6 @@ namespace game_logic {
   class EntityFactory;
   class RadarDishCounter;
 }
-namespace loader { class ResourceLoader; }
 
 }
 
@@ -82,7 +83,7 @@ public:
     renderer::Renderer* pRenderer,
     entityx::EntityManager& entities,
     entityx::EventManager& eventManager,
-    const loader::ResourceLoader& resources);
+    data::LevelHints levelHints);
 
   void update(
     const PlayerInput& inputState,
@@ -108,10 +109,16 @@ public:
     return mPlayer;
   }
 
+  /** Time spent in each stage during the most recent update() */
+  const UpdateStageTimings& lastUpdateTimings() const {
+    return mLastUpdateTimings;
+  }
+
   void printDebugText(std::ostream& stream) const;
 
 private:
   Player mPlayer;
+  PlayerContext mPlayerContext;
   Camera mCamera;
 
   engine::ParticleSystem mParticles;
@@ -151,6 +158,7 @@ private:
   IGameServiceProvider* mpServiceProvider;
   renderer::Renderer* mpRenderer;
   renderer::RenderTargetTexture mLowResLayer;
+  UpdateStageTimings mLastUpdateTimings{};
 };
 
 }
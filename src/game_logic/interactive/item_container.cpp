@@ -45,13 +45,13 @@ constexpr int ITEM_BOUNCE_SEQUENCE[] = {-3, -2, -1, 0, 1, 2, 3, -1, 1};
 
 
 struct ItemBounceEffect {
-  explicit ItemBounceEffect(const float fallVelocity)
+  explicit ItemBounceEffect(const engine::MotionValue fallVelocity)
     : mFallVelocity(fallVelocity)
   {
   }
 
   int mFramesElapsed = 1;
-  float mFallVelocity = 0.0f;
+  engine::MotionValue mFallVelocity = 0;
 };
 
 }
@@ -236,7 +236,7 @@ void NapalmBomb::update(
 void NapalmBomb::onKilled(
   GlobalDependencies& d,
   GlobalState&,
-  const base::Point<float>&,
+  const engine::Velocity&,
   entityx::Entity entity
 ) {
   explode(d, entity);
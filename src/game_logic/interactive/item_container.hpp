@@ -18,6 +18,7 @@
 
 #include "base/warnings.hpp"
 #include "base/spatial_types.hpp"
+#include "engine/physical_components.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
@@ -131,7 +132,7 @@ public:
   void onKilled(
     GlobalDependencies& dependencies,
     GlobalState& state,
-    const base::Point<float>& inflictorVelocity,
+    const engine::Velocity& inflictorVelocity,
     entityx::Entity entity);
 
   enum class State {
@@ -138,7 +138,7 @@ void Missile::update(
 void Missile::onKilled(
   GlobalDependencies& d,
   GlobalState& state,
-  const base::Point<float>& inflictorVelocity,
+  const engine::Velocity& inflictorVelocity,
   entityx::Entity entity
 ) {
   if (!mIsActive) {
@@ -190,7 +190,7 @@ void BrokenMissile::update(
 void BrokenMissile::onKilled(
   GlobalDependencies& d,
   GlobalState& state,
-  const base::Point<float>& inflictorVelocity,
+  const engine::Velocity& inflictorVelocity,
   entityx::Entity entity
 ) {
   if (!mIsActive) {
@@ -28,6 +28,7 @@
 #include "game_logic/damage_components.hpp"
 #include "game_logic/entity_factory.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/player_context.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -131,6 +132,8 @@ void SuperForceField::update(
       if (playerPos.x + 2 > position.x) {
         ++playerPos.x;
       }
+
+      s.mpPlayerContext->update();
     }
   }
 }
@@ -139,7 +142,7 @@ void SuperForceField::update(
 void SuperForceField::onHit(
   GlobalDependencies& d,
   GlobalState& s,
-  const base::Point<float>& inflictorVelocity,
+  const engine::Velocity& inflictorVelocity,
   entityx::Entity entity
 ) {
   using game_logic::components::Shootable;
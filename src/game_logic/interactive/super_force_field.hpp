@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "engine/physical_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 
 #include <optional>
@@ -33,7 +34,7 @@ struct SuperForceField {
   void onHit(
     GlobalDependencies& dependencies,
     GlobalState& state,
-    const base::Point<float>& inflictorVelocity,
+    const engine::Velocity& inflictorVelocity,
     entityx::Entity entity);
 
   void startFizzle();
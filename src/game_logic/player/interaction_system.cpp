@@ -28,8 +28,8 @@
 #include "game_logic/interactive/force_field.hpp"
 #include "game_logic/interactive/locked_door.hpp"
 #include "game_logic/player.hpp"
-#include "loader/duke_script_loader.hpp"
-#include "loader/resource_loader.hpp"
+
+#include <utility>
 
 
 namespace rigel::game_logic {
@@ -140,12 +140,6 @@ std::optional<base::Vector> findTeleporterTargetPosition(
   return targetTeleporterPosition + PLAYER_TO_TELEPORTER_OFFSET;
 }
 
-
-data::LevelHints loadHints(const loader::ResourceLoader& resources) {
-  const auto text = resources.fileAsText("HELP.MNI");
-  return loader::loadHintMessages(text);
-}
-
 }
 
 
@@ -156,14 +150,14 @@ PlayerInteractionSystem::PlayerInteractionSystem(
   IGameServiceProvider* pServices,
   EntityFactory* pEntityFactory,
   entityx::EventManager* pEvents,
-  const loader::ResourceLoader& resources
+  data::LevelHints levelHints
 )
   : mpPlayer(pPlayer)
   , mpPlayerModel(pPlayerModel)
   , mpServiceProvider(pServices)
   , mpEntityFactory(pEntityFactory)
   , mpEvents(pEvents)
-  , mLevelHints(loadHints(resources))
+  , mLevelHints(std::move(levelHints))
   , mSessionId(sessionId)
 {
   mpEvents->subscribe<rigel::events::CloakExpired>(*this);
@@ -252,6 +246,12 @@ void PlayerInteractionSystem::updateItemCollection(entityx::EntityManager& es) {
 
       auto playerBBox = mpPlayer->worldSpaceHitBox();
       if (worldSpaceBbox.intersects(playerBBox)) {
+        // Leave items in the world while there's no room for them, so that
+        // they can still be picked up once the inventory has space again
+        if (collectable.mGivenItem && mpPlayerModel->isInventoryFull()) {
+          return;
+        }
+
         std::optional<data::SoundId> soundToPlay;
 
         const auto playerAtFullHealth = mpPlayerModel->isAtFullHealth();
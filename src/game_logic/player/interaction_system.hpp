@@ -45,10 +45,6 @@ namespace rigel {
   namespace game_logic {
     class EntityFactory;
   }
-
-  namespace loader {
-    class ResourceLoader;
-  }
 }
 
 
@@ -67,7 +63,7 @@ public:
     IGameServiceProvider* pServices,
     EntityFactory* pEntityFactory,
     entityx::EventManager* pEvents,
-    const loader::ResourceLoader& resources);
+    data::LevelHints levelHints);
 
   void updatePlayerInteraction(
     const PlayerInput& input,
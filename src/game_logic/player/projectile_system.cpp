@@ -41,8 +41,8 @@ void deactivateProjectile(entityx::Entity entity) {
 }
 
 
-base::Vector regularShotDebrisOffset(const base::Point<float>& velocity) {
-  const auto isHorizontal = velocity.x != 0.0f;
+base::Vector regularShotDebrisOffset(const engine::Velocity& velocity) {
+  const auto isHorizontal = velocity.x != 0;
   return {isHorizontal ? 0 : -1, 1};
 }
 
@@ -50,17 +50,17 @@ base::Vector regularShotDebrisOffset(const base::Point<float>& velocity) {
 void spawnRegularShotImpactEffect(
   EntityFactory& entityFactory,
   const base::Vector& position,
-  const base::Point<float> velocity
+  const engine::Velocity velocity
 ) {
   const auto debrisPosition = position + regularShotDebrisOffset(velocity);
   spawnFloatingOneShotSprite(entityFactory, data::ActorID::Shot_impact_FX, debrisPosition);
 }
 
 
-base::Vector rocketSmokeOffset(const base::Point<float>& velocity) {
-  const auto isFacingOpposite = velocity.x < 0.0f || velocity.y > 0.0f;
+base::Vector rocketSmokeOffset(const engine::Velocity& velocity) {
+  const auto isFacingOpposite = velocity.x < 0 || velocity.y > 0;
   if (isFacingOpposite) {
-    const auto isHorizontal = velocity.x != 0.0f;
+    const auto isHorizontal = velocity.x != 0;
     if (isHorizontal) {
       return {3, 0};
     } else {
@@ -75,15 +75,15 @@ base::Vector rocketSmokeOffset(const base::Point<float>& velocity) {
 void generateRocketSmoke(
   EntityFactory& entityFactory,
   const base::Vector& position,
-  const base::Point<float> velocity
+  const engine::Velocity velocity
 ) {
   const auto offset = rocketSmokeOffset(velocity);
   spawnOneShotSprite(entityFactory, data::ActorID::Smoke_puff_FX, position + offset);
 }
 
 
-base::Vector rocketWallImpactOffset(const base::Point<float>& velocity) {
-  const auto isHorizontal = velocity.x != 0.0f;
+base::Vector rocketWallImpactOffset(const engine::Velocity& velocity) {
+  const auto isHorizontal = velocity.x != 0;
   if (isHorizontal) {
     return {-1, 2};
   } else {
@@ -96,7 +96,7 @@ void spawnRocketWallImpactEffect(
   EntityFactory& entityFactory,
   const base::Vector& position,
   const engine::components::BoundingBox& bbox,
-  const base::Point<float> velocity
+  const engine::Velocity velocity
 ) {
   const auto offset = rocketWallImpactOffset(velocity);
   spawnOneShotSprite(
@@ -216,7 +216,7 @@ void ProjectileSystem::update(entityx::EntityManager& es) {
 void ProjectileSystem::spawnWallImpactEffect(
   entityx::Entity entity,
   const base::Vector& position,
-  const base::Point<float>& velocity,
+  const engine::Velocity& velocity,
   const bool isRocket
 ) {
   const auto& bbox = *entity.component<engine::components::BoundingBox>();
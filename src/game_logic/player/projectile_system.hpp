@@ -18,6 +18,7 @@
 
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
+#include "engine/physical_components.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
@@ -46,7 +47,7 @@ private:
   void spawnWallImpactEffect(
     entityx::Entity entity,
     const base::Vector& position,
-    const base::Point<float>& velocity,
+    const engine::Velocity& velocity,
     bool isRocket);
   bool isCollidingWithWorld(const base::Rect<int>& bbox);
 
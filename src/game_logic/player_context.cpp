@@ -0,0 +1,47 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "player_context.hpp"
+
+#include "game_logic/player.hpp"
+
+
+namespace rigel::game_logic {
+
+PlayerContext::PlayerContext(const Player* pPlayer)
+  : mpPlayer(pPlayer)
+{
+  update();
+}
+
+
+void PlayerContext::update() {
+  mPosition = mpPlayer->position();
+  mOrientedPosition = mpPlayer->orientedPosition();
+  mOrientation = mpPlayer->orientation();
+  mWorldSpaceHitBox = mpPlayer->worldSpaceHitBox();
+  mIsCloaked = mpPlayer->isCloaked();
+  mIsCrouching = mpPlayer->isCrouching();
+}
+
+
+bool PlayerContext::isTouching(
+  const engine::components::BoundingBox& worldSpaceBounds
+) const {
+  return mWorldSpaceHitBox.intersects(worldSpaceBounds);
+}
+
+}
@@ -0,0 +1,86 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/spatial_types.hpp"
+#include "engine/base_components.hpp"
+
+
+namespace rigel::game_logic {
+
+class Player;
+
+
+/** Player state shared by all enemy A.I. code during one update
+ *
+ * Enemies frequently need to know where the player is, which way they are
+ * facing, or whether they are touching the player. Instead of each enemy
+ * deriving this from the Player on its own, it's computed once per update,
+ * right before the A.I. logic runs, i.e. after the player, camera and
+ * elevators have been updated.
+ *
+ * Only state which doesn't change as a side-effect of enemies interacting
+ * with the player is provided here. Things like isDead() can change when an
+ * enemy damages the player, so code depending on that needs to ask the
+ * Player directly. Code which moves the player needs to call update()
+ * afterwards.
+ */
+class PlayerContext {
+public:
+  explicit PlayerContext(const Player* pPlayer);
+
+  void update();
+
+  const base::Vector& position() const {
+    return mPosition;
+  }
+
+  const base::Vector& orientedPosition() const {
+    return mOrientedPosition;
+  }
+
+  engine::components::Orientation orientation() const {
+    return mOrientation;
+  }
+
+  const engine::components::BoundingBox& worldSpaceHitBox() const {
+    return mWorldSpaceHitBox;
+  }
+
+  bool isCloaked() const {
+    return mIsCloaked;
+  }
+
+  bool isCrouching() const {
+    return mIsCrouching;
+  }
+
+  bool isTouching(
+    const engine::components::BoundingBox& worldSpaceBounds) const;
+
+private:
+  const Player* mpPlayer;
+
+  base::Vector mPosition;
+  base::Vector mOrientedPosition;
+  engine::components::BoundingBox mWorldSpaceHitBox;
+  engine::components::Orientation mOrientation;
+  bool mIsCloaked;
+  bool mIsCrouching;
+};
+
+}
@@ -0,0 +1,62 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+
+namespace rigel::game_logic {
+
+/** Phases of a logic update, see IngameSystems::update() */
+enum class UpdateStage {
+  Animation,
+  Player,
+  PlayerRelatedLogic,
+  Ai,
+  PhysicsAndOther
+};
+
+constexpr auto NUM_UPDATE_STAGES = std::size_t{5};
+
+
+/** Time in milliseconds spent in each UpdateStage during one logic update */
+using UpdateStageTimings = std::array<float, NUM_UPDATE_STAGES>;
+
+
+constexpr const char* updateStageName(const UpdateStage stage) {
+  switch (stage) {
+    case UpdateStage::Animation:
+      return "animation";
+
+    case UpdateStage::Player:
+      return "player";
+
+    case UpdateStage::PlayerRelatedLogic:
+      return "playerRelatedLogic";
+
+    case UpdateStage::Ai:
+      return "ai";
+
+    case UpdateStage::PhysicsAndOther:
+      return "physicsAndOther";
+  }
+
+  return "";
+}
+
+}
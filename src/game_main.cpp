@@ -19,9 +19,11 @@
 
 #include "base/defer.hpp"
 #include "base/math_tools.hpp"
+#include "common/startup_timeline.hpp"
 #include "data/duke_script.hpp"
 #include "data/game_traits.hpp"
 #include "engine/timing.hpp"
+#include "game_logic/hitch_recorder.hpp"
 #include "loader/duke_script_loader.hpp"
 #include "renderer/opengl.hpp"
 #include "renderer/upscaling_utils.hpp"
@@ -33,6 +35,7 @@
 #include "game_session_mode.hpp"
 #include "intro_demo_loop_mode.hpp"
 #include "menu_mode.hpp"
+#include "performance_comparison_mode.hpp"
 #include "platform.hpp"
 
 RIGEL_DISABLE_WARNINGS
@@ -44,8 +47,12 @@ RIGEL_RESTORE_WARNINGS
 #include <Windows.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <ctime>
 #include <filesystem>
+#include <iostream>
 
 
 namespace rigel {
@@ -57,6 +64,39 @@ using RenderTargetBinder = renderer::RenderTargetTexture::Binder;
 
 namespace {
 
+// Frame rate used while the window is inactive and the background mode is
+// set to LowRefreshRate. Game logic keeps running at its normal rate, since
+// it's decoupled from the frame rate. Not used on the web, see
+// Game::resetFpsLimiter().
+#ifndef __EMSCRIPTEN__
+constexpr auto BACKGROUND_FPS = 10;
+#endif
+
+
+/** Returns CPU time consumed by the process so far, in seconds */
+double processCpuTime() {
+#ifdef _WIN32
+  // On Windows, std::clock() measures wall time instead of CPU time
+  FILETIME creationTime, exitTime, kernelTime, userTime;
+  if (!GetProcessTimes(
+    GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+  {
+    return 0.0;
+  }
+
+  const auto toTicks = [](const FILETIME& time) {
+    return (static_cast<std::uint64_t>(time.dwHighDateTime) << 32) |
+      time.dwLowDateTime;
+  };
+
+  // FILETIME is in units of 100 ns
+  return (toTicks(kernelTime) + toTicks(userTime)) / 10'000'000.0;
+#else
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+
 auto wrapWithInitialFadeIn(std::unique_ptr<GameMode> mode) {
   class InitialFadeInWrapper : public GameMode {
   public:
@@ -80,18 +120,49 @@ auto wrapWithInitialFadeIn(std::unique_ptr<GameMode> mode) {
 }
 
 
+const char* const SCRIPT_FILES[] = {"TEXT.MNI", "OPTIONS.MNI", "ORDERTXT.MNI"};
+const auto UI_SPRITE_SHEET_FILE = "STATUS.MNI";
+
+
 auto loadScripts(const loader::ResourceLoader& resources) {
-  auto allScripts = resources.loadScriptBundle("TEXT.MNI");
-  const auto optionsScripts = resources.loadScriptBundle("OPTIONS.MNI");
-  const auto orderInfoScripts = resources.loadScriptBundle("ORDERTXT.MNI");
+  auto allScripts = loader::ScriptBundle{};
 
-  allScripts.insert(std::begin(optionsScripts), std::end(optionsScripts));
-  allScripts.insert(std::begin(orderInfoScripts), std::end(orderInfoScripts));
+  // Earlier files take priority in case of duplicate script names
+  for (const auto fileName : SCRIPT_FILES) {
+    const auto scripts = resources.loadScriptBundle(fileName);
+    allScripts.insert(std::begin(scripts), std::end(scripts));
+  }
 
   return allScripts;
 }
 
 
+auto loadUiSpriteSheet(
+  renderer::Renderer* pRenderer,
+  const loader::ResourceLoader& resources
+) {
+  return engine::TiledTexture{
+    renderer::OwningTexture{
+      pRenderer,
+      resources.loadTiledFullscreenImage(UI_SPRITE_SHEET_FILE),
+      renderer::TextureCategory::Ui},
+    pRenderer};
+}
+
+
+bool detectShareWareVersion(const loader::ResourceLoader& resources) {
+  // The registered version has 24 additional level files, and a
+  // "anti-piracy" image (LCR.MNI). But we don't check for the presence of
+  // all of these files, as that would be fairly tedious. Instead, we just
+  // check for the presence of one of the registered version's levels, and
+  // the anti-piracy screen, and assume that we're dealing with a
+  // registered version data set if these two are present.
+  const auto hasRegisteredVersionFiles =
+    resources.hasFile("LCR.MNI") && resources.hasFile("O1.MNI");
+  return !hasRegisteredVersionFiles;
+}
+
+
 [[nodiscard]] auto setupSimpleUpscaling(renderer::Renderer* pRenderer) {
   auto saved = renderer::Renderer::StateSaver{pRenderer};
 
@@ -110,7 +181,23 @@ std::unique_ptr<GameMode> createInitialGameMode(
   const CommandLineOptions& commandLineOptions,
   const bool isShareWareVersion)
 {
-  if (commandLineOptions.mLevelToJumpTo)
+  if (!commandLineOptions.mHitchReportToReplay.empty())
+  {
+    auto replayData = game_logic::loadHitchReplayData(
+      std::filesystem::u8path(commandLineOptions.mHitchReportToReplay));
+
+    if (!commandLineOptions.mComparisonOptionOverrides.empty()) {
+      return std::make_unique<PerformanceComparisonMode>(
+        replayData,
+        withOptionOverrides(
+          context.mpUserProfile->mOptions,
+          commandLineOptions.mComparisonOptionOverrides),
+        context);
+    }
+
+    return std::make_unique<GameSessionMode>(replayData, context);
+  }
+  else if (commandLineOptions.mLevelToJumpTo)
   {
     return std::make_unique<GameSessionMode>(
       *commandLineOptions.mLevelToJumpTo,
@@ -224,10 +311,14 @@ for more info.)");
 void initAndRunGame(
   SDL_Window* pWindow,
   UserProfile& userProfile,
-  const CommandLineOptions& commandLineOptions
+  const CommandLineOptions& commandLineOptions,
+  StartupTimeline& startupTimeline
 ) {
-  auto run = [&](const CommandLineOptions& options) {
-    Game game(options, &userProfile, pWindow);
+  auto run = [&](
+    const CommandLineOptions& options,
+    StartupTimeline* pStartupTimeline
+  ) {
+    Game game(options, &userProfile, pWindow, pStartupTimeline);
 
     for (;;) {
       auto maybeStopReason = game.runOneFrame();
@@ -239,14 +330,15 @@ void initAndRunGame(
 
   if (!userProfile.mGamePath) {
     setupForFirstLaunch(pWindow, userProfile, commandLineOptions.mGamePath);
+    startupTimeline.completePhase("First launch setup");
   }
 
-  auto result = run(commandLineOptions);
+  auto result = run(commandLineOptions, &startupTimeline);
 
-  // Some game option changes (like choosing a new game path) require
-  // restarting the game to make the change effective. If the first game run
-  // ended with a result of RestartNeeded, launch a new game, but start from
-  // the main menu and discard most command line options.
+  // A new game path is normally applied in place, but if that fails, the
+  // game falls back to restarting itself to make the change effective. If
+  // the first game run ended with a result of RestartNeeded, launch a new
+  // game, but start from the main menu and discard most command line options.
   if (result == Game::StopReason::RestartNeeded) {
     auto optionsForRestartedGame = CommandLineOptions{};
     optionsForRestartedGame.mSkipIntro = true;
@@ -254,7 +346,7 @@ void initAndRunGame(
       commandLineOptions.mDebugModeEnabled;
 
     while (result == Game::StopReason::RestartNeeded) {
-      result = run(optionsForRestartedGame);
+      result = run(optionsForRestartedGame, nullptr);
     }
   }
 
@@ -268,6 +360,8 @@ void initAndRunGame(
 void gameMain(const CommandLineOptions& options) {
   using base::defer;
 
+  StartupTimeline startupTimeline;
+
 #ifdef _WIN32
   SDL_setenv("SDL_AUDIODRIVER", "directsound", true);
   SetProcessDPIAware();
@@ -279,14 +373,18 @@ void gameMain(const CommandLineOptions& options) {
 
   sdl_utils::check(SDL_GL_LoadLibrary(nullptr));
   platform::setGLAttributes();
+  startupTimeline.completePhase("SDL init");
 
   auto userProfile = loadOrCreateUserProfile();
+  startupTimeline.completePhase("User profile");
+
   auto pWindow = platform::createWindow(userProfile.mOptions);
   SDL_GLContext pGlContext =
     sdl_utils::check(SDL_GL_CreateContext(pWindow.get()));
   auto glGuard = defer([pGlContext]() { SDL_GL_DeleteContext(pGlContext); });
 
   renderer::loadGlFunctions();
+  startupTimeline.completePhase("Window and OpenGL context");
 
   SDL_DisableScreenSaver();
   SDL_ShowCursor(SDL_DISABLE);
@@ -294,9 +392,10 @@ void gameMain(const CommandLineOptions& options) {
   ui::imgui_integration::init(
     pWindow.get(), pGlContext, createOrGetPreferencesPath());
   auto imGuiGuard = defer([]() { ui::imgui_integration::shutdown(); });
+  startupTimeline.completePhase("ImGui init");
 
   try {
-    initAndRunGame(pWindow.get(), userProfile, options);
+    initAndRunGame(pWindow.get(), userProfile, options, startupTimeline);
   } catch (const std::exception& error) {
     ui::showErrorMessage(pWindow.get(), error.what());
   }
@@ -314,7 +413,7 @@ std::unique_ptr<Game, GameDeleter> createGame(
   const CommandLineOptions& commandLineOptions
 ) {
   return std::unique_ptr<Game, GameDeleter>(
-    new Game{commandLineOptions, pUserProfile, pWindow});
+    new Game{commandLineOptions, pUserProfile, pWindow, nullptr});
 }
 
 
@@ -348,25 +447,59 @@ void FpsLimiter::updateAndWait() {
 }
 
 
+CpuUsageMeter::CpuUsageMeter()
+  : mLastWallTime(std::chrono::high_resolution_clock::now())
+  , mLastCpuTime(processCpuTime())
+{
+}
+
+
+void CpuUsageMeter::switchTo(const State newState) {
+  using namespace std::chrono;
+
+  const auto now = high_resolution_clock::now();
+  const auto cpuTime = processCpuTime();
+
+  auto& totals = mTotalsByState[static_cast<std::size_t>(mCurrentState)];
+  totals.mWallTime += duration<double>(now - mLastWallTime).count();
+  totals.mCpuTime += cpuTime - mLastCpuTime;
+
+  mLastWallTime = now;
+  mLastCpuTime = cpuTime;
+  mCurrentState = newState;
+}
+
+
+ui::CpuUsageReport CpuUsageMeter::report() const {
+  const auto usageFor = [this](const State state) {
+    const auto& totals = mTotalsByState[static_cast<std::size_t>(state)];
+    return totals.mWallTime > 0.0
+      ? static_cast<float>(100.0 * totals.mCpuTime / totals.mWallTime)
+      : 0.0f;
+  };
+
+  return {
+    usageFor(State::Foreground),
+    usageFor(State::BackgroundLowRefreshRate),
+    usageFor(State::BackgroundPaused)};
+}
+
+
 Game::Game(
   const CommandLineOptions& commandLineOptions,
   UserProfile* pUserProfile,
-  SDL_Window* pWindow
+  SDL_Window* pWindow,
+  StartupTimeline* pStartupTimeline
 )
   : mpWindow(pWindow)
-  , mRenderer(pWindow)
-  , mResources(effectiveGamePath(commandLineOptions, *pUserProfile))
-  , mIsShareWareVersion([this]() {
-      // The registered version has 24 additional level files, and a
-      // "anti-piracy" image (LCR.MNI). But we don't check for the presence of
-      // all of these files, as that would be fairly tedious. Instead, we just
-      // check for the presence of one of the registered version's levels, and
-      // the anti-piracy screen, and assume that we're dealing with a
-      // registered version data set if these two are present.
-      const auto hasRegisteredVersionFiles =
-        mResources.hasFile("LCR.MNI") && mResources.hasFile("O1.MNI");
-      return !hasRegisteredVersionFiles;
-    }())
+  , mRenderer(measureStartupPhase(pStartupTimeline, "Renderer and shaders",
+      [&]() { return renderer::Renderer{pWindow}; }))
+  , mResources(measureStartupPhase(pStartupTimeline, "Opening game data",
+      [&]() {
+        return loader::ResourceLoader{
+          effectiveGamePath(commandLineOptions, *pUserProfile)};
+      }))
+  , mIsShareWareVersion(detectShareWareVersion(mResources))
   , mFpsLimiter(createLimiter(pUserProfile->mOptions))
   , mRenderTarget(
       &mRenderer,
@@ -374,29 +507,63 @@ Game::Game(
       mRenderer.maxWindowSize().height)
   , mIsRunning(true)
   , mIsMinimized(false)
+  , mHasFocus(true)
+  , mIsHidden(false)
+  , mWasInBackground(false)
   , mCommandLineOptions(commandLineOptions)
   , mpUserProfile(pUserProfile)
+  , mpStartupTimeline(pStartupTimeline)
   , mScriptRunner(&mResources, &mRenderer, &mpUserProfile->mSaveSlots, this)
-  , mAllScripts(loadScripts(mResources))
-  , mUiSpriteSheet(
-      renderer::OwningTexture{
-        &mRenderer, mResources.loadTiledFullscreenImage("STATUS.MNI")},
-      &mRenderer)
-  , mTextRenderer(&mUiSpriteSheet, &mRenderer, mResources)
+  , mAllScripts(measureStartupPhase(pStartupTimeline, "Scripts",
+      [this]() { return loadScripts(mResources); }))
+  , mUiSpriteSheet(measureStartupPhase(pStartupTimeline, "UI sprite sheet",
+      [this]() { return loadUiSpriteSheet(&mRenderer, mResources); }))
+  , mTextRenderer(measureStartupPhase(pStartupTimeline, "Menu text renderer",
+      [this]() {
+        return ui::MenuElementRenderer{
+          &mUiSpriteSheet, &mRenderer, mResources};
+      }))
 {
+  // Textures created above are already accounted for, so they count against
+  // the budget even though they were created before setting it.
+  if (commandLineOptions.mTextureMemoryBudgetMb) {
+    mRenderer.setTextureMemoryBudget(
+      *commandLineOptions.mTextureMemoryBudgetMb * 1024 * 1024,
+      commandLineOptions.mRejectTexturesOverBudget
+        ? renderer::TextureBudgetPolicy::Reject
+        : renderer::TextureBudgetPolicy::Log);
+  }
+
   mRenderer.clear();
   mRenderer.swapBuffers();
 
-  data::forEachSoundId([this](const auto id) {
-    mSoundsById.emplace_back(mSoundSystem.addSound(mResources.loadSound(id)));
+  measureStartupPhase(pStartupTimeline, "Sounds", [this]() {
+    data::forEachSoundId([this](const auto id) {
+      mSoundsById.emplace_back(mSoundSystem.addSound(mResources.loadSound(
+        id, mSoundSystem.sampleRate(), data::DEFAULT_ADLIB_EMULATOR_TYPE)));
+    });
   });
 
+  std::cout << "Sound memory: "
+    << mSoundSystem.memoryStatistics().mNativeBytes / 1024
+    << " KB resident\n";
+
   applyChangedOptions();
 
-  mpCurrentGameMode = wrapWithInitialFadeIn(createInitialGameMode(
-    makeModeContext(), mCommandLineOptions, mIsShareWareVersion));
+  mpCurrentGameMode = measureStartupPhase(
+    pStartupTimeline, "Initial game mode", [this]() {
+      return wrapWithInitialFadeIn(createInitialGameMode(
+        makeModeContext(), mCommandLineOptions, mIsShareWareVersion));
+    });
 
-  enumerateGameControllers();
+  measureStartupPhase(
+    pStartupTimeline, "Game controllers", [this]() {
+      enumerateGameControllers();
+    });
+
+  if (mCommandLineOptions.mUseRenderThread) {
+    mRenderer.startRenderThread();
+  }
 
   mLastTime = std::chrono::high_resolution_clock::now();
 }
@@ -406,19 +573,22 @@ auto Game::runOneFrame() -> std::optional<StopReason> {
   using namespace std::chrono;
   using base::defer;
 
-  const auto startOfFrame = high_resolution_clock::now();
-  const auto elapsed =
-    duration<entityx::TimeDelta>(startOfFrame - mLastTime).count();
-  mLastTime = startOfFrame;
-
   pumpEvents();
   if (!mIsRunning) {
     return StopReason::GameEnded;
   }
 
+  updateBackgroundState();
+
+  const auto startOfFrame = high_resolution_clock::now();
+  const auto elapsed =
+    duration<entityx::TimeDelta>(startOfFrame - mLastTime).count();
+  mLastTime = startOfFrame;
+
   {
     ui::imgui_integration::beginFrame(mpWindow);
-    auto imGuiFrameGuard = defer([]() { ui::imgui_integration::endFrame(); });
+    auto imGuiFrameGuard =
+      defer([this]() { ui::imgui_integration::endFrame(&mRenderer); });
     ImGui::SetMouseCursor(ImGuiMouseCursor_None);
 
     updateAndRender(elapsed);
@@ -427,12 +597,54 @@ auto Game::runOneFrame() -> std::optional<StopReason> {
 
   swapBuffers();
 
+  if (mpStartupTimeline) {
+    mpStartupTimeline->completePhase("First frame");
+    mpStartupTimeline->print(std::cout);
+    mpStartupTimeline = nullptr;
+
+    if (mCommandLineOptions.mExitAfterStartup) {
+      return StopReason::GameEnded;
+    }
+  }
+
   applyChangedOptions();
 
   if (!mGamePathToSwitchTo.empty()) {
     mpUserProfile->mGamePath = mGamePathToSwitchTo;
     mpUserProfile->saveToDisk();
-    return StopReason::RestartNeeded;
+    mGamePathToSwitchTo.clear();
+
+    // A game path given on the command line takes priority over the one
+    // stored in the profile, so it needs to be dropped for the switch to
+    // become effective.
+    mCommandLineOptions.mGamePath.clear();
+
+    // The current mode can't survive a switch to a different data set, so
+    // we start over from the main menu - like a restart would, but without
+    // tearing down the renderer and sound system.
+    mpCurrentGameMode.reset();
+
+    try {
+      reloadAssets();
+    } catch (const std::exception& error) {
+      std::cerr << "Switching game path in place failed: " << error.what()
+        << ", restarting\n";
+      return StopReason::RestartNeeded;
+    }
+
+    mpCurrentGameMode =
+      wrapWithInitialFadeIn(std::make_unique<MenuMode>(makeModeContext()));
+  } else if (mAssetReloadRequested) {
+    mAssetReloadRequested = false;
+
+    // Files might be in the middle of being edited, so a failure here is
+    // reported instead of terminating the game. Changes which haven't been
+    // fully applied are retried on the next reload, see reloadAssets().
+    try {
+      reloadAssets();
+    } catch (const std::exception& error) {
+      std::cerr << "Asset reload failed: " << error.what() << '\n';
+    }
   }
 
   return {};
@@ -441,10 +653,24 @@ auto Game::runOneFrame() -> std::optional<StopReason> {
 
 void Game::pumpEvents() {
   SDL_Event event;
-  while (mIsMinimized && SDL_WaitEvent(&event)) {
-    if (!handleEvent(event)) {
-      mEventQueue.push_back(event);
+
+  if (shouldPauseInBackground()) {
+    mCpuUsageMeter.switchTo(CpuUsageMeter::State::BackgroundPaused);
+
+    while (
+      mIsRunning &&
+      shouldPauseInBackground() &&
+      SDL_WaitEvent(&event)
+    ) {
+      if (!handleEvent(event)) {
+        mEventQueue.push_back(event);
+      }
     }
+
+    // Pretend that no time passed while paused. Otherwise, game logic would
+    // try to catch up on all the updates it missed in the meantime.
+    mLastTime = std::chrono::high_resolution_clock::now();
+    resetFpsLimiter();
   }
 
   while (SDL_PollEvent(&event)) {
@@ -455,6 +681,60 @@ void Game::pumpEvents() {
 }
 
 
+bool Game::isInBackground() const {
+  return mIsMinimized || mIsHidden || !mHasFocus;
+}
+
+
+bool Game::shouldPauseInBackground() const {
+#ifdef __EMSCRIPTEN__
+  // Pausing blocks until the next event arrives. On the web, each frame is
+  // a callback from the browser's main loop, which must never block.
+  return false;
+#else
+  // Nothing can be seen of a minimized or hidden window, so there is no
+  // point in running the game, regardless of the background mode.
+  if (mIsMinimized || mIsHidden) {
+    return true;
+  }
+
+  return
+    !mHasFocus &&
+    mpUserProfile->mOptions.mBackgroundMode == data::BackgroundMode::Pause;
+#endif
+}
+
+
+void Game::updateBackgroundState() {
+  const auto inBackground = isInBackground();
+
+  if (inBackground != mWasInBackground) {
+    mWasInBackground = inBackground;
+    resetFpsLimiter();
+  }
+
+  mCpuUsageMeter.switchTo(inBackground
+    ? CpuUsageMeter::State::BackgroundLowRefreshRate
+    : CpuUsageMeter::State::Foreground);
+}
+
+
+void Game::resetFpsLimiter() {
+  // A new limiter is created instead of adjusting the existing one, so
+  // that time spent in a different state doesn't count as accumulated error.
+#ifndef __EMSCRIPTEN__
+  // On the web, waiting for the next frame would busy-wait inside the
+  // browser's main loop callback, so throttling is left to the browser.
+  if (isInBackground()) {
+    mFpsLimiter = FpsLimiter{BACKGROUND_FPS};
+    return;
+  }
+#endif
+
+  mFpsLimiter = createLimiter(mpUserProfile->mOptions);
+}
+
+
 void Game::updateAndRender(const entityx::TimeDelta elapsed) {
   {
     RenderTargetBinder bindRenderTarget(mRenderTarget, &mRenderer);
@@ -479,7 +759,10 @@ void Game::updateAndRender(const entityx::TimeDelta elapsed) {
     mRenderer.submitBatch();
 
     if (mpUserProfile->mOptions.mShowFpsCounter) {
-      mFpsDisplay.updateAndRender(elapsed);
+      mFpsDisplay.updateAndRender(
+        elapsed,
+        mCpuUsageMeter.report(),
+        mRenderer.textureMemoryStatistics());
     }
   }
 }
@@ -509,6 +792,13 @@ bool Game::handleEvent(const SDL_Event& event) {
       if (event.key.keysym.sym == SDLK_F6) {
         options.mShowFpsCounter = !options.mShowFpsCounter;
       }
+
+      if (
+        event.key.keysym.sym == SDLK_F5 &&
+        mCommandLineOptions.mDebugModeEnabled
+      ) {
+        mAssetReloadRequested = true;
+      }
       return false;
 
     case SDL_QUIT:
@@ -525,6 +815,23 @@ bool Game::handleEvent(const SDL_Event& event) {
           mIsMinimized = false;
           break;
 
+        case SDL_WINDOWEVENT_FOCUS_LOST:
+          mHasFocus = false;
+          break;
+
+        case SDL_WINDOWEVENT_FOCUS_GAINED:
+          mHasFocus = true;
+          break;
+
+        case SDL_WINDOWEVENT_HIDDEN:
+          mIsHidden = true;
+          break;
+
+        case SDL_WINDOWEVENT_SHOWN:
+        case SDL_WINDOWEVENT_EXPOSED:
+          mIsHidden = false;
+          break;
+
         case SDL_WINDOWEVENT_SIZE_CHANGED:
           if (options.mWindowMode == data::WindowMode::Windowed) {
             options.mWindowWidth = event.window.data1;
@@ -627,7 +934,9 @@ void Game::applyChangedOptions() {
   }
 
   if (currentOptions.mEnableVsync != mPreviousOptions.mEnableVsync) {
-    SDL_GL_SetSwapInterval(mpUserProfile->mOptions.mEnableVsync ? 1 : 0);
+    const auto swapInterval = currentOptions.mEnableVsync ? 1 : 0;
+    mRenderer.submitCustomCommand(
+      [swapInterval]() { SDL_GL_SetSwapInterval(swapInterval); });
   }
 
   if (
@@ -635,7 +944,7 @@ void Game::applyChangedOptions() {
     currentOptions.mEnableFpsLimit != mPreviousOptions.mEnableFpsLimit ||
     currentOptions.mMaxFps != mPreviousOptions.mMaxFps
   ) {
-    mFpsLimiter = createLimiter(currentOptions);
+    resetFpsLimiter();
   }
 
   if (
@@ -658,10 +967,92 @@ void Game::applyChangedOptions() {
     mSoundSystem.setSoundVolume(newVolume);
   }
 
+  if (
+    currentOptions.mAdlibEmulatorType != mPreviousOptions.mAdlibEmulatorType
+  ) {
+    const auto emulatorType = currentOptions.mAdlibEmulatorType;
+    mSoundSystem.setAdlibEmulatorType(emulatorType);
+
+    // Digitized sounds are reloaded as well, even though they are not
+    // affected. This only happens when the option is changed, so it's not
+    // worth the additional complexity to single them out.
+    data::forEachSoundId([&](const auto id) {
+      mSoundSystem.replaceSound(
+        mSoundsById[static_cast<std::size_t>(id)],
+        mResources.loadSound(id, mSoundSystem.sampleRate(), emulatorType));
+    });
+  }
+
   mPreviousOptions = mpUserProfile->mOptions;
 }
 
 
+void Game::reloadAssets() {
+  using namespace std::chrono;
+
+  const auto before = high_resolution_clock::now();
+
+  // The resource loader considers files up to date as soon as it has seen
+  // them. If one of the consumers below fails, the changes are kept around
+  // until a later reload succeeds, so that nothing is skipped. Reloading
+  // the same file multiple times is harmless.
+  const auto newlyChangedFiles = mResources.reload(
+    effectiveGamePath(mCommandLineOptions, *mpUserProfile));
+  mPendingChangedFiles.insert(
+    newlyChangedFiles.begin(), newlyChangedFiles.end());
+
+  const auto& changedFiles = mPendingChangedFiles;
+  const auto hasChanged = [&](const std::string& name) {
+    return changedFiles.count(name) != 0;
+  };
+
+  mIsShareWareVersion = detectShareWareVersion(mResources);
+
+  auto numSoundsReloaded = 0;
+  data::forEachSoundId([&](const auto id) {
+    const auto sourceFiles = mResources.soundSourceFiles(id);
+    if (std::any_of(sourceFiles.begin(), sourceFiles.end(), hasChanged)) {
+      mSoundSystem.replaceSound(
+        mSoundsById[static_cast<std::size_t>(id)],
+        mResources.loadSound(
+          id,
+          mSoundSystem.sampleRate(),
+          mpUserProfile->mOptions.mAdlibEmulatorType));
+      ++numSoundsReloaded;
+    }
+  });
+
+  if (std::any_of(std::begin(SCRIPT_FILES), std::end(SCRIPT_FILES), hasChanged))
+  {
+    mAllScripts = loadScripts(mResources);
+  }
+
+  if (hasChanged(UI_SPRITE_SHEET_FILE)) {
+    mUiSpriteSheet = loadUiSpriteSheet(&mRenderer, mResources);
+  }
+
+  if (
+    hasChanged(loader::ActorImagePackage::IMAGE_DATA_FILE) ||
+    hasChanged(loader::ActorImagePackage::ACTOR_INFO_FILE)
+  ) {
+    mTextRenderer =
+      ui::MenuElementRenderer{&mUiSpriteSheet, &mRenderer, mResources};
+  }
+
+  if (mpCurrentGameMode && !changedFiles.empty()) {
+    mpCurrentGameMode->handleAssetReload();
+  }
+
+  const auto numChangedFiles = changedFiles.size();
+  mPendingChangedFiles.clear();
+
+  const auto after = high_resolution_clock::now();
+  std::cout << "Asset reload: " << numChangedFiles << " changed files, " <<
+    numSoundsReloaded << " sounds re-decoded, " <<
+    duration<double>(after - before).count() * 1000.0 << " ms\n";
+}
+
+
 void Game::enumerateGameControllers() {
   // TODO : support multiple controllers.
   // At the moment, this opens only the first available controller.
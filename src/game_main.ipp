@@ -34,14 +34,19 @@
 
 #include "SDL_gamecontroller.h"
 
+#include <array>
 #include <chrono>
 #include <memory>
 #include <optional>
+#include <set>
 #include <string>
 
 
 namespace rigel {
 
+class StartupTimeline;
+
+
 class FpsLimiter {
 public:
   explicit FpsLimiter(int targetFps);
@@ -55,6 +60,38 @@ private:
 };
 
 
+/** Measures process CPU usage separately for each window activity state
+ *
+ * Call switchTo() whenever the state changes. Time passed since the previous
+ * call is attributed to the state that was active until then. Calling it
+ * again with the same state is fine, and just updates the measurement.
+ */
+class CpuUsageMeter {
+public:
+  enum class State {
+    Foreground,
+    BackgroundLowRefreshRate,
+    BackgroundPaused
+  };
+
+  CpuUsageMeter();
+
+  void switchTo(State newState);
+  ui::CpuUsageReport report() const;
+
+private:
+  struct Totals {
+    double mWallTime = 0.0;
+    double mCpuTime = 0.0;
+  };
+
+  std::array<Totals, 3> mTotalsByState;
+  State mCurrentState = State::Foreground;
+  std::chrono::high_resolution_clock::time_point mLastWallTime;
+  double mLastCpuTime;
+};
+
+
 class Game : public IGameServiceProvider {
 public:
   enum class StopReason {
@@ -65,7 +102,8 @@ public:
   Game(
     const CommandLineOptions& commandLineOptions,
     UserProfile* pUserProfile,
-    SDL_Window* pWindow);
+    SDL_Window* pWindow,
+    StartupTimeline* pStartupTimeline);
   Game(const Game&) = delete;
   Game& operator=(const Game&) = delete;
 
@@ -90,6 +128,10 @@ private:
   };
 
   void pumpEvents();
+  bool isInBackground() const;
+  bool shouldPauseInBackground() const;
+  void updateBackgroundState();
+  void resetFpsLimiter();
   void updateAndRender(entityx::TimeDelta elapsed);
 
   GameMode::Context makeModeContext();
@@ -100,6 +142,7 @@ private:
 
   void swapBuffers();
   void applyChangedOptions();
+  void reloadAssets();
   void enumerateGameControllers();
 
   // IGameServiceProvider implementation
@@ -139,12 +182,21 @@ private:
 
   bool mIsRunning;
   bool mIsMinimized;
+  bool mHasFocus;
+  bool mIsHidden;
+  bool mWasInBackground;
+  CpuUsageMeter mCpuUsageMeter;
   std::chrono::high_resolution_clock::time_point mLastTime;
 
   CommandLineOptions mCommandLineOptions;
   UserProfile* mpUserProfile;
+  // Only set until the first frame has been presented
+  StartupTimeline* mpStartupTimeline;
   data::GameOptions mPreviousOptions;
   std::filesystem::path mGamePathToSwitchTo;
+  bool mAssetReloadRequested = false;
+  // Changed files not yet handled by all consumers, due to a failed reload
+  std::set<std::string> mPendingChangedFiles;
 
   ui::DukeScriptRunner mScriptRunner;
   loader::ScriptBundle mAllScripts;
@@ -21,6 +21,8 @@
 #include "game_logic/ingame_systems.hpp"
 #include "ui/utils.hpp"
 
+#include <chrono>
+#include <iostream>
 #include <sstream>
 
 
@@ -107,6 +109,11 @@ void GameRunner::handleEvent(const SDL_Event& event) {
 }
 
 
+base::Vector GameRunner::playerPosition() const {
+  return mWorld.mpState->mpSystems->player().position();
+}
+
+
 void GameRunner::updateAndRender(engine::TimeDelta dt) {
   if (gameQuit() || levelFinished() || requestedGameToLoad()) {
     // TODO: This is a workaround to make the fadeout on quitting work.
@@ -119,10 +126,71 @@ void GameRunner::updateAndRender(engine::TimeDelta dt) {
     return;
   }
 
-  updateWorld(dt);
+  using namespace std::chrono;
+  const auto startOfFrame = high_resolution_clock::now();
+
+  if (isReplaying()) {
+    updateReplay(dt);
+  } else {
+    updateWorld(dt);
+  }
+
   mWorld.render();
   renderDebugText();
   mWorld.processEndOfFrameActions();
+
+  mWorld.recordFrameTimings(
+    dt,
+    duration<engine::TimeDelta>(high_resolution_clock::now() - startOfFrame)
+      .count());
+}
+
+
+void GameRunner::replay(const game_logic::LevelReplayData& replayData) {
+  const auto viewPortSize = mWorld.viewPortSize();
+  if (viewPortSize != replayData.mViewPortSize) {
+    std::cerr << "Warning: Replay was recorded with a view port of "
+      << replayData.mViewPortSize.width << "x"
+      << replayData.mViewPortSize.height << " tiles, but current one is "
+      << viewPortSize.width << "x" << viewPortSize.height
+      << ". Replay might diverge from the original session\n";
+  }
+
+  mTicksToReplay = replayData.mTicks;
+  mNextTickToReplay = 0;
+  mAccumulatedTime = 0.0;
+}
+
+
+void GameRunner::updateReplay(const engine::TimeDelta dt) {
+  // Only a single recorded frame can be replayed per rendered frame, since
+  // end-of-frame processing needs to happen at the same points as during
+  // recording. If that frame contained multiple updates, the accumulated
+  // time goes negative, delaying the next frame accordingly.
+  mAccumulatedTime += dt;
+  if (mAccumulatedTime < GAME_LOGIC_UPDATE_DELAY) {
+    return;
+  }
+
+  for (auto frameDone = false; !frameDone && isReplaying();) {
+    const auto& tick = mTicksToReplay[mNextTickToReplay++];
+    mWorld.updateGameLogic(tick.mInput);
+    mAccumulatedTime -= GAME_LOGIC_UPDATE_DELAY;
+    frameDone = tick.mEndsFrame;
+  }
+
+  mWorld.mpState->mpSystems->updateBackdropAutoScrolling(dt);
+
+  if (!isReplaying()) {
+    std::cout << "Replay finished after " << mTicksToReplay.size()
+      << " updates\n";
+
+    mTicksToReplay.clear();
+    mNextTickToReplay = 0;
+    mAccumulatedTime = 0.0;
+    mSingleStepping =
+      mContext.mpServiceProvider->commandLineOptions().mDebugModeEnabled;
+  }
 }
 
 
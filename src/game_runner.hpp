@@ -22,6 +22,7 @@
 #include "data/bonus.hpp"
 #include "data/saved_game.hpp"
 #include "game_logic/game_world.hpp"
+#include "game_logic/hitch_recorder.hpp"
 #include "game_logic/input.hpp"
 #include "ui/ingame_menu.hpp"
 
@@ -29,6 +30,9 @@ RIGEL_DISABLE_WARNINGS
 #include <SDL.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
+#include <vector>
+
 
 namespace rigel {
 
@@ -50,8 +54,22 @@ public:
 
   std::set<data::Bonus> achievedBonuses() const;
 
+  base::Vector playerPosition() const;
+
+  /** Drive the game with previously recorded input
+   *
+   * Must be called right after construction, with a runner created for the
+   * replay's session and player model. Replays one recorded frame per
+   * rendered frame, at the regular game speed. Live input is ignored until
+   * the replay is done. In debug mode, the game is then paused in
+   * single-step mode, otherwise the player takes over.
+   */
+  void replay(const game_logic::LevelReplayData& replayData);
+
 private:
   void updateWorld(engine::TimeDelta dt);
+  void updateReplay(engine::TimeDelta dt);
+  bool isReplaying() const;
   bool updateMenu(engine::TimeDelta dt);
   void handlePlayerKeyboardInput(const SDL_Event& event);
   void handlePlayerGameControllerInput(const SDL_Event& event);
@@ -69,6 +87,9 @@ private:
   bool mShowDebugText = false;
   bool mSingleStepping = false;
   bool mDoNextSingleStep = false;
+
+  std::vector<game_logic::RecordedTick> mTicksToReplay;
+  std::size_t mNextTickToReplay = 0;
 };
 
 
@@ -91,4 +112,9 @@ inline std::set<data::Bonus> GameRunner::achievedBonuses() const {
   return mWorld.achievedBonuses();
 }
 
+
+inline bool GameRunner::isReplaying() const {
+  return mNextTickToReplay < mTicksToReplay.size();
+}
+
 }
@@ -23,6 +23,7 @@
 #include "common/game_service_provider.hpp"
 #include "common/user_profile.hpp"
 #include "data/saved_game.hpp"
+#include "game_logic/hitch_recorder.hpp"
 #include "ui/high_score_list.hpp"
 #include "ui/menu_navigation.hpp"
 
@@ -64,6 +65,25 @@ GameSessionMode::GameSessionMode(const data::SavedGame& save, Context context)
 }
 
 
+GameSessionMode::GameSessionMode(
+  const game_logic::LevelReplayData& replayData,
+  Context context
+)
+  : mPlayerModel(replayData.mPlayerModelAtLevelStart)
+  , mCurrentStage(std::make_unique<GameRunner>(
+      &mPlayerModel,
+      replayData.mSessionId,
+      context,
+      replayData.mPlayerPositionOverride))
+  , mEpisode(replayData.mSessionId.mEpisode)
+  , mCurrentLevelNr(replayData.mSessionId.mLevel)
+  , mDifficulty(replayData.mSessionId.mDifficulty)
+  , mContext(context)
+{
+  std::get<std::unique_ptr<GameRunner>>(mCurrentStage)->replay(replayData);
+}
+
+
 void GameSessionMode::handleEvent(const SDL_Event& event) {
   base::match(mCurrentStage,
     [&event, this](std::unique_ptr<GameRunner>& pIngameMode) {
@@ -103,6 +123,28 @@ void GameSessionMode::handleEvent(const SDL_Event& event) {
 }
 
 
+void GameSessionMode::handleAssetReload() {
+  // Only the level itself is restarted, the other stages are short-lived
+  // and pick up changes the next time they are entered.
+  if (auto ppIngameMode = std::get_if<std::unique_ptr<GameRunner>>(
+    &mCurrentStage)
+  ) {
+    auto& pIngameMode = *ppIngameMode;
+    const auto playerPosition = pIngameMode->playerPosition();
+
+    // The new level is loaded before the old one is discarded. This way,
+    // the current level keeps running if loading fails, e.g. due to a
+    // half-edited level file or a texture exceeding the memory budget.
+    auto pNewIngameMode = std::make_unique<GameRunner>(
+      &mPlayerModel,
+      data::GameSessionId{mEpisode, mCurrentLevelNr, mDifficulty},
+      mContext,
+      playerPosition);
+    pIngameMode = std::move(pNewIngameMode);
+  }
+}
+
+
 std::unique_ptr<GameMode> GameSessionMode::updateAndRender(
   const engine::TimeDelta dt,
   const std::vector<SDL_Event>& events
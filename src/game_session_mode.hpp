@@ -39,10 +39,17 @@ public:
 
   GameSessionMode(const data::SavedGame& save, Context context);
 
+  /** Start a session by replaying a level captured by HitchRecorder */
+  GameSessionMode(
+    const game_logic::LevelReplayData& replayData,
+    Context context);
+
   std::unique_ptr<GameMode> updateAndRender(
     engine::TimeDelta dt,
     const std::vector<SDL_Event>& events) override;
 
+  void handleAssetReload() override;
+
 private:
   void handleEvent(const SDL_Event& event);
   template<typename StageT>
@@ -97,6 +97,37 @@ ActorData ActorImagePackage::loadActor(
   const ActorID id,
   const Palette16& palette
 ) const {
+  const auto& header = actorHeader(id);
+  return ActorData{
+    header.mDrawIndex,
+    loadFrameImages(id, header, palette)
+  };
+}
+
+
+IndexedActorData ActorImagePackage::loadIndexedActor(const ActorID id) const {
+  const auto& header = actorHeader(id);
+  return IndexedActorData{
+    header.mDrawIndex,
+    utils::transformed(
+      header.mFrames,
+      [&, this, frame = 0](const auto& frameHeader) mutable {
+        auto maybeReplacement = loadReplacementImage(id, frame);
+        ++frame;
+
+        return IndexedActorData::Frame{
+          frameHeader.mDrawOffset,
+          maybeReplacement
+            ? data::AnyImage{std::move(*maybeReplacement)}
+            : data::AnyImage{loadIndexedImage(frameHeader)}};
+      })
+  };
+}
+
+
+auto ActorImagePackage::actorHeader(const ActorID id) const
+  -> const ActorHeader&
+{
   // Font has to be loaded using loadFont()
   assert(id != data::ActorID::Menu_font_grayscale);
 
@@ -105,11 +136,7 @@ ActorData ActorImagePackage::loadActor(
     throw invalid_argument("loadActor(): No actor at this ID " + std::to_string(static_cast<int>(id)));
   }
 
-  const auto& header = it->second;
-  return ActorData{
-    header.mDrawIndex,
-    loadFrameImages(id, header, palette)
-  };
+  return it->second;
 }
 
 
@@ -135,21 +162,30 @@ std::vector<ActorData::Frame> ActorImagePackage::loadFrameImages(
   return utils::transformed(
     header.mFrames,
     [&, this, frame = 0](const auto& frameHeader) mutable {
-      auto maybeReplacement = mMaybeReplacementsPath
-        ? loadPng(replacementImagePath(*mMaybeReplacementsPath, static_cast<int>(id), frame))
-        : std::nullopt;
+      auto maybeReplacement = loadReplacementImage(id, frame);
       ++frame;
 
       return ActorData::Frame{
         frameHeader.mDrawOffset,
-        maybeReplacement ? *maybeReplacement : loadImage(frameHeader, palette)};
+        maybeReplacement
+          ? *maybeReplacement
+          : applyPalette(loadIndexedImage(frameHeader), palette)};
     });
 }
 
 
-data::Image ActorImagePackage::loadImage(
-  const ActorFrameHeader& frameHeader,
-  const Palette16& palette
+std::optional<data::Image> ActorImagePackage::loadReplacementImage(
+  const data::ActorID id,
+  const int frame
+) const {
+  return mMaybeReplacementsPath
+    ? loadPng(replacementImagePath(*mMaybeReplacementsPath, static_cast<int>(id), frame))
+    : std::nullopt;
+}
+
+
+data::IndexedImage ActorImagePackage::loadIndexedImage(
+  const ActorFrameHeader& frameHeader
 ) const {
   using T = data::TileImageType;
 
@@ -163,11 +199,10 @@ data::Image ActorImagePackage::loadImage(
   }
 
   const auto dataStart = mImageData.begin() + frameHeader.mFileOffset;
-  return loadTiledImage(
+  return loadTiledIndexedImage(
     dataStart,
     dataStart + dataSize,
     width,
-    palette,
     T::Masked);
 }
 
@@ -41,6 +41,22 @@ struct ActorData {
 };
 
 
+/** Like ActorData, but keeps frames as palette indices where possible
+ *
+ * Frames taken from replacement PNG files can't be represented with indices,
+ * these are provided as RGBA images instead.
+ */
+struct IndexedActorData {
+  struct Frame {
+    base::Vector mDrawOffset;
+    data::AnyImage mFrameImage;
+  };
+
+  int mDrawIndex;
+  std::vector<Frame> mFrames;
+};
+
+
 using FontData = std::vector<data::Image>;
 
 
@@ -57,6 +73,7 @@ public:
   ActorData loadActor(
     data::ActorID id,
     const Palette16& palette = INGAME_PALETTE) const;
+  IndexedActorData loadIndexedActor(data::ActorID id) const;
 
   base::Rect<int> actorFrameRect(data::ActorID id, int frame) const;
 
@@ -79,13 +96,16 @@ private:
     const ActorHeader& header,
     const Palette16& palette) const;
 
-  data::Image loadImage(
-    const ActorFrameHeader& frameHeader,
-    const Palette16& palette
-  ) const;
+  const ActorHeader& actorHeader(data::ActorID id) const;
+
+  data::IndexedImage loadIndexedImage(
+    const ActorFrameHeader& frameHeader) const;
+  std::optional<data::Image> loadReplacementImage(
+    data::ActorID id,
+    int frame) const;
 
 private:
-  const ByteBuffer mImageData;
+  ByteBuffer mImageData;
   std::map<data::ActorID, ActorHeader> mHeadersById;
   std::optional<std::string> mMaybeReplacementsPath;
 };
@@ -17,28 +17,64 @@
 #pragma once
 
 #include "base/math_tools.hpp"
+#include "data/game_options.hpp"
+#include "loader/fast_opl2.hpp"
 
 #include <dbopl.h>
 
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <variant>
 
 
 namespace rigel::loader {
 
 class AdlibEmulator {
 public:
-  explicit AdlibEmulator(int sampleRate)
-    : mEmulator(sampleRate)
+  explicit AdlibEmulator(
+    int sampleRate,
+    const data::AdlibEmulatorType type = data::DEFAULT_ADLIB_EMULATOR_TYPE)
+    : mEmulator(
+        std::in_place_type<DBOPL::Chip>,
+        static_cast<DBOPL::Bit32u>(sampleRate))
+    , mSampleRate(sampleRate)
   {
+    if (type != data::AdlibEmulatorType::DBOPL) {
+      createEmulator(type);
+    }
+
     // This is normally done by the game to select the right type of wave forms.
     // It's not part of the IMF files.
-    mEmulator.WriteReg(1, 32);
+    writeRegister(1, 32);
+  }
+
+  data::AdlibEmulatorType type() const {
+    return std::holds_alternative<FastOpl2>(mEmulator)
+      ? data::AdlibEmulatorType::Fast
+      : data::AdlibEmulatorType::DBOPL;
+  }
+
+  /** Switch to a different emulator
+   *
+   * All registers written so far are written to the new emulator as well,
+   * so that playback can continue with the same instrument settings. Notes
+   * which are currently playing are restarted.
+   */
+  void setType(const data::AdlibEmulatorType type) {
+    if (type == this->type()) {
+      return;
+    }
+
+    createEmulator(type);
+    for (auto reg = 0u; reg < mRegisters.size(); ++reg) {
+      writeRegisterToEmulator(reg, mRegisters[reg]);
+    }
   }
 
   void writeRegister(const std::uint32_t reg, const std::uint8_t value) {
-    mEmulator.WriteReg(reg, value);
+    mRegisters[reg & 0xFF] = value;
+    writeRegisterToEmulator(reg, value);
   }
 
   template<typename OutputIt>
@@ -47,16 +83,21 @@ public:
     OutputIt destination,
     const float volumeScale = 1.0f
   ) {
-    // DBOPL outputs 32 bit samples, but they never exceed the 16 bit range
-    // (compare source code comment in MixerChannel::AddSamples() in mixer.cpp
-    // in the DosBox source). Still, this means we cannot render directly into
-    // the output buffer.
+    // Both emulators output 32 bit samples, but they never exceed the 16 bit
+    // range (compare source code comment in MixerChannel::AddSamples() in
+    // mixer.cpp in the DosBox source). Still, this means we cannot render
+    // directly into the output buffer.
 
     while (numSamples > 0) {
       const auto samplesForIteration = std::min(mTempBuffer.size(), numSamples);
 
-      mEmulator.GenerateBlock2(
-        static_cast<DBOPL::Bitu>(samplesForIteration), mTempBuffer.data());
+      if (auto pFastEmulator = std::get_if<FastOpl2>(&mEmulator)) {
+        pFastEmulator->generateBlock(mTempBuffer.data(), samplesForIteration);
+      } else {
+        std::get<DBOPL::Chip>(mEmulator).GenerateBlock2(
+          static_cast<DBOPL::Bitu>(samplesForIteration), mTempBuffer.data());
+      }
+
       destination = std::transform(
         mTempBuffer.begin(),
         mTempBuffer.begin() + samplesForIteration,
@@ -71,8 +112,29 @@ public:
   }
 
 private:
-  DBOPL::Chip mEmulator;
+  void createEmulator(const data::AdlibEmulatorType type) {
+    if (type == data::AdlibEmulatorType::Fast) {
+      mEmulator.emplace<FastOpl2>(mSampleRate);
+    } else {
+      mEmulator.emplace<DBOPL::Chip>(static_cast<DBOPL::Bit32u>(mSampleRate));
+    }
+  }
+
+  void writeRegisterToEmulator(
+    const std::uint32_t reg,
+    const std::uint8_t value
+  ) {
+    if (auto pFastEmulator = std::get_if<FastOpl2>(&mEmulator)) {
+      pFastEmulator->writeRegister(reg, value);
+    } else {
+      std::get<DBOPL::Chip>(mEmulator).WriteReg(reg, value);
+    }
+  }
+
+  std::variant<DBOPL::Chip, FastOpl2> mEmulator;
+  std::array<std::uint8_t, 256> mRegisters{};
   std::array<std::int32_t, 256> mTempBuffer;
+  int mSampleRate;
 };
 
 }
@@ -107,23 +107,27 @@ AudioPackage::AudioPackage(
 }
 
 
-data::AudioBuffer AudioPackage::loadAdlibSound(SoundId id) const {
+data::AudioBuffer AudioPackage::loadAdlibSound(
+  const SoundId id,
+  const int sampleRate,
+  const data::AdlibEmulatorType emulatorType
+) const {
   const auto idAsIndex = static_cast<int>(id);
   if (idAsIndex < 0 || idAsIndex >= 34) {
     throw std::invalid_argument("Invalid sound ID");
   }
 
   const auto& sound = mSounds[idAsIndex];
-  return renderAdlibSound(sound);
+  return renderAdlibSound(sound, sampleRate, emulatorType);
 }
 
 
 data::AudioBuffer AudioPackage::renderAdlibSound(
-  const AdlibSound& sound
+  const AdlibSound& sound,
+  const int sampleRate,
+  const data::AdlibEmulatorType emulatorType
 ) const {
-  const auto sampleRate = 44100;
-
-  AdlibEmulator emulator{sampleRate};
+  AdlibEmulator emulator{sampleRate, emulatorType};
 
   emulator.writeRegister(0x20, sound.mInstrumentSettings[0]);
   emulator.writeRegister(0x40, sound.mInstrumentSettings[2]);
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "data/audio_buffer.hpp"
+#include "data/game_options.hpp"
 #include "data/sound_ids.hpp"
 #include "loader/byte_buffer.hpp"
 
@@ -37,7 +38,11 @@ public:
     const ByteBuffer& audioDictData,
     const ByteBuffer& bundledAudioData);
 
-  data::AudioBuffer loadAdlibSound(data::SoundId id) const;
+  /** Render Adlib sound effect at the given sample rate */
+  data::AudioBuffer loadAdlibSound(
+    data::SoundId id,
+    int sampleRate,
+    data::AdlibEmulatorType emulatorType) const;
 
 private:
   struct AdlibSound {
@@ -48,7 +53,10 @@ private:
     std::vector<std::uint8_t> mSoundData;
   };
 
-  data::AudioBuffer renderAdlibSound(const AdlibSound& sound) const;
+  data::AudioBuffer renderAdlibSound(
+    const AdlibSound& sound,
+    int sampleRate,
+    data::AdlibEmulatorType emulatorType) const;
 
 private:
   std::vector<AdlibSound> mSounds;
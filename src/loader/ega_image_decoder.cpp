@@ -142,15 +142,15 @@ void applyEgaMask(
 }
 
 
-template<typename Callable>
-data::PixelBuffer decodeTiledEgaData(
+template<typename BufferT, typename Callable>
+BufferT decodeTiledEgaData(
   const ByteBufferCIter dataIter,
   const std::size_t widthInTiles,
   const std::size_t heightInTiles,
   Callable decodeRow
 ) {
   const auto targetBufferStride = tilesToPixels(widthInTiles);
-  PixelBuffer pixels(
+  BufferT pixels(
     widthInTiles * heightInTiles * GameTraits::tileSizeSquared);
 
   BitWiseIterator<ByteBufferCIter> bitsIter(dataIter);
@@ -194,18 +194,20 @@ data::PixelBuffer decodeSimplePlanarEgaBuffer(
 }
 
 
-data::Image loadTiledImage(
+data::IndexedImage loadTiledIndexedImage(
   const ByteBufferCIter begin,
   const ByteBufferCIter end,
   std::size_t widthInTiles,
-  const Palette16& palette,
   const data::TileImageType type
 ) {
   const auto heightInTiles =
     inferHeight(begin, end, widthInTiles, GameTraits::bytesPerTile(type));
 
-  auto pixels = decodeTiledEgaData(begin, widthInTiles, heightInTiles,
-    [&palette, type](auto sourceBitsIter, const auto targetPixelIter) {
+  auto pixels = decodeTiledEgaData<data::IndexedPixelBuffer>(
+    begin,
+    widthInTiles,
+    heightInTiles,
+    [type](auto sourceBitsIter, const auto targetPixelIter) {
       const auto isMasked = type == data::TileImageType::Masked;
       array<bool, GameTraits::tileSize> pixelMask;
       if (isMasked) {
@@ -213,29 +215,39 @@ data::Image loadTiledImage(
           sourceBitsIter, pixelMask.begin(), GameTraits::tileSize);
       }
 
-      array<uint8_t, GameTraits::tileSize> indexedPixels;
-      indexedPixels.fill(0);
       sourceBitsIter = readEgaColorData(
-        sourceBitsIter, indexedPixels.begin(), GameTraits::tileSize);
-
-      for (auto i=0; i<GameTraits::tileSize; ++i) {
-        *(targetPixelIter + i) = palette[indexedPixels[i]];
-      }
+        sourceBitsIter, targetPixelIter, GameTraits::tileSize);
 
       if (isMasked) {
-        applyEgaMask(pixelMask.begin(), targetPixelIter, GameTraits::tileSize);
+        for (auto i=0; i<GameTraits::tileSize; ++i) {
+          if (pixelMask[i]) {
+            *(targetPixelIter + i) |= data::IndexedImage::MASKED_PIXEL_FLAG;
+          }
+        }
       }
 
       return sourceBitsIter;
     });
 
-  return data::Image(
+  return data::IndexedImage(
     std::move(pixels),
     tilesToPixels(widthInTiles),
     tilesToPixels(heightInTiles));
 }
 
 
+data::Image loadTiledImage(
+  const ByteBufferCIter begin,
+  const ByteBufferCIter end,
+  std::size_t widthInTiles,
+  const Palette16& palette,
+  const data::TileImageType type
+) {
+  return applyPalette(
+    loadTiledIndexedImage(begin, end, widthInTiles, type), palette);
+}
+
+
 data::Image loadTiledFontBitmap(
   const ByteBufferCIter begin,
   const ByteBufferCIter end,
@@ -244,7 +256,10 @@ data::Image loadTiledFontBitmap(
   const auto heightInTiles =
     inferHeight(begin, end, widthInTiles, GameTraits::bytesPerFontTile());
 
-  auto pixels = decodeTiledEgaData(begin, widthInTiles, heightInTiles,
+  auto pixels = decodeTiledEgaData<PixelBuffer>(
+    begin,
+    widthInTiles,
+    heightInTiles,
     [](auto sourceBitsIter, const auto targetPixelIter) {
       array<bool, GameTraits::tileSize> pixelMask;
       sourceBitsIter = readEgaMaskPlane(sourceBitsIter, pixelMask.begin(), GameTraits::tileSize);
@@ -30,6 +30,17 @@ data::PixelBuffer decodeSimplePlanarEgaBuffer(
   const Palette16& palette);
 
 
+/** Decode tiled EGA image data, keeping palette indices
+ *
+ * Masked pixels are marked with data::IndexedImage::MASKED_PIXEL_FLAG.
+ */
+data::IndexedImage loadTiledIndexedImage(
+  ByteBufferCIter begin,
+  ByteBufferCIter end,
+  std::size_t widthInTiles,
+  data::TileImageType type);
+
+
 data::Image loadTiledImage(
   ByteBufferCIter begin,
   ByteBufferCIter end,
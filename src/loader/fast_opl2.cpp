@@ -0,0 +1,665 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fast_opl2.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace rigel::loader {
+
+namespace {
+
+// The OPL2 runs at 14.318 MHz / 4 / 72 = 49716 Hz
+constexpr auto NATIVE_SAMPLE_RATE = 49716;
+
+constexpr auto PI = 3.14159265358979323846;
+
+constexpr auto NUM_WAVEFORMS = 4;
+constexpr auto PHASE_RESOLUTION = 1024;
+constexpr auto MAX_ATTENUATION = 0x1FF;
+
+constexpr std::uint8_t KEY_SCALE_LEVELS[] = {
+  0, 32, 40, 45, 48, 51, 53, 55, 56, 58, 59, 60, 61, 62, 63, 64
+};
+
+constexpr std::uint8_t KEY_SCALE_LEVEL_SHIFTS[] = {8, 1, 2, 0};
+
+// Frequency multipliers, times two
+constexpr std::uint8_t MULTIPLIERS[] = {
+  1, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 20, 24, 24, 30, 30
+};
+
+using WaveformTables =
+  std::array<std::array<std::int16_t, PHASE_RESOLUTION>, NUM_WAVEFORMS>;
+
+
+/** Output for each waveform and phase at full volume
+ *
+ * The OPL2 stores a quarter sine wave as a table of logarithmic attenuation
+ * values, which is converted to linear output using an exponent table after
+ * adding the envelope's attenuation. All waveforms are derived from the
+ * quarter sine by mirroring, and by replacing parts of the wave with silence.
+ *
+ * We do the conversion to linear up front, and apply attenuation by
+ * multiplying with a volume factor instead (see createVolumeTable()). This
+ * loses a bit of precision at high attenuation, but makes synthesis a lot
+ * cheaper.
+ */
+WaveformTables createWaveformTables() {
+  std::array<std::int16_t, 256> quarterSine;
+  for (auto i = 0u; i < quarterSine.size(); ++i) {
+    const auto value = std::sin((i + 0.5) * PI / 512.0);
+    const auto logSin = std::lround(-std::log2(value) * 256.0);
+    const auto exponent = std::lround(std::exp2((255 - (logSin & 0xFF)) / 256.0) * 1024.0);
+    quarterSine[i] =
+      static_cast<std::int16_t>((exponent << 1) >> (logSin >> 8));
+  }
+
+  WaveformTables result;
+  for (auto phase = 0; phase < PHASE_RESOLUTION; ++phase) {
+    const auto isMirrored = (phase & 0x100) != 0;
+    const auto isNegative = (phase & 0x200) != 0;
+    const auto quarterIndex = isMirrored ? (phase & 0xFF) ^ 0xFF : phase & 0xFF;
+    const auto value = quarterSine[quarterIndex];
+
+    // Sine
+    result[0][phase] = static_cast<std::int16_t>(isNegative ? -value : value);
+
+    // Half sine
+    result[1][phase] = isNegative ? std::int16_t{0} : value;
+
+    // Absolute sine
+    result[2][phase] = value;
+
+    // Quarter sine (pulse)
+    result[3][phase] = isMirrored ? std::int16_t{0} : quarterSine[phase & 0xFF];
+  }
+
+  return result;
+}
+
+
+/** Volume factor in 16.16 fixed point for each attenuation value
+ *
+ * One step of attenuation corresponds to 0.1875 dB.
+ */
+std::array<std::int32_t, MAX_ATTENUATION + 1> createVolumeTable() {
+  std::array<std::int32_t, MAX_ATTENUATION + 1> result;
+  for (auto i = 0u; i < result.size(); ++i) {
+    result[i] =
+      static_cast<std::int32_t>(std::lround(std::exp2(i / -32.0) * 65536.0));
+  }
+
+  return result;
+}
+
+
+const auto WAVEFORM_TABLES = createWaveformTables();
+const auto VOLUME_TABLE = createVolumeTable();
+
+
+/** Produce output for a single operator, given its volume factor */
+inline std::int32_t synthesize(
+  const std::int16_t* pWaveform,
+  const std::uint32_t phase,
+  const std::int32_t volume
+) {
+  return (pWaveform[phase & 0x3FF] * volume) >> 16;
+}
+
+
+/** Combine envelope rate register value and key scaling into a rate (0-63)
+ *
+ * A result of 0 means that the envelope doesn't change at all.
+ */
+int effectiveRate(
+  const int rateRegister,
+  const int keyScaleValue,
+  const bool keyScaleRateOn
+) {
+  if (rateRegister == 0) {
+    return 0;
+  }
+
+  const auto keyScale = keyScaleValue >> (keyScaleRateOn ? 0 : 2);
+  return std::min((rateRegister << 2) + keyScale, 63);
+}
+
+}
+
+
+
+
+FastOpl2::FastOpl2(const int sampleRate)
+  : mSampleRate(sampleRate)
+  // The chip's phase increments are given in units of 1/512th of a step in
+  // its 10-bit phase. We keep phase in 10.22 fixed point, and advance it once
+  // per output sample instead of once per native sample.
+  , mPhaseIncrementScale(
+      8192.0 * NATIVE_SAMPLE_RATE / static_cast<double>(sampleRate))
+  // Envelope rates are in 16.16 fixed point, in steps per output sample
+  , mEnvelopeRateScale(
+      65536.0 * NATIVE_SAMPLE_RATE / static_cast<double>(sampleRate))
+  , mNativeTicksPerSample(
+      (std::uint64_t{NATIVE_SAMPLE_RATE} << 16) /
+        static_cast<std::uint64_t>(sampleRate))
+{
+}
+
+
+void FastOpl2::writeRegister(std::uint32_t reg, const std::uint8_t value) {
+  reg &= 0xFF;
+
+  if (reg == 0x01) {
+    mWaveformSelectOn = (value & 0x20) != 0;
+  } else if (reg == 0x08) {
+    mNoteSelect = (value & 0x40) != 0;
+    for (auto& channel : mChannels) {
+      updateChannel(channel);
+    }
+  } else if (reg == 0xBD) {
+    // Bit 5 enables rhythm mode, which we don't support.
+    mTremoloShift = (value & 0x80) ? 2 : 4;
+    mVibratoShift = (value & 0x40) ? 0 : 1;
+    for (auto& channel : mChannels) {
+      updateChannel(channel);
+    }
+  } else if (reg >= 0xA0 && reg < 0xD0) {
+    writeChannelRegister(reg, value);
+  } else if (reg >= 0x20) {
+    writeOperatorRegister(reg, value);
+  }
+}
+
+
+void FastOpl2::writeOperatorRegister(
+  const std::uint32_t reg,
+  const std::uint8_t value
+) {
+  const auto offset = reg & 0x1F;
+  if (offset > 0x15 || (offset & 7) > 5) {
+    return;
+  }
+
+  // Operators are arranged in three groups of 6, with each group covering
+  // three channels. The first three operators in a group are the modulators,
+  // the other three the carriers.
+  const auto indexInGroup = offset & 7;
+  auto& channel = mChannels[(offset >> 3) * 3 + indexInGroup % 3];
+  auto& op = channel.mOperators[indexInGroup / 3];
+
+  switch (reg & 0xE0) {
+    case 0x20:
+      op.mTremoloOn = (value & 0x80) != 0;
+      op.mVibratoOn = (value & 0x40) != 0;
+      op.mSustainOn = (value & 0x20) != 0;
+      op.mKeyScaleRateOn = (value & 0x10) != 0;
+      op.mMultiplier = value & 0x0F;
+      updatePhaseIncrements(channel, op);
+      updateEnvelopeRate(channel, op);
+      break;
+
+    case 0x40:
+      op.mKeyScaleLevel = value >> 6;
+      op.mTotalLevel = value & 0x3F;
+      updateBaseAttenuation(channel, op);
+      break;
+
+    case 0x60:
+      op.mAttackRate = value >> 4;
+      op.mDecayRate = value & 0x0F;
+      updateEnvelopeRate(channel, op);
+      break;
+
+    case 0x80:
+      op.mSustainLevel = value >> 4;
+      if (op.mSustainLevel == 0x0F) {
+        op.mSustainLevel = 0x1F;
+      }
+      op.mReleaseRate = value & 0x0F;
+      updateEnvelopeRate(channel, op);
+      break;
+
+    case 0xE0:
+      op.mWaveform = value & 0x03;
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+void FastOpl2::writeChannelRegister(
+  const std::uint32_t reg,
+  const std::uint8_t value
+) {
+  const auto index = reg & 0x0F;
+  if (index > 8) {
+    return;
+  }
+
+  auto& channel = mChannels[index];
+  switch (reg & 0xF0) {
+    case 0xA0:
+      channel.mFrequencyNumber = static_cast<std::uint16_t>(
+        (channel.mFrequencyNumber & 0x300) | value);
+      updateChannel(channel);
+      break;
+
+    case 0xB0:
+      channel.mFrequencyNumber = static_cast<std::uint16_t>(
+        (channel.mFrequencyNumber & 0xFF) | ((value & 0x03) << 8));
+      channel.mBlock = (value >> 2) & 0x07;
+      updateChannel(channel);
+      setKeyOn(channel, (value & 0x20) != 0);
+      break;
+
+    case 0xC0:
+      channel.mFeedback = (value >> 1) & 0x07;
+      channel.mAdditive = (value & 0x01) != 0;
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+void FastOpl2::setKeyOn(Channel& channel, const bool keyOn) {
+  if (keyOn == channel.mKeyOn) {
+    return;
+  }
+
+  channel.mKeyOn = keyOn;
+
+  for (auto& op : channel.mOperators) {
+    if (keyOn) {
+      op.mStage = EnvelopeStage::Attack;
+      op.mPhase = 0;
+      op.mEnvelopeCounter = 0;
+
+      // The highest attack rates skip the attack phase entirely
+      const auto rate = effectiveRate(
+        op.mAttackRate, channel.mKeyScaleValue, op.mKeyScaleRateOn);
+      if (rate >= 60) {
+        op.mEnvelope = 0;
+        op.mStage = EnvelopeStage::Decay;
+      }
+    } else {
+      op.mStage = EnvelopeStage::Release;
+    }
+
+    updateEnvelopeRate(channel, op);
+  }
+}
+
+
+void FastOpl2::updateChannel(Channel& channel) {
+  const auto noteSelectBit = mNoteSelect
+    ? (channel.mFrequencyNumber >> 8) & 1
+    : (channel.mFrequencyNumber >> 9) & 1;
+  channel.mKeyScaleValue =
+    static_cast<std::uint8_t>((channel.mBlock << 1) | noteSelectBit);
+
+  for (auto& op : channel.mOperators) {
+    updatePhaseIncrements(channel, op);
+    updateBaseAttenuation(channel, op);
+    updateEnvelopeRate(channel, op);
+  }
+}
+
+
+void FastOpl2::updatePhaseIncrements(const Channel& channel, Operator& op) {
+  for (auto vibratoPosition = 0; vibratoPosition < 8; ++vibratoPosition) {
+    int frequencyNumber = channel.mFrequencyNumber;
+
+    if (op.mVibratoOn) {
+      auto range = (frequencyNumber >> 7) & 7;
+      if ((vibratoPosition & 3) == 0) {
+        range = 0;
+      } else if (vibratoPosition & 1) {
+        range >>= 1;
+      }
+      range >>= mVibratoShift;
+
+      frequencyNumber += (vibratoPosition & 4) ? -range : range;
+    }
+
+    const auto baseIncrement = (frequencyNumber << channel.mBlock) >> 1;
+    const auto nativeIncrement =
+      (baseIncrement * MULTIPLIERS[op.mMultiplier]) >> 1;
+    op.mPhaseIncrements[vibratoPosition] = static_cast<std::uint32_t>(
+      std::llround(nativeIncrement * mPhaseIncrementScale));
+  }
+}
+
+
+void FastOpl2::updateBaseAttenuation(const Channel& channel, Operator& op) {
+  const auto keyScaleLevel = std::max(
+    0,
+    (KEY_SCALE_LEVELS[channel.mFrequencyNumber >> 6] << 2) -
+      ((8 - channel.mBlock) << 5));
+  op.mBaseAttenuation = (op.mTotalLevel << 2) +
+    (keyScaleLevel >> KEY_SCALE_LEVEL_SHIFTS[op.mKeyScaleLevel]);
+}
+
+
+void FastOpl2::updateEnvelopeRate(const Channel& channel, Operator& op) {
+  if (
+    op.mStage == EnvelopeStage::Decay &&
+    (op.mEnvelope >> 4) >= op.mSustainLevel
+  ) {
+    op.mStage = EnvelopeStage::Sustain;
+  }
+
+  auto rateRegister = 0;
+  switch (op.mStage) {
+    case EnvelopeStage::Attack:
+      rateRegister = op.mAttackRate;
+      break;
+
+    case EnvelopeStage::Decay:
+      rateRegister = op.mDecayRate;
+      break;
+
+    case EnvelopeStage::Sustain:
+      rateRegister = op.mSustainOn ? 0 : op.mReleaseRate;
+      break;
+
+    case EnvelopeStage::Release:
+      rateRegister = op.mReleaseRate;
+      break;
+  }
+
+  const auto rate = effectiveRate(
+    rateRegister, channel.mKeyScaleValue, op.mKeyScaleRateOn);
+  const auto isFinished =
+    op.mStage != EnvelopeStage::Attack && op.mEnvelope == MAX_ATTENUATION;
+  if (rate == 0 || isFinished) {
+    op.mEnvelopeRate = 0;
+    return;
+  }
+
+  // The chip's envelope generator advances the envelope by (4 + rateLow)
+  // steps every 2^(15 - rateHigh) native samples, but by at most 4 steps per
+  // sample. We only care about the average rate.
+  const auto rateHigh = rate >> 2;
+  const auto rateLow = rate & 3;
+  const auto stepsPerNativeSample =
+    rateHigh == 15 ? 4.0 : std::ldexp(4 + rateLow, rateHigh - 15);
+  op.mEnvelopeRate = static_cast<std::uint32_t>(
+    std::lround(stepsPerNativeSample * mEnvelopeRateScale));
+}
+
+
+void FastOpl2::advanceEnvelope(
+  const Channel& channel,
+  Operator& op,
+  const int steps
+) {
+  switch (op.mStage) {
+    case EnvelopeStage::Attack:
+      // Attack is exponential, each step moves the envelope 1/8th closer
+      // to full volume
+      for (auto i = 0; i < steps && op.mEnvelope > 0; ++i) {
+        op.mEnvelope -= (op.mEnvelope >> 3) + 1;
+      }
+
+      if (op.mEnvelope <= 0) {
+        op.mEnvelope = 0;
+        op.mStage = EnvelopeStage::Decay;
+        updateEnvelopeRate(channel, op);
+      }
+      return;
+
+    case EnvelopeStage::Decay:
+      op.mEnvelope += steps;
+      if ((op.mEnvelope >> 4) >= op.mSustainLevel) {
+        updateEnvelopeRate(channel, op);
+      }
+      break;
+
+    case EnvelopeStage::Sustain:
+    case EnvelopeStage::Release:
+      op.mEnvelope += steps;
+      break;
+  }
+
+  // Like the actual chip, we go to silence directly once we're very close
+  if (op.mEnvelope >= 0x1F8) {
+    op.mEnvelope = MAX_ATTENUATION;
+    op.mEnvelopeRate = 0;
+  }
+}
+
+
+void FastOpl2::prepareBlock(const std::size_t numSamples) {
+  for (auto i = 0u; i < numSamples; ++i) {
+    mNativeTime += mNativeTicksPerSample;
+    const auto nativeTicks = mNativeTime >> 16;
+
+    // Tremolo is a triangle wave over 210 positions, advancing every 64
+    // native samples. Vibrato has 8 positions, advancing every 1024 samples.
+    const auto tremoloPosition = static_cast<int>((nativeTicks >> 6) % 210);
+    const auto tremoloLevel =
+      tremoloPosition < 105 ? tremoloPosition : 210 - tremoloPosition;
+    mTremoloValues[i] = static_cast<std::uint8_t>(tremoloLevel >> mTremoloShift);
+    mVibratoPositions[i] = static_cast<std::uint8_t>((nativeTicks >> 10) & 7);
+  }
+}
+
+
+void FastOpl2::computeVolumes(
+  const Channel& channel,
+  Operator& op,
+  std::int32_t* pVolumes,
+  const std::size_t numSamples
+) {
+  // With tremolo, attenuation changes every sample, so we first produce
+  // envelope values and convert them in a second pass. Otherwise, we can
+  // write volume factors directly.
+  const auto baseAttenuation = op.mBaseAttenuation;
+  const auto valueFor = [&](const std::int32_t envelope) {
+    return op.mTremoloOn
+      ? envelope
+      : VOLUME_TABLE[std::min(envelope + baseAttenuation, MAX_ATTENUATION)];
+  };
+
+  // The envelope changes only every couple of samples for most rates, so we
+  // fill in runs of constant values in between envelope steps.
+  auto i = std::size_t{0};
+  while (i < numSamples) {
+    const auto remaining = numSamples - i;
+    const auto rate = op.mEnvelopeRate;
+    const auto samplesUntilStep = rate != 0
+      ? (0x10000 - op.mEnvelopeCounter + rate - 1) / rate
+      : std::numeric_limits<std::uint32_t>::max();
+
+    if (samplesUntilStep > remaining) {
+      std::fill(pVolumes + i, pVolumes + numSamples, valueFor(op.mEnvelope));
+      op.mEnvelopeCounter += rate * static_cast<std::uint32_t>(remaining);
+      break;
+    }
+
+    std::fill(
+      pVolumes + i, pVolumes + i + samplesUntilStep - 1, valueFor(op.mEnvelope));
+    i += samplesUntilStep - 1;
+
+    op.mEnvelopeCounter += rate * samplesUntilStep;
+    const auto steps = static_cast<int>(op.mEnvelopeCounter >> 16);
+    op.mEnvelopeCounter &= 0xFFFF;
+    advanceEnvelope(channel, op, steps);
+
+    pVolumes[i] = valueFor(op.mEnvelope);
+    ++i;
+  }
+
+  if (op.mTremoloOn) {
+    for (i = 0; i < numSamples; ++i) {
+      pVolumes[i] = VOLUME_TABLE[std::min(
+        pVolumes[i] + baseAttenuation + mTremoloValues[i],
+        MAX_ATTENUATION)];
+    }
+  }
+}
+
+
+void FastOpl2::computePhases(
+  Operator& op,
+  std::uint32_t* pPhases,
+  const std::size_t numSamples
+) {
+  if (op.mVibratoOn) {
+    for (auto i = 0u; i < numSamples; ++i) {
+      pPhases[i] = op.mPhase >> 22;
+      op.mPhase += op.mPhaseIncrements[mVibratoPositions[i]];
+    }
+  } else {
+    const auto phase = op.mPhase;
+    const auto increment = op.mPhaseIncrements[0];
+    for (auto i = 0u; i < numSamples; ++i) {
+      pPhases[i] = (phase + static_cast<std::uint32_t>(i) * increment) >> 22;
+    }
+
+    op.mPhase += static_cast<std::uint32_t>(numSamples) * increment;
+  }
+}
+
+
+void FastOpl2::prepareChannel(
+  Channel& channel,
+  ChannelBlock& block,
+  const std::size_t numSamples
+) {
+  auto& modulator = channel.mOperators[0];
+  auto& carrier = channel.mOperators[1];
+
+  computeVolumes(channel, modulator, block.mModulatorVolumes.data(), numSamples);
+  computeVolumes(channel, carrier, block.mCarrierVolumes.data(), numSamples);
+  computePhases(modulator, block.mModulatorPhases.data(), numSamples);
+  computePhases(carrier, block.mCarrierPhases.data(), numSamples);
+}
+
+
+void FastOpl2::generateBlock(
+  std::int32_t* pDestination,
+  std::size_t numSamples
+) {
+  // Per-channel state needed during synthesis. Connection type and feedback
+  // are turned into bit masks, to avoid branches in the inner loop.
+  struct Voice {
+    Channel* mpChannel;
+    const std::int16_t* mpModulatorWaveform;
+    const std::int16_t* mpCarrierWaveform;
+    std::int32_t mPreviousOutput;
+    std::int32_t mOutput;
+    int mFeedbackShift;
+    std::int32_t mFeedbackMask;
+    std::int32_t mModulationMask;
+    std::int32_t mAdditiveMask;
+  };
+
+  const auto isSilent = [](const Channel& channel) {
+    return !channel.mKeyOn &&
+      std::all_of(
+        channel.mOperators.begin(),
+        channel.mOperators.end(),
+        [](const Operator& op) { return op.mEnvelope == MAX_ATTENUATION; });
+  };
+
+  while (numSamples > 0) {
+    const auto samplesForIteration = std::min(numSamples, BLOCK_SIZE);
+
+    prepareBlock(samplesForIteration);
+
+    // A silent channel stays at maximum attenuation until the next key on,
+    // which also resets the phase. Skipping it therefore makes no audible
+    // difference.
+    std::array<Voice, 9> voices;
+    auto numVoices = 0;
+    for (auto& channel : mChannels) {
+      auto& modulator = channel.mOperators[0];
+      auto& carrier = channel.mOperators[1];
+
+      if (isSilent(channel)) {
+        modulator.mOutput = 0;
+        modulator.mPreviousOutput = 0;
+        continue;
+      }
+
+      // Envelopes and phases don't depend on the operators' output, so we
+      // compute them for the whole block up front.
+      prepareChannel(channel, mChannelBlocks[numVoices], samplesForIteration);
+
+      voices[numVoices] = Voice{
+        &channel,
+        WAVEFORM_TABLES[mWaveformSelectOn ? modulator.mWaveform : 0].data(),
+        WAVEFORM_TABLES[mWaveformSelectOn ? carrier.mWaveform : 0].data(),
+        modulator.mPreviousOutput,
+        modulator.mOutput,
+        9 - channel.mFeedback,
+        channel.mFeedback ? -1 : 0,
+        channel.mAdditive ? 0 : -1,
+        channel.mAdditive ? -1 : 0};
+      ++numVoices;
+    }
+
+    // The modulator's feedback makes each sample depend on the previous one.
+    // By synthesizing all channels at once, we give the CPU independent work
+    // to do while waiting for the result of the previous sample.
+    for (auto i = 0u; i < samplesForIteration; ++i) {
+      auto sum = 0;
+
+      for (auto v = 0; v < numVoices; ++v) {
+        auto& voice = voices[v];
+        const auto& block = mChannelBlocks[v];
+
+        const auto feedback =
+          ((voice.mPreviousOutput + voice.mOutput) >> voice.mFeedbackShift) &
+          voice.mFeedbackMask;
+        voice.mPreviousOutput = voice.mOutput;
+        voice.mOutput = synthesize(
+          voice.mpModulatorWaveform,
+          block.mModulatorPhases[i] + static_cast<std::uint32_t>(feedback),
+          block.mModulatorVolumes[i]);
+
+        const auto modulation = voice.mOutput & voice.mModulationMask;
+        sum += synthesize(
+            voice.mpCarrierWaveform,
+            block.mCarrierPhases[i] + static_cast<std::uint32_t>(modulation),
+            block.mCarrierVolumes[i]) +
+          (voice.mOutput & voice.mAdditiveMask);
+      }
+
+      pDestination[i] = sum;
+    }
+
+    for (auto v = 0; v < numVoices; ++v) {
+      auto& modulator = voices[v].mpChannel->mOperators[0];
+      modulator.mPreviousOutput = voices[v].mPreviousOutput;
+      modulator.mOutput = voices[v].mOutput;
+    }
+
+    pDestination += samplesForIteration;
+    numSamples -= samplesForIteration;
+  }
+}
+
+}
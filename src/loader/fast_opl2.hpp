@@ -0,0 +1,157 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace rigel::loader {
+
+/** Reduced OPL2 emulator, covering what Duke Nukem II actually uses
+ *
+ * The game only ever uses the 9 two-operator melodic channels of the OPL2.
+ * This emulator implements exactly those: all four waveforms, feedback,
+ * FM and additive synthesis, envelopes with key scaling, tremolo and vibrato.
+ * Rhythm mode, CSM mode and the timers are not supported.
+ *
+ * Waveform generation uses the same log-sin and exponent tables as the real
+ * chip. Everything else is computed directly at the output sample rate:
+ * Phase is kept in fixed point, and envelopes advance at the average rate
+ * the chip's envelope generator would produce, instead of emulating its
+ * timer. Audio is rendered in blocks of samples: Envelopes and phases are
+ * computed up front for each channel, then all active channels are
+ * synthesized together, interleaved per sample. Channels which are
+ * completely silent are skipped.
+ *
+ * Compared to DBOPL (see AdlibEmulator), the output is not bit-exact, but
+ * differences are small. The emulator comparison tool in modding_tools can
+ * be used to measure them using the game's actual music and sound effects.
+ */
+class FastOpl2 {
+public:
+  explicit FastOpl2(int sampleRate);
+
+  void writeRegister(std::uint32_t reg, std::uint8_t value);
+
+  /** Render the given number of samples, overwriting the destination */
+  void generateBlock(std::int32_t* pDestination, std::size_t numSamples);
+
+private:
+  enum class EnvelopeStage : std::uint8_t {
+    Attack,
+    Decay,
+    Sustain,
+    Release
+  };
+
+  struct Operator {
+    // Register values
+    bool mTremoloOn = false;
+    bool mVibratoOn = false;
+    bool mSustainOn = false;
+    bool mKeyScaleRateOn = false;
+    std::uint8_t mMultiplier = 0;
+    std::uint8_t mKeyScaleLevel = 0;
+    std::uint8_t mTotalLevel = 0;
+    std::uint8_t mAttackRate = 0;
+    std::uint8_t mDecayRate = 0;
+    std::uint8_t mSustainLevel = 0;
+    std::uint8_t mReleaseRate = 0;
+    std::uint8_t mWaveform = 0;
+
+    // Derived from register values. Phase increments are indexed by
+    // vibrato position.
+    std::array<std::uint32_t, 8> mPhaseIncrements{};
+    std::int32_t mBaseAttenuation = 0;
+    std::uint32_t mEnvelopeRate = 0;
+
+    // State
+    std::uint32_t mPhase = 0;
+    std::uint32_t mEnvelopeCounter = 0;
+    std::int32_t mEnvelope = 0x1FF;
+    EnvelopeStage mStage = EnvelopeStage::Release;
+    std::int32_t mOutput = 0;
+    std::int32_t mPreviousOutput = 0;
+  };
+
+  struct Channel {
+    std::array<Operator, 2> mOperators;
+    std::uint16_t mFrequencyNumber = 0;
+    std::uint8_t mBlock = 0;
+    std::uint8_t mKeyScaleValue = 0;
+    std::uint8_t mFeedback = 0;
+    bool mAdditive = false;
+    bool mKeyOn = false;
+  };
+
+  static constexpr std::size_t BLOCK_SIZE = 128;
+
+  /** Envelope and phase values for one channel, for a block of samples */
+  struct ChannelBlock {
+    std::array<std::int32_t, BLOCK_SIZE> mModulatorVolumes;
+    std::array<std::int32_t, BLOCK_SIZE> mCarrierVolumes;
+    std::array<std::uint32_t, BLOCK_SIZE> mModulatorPhases;
+    std::array<std::uint32_t, BLOCK_SIZE> mCarrierPhases;
+  };
+
+  void writeOperatorRegister(std::uint32_t reg, std::uint8_t value);
+  void writeChannelRegister(std::uint32_t reg, std::uint8_t value);
+  void setKeyOn(Channel& channel, bool keyOn);
+
+  void updateChannel(Channel& channel);
+  void updatePhaseIncrements(const Channel& channel, Operator& op);
+  void updateBaseAttenuation(const Channel& channel, Operator& op);
+  void updateEnvelopeRate(const Channel& channel, Operator& op);
+  void advanceEnvelope(const Channel& channel, Operator& op, int steps);
+
+  void prepareBlock(std::size_t numSamples);
+  void computeVolumes(
+    const Channel& channel,
+    Operator& op,
+    std::int32_t* pVolumes,
+    std::size_t numSamples);
+  void computePhases(
+    Operator& op,
+    std::uint32_t* pPhases,
+    std::size_t numSamples);
+  void prepareChannel(
+    Channel& channel,
+    ChannelBlock& block,
+    std::size_t numSamples);
+
+  std::array<Channel, 9> mChannels;
+
+  int mSampleRate;
+  double mPhaseIncrementScale;
+  double mEnvelopeRateScale;
+  std::uint64_t mNativeTicksPerSample;
+  std::uint64_t mNativeTime = 0;
+
+  bool mWaveformSelectOn = false;
+  bool mNoteSelect = false;
+  int mTremoloShift = 4;
+  int mVibratoShift = 1;
+
+  // State for the block currently being rendered
+  std::array<std::uint8_t, BLOCK_SIZE> mTremoloValues;
+  std::array<std::uint8_t, BLOCK_SIZE> mVibratoPositions;
+  std::array<ChannelBlock, 9> mChannelBlocks;
+};
+
+}
@@ -21,14 +21,15 @@
 #include "base/math_tools.hpp"
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
-#include "loader/bitwise_iter.hpp"
-#include "loader/file_utils.hpp"
 #include "loader/resource_loader.hpp"
 #include "loader/rle_compression.hpp"
 
-#include <fstream>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <stdexcept>
 #include <string>
-#include <type_traits>
+#include <utility>
 
 
 /* Duke Nukem II level loader
@@ -79,54 +80,286 @@ data::map::TileIndex convertTileIndex(const uint16_t rawIndex) {
 }
 
 
-struct LevelHeader {
-  explicit LevelHeader(LeStreamReader& reader)
-    : dataOffset(reader.readU16())
-    , CZone(stripSpaces(readFixedSizeString(reader, 13)))
-    , backdrop(stripSpaces(readFixedSizeString(reader, 13)))
-    , music(stripSpaces(readFixedSizeString(reader, 13)))
-    , flags(reader.readU8())
-    , alternativeBackdropNumber(reader.readU8())
-    , unknown(reader.readU16())
-    , numActorWords(reader.readU16())
+constexpr auto LEVEL_HEADER_STRING_LENGTH = 13u;
+constexpr auto LEVEL_HEADER_SIZE = 2u + 3u*LEVEL_HEADER_STRING_LENGTH + 6u;
+
+// The extended format starts with a magic string instead of the data offset.
+// An original level file can't start with this, since the offset is always
+// followed by the CZone file name.
+constexpr char EXTENDED_LEVEL_MAGIC[] = "RIGELLVL";
+constexpr auto EXTENDED_LEVEL_MAGIC_LENGTH = sizeof(EXTENDED_LEVEL_MAGIC) - 1u;
+constexpr auto EXTENDED_LEVEL_FORMAT_VERSION = 1u;
+
+// Magic, version, strings, flags, alternative backdrop, then 32-bit width,
+// height, number of actors, tile data size and extra info size.
+constexpr auto EXTENDED_LEVEL_HEADER_SIZE =
+  EXTENDED_LEVEL_MAGIC_LENGTH + 2u + 3u*LEVEL_HEADER_STRING_LENGTH + 2u +
+  5u*4u;
+constexpr auto EXTENDED_LEVEL_DIMENSIONS_OFFSET =
+  EXTENDED_LEVEL_HEADER_SIZE - 5u*4u;
+
+// 16-bit actor ID, 32-bit x and y position
+constexpr auto EXTENDED_ACTOR_SIZE = 10u;
+
+// Upper limit for the number of tiles in an extended level, to reject
+// corrupt dimensions before allocating memory for them. This is 32 times
+// the size of the largest possible original level.
+constexpr auto MAX_EXTENDED_MAP_TILES = 32u * GameTraits::mapDataWords;
+
+// The uncompressed masked tile extra bits contain 2 bits for each tile, so
+// we need one byte to represent 4 tiles.
+constexpr auto MAX_EXTRA_MASKED_TILE_BYTES =
+  (GameTraits::mapDataWords + 3u) / 4u;
+
+using ExtraMaskedTileBits = std::array<uint8_t, MAX_EXTRA_MASKED_TILE_BYTES>;
+
+
+/** Bounds-checked little-endian reader which tracks its offset in the file
+ *
+ * Unlike LeStreamReader, this doesn't check each individual read. Instead,
+ * callers need to invoke require() before reading a section of data. This
+ * gives us more meaningful error messages, and faster decoding.
+ */
+class LevelDataReader {
+public:
+  explicit LevelDataReader(const ByteBuffer& data)
+    : mpData(data.data())
+    , mSize(data.size())
   {
   }
 
-  bool flagBitSet(const uint8_t bitMask) {
-    return (flags & bitMask) != 0;
+  void require(const size_t numBytes, const char* what) const {
+    if (remaining() < numBytes) {
+      throw LevelParseError(
+        string{"Unexpected end of data while reading "} + what, mOffset);
+    }
   }
 
-  const uint16_t dataOffset;
-  const string CZone;
-  const string backdrop;
-  const string music;
-  const uint8_t flags;
-  const uint8_t alternativeBackdropNumber;
-  const uint16_t unknown;
-  const uint16_t numActorWords;
+  uint8_t readU8() {
+    return mpData[mOffset++];
+  }
+
+  uint16_t readU16() {
+    const auto lsb = mpData[mOffset];
+    const auto msb = mpData[mOffset + 1];
+    mOffset += 2;
+    return uint16_t(lsb | (msb << 8));
+  }
+
+  uint32_t readU32() {
+    const auto lsw = readU16();
+    const auto msw = readU16();
+    return uint32_t(lsw) | (uint32_t(msw) << 16);
+  }
+
+  string readFixedSizeString(const size_t length) {
+    const auto pBegin = reinterpret_cast<const char*>(mpData + mOffset);
+    const auto pEnd = find(pBegin, pBegin + length, '\0');
+    mOffset += length;
+    return string(pBegin, pEnd);
+  }
+
+  size_t offset() const {
+    return mOffset;
+  }
+
+  size_t remaining() const {
+    return mSize - mOffset;
+  }
+
+  const uint8_t* current() const {
+    return mpData + mOffset;
+  }
+
+  void seek(const size_t offset) {
+    mOffset = offset;
+  }
+
+private:
+  const uint8_t* mpData;
+  size_t mSize;
+  size_t mOffset = 0;
 };
 
 
-ByteBuffer readExtraMaskedTileBits(const LeStreamReader& levelReader) {
-  LeStreamReader extraInfoReader(levelReader);
-  extraInfoReader.skipBytes(GameTraits::mapDataWords * sizeof(uint16_t));
-  const auto extraInfoSize = extraInfoReader.readU16();
+/** Decompresses an RLE compressed section of the given size
+ *
+ * Returns the number of decoded bytes, which can exceed the destination's
+ * capacity. Any data which doesn't fit is ignored. Leaves the reader
+ * positioned after the section's RLE terminator.
+ */
+size_t readRleSection(
+  LevelDataReader& reader,
+  const size_t sectionSize,
+  uint8_t* pDestination,
+  const size_t destinationCapacity,
+  const char* what
+) {
+  reader.require(sectionSize, what);
+
+  const auto sectionStart = reader.offset();
+  const auto sectionEnd = sectionStart + sectionSize;
+  const auto result = decompressRleInto(
+    reader.current(), sectionSize, pDestination, destinationCapacity);
+
+  switch (result.mStatus) {
+    case RleDecodingResult::Status::MissingTerminator:
+      throw LevelParseError(
+        string{"Missing RLE terminator in "} + what, sectionEnd);
 
-  LeStreamReader rleReader(
-    extraInfoReader.currentIter(),
-    extraInfoReader.currentIter() + extraInfoSize);
+    case RleDecodingResult::Status::TruncatedWord:
+      throw LevelParseError(
+        string{"RLE word exceeds section: "} + what,
+        sectionStart + result.mStopOffset);
 
-  ByteBuffer maskedTileOffsets;
-  // The uncompressed masked tile extra bits contain 2 bits for each tile, so
-  // we need one byte to represent 4 tiles.
-  maskedTileOffsets.reserve(
-    base::integerDivCeil<size_t>(GameTraits::mapDataWords, 4u));
+    case RleDecodingResult::Status::Ok:
+      break;
+  }
+
+  reader.seek(sectionStart + result.mStopOffset + 1);
+  return result.mDecodedSize;
+}
 
-  decompressRle(rleReader, [&maskedTileOffsets](const auto decoded) {
-    maskedTileOffsets.push_back(decoded);
-  });
 
-  return maskedTileOffsets;
+/** Decompresses the extra masked tile bits into the given array
+ *
+ * Returns the number of decoded bytes. Any data which would exceed the
+ * array's capacity is ignored.
+ */
+size_t readExtraMaskedTileBits(
+  LevelDataReader& reader,
+  ExtraMaskedTileBits& destination
+) {
+  reader.require(sizeof(uint16_t), "masked tile bits size");
+  const auto extraInfoSize = reader.readU16();
+
+  const auto decodedSize = readRleSection(
+    reader,
+    extraInfoSize,
+    destination.data(),
+    destination.size(),
+    "masked tile bits");
+  return min(decodedSize, destination.size());
+}
+
+
+/** Two additional bits per tile, extending the masked tile index
+ *
+ * Each byte holds the bits for 4 horizontally adjacent tiles.
+ */
+class MaskedTileBits {
+public:
+  MaskedTileBits(
+    const uint8_t* pData,
+    const size_t size,
+    const size_t bytesPerRow
+  )
+    : mpData(pData)
+    , mSize(size)
+    , mBytesPerRow(bytesPerRow)
+  {
+  }
+
+  std::optional<int> bitsAt(const int x, const int y) const {
+    const auto index = size_t(x/4) + size_t(y)*mBytesPerRow;
+    if (index >= mSize) {
+      return std::nullopt;
+    }
+
+    const auto indexInPack = x % 4;
+    return (mpData[index] >> indexInPack*2) & 0x03;
+  }
+
+private:
+  const uint8_t* mpData;
+  size_t mSize;
+  size_t mBytesPerRow;
+};
+
+
+/** Decodes a tile specification word into the map's two layers
+ *
+ * The offset is only used for error reporting.
+ */
+void decodeTileSpec(
+  data::map::Map& map,
+  const int x,
+  const int y,
+  const uint16_t tileSpec,
+  const MaskedTileBits& maskedTileBits,
+  const size_t tileOffset
+) {
+  if (tileSpec & 0x8000) {
+    // extended tile spec: separate indices for layers 0 and 1.
+    // 10 bits for solid, 5 for masked (the most significant bit serves
+    // as a marker to distinguish the complex and simple masked tile
+    // combination cases).
+    const auto extraBits = maskedTileBits.bitsAt(x, y);
+    if (!extraBits) {
+      throw LevelParseError(
+        "Missing masked tile bits for tile at " + to_string(x) + ", " +
+          to_string(y),
+        tileOffset);
+    }
+
+    const auto solidIndex = data::map::TileIndex(tileSpec & 0x3FF);
+    const auto maskedIndex = data::map::TileIndex(
+      (((tileSpec & 0x7C00) >> 10) | (*extraBits << 5)) +
+      GameTraits::CZone::numSolidTiles);
+
+    map.setTileAt(0, x, y, solidIndex);
+    map.setTileAt(1, x, y, maskedIndex);
+  } else {
+    const auto index = convertTileIndex(tileSpec);
+    if (index >= GameTraits::CZone::numTilesTotal) {
+      throw LevelParseError(
+        "Tile index " + to_string(index) + " out of range", tileOffset);
+    }
+
+    map.setTileAt(0, x, y, index);
+  }
+}
+
+
+/** Inverse of decodeTileSpec()
+ *
+ * Returns the tile specification word and the extra masked tile bits.
+ */
+pair<uint16_t, int> encodeTileSpec(
+  const data::map::Map& map,
+  const int x,
+  const int y
+) {
+  const auto solidIndex = map.tileAt(0, x, y);
+  const auto maskedIndex = map.tileAt(1, x, y);
+
+  if (maskedIndex == 0) {
+    const auto rawIndex = solidIndex < GameTraits::CZone::numSolidTiles
+      ? solidIndex
+      : (solidIndex - GameTraits::CZone::numSolidTiles) * 5u +
+          GameTraits::CZone::numSolidTiles;
+    return {uint16_t(rawIndex * 8u), 0};
+  }
+
+  // The tile spec has room for 5 bits of the masked index, plus the 2 extra
+  // bits
+  constexpr auto MAX_ENCODABLE_MASKED_INDEX =
+    GameTraits::CZone::numSolidTiles + (1u << 7u);
+
+  if (
+    solidIndex >= GameTraits::CZone::numSolidTiles ||
+    maskedIndex < GameTraits::CZone::numSolidTiles ||
+    maskedIndex >= MAX_ENCODABLE_MASKED_INDEX
+  ) {
+    throw invalid_argument(
+      "Unsupported tile combination at " + to_string(x) + ", " +
+      to_string(y));
+  }
+
+  const auto maskedPart = maskedIndex - GameTraits::CZone::numSolidTiles;
+  return {
+    uint16_t(0x8000 | solidIndex | ((maskedPart & 0x1F) << 10)),
+    int(maskedPart >> 5)};
 }
 
 
@@ -474,75 +707,357 @@ ActorList preProcessActorDescriptions(
   return actors;
 }
 
+
+LevelFileContents parseOriginalLevelContents(
+  const ByteBuffer& data,
+  const LevelFileHeader& header,
+  data::map::TileAttributeDict attributes
+) {
+  LevelDataReader reader(data);
+  reader.seek(LEVEL_HEADER_SIZE);
+
+  const auto numActors = header.mNumActorWords / 3u;
+  const auto actorListSize = numActors * 3u * sizeof(uint16_t);
+  reader.require(actorListSize, "actor list");
+
+  // The map's size is needed for validating actor positions, so we read it
+  // first
+  const auto widthOffset = LEVEL_HEADER_SIZE + actorListSize;
+  reader.seek(widthOffset);
+  reader.require(sizeof(uint16_t), "map width");
+  const auto width = static_cast<int>(reader.readU16());
+  if (width == 0 || size_t(width) > GameTraits::mapDataWords) {
+    throw LevelParseError(
+      "Invalid map width " + to_string(width), widthOffset);
+  }
+
+  const auto height = static_cast<int>(GameTraits::mapHeightForWidth(width));
+  const auto tileDataOffset = reader.offset();
+
+  reader.seek(LEVEL_HEADER_SIZE);
+
+  ActorList actors;
+  actors.reserve(numActors);
+  for (size_t i=0; i<numActors; ++i) {
+    const auto actorOffset = reader.offset();
+    const auto type = reader.readU16();
+    const auto x = reader.readU16();
+    const auto y = reader.readU16();
+    if (!isValidActorId(type)) {
+      continue;
+    }
+
+    if (x >= width || y >= height) {
+      throw LevelParseError("Actor position outside of map", actorOffset);
+    }
+
+    actors.emplace_back(LevelData::Actor{
+      base::Vector{x, y}, static_cast<ActorID>(type), std::nullopt});
+  }
+
+  // The extra masked tile bits are stored after the tile data, but are needed
+  // for decoding tiles. The tile data section always has the same size,
+  // independently of the map's dimensions.
+  reader.seek(tileDataOffset);
+  reader.require(GameTraits::mapDataWords * sizeof(uint16_t), "map data");
+  reader.seek(tileDataOffset + GameTraits::mapDataWords * sizeof(uint16_t));
+
+  ExtraMaskedTileBits maskedTileBitsData;
+  const auto numMaskedTileBytes =
+    readExtraMaskedTileBits(reader, maskedTileBitsData);
+  const auto maskedTileBits = MaskedTileBits{
+    maskedTileBitsData.data(), numMaskedTileBytes, size_t(width/4)};
+
+  reader.seek(tileDataOffset);
+
+  data::map::Map map(width, height, std::move(attributes));
+  for (int y=0; y<height; ++y) {
+    for (int x=0; x<width; ++x) {
+      const auto tileOffset = reader.offset();
+      decodeTileSpec(map, x, y, reader.readU16(), maskedTileBits, tileOffset);
+    }
+  }
+
+  return LevelFileContents{std::move(map), std::move(actors)};
 }
 
 
-LevelData loadLevel(
-  const string& mapName,
-  const ResourceLoader& resources,
-  const Difficulty chosenDifficulty
+/** Parses actor list and map data of an extended format level file
+ *
+ * Layout after the header:
+ *
+ *  - actor list: 16-bit ID, 32-bit x and y position per actor
+ *  - tile data: RLE compressed tile spec words, using the same encoding as
+ *    the original format. The words are split into two planes, first all
+ *    low bytes, then all high bytes. This makes the repetition in the data
+ *    visible to the byte-oriented RLE compression.
+ *  - extra info: RLE compressed masked tile bits, like in the original
+ *    format but with (width + 3) / 4 bytes per row.
+ *
+ * The sizes of all sections are given in the header.
+ */
+LevelFileContents parseExtendedLevelContents(
+  const ByteBuffer& data,
+  data::map::TileAttributeDict attributes
 ) {
-  const auto levelData = resources.file(mapName);
-  LeStreamReader levelReader(levelData);
+  LevelDataReader reader(data);
+  reader.require(EXTENDED_LEVEL_HEADER_SIZE, "header");
+  reader.seek(EXTENDED_LEVEL_DIMENSIONS_OFFSET);
+
+  const auto width = reader.readU32();
+  const auto height = reader.readU32();
+  const auto numActors = reader.readU32();
+  const auto tileDataSize = reader.readU32();
+  const auto extraInfoSize = reader.readU32();
+
+  if (
+    width == 0 || height == 0 ||
+    width > MAX_EXTENDED_MAP_TILES ||
+    height > MAX_EXTENDED_MAP_TILES / width
+  ) {
+    throw LevelParseError(
+      "Invalid map dimensions " + to_string(width) + "x" + to_string(height),
+      EXTENDED_LEVEL_DIMENSIONS_OFFSET);
+  }
+
+  // Checked before multiplying, since the actor list size could otherwise
+  // overflow on 32-bit platforms
+  if (numActors > reader.remaining() / EXTENDED_ACTOR_SIZE) {
+    throw LevelParseError(
+      "Unexpected end of data while reading actor list", reader.offset());
+  }
 
-  LevelHeader header(levelReader);
   ActorList actors;
-  for (size_t i=0; i<header.numActorWords/3; ++i) {
-    const auto type = levelReader.readU16();
-    const base::Vector position{levelReader.readU16(), levelReader.readU16()};
-    if (isValidActorId(type)) {
-      actors.emplace_back(LevelData::Actor{
-          position, static_cast<ActorID>(type), std::nullopt});
+  actors.reserve(numActors);
+  for (size_t i=0; i<numActors; ++i) {
+    const auto actorOffset = reader.offset();
+    const auto type = reader.readU16();
+    const auto x = reader.readU32();
+    const auto y = reader.readU32();
+    if (!isValidActorId(type)) {
+      continue;
+    }
+
+    if (x >= width || y >= height) {
+      throw LevelParseError("Actor position outside of map", actorOffset);
     }
+
+    actors.emplace_back(LevelData::Actor{
+      base::Vector{int(x), int(y)}, static_cast<ActorID>(type), std::nullopt});
   }
 
-  auto tileSet = resources.loadCZone(header.CZone);
+  const auto numTiles = size_t(width) * height;
+  const auto tileDataOffset = reader.offset();
+  ByteBuffer tileData(numTiles * sizeof(uint16_t));
+  const auto decodedTileDataSize = readRleSection(
+    reader, tileDataSize, tileData.data(), tileData.size(), "map data");
+  if (decodedTileDataSize != tileData.size()) {
+    throw LevelParseError(
+      "Map data size doesn't match map dimensions", tileDataOffset);
+  }
 
-  const auto width = static_cast<int>(levelReader.readU16());
-  const auto height = static_cast<int>(GameTraits::mapHeightForWidth(width));
-  data::map::Map map(width, height, std::move(tileSet.mAttributes));
+  const auto bytesPerRow = (size_t(width) + 3u) / 4u;
+  ByteBuffer maskedTileBitsData(bytesPerRow * height);
+  const auto numMaskedTileBytes = min(
+    readRleSection(
+      reader,
+      extraInfoSize,
+      maskedTileBitsData.data(),
+      maskedTileBitsData.size(),
+      "masked tile bits"),
+    maskedTileBitsData.size());
+  const auto maskedTileBits = MaskedTileBits{
+    maskedTileBitsData.data(), numMaskedTileBytes, bytesPerRow};
+
+  // Errors in the decompressed data can't be attributed to a specific
+  // position in the file, so they are reported at the start of the section.
+  const auto pLowBytes = tileData.data();
+  const auto pHighBytes = tileData.data() + numTiles;
+
+  data::map::Map map(int(width), int(height), std::move(attributes));
+  auto tileIndex = size_t{0};
+  for (int y=0; y<int(height); ++y) {
+    for (int x=0; x<int(width); ++x) {
+      const auto tileSpec =
+        uint16_t(pLowBytes[tileIndex] | (pHighBytes[tileIndex] << 8));
+      decodeTileSpec(map, x, y, tileSpec, maskedTileBits, tileDataOffset);
+      ++tileIndex;
+    }
+  }
 
-  const auto maskedTileOffsets = readExtraMaskedTileBits(levelReader);
-  auto lookupExtraMaskedTileBits = [&maskedTileOffsets, width, height](
-    const int x,
-    const int y
-  ) {
-    const auto index = x/4 + y*(width/4);
-    const auto extraBitPack = maskedTileOffsets.at(index);
+  return LevelFileContents{std::move(map), std::move(actors)};
+}
 
-    const auto indexInPack = x % 4;
-    const auto bitMask = 0x03 << indexInPack*2;
-    const auto extraBits = (extraBitPack & bitMask) >> indexInPack*2;
+}
 
-    return static_cast<uint8_t>(extraBits << 5);
-  };
 
-  LeStreamReader tileDataReader(
-    levelReader.currentIter(),
-    levelReader.currentIter() + width*height*sizeof(uint16_t));
-  for (int y=0; y<height; ++y) {
-    for (int x=0; x<width; ++x) {
-      const auto tileSpec = tileDataReader.readU16();
-
-      if (tileSpec & 0x8000) {
-        // extended tile spec: separate indices for layers 0 and 1.
-        // 10 bits for solid, 5 for masked (the most significant bit serves
-        // as a marker to distinguish the complex and simple masked tile
-        // combination cases).
-        const auto solidIndex = tileSpec & 0x3FF;
-        auto maskedIndex = ((tileSpec & 0x7C00) >> 10);
-        maskedIndex |= lookupExtraMaskedTileBits(x, y);
-        maskedIndex += GameTraits::CZone::numSolidTiles;
-
-        map.setTileAt(0, x, y, solidIndex);
-        map.setTileAt(1, x, y, maskedIndex);
-      } else {
-        const auto index = convertTileIndex(tileSpec);
-        map.setTileAt(0, x, y, index);
-      }
+LevelParseError::LevelParseError(
+  const std::string& message,
+  const std::size_t offset
+)
+  : std::runtime_error(
+      "Malformed level data at offset " + to_string(offset) + ": " + message)
+  , mOffset(offset)
+{
+}
+
+
+LevelFileHeader parseLevelHeader(const ByteBuffer& data) {
+  LevelDataReader reader(data);
+
+  const auto isExtendedFormat =
+    data.size() >= EXTENDED_LEVEL_MAGIC_LENGTH &&
+    equal(
+      data.begin(),
+      data.begin() + EXTENDED_LEVEL_MAGIC_LENGTH,
+      begin(EXTENDED_LEVEL_MAGIC));
+  if (isExtendedFormat) {
+    reader.require(EXTENDED_LEVEL_HEADER_SIZE, "header");
+    reader.seek(EXTENDED_LEVEL_MAGIC_LENGTH);
+
+    const auto version = reader.readU16();
+    if (version != EXTENDED_LEVEL_FORMAT_VERSION) {
+      throw LevelParseError(
+        "Unsupported extended level format version " + to_string(version),
+        EXTENDED_LEVEL_MAGIC_LENGTH);
+    }
+  } else {
+    reader.require(LEVEL_HEADER_SIZE, "header");
+    reader.readU16(); // data offset, unused
+  }
+
+  auto header = LevelFileHeader{};
+  header.mCZone =
+    stripSpaces(reader.readFixedSizeString(LEVEL_HEADER_STRING_LENGTH));
+  header.mBackdrop =
+    stripSpaces(reader.readFixedSizeString(LEVEL_HEADER_STRING_LENGTH));
+  header.mMusic =
+    stripSpaces(reader.readFixedSizeString(LEVEL_HEADER_STRING_LENGTH));
+  header.mFlags = reader.readU8();
+  header.mAlternativeBackdropNumber = reader.readU8();
+
+  if (isExtendedFormat) {
+    header.mFormat = LevelFileFormat::Extended;
+  } else {
+    reader.readU16(); // unknown
+    header.mNumActorWords = reader.readU16();
+  }
+
+  return header;
+}
+
+
+LevelFileContents parseLevelContents(
+  const ByteBuffer& data,
+  const LevelFileHeader& header,
+  data::map::TileAttributeDict attributes
+) {
+  if (header.mFormat == LevelFileFormat::Extended) {
+    return parseExtendedLevelContents(data, std::move(attributes));
+  }
+
+  return parseOriginalLevelContents(data, header, std::move(attributes));
+}
+
+
+ByteBuffer serializeExtendedLevel(
+  const LevelFileHeader& header,
+  const LevelFileContents& contents
+) {
+  const auto& map = contents.mMap;
+  const auto width = size_t(map.width());
+  const auto height = size_t(map.height());
+  const auto numTiles = width * height;
+  const auto bytesPerRow = (width + 3u) / 4u;
+
+  ByteBuffer tileData(numTiles * sizeof(uint16_t));
+  ByteBuffer maskedTileBitsData(bytesPerRow * height);
+  auto tileIndex = size_t{0};
+  for (int y=0; y<map.height(); ++y) {
+    for (int x=0; x<map.width(); ++x) {
+      const auto [tileSpec, extraBits] = encodeTileSpec(map, x, y);
+      tileData[tileIndex] = uint8_t(tileSpec & 0xFF);
+      tileData[tileIndex + numTiles] = uint8_t(tileSpec >> 8);
+      maskedTileBitsData[size_t(x/4) + y*bytesPerRow] |=
+        uint8_t(extraBits << (x % 4)*2);
+      ++tileIndex;
     }
   }
 
+  const auto compressedTileData =
+    compressRle(tileData.data(), tileData.size());
+  const auto compressedMaskedTileBits =
+    compressRle(maskedTileBitsData.data(), maskedTileBitsData.size());
+
+  ByteBuffer result;
+  result.reserve(
+    EXTENDED_LEVEL_HEADER_SIZE +
+    contents.mActors.size() * EXTENDED_ACTOR_SIZE +
+    compressedTileData.size() +
+    compressedMaskedTileBits.size());
+
+  auto writeU8 = [&](const uint32_t value) {
+    result.push_back(uint8_t(value & 0xFF));
+  };
+  auto writeU16 = [&](const uint32_t value) {
+    writeU8(value);
+    writeU8(value >> 8);
+  };
+  auto writeU32 = [&](const uint32_t value) {
+    writeU16(value);
+    writeU16(value >> 16);
+  };
+  auto writeString = [&](const string& str) {
+    for (auto i = 0u; i < LEVEL_HEADER_STRING_LENGTH; ++i) {
+      writeU8(i < str.size() ? uint8_t(str[i]) : 0u);
+    }
+  };
+
+  result.insert(
+    result.end(),
+    begin(EXTENDED_LEVEL_MAGIC),
+    begin(EXTENDED_LEVEL_MAGIC) + EXTENDED_LEVEL_MAGIC_LENGTH);
+  writeU16(EXTENDED_LEVEL_FORMAT_VERSION);
+  writeString(header.mCZone);
+  writeString(header.mBackdrop);
+  writeString(header.mMusic);
+  writeU8(header.mFlags);
+  writeU8(header.mAlternativeBackdropNumber);
+  writeU32(uint32_t(width));
+  writeU32(uint32_t(height));
+  writeU32(uint32_t(contents.mActors.size()));
+  writeU32(uint32_t(compressedTileData.size()));
+  writeU32(uint32_t(compressedMaskedTileBits.size()));
+
+  for (const auto& actor : contents.mActors) {
+    writeU16(static_cast<uint32_t>(actor.mID));
+    writeU32(uint32_t(actor.mPosition.x));
+    writeU32(uint32_t(actor.mPosition.y));
+  }
+
+  result.insert(
+    result.end(), compressedTileData.begin(), compressedTileData.end());
+  result.insert(
+    result.end(),
+    compressedMaskedTileBits.begin(),
+    compressedMaskedTileBits.end());
+
+  return result;
+}
+
+
+LevelData loadLevel(
+  const string& mapName,
+  const ResourceLoader& resources,
+  const Difficulty chosenDifficulty
+) {
+  const auto levelData = resources.file(mapName);
+  const auto header = parseLevelHeader(levelData);
+
+  auto tileSet = resources.loadCZone(header.mCZone);
+  auto contents =
+    parseLevelContents(levelData, header, std::move(tileSet.mAttributes));
+
   auto scrollMode = BackdropScrollMode::None;
   if (header.flagBitSet(0x1)) {
     scrollMode = BackdropScrollMode::ParallaxBoth;
@@ -566,24 +1081,24 @@ LevelData loadLevel(
     }
   }
 
-  auto backdropImage = resources.loadTiledFullscreenImage(header.backdrop);
+  auto backdropImage = resources.loadTiledFullscreenImage(header.mBackdrop);
   std::optional<data::Image> alternativeBackdropImage;
   if (header.flagBitSet(0x40) || header.flagBitSet(0x80)) {
     alternativeBackdropImage = resources.loadTiledFullscreenImage(
-      backdropNameFromNumber(header.alternativeBackdropNumber));
+      backdropNameFromNumber(header.mAlternativeBackdropNumber));
   }
-  auto actorDescriptions =
-      preProcessActorDescriptions(map, actors, chosenDifficulty);
+  auto actorDescriptions = preProcessActorDescriptions(
+    contents.mMap, contents.mActors, chosenDifficulty);
   return LevelData{
     std::move(tileSet.mTiles),
     std::move(backdropImage),
     std::move(alternativeBackdropImage),
-    std::move(map),
+    std::move(contents.mMap),
     std::move(actorDescriptions),
     scrollMode,
     backdropSwitchCondition,
     header.flagBitSet(0x20),
-    header.music
+    header.mMusic
   };
 }
 
@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -23,6 +26,7 @@
 #include "data/game_session_data.hpp"
 #include "data/map.hpp"
 #include "loader/actor_image_package.hpp"
+#include "loader/byte_buffer.hpp"
 
 
 namespace rigel::loader {
@@ -30,6 +34,93 @@ namespace rigel::loader {
 class ResourceLoader;
 
 
+/** Thrown when a level file contains malformed data
+ *
+ * Besides the human-readable message, this carries the position (in bytes,
+ * relative to the start of the file) at which the problem was detected.
+ */
+class LevelParseError : public std::runtime_error {
+public:
+  LevelParseError(const std::string& message, std::size_t offset);
+
+  std::size_t offset() const {
+    return mOffset;
+  }
+
+private:
+  std::size_t mOffset;
+};
+
+
+/** Container format of a level file
+ *
+ * Original is the format used by the DOS version, where the map data always
+ * has a size of GameTraits::mapDataWords. Extended is our own, versioned
+ * format which stores the map's width and height explicitly and compresses
+ * the map data, allowing for much larger levels.
+ */
+enum class LevelFileFormat {
+  Original,
+  Extended
+};
+
+
+struct LevelFileHeader {
+  bool flagBitSet(const std::uint8_t bitMask) const {
+    return (mFlags & bitMask) != 0;
+  }
+
+  std::string mCZone;
+  std::string mBackdrop;
+  std::string mMusic;
+  std::uint8_t mFlags = 0;
+  std::uint8_t mAlternativeBackdropNumber = 0;
+  LevelFileFormat mFormat = LevelFileFormat::Original;
+
+  // Only used by the original format
+  std::uint16_t mNumActorWords = 0;
+};
+
+
+struct LevelFileContents {
+  data::map::Map mMap;
+  data::map::ActorDescriptionList mActors;
+};
+
+
+/** Parse the header of a level file
+ *
+ * The header names the tile set (CZone) needed for parsing the rest of the
+ * file, see parseLevelContents(). Both the original and the extended format
+ * are recognized. Throws LevelParseError if the data is too short to contain
+ * a header, or uses an unsupported version of the extended format.
+ */
+LevelFileHeader parseLevelHeader(const ByteBuffer& data);
+
+/** Parse actor list and map data of a level file
+ *
+ * Tiles are decoded straight into the returned map, without going through
+ * any intermediate buffers. Actors with unknown IDs are skipped, no further
+ * processing of the actor list is done (see loadLevel()).
+ *
+ * Throws LevelParseError on malformed data.
+ */
+LevelFileContents parseLevelContents(
+  const ByteBuffer& data,
+  const LevelFileHeader& header,
+  data::map::TileAttributeDict attributes);
+
+/** Produce a level file in the extended format
+ *
+ * The format-specific parts of the header are ignored, and tile attributes
+ * are not stored. Throws std::invalid_argument if the map contains tile
+ * combinations which can't be represented in a level file.
+ */
+ByteBuffer serializeExtendedLevel(
+  const LevelFileHeader& header,
+  const LevelFileContents& contents);
+
+
 data::map::LevelData loadLevel(
   const std::string& mapName,
   const ResourceLoader& resources,
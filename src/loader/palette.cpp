@@ -20,6 +20,7 @@
 #include "loader/file_utils.hpp"
 
 #include <iostream>
+#include <utility>
 
 
 namespace rigel::loader {
@@ -108,4 +109,26 @@ Palette256 load6bitPalette256(
   });
 }
 
+
+
+data::Image applyPalette(
+  const data::IndexedImage& image,
+  const Palette16& palette
+) {
+  using data::IndexedImage;
+
+  data::PixelBuffer pixels;
+  pixels.reserve(image.pixelData().size());
+  for (const auto indexedPixel : image.pixelData()) {
+    auto color = palette[indexedPixel & IndexedImage::COLOR_INDEX_MASK];
+    if (indexedPixel & IndexedImage::MASKED_PIXEL_FLAG) {
+      color.a = 0;
+    }
+
+    pixels.push_back(color);
+  }
+
+  return data::Image(std::move(pixels), image.width(), image.height());
+}
+
 }
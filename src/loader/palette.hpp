@@ -47,4 +47,13 @@ inline Palette256 load6bitPalette256(const ByteBuffer& buffer) {
   return load6bitPalette256(buffer.begin(), buffer.end());
 }
 
+
+/** Convert indexed image to RGBA using the given palette
+ *
+ * Masked pixels get the color of their palette index, with alpha set to 0.
+ */
+data::Image applyPalette(
+  const data::IndexedImage& image,
+  const Palette16& palette);
+
 }
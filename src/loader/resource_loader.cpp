@@ -67,13 +67,69 @@ const auto FULL_SCREEN_IMAGE_DATA_SIZE =
 const auto ASSET_REPLACEMENTS_PATH = "asset_replacements";
 
 
+namespace {
+
+const auto FILE_PACKAGE_NAME = "NUKEM2.CMP";
+
+
+std::string replacementsPath(const std::string& gamePath) {
+  return gamePath + "/" + ASSET_REPLACEMENTS_PATH;
+}
+
+
+std::map<std::string, fs::file_time_type> scanReplacementImages(
+  const std::string& gamePath
+) {
+  std::map<std::string, fs::file_time_type> modificationTimesByName;
+
+  // A missing replacements directory is not an error, it just means that
+  // there are no replacements.
+  std::error_code error;
+  const auto path = fs::u8path(replacementsPath(gamePath));
+  for (const auto& entry : fs::directory_iterator(path, error)) {
+    if (entry.is_regular_file(error)) {
+      modificationTimesByName.emplace(
+        entry.path().filename().u8string(), entry.last_write_time(error));
+    }
+  }
+
+  return modificationTimesByName;
+}
+
+
+const char* introSoundFileName(const data::SoundId id) {
+  static const std::map<data::SoundId, const char*> INTRO_SOUND_MAP{
+    {data::SoundId::IntroGunShot, "INTRO3.MNI"},
+    {data::SoundId::IntroGunShotLow, "INTRO4.MNI"},
+    {data::SoundId::IntroEmptyShellsFalling, "INTRO5.MNI"},
+    {data::SoundId::IntroTargetMovingCloser, "INTRO6.MNI"},
+    {data::SoundId::IntroTargetStopsMoving, "INTRO7.MNI"},
+    {data::SoundId::IntroDukeSpeaks1, "INTRO8.MNI"},
+    {data::SoundId::IntroDukeSpeaks2, "INTRO9.MNI"}
+  };
+
+  const auto iIntroSound = INTRO_SOUND_MAP.find(id);
+  return iIntroSound != INTRO_SOUND_MAP.end() ? iIntroSound->second : nullptr;
+}
+
+
+std::string digitizedSoundFileName(const data::SoundId id) {
+  return string("SB_") + to_string(static_cast<int>(id) + 1) + ".MNI";
+}
+
+}
+
+
 ResourceLoader::ResourceLoader(const std::string& gamePath)
   : mGamePath(fs::u8path(gamePath))
-  , mFilePackage(gamePath + "NUKEM2.CMP")
+  , mReplacementStamps(scanReplacementImages(gamePath))
+  , mFilePackageModificationTime(
+      fs::last_write_time(fs::u8path(gamePath + FILE_PACKAGE_NAME)))
+  , mFilePackage(gamePath + FILE_PACKAGE_NAME)
   , mActorImagePackage(
       file(ActorImagePackage::IMAGE_DATA_FILE),
       file(ActorImagePackage::ACTOR_INFO_FILE),
-      gamePath + "/" + ASSET_REPLACEMENTS_PATH)
+      replacementsPath(gamePath))
   , mAdlibSoundsPackage(
       file(AudioPackage::AUDIO_DICT_FILE),
       file(AudioPackage::AUDIO_DATA_FILE))
@@ -171,7 +227,7 @@ TileSet ResourceLoader::loadCZone(const std::string& name) const {
     }
   }
 
-  Image fullImage(
+  IndexedImage fullImage(
     tilesToPixels(GameTraits::CZone::tileSetImageWidth),
     tilesToPixels(GameTraits::CZone::tileSetImageHeight));
 
@@ -180,17 +236,15 @@ TileSet ResourceLoader::loadCZone(const std::string& name) const {
   const auto maskedTilesBegin =
     tilesBegin + GameTraits::CZone::numSolidTiles*GameTraits::CZone::tileBytes;
 
-  const auto solidTilesImage = loadTiledImage(
+  const auto solidTilesImage = loadTiledIndexedImage(
     tilesBegin,
     maskedTilesBegin,
     GameTraits::CZone::tileSetImageWidth,
-    INGAME_PALETTE,
     T::Unmasked);
-  const auto maskedTilesImage = loadTiledImage(
+  const auto maskedTilesImage = loadTiledIndexedImage(
     maskedTilesBegin,
     data.end(),
     GameTraits::CZone::tileSetImageWidth,
-    INGAME_PALETTE,
     T::Masked);
   fullImage.insertImage(0, 0, solidTilesImage);
   fullImage.insertImage(
@@ -212,33 +266,39 @@ data::Song ResourceLoader::loadMusic(const std::string& name) const {
 }
 
 
-data::AudioBuffer ResourceLoader::loadSound(const data::SoundId id) const {
-  static const std::map<data::SoundId, const char*> INTRO_SOUND_MAP{
-    {data::SoundId::IntroGunShot, "INTRO3.MNI"},
-    {data::SoundId::IntroGunShotLow, "INTRO4.MNI"},
-    {data::SoundId::IntroEmptyShellsFalling, "INTRO5.MNI"},
-    {data::SoundId::IntroTargetMovingCloser, "INTRO6.MNI"},
-    {data::SoundId::IntroTargetStopsMoving, "INTRO7.MNI"},
-    {data::SoundId::IntroDukeSpeaks1, "INTRO8.MNI"},
-    {data::SoundId::IntroDukeSpeaks2, "INTRO9.MNI"}
-  };
-
-  const auto introSoundIter = INTRO_SOUND_MAP.find(id);
-
-  if (introSoundIter != INTRO_SOUND_MAP.end()) {
-    return loadSound(introSoundIter->second);
+data::AudioBuffer ResourceLoader::loadSound(
+  const data::SoundId id,
+  const int adlibSampleRate,
+  const data::AdlibEmulatorType adlibEmulatorType
+) const {
+  if (const auto introSoundFile = introSoundFileName(id)) {
+    return loadSound(introSoundFile);
   }
 
-  const auto digitizedSoundFileName =
-    string("SB_") + to_string(static_cast<int>(id) + 1) + ".MNI";
-  if (hasFile(digitizedSoundFileName)) {
-    return loadSound(digitizedSoundFileName);
+  const auto digitizedSoundFile = digitizedSoundFileName(id);
+  if (hasFile(digitizedSoundFile)) {
+    return loadSound(digitizedSoundFile);
   } else {
-    return mAdlibSoundsPackage.loadAdlibSound(id);
+    return mAdlibSoundsPackage.loadAdlibSound(
+      id, adlibSampleRate, adlibEmulatorType);
   }
 }
 
 
+std::vector<std::string> ResourceLoader::soundSourceFiles(
+  const data::SoundId id
+) const {
+  if (const auto introSoundFile = introSoundFileName(id)) {
+    return {introSoundFile};
+  }
+
+  return {
+    digitizedSoundFileName(id),
+    AudioPackage::AUDIO_DICT_FILE,
+    AudioPackage::AUDIO_DATA_FILE};
+}
+
+
 data::AudioBuffer ResourceLoader::loadSound(const std::string& name) const {
   return loader::decodeVoc(file(name));
 }
@@ -252,9 +312,8 @@ ScriptBundle ResourceLoader::loadScriptBundle(
 
 
 ByteBuffer ResourceLoader::file(const std::string& name) const {
-  const auto unpackedFilePath = mGamePath / fs::u8path(name);
-  if (fs::exists(unpackedFilePath)) {
-    return loadFile(unpackedFilePath);
+  if (recordFileAccess(name).mIsLooseFile) {
+    return loadFile(mGamePath / fs::u8path(name));
   }
 
   return mFilePackage.file(name);
@@ -266,8 +325,105 @@ std::string ResourceLoader::fileAsText(const std::string& name) const {
 }
 
 bool ResourceLoader::hasFile(const std::string& name) const {
-  const auto unpackedFilePath = mGamePath / fs::u8path(name);
-  return fs::exists(unpackedFilePath) || mFilePackage.hasFile(name);
+  return recordFileAccess(name).mIsLooseFile || mFilePackage.hasFile(name);
+}
+
+
+std::set<std::string> ResourceLoader::reload(const std::string& gamePath) {
+  const auto newGamePath = fs::u8path(gamePath);
+  const auto gamePathChanged = newGamePath != mGamePath;
+
+  const auto packageModificationTime =
+    fs::last_write_time(fs::u8path(gamePath + FILE_PACKAGE_NAME));
+  const auto packageChanged = gamePathChanged ||
+    packageModificationTime != mFilePackageModificationTime;
+
+  // Loading the package is the step most likely to fail (e.g. when switching
+  // to a path which doesn't contain game data), so do it before modifying
+  // any other state.
+  if (packageChanged) {
+    mFilePackage = CMPFilePackage{gamePath + FILE_PACKAGE_NAME};
+    mFilePackageModificationTime = packageModificationTime;
+  }
+
+  mGamePath = newGamePath;
+
+  std::set<std::string> changedFiles;
+  for (auto& [name, stamp] : mFileStamps) {
+    const auto previousStamp = stamp;
+    const auto currentStamp = recordFileAccess(name);
+
+    const auto hasChanged = gamePathChanged ||
+      currentStamp != previousStamp ||
+      (packageChanged && !currentStamp.mIsLooseFile);
+    if (hasChanged) {
+      changedFiles.insert(name);
+    }
+  }
+
+  auto replacementStamps = scanReplacementImages(gamePath);
+  const auto recordReplacementChange = [&](const auto& name) {
+    changedFiles.insert(string(ASSET_REPLACEMENTS_PATH) + "/" + name);
+  };
+
+  for (const auto& [name, modificationTime] : replacementStamps) {
+    const auto iPrevious = mReplacementStamps.find(name);
+    if (
+      iPrevious == mReplacementStamps.end() ||
+      iPrevious->second != modificationTime
+    ) {
+      recordReplacementChange(name);
+    }
+  }
+  for (const auto& [name, modificationTime] : mReplacementStamps) {
+    if (replacementStamps.count(name) == 0) {
+      recordReplacementChange(name);
+    }
+  }
+  mReplacementStamps = std::move(replacementStamps);
+
+  const auto anyChanged = [&](const auto&... names) {
+    return ((changedFiles.count(names) != 0) || ...);
+  };
+
+  if (
+    gamePathChanged ||
+    anyChanged(
+      ActorImagePackage::IMAGE_DATA_FILE,
+      ActorImagePackage::ACTOR_INFO_FILE)
+  ) {
+    mActorImagePackage = ActorImagePackage{
+      file(ActorImagePackage::IMAGE_DATA_FILE),
+      file(ActorImagePackage::ACTOR_INFO_FILE),
+      replacementsPath(gamePath)};
+  }
+
+  if (
+    anyChanged(AudioPackage::AUDIO_DICT_FILE, AudioPackage::AUDIO_DATA_FILE)
+  ) {
+    mAdlibSoundsPackage = AudioPackage{
+      file(AudioPackage::AUDIO_DICT_FILE),
+      file(AudioPackage::AUDIO_DATA_FILE)};
+  }
+
+  return changedFiles;
+}
+
+
+auto ResourceLoader::recordFileAccess(const std::string& name) const
+  -> FileStamp
+{
+  std::error_code error;
+  const auto looseFilePath = mGamePath / fs::u8path(name);
+
+  auto stamp = FileStamp{};
+  if (fs::exists(looseFilePath, error)) {
+    stamp.mIsLooseFile = true;
+    stamp.mModificationTime = fs::last_write_time(looseFilePath, error);
+  }
+
+  mFileStamps[name] = stamp;
+  return stamp;
 }
 
 }
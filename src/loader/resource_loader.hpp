@@ -28,14 +28,22 @@
 #include "loader/cmp_file_package.hpp"
 #include "loader/palette.hpp"
 
-#include <string>
 #include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 
 namespace rigel::loader {
 
+/** Tile set image and attributes
+ *
+ * The image is kept in indexed form, using the in-game palette.
+ */
 struct TileSet {
-  data::Image mTiles;
+  data::IndexedImage mTiles;
   data::map::TileAttributeDict mAttributes;
 };
 
@@ -61,7 +69,23 @@ public:
 
   data::AudioBuffer loadSound(const std::string& name) const;
 
-  data::AudioBuffer loadSound(data::SoundId id) const;
+  /** Load sound effect
+   *
+   * Digitized sounds are returned at their original sample rate. Sounds
+   * which only exist in Adlib format are rendered at the given rate, using
+   * the given emulator.
+   */
+  data::AudioBuffer loadSound(
+    data::SoundId id,
+    int adlibSampleRate,
+    data::AdlibEmulatorType adlibEmulatorType) const;
+
+  /** Names of the files which a sound effect can be loaded from
+   *
+   * Covers all candidates, i.e. a digitized version of the sound as well as
+   * the Adlib sound package, since the former takes priority if present.
+   */
+  std::vector<std::string> soundSourceFiles(data::SoundId id) const;
 
   ScriptBundle loadScriptBundle(const std::string& fileName) const;
 
@@ -69,8 +93,44 @@ public:
   std::string fileAsText(const std::string& name) const;
   bool hasFile(const std::string& name) const;
 
+  /** Re-open game data in place, and report which files have changed
+   *
+   * Every file which was accessed so far is checked against its current
+   * state on disk: Whether it's a loose file or comes from the CMP
+   * package, and its modification time. The CMP package, actor image
+   * package and Adlib sound package are only re-read if their sources
+   * changed.
+   *
+   * Returns the names of all changed files, so that the caller can
+   * re-decode whatever it created from them. Changed replacement images
+   * are reported with their path relative to the game path, e.g.
+   * "asset_replacements/actor159_frame0.png". Switching to a different game
+   * path marks everything as changed.
+   */
+  std::set<std::string> reload(const std::string& gamePath);
+
 private:
+  struct FileStamp {
+    bool operator==(const FileStamp& other) const {
+      return
+        mIsLooseFile == other.mIsLooseFile &&
+        mModificationTime == other.mModificationTime;
+    }
+
+    bool operator!=(const FileStamp& other) const {
+      return !(*this == other);
+    }
+
+    bool mIsLooseFile = false;
+    std::filesystem::file_time_type mModificationTime;
+  };
+
+  FileStamp recordFileAccess(const std::string& name) const;
+
   std::filesystem::path mGamePath;
+  mutable std::unordered_map<std::string, FileStamp> mFileStamps;
+  std::map<std::string, std::filesystem::file_time_type> mReplacementStamps;
+  std::filesystem::file_time_type mFilePackageModificationTime;
   loader::CMPFilePackage mFilePackage;
 
 public:
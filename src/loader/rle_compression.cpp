@@ -0,0 +1,137 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rle_compression.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+
+namespace rigel::loader {
+
+RleDecodingResult decompressRleInto(
+  const std::uint8_t* pSource,
+  const std::size_t sourceSize,
+  std::uint8_t* pDestination,
+  const std::size_t destinationCapacity
+) {
+  using Status = RleDecodingResult::Status;
+
+  auto offset = std::size_t{0};
+  auto decodedSize = std::size_t{0};
+
+  // Returns where to write the next count bytes of output, and how many of
+  // them fit into the destination
+  auto reserveOutput = [&](const std::size_t count) {
+    const auto start = decodedSize;
+    decodedSize += count;
+
+    if (start >= destinationCapacity) {
+      return std::pair{pDestination, std::size_t{0}};
+    }
+
+    return std::pair{
+      pDestination + start, std::min(count, destinationCapacity - start)};
+  };
+
+  while (offset < sourceSize) {
+    const auto markerOffset = offset;
+    const auto marker = static_cast<std::int8_t>(pSource[offset++]);
+
+    if (marker == 0) {
+      return {Status::Ok, markerOffset, decodedSize};
+    }
+
+    if (marker > 0) {
+      if (offset == sourceSize) {
+        return {Status::TruncatedWord, markerOffset, decodedSize};
+      }
+
+      const auto [pOutput, numBytes] =
+        reserveOutput(static_cast<std::size_t>(marker));
+      std::memset(pOutput, pSource[offset], numBytes);
+      ++offset;
+    } else {
+      const auto count = static_cast<std::size_t>(-marker);
+      if (sourceSize - offset < count) {
+        return {Status::TruncatedWord, markerOffset, decodedSize};
+      }
+
+      const auto [pOutput, numBytes] = reserveOutput(count);
+      std::memcpy(pOutput, pSource + offset, numBytes);
+      offset += count;
+    }
+  }
+
+  return {Status::MissingTerminator, sourceSize, decodedSize};
+}
+
+
+ByteBuffer compressRle(const std::uint8_t* pSource, const std::size_t size) {
+  constexpr auto MAX_RUN_LENGTH = std::size_t{127};
+  constexpr auto MAX_LITERAL_LENGTH = std::size_t{128};
+
+  // Runs shorter than this don't save anything compared to extending a
+  // literal span
+  constexpr auto MIN_RUN_LENGTH = std::size_t{3};
+
+  ByteBuffer result;
+  result.reserve(size / 4 + 1);
+
+  auto runLengthAt = [&](const std::size_t offset) {
+    const auto maxLength = std::min(MAX_RUN_LENGTH, size - offset);
+    auto length = std::size_t{1};
+    while (length < maxLength && pSource[offset + length] == pSource[offset]) {
+      ++length;
+    }
+    return length;
+  };
+
+  auto literalStart = std::size_t{0};
+  auto flushLiteral = [&](const std::size_t end) {
+    while (literalStart < end) {
+      const auto count = std::min(MAX_LITERAL_LENGTH, end - literalStart);
+      result.push_back(static_cast<std::uint8_t>(-static_cast<int>(count)));
+      result.insert(
+        result.end(),
+        pSource + literalStart,
+        pSource + literalStart + count);
+      literalStart += count;
+    }
+  };
+
+  auto offset = std::size_t{0};
+  while (offset < size) {
+    const auto runLength = runLengthAt(offset);
+    if (runLength < MIN_RUN_LENGTH) {
+      offset += runLength;
+      continue;
+    }
+
+    flushLiteral(offset);
+    result.push_back(static_cast<std::uint8_t>(runLength));
+    result.push_back(pSource[offset]);
+    offset += runLength;
+    literalStart = offset;
+  }
+
+  flushLiteral(size);
+  result.push_back(0);
+  return result;
+}
+
+}
@@ -16,8 +16,11 @@
 
 #pragma once
 
+#include "loader/byte_buffer.hpp"
 #include "loader/file_utils.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 
 
@@ -75,4 +78,46 @@ void decompressRle(
 }
 
 
+struct RleDecodingResult {
+  enum class Status {
+    Ok,
+    MissingTerminator,
+    TruncatedWord
+  };
+
+  Status mStatus;
+
+  /** Offset of the terminating 0 marker, or of the marker where decoding
+   * failed. For a missing terminator, this is the size of the input.
+   */
+  std::size_t mStopOffset;
+
+  /** Size of the decoded data, including bytes which didn't fit into the
+   * destination buffer.
+   */
+  std::size_t mDecodedSize;
+};
+
+
+/** Decompress RLE data with terminating 0 marker into a preallocated buffer
+ *
+ * Produces the same output as decompressRle(), but expands each run and
+ * copies each literal span as a whole instead of invoking a callback for
+ * every byte. Never reads past the end of the input. Output which exceeds
+ * the destination's capacity is discarded.
+ */
+RleDecodingResult decompressRleInto(
+  const std::uint8_t* pSource,
+  std::size_t sourceSize,
+  std::uint8_t* pDestination,
+  std::size_t destinationCapacity);
+
+
+/** Compress data into RLE format with terminating 0 marker
+ *
+ * The output can be decoded by decompressRle() and decompressRleInto().
+ * Repeated bytes are stored as runs, everything else as literal spans.
+ */
+ByteBuffer compressRle(const std::uint8_t* pSource, std::size_t size);
+
 }
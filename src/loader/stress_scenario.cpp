@@ -0,0 +1,356 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stress_scenario.hpp"
+
+#include "data/game_traits.hpp"
+#include "data/unit_conversions.hpp"
+
+#include <algorithm>
+#include <random>
+
+
+namespace rigel::loader {
+
+using data::ActorID;
+using data::GameTraits;
+using data::map::LevelData;
+
+
+namespace {
+
+constexpr auto PLATFORM_SPACING = 4;
+constexpr auto MIN_SEGMENT_LENGTH = 4;
+constexpr auto MAX_SEGMENT_LENGTH = 16;
+constexpr auto NUM_PLATFORM_TILE_VARIANTS = 32;
+constexpr auto WALL_TILE = data::map::TileIndex{1};
+
+constexpr auto NUM_PLACEHOLDER_FRAMES = 64;
+constexpr auto PLACEHOLDER_FRAME_SIZE = base::Extents{2, 2};
+
+// Highest ID in data::ActorID, plus one
+constexpr auto NUM_ACTOR_IDS =
+  static_cast<int>(ActorID::Rigelatin_soldier_projectile) + 1;
+
+
+/** Random number source which gives identical results on all platforms
+ *
+ * The standard library's distributions are implementation-defined, so we
+ * only rely on the raw output of the Mersenne Twister engine.
+ */
+class ScenarioRandom {
+public:
+  explicit ScenarioRandom(const std::uint32_t seed)
+    : mEngine(seed)
+  {
+  }
+
+  int next(const int min, const int max) {
+    const auto range = static_cast<std::uint32_t>(max - min + 1);
+    return min + static_cast<int>(nextRaw() % range);
+  }
+
+  bool chance(const float probability) {
+    return nextRaw() < probability * 4294967296.0;
+  }
+
+  template <typename T>
+  const T& pick(const std::vector<T>& items) {
+    return items[next(0, static_cast<int>(items.size()) - 1)];
+  }
+
+private:
+  std::uint32_t nextRaw() {
+    return static_cast<std::uint32_t>(mEngine());
+  }
+
+  std::mt19937 mEngine;
+};
+
+
+int actorCountFor(const float density, const base::Extents& mapSize) {
+  const auto numTiles = float(mapSize.width) * float(mapSize.height);
+  return static_cast<int>(density * numTiles / 1000.0f + 0.5f);
+}
+
+
+data::map::TileAttributeDict makeTileAttributes() {
+  // All solid tiles except for the empty tile block movement on all sides,
+  // masked tiles are purely decorative.
+  auto attributes = data::map::TileAttributeDict::AttributeArray(
+    GameTraits::CZone::numTilesTotal, 0);
+  std::fill(
+    attributes.begin() + 1,
+    attributes.begin() + GameTraits::CZone::numSolidTiles,
+    std::uint16_t{0x0F});
+  return data::map::TileAttributeDict{std::move(attributes)};
+}
+
+
+data::IndexedImage makePlaceholderTileSet() {
+  const auto width = data::tilesToPixels(GameTraits::CZone::tileSetImageWidth);
+  const auto height =
+    data::tilesToPixels(GameTraits::CZone::tileSetImageHeight);
+  const auto solidTilesHeight =
+    data::tilesToPixels(GameTraits::CZone::solidTilesImageHeight);
+
+  data::IndexedPixelBuffer pixels;
+  pixels.reserve(width * height);
+
+  for (auto y = 0; y < height; ++y) {
+    for (auto x = 0; x < width; ++x) {
+      const auto tileIndex =
+        data::pixelsToTiles(y) * GameTraits::CZone::tileSetImageWidth +
+        data::pixelsToTiles(x);
+      const auto isTileBorder =
+        x % GameTraits::tileSize == 0 || y % GameTraits::tileSize == 0;
+      const auto color = isTileBorder
+        ? data::IndexedPixel{0}
+        : data::IndexedPixel(1 + tileIndex % 15);
+
+      const auto isMaskedPixel = y >= solidTilesHeight && (x + y) % 2 == 0;
+      pixels.push_back(
+        isMaskedPixel ? data::IndexedImage::MASKED_PIXEL_FLAG : color);
+    }
+  }
+
+  return data::IndexedImage{std::move(pixels), size_t(width), size_t(height)};
+}
+
+
+data::Image makePlaceholderBackdrop() {
+  const auto width = GameTraits::viewPortWidthPx;
+  const auto height = GameTraits::viewPortHeightPx;
+
+  data::PixelBuffer pixels;
+  pixels.reserve(width * height);
+
+  for (auto y = 0; y < height; ++y) {
+    const auto shade = static_cast<std::uint8_t>(32 + y * 64 / height);
+    for (auto x = 0; x < width; ++x) {
+      pixels.push_back(data::Pixel{0, shade, std::uint8_t(shade * 2), 255});
+    }
+  }
+
+  return data::Image{std::move(pixels), size_t(width), size_t(height)};
+}
+
+
+class ScenarioBuilder {
+public:
+  explicit ScenarioBuilder(const StressScenarioParameters& parameters)
+    : mParameters(parameters)
+    , mRandom(parameters.mSeed)
+    , mMap(
+        std::max(parameters.mMapSize.width, MAX_SEGMENT_LENGTH),
+        std::max(parameters.mMapSize.height, PLATFORM_SPACING * 2),
+        makeTileAttributes())
+  {
+  }
+
+  void buildMap() {
+    const auto width = mMap.width();
+    const auto height = mMap.height();
+
+    for (auto y = 0; y < height; ++y) {
+      mMap.setTileAt(0, 0, y, WALL_TILE);
+      mMap.setTileAt(0, width - 1, y, WALL_TILE);
+    }
+    for (auto x = 0; x < width; ++x) {
+      mMap.setTileAt(0, x, height - 1, WALL_TILE);
+    }
+
+    // Platforms only appear on every PLATFORM_SPACING'th row, so they need
+    // to be denser than the overall density requested
+    const auto segmentProbability = std::min(
+      mParameters.mSolidTileDensity * PLATFORM_SPACING, 1.0f);
+
+    for (auto y = PLATFORM_SPACING; y < height - 1; y += PLATFORM_SPACING) {
+      mPlatformRows.push_back(y);
+
+      auto x = 1;
+      while (x < width - 1) {
+        const auto length =
+          mRandom.next(MIN_SEGMENT_LENGTH, MAX_SEGMENT_LENGTH);
+        const auto end = std::min(x + length, width - 1);
+
+        if (mRandom.chance(segmentProbability)) {
+          const auto tile = data::map::TileIndex(
+            mRandom.next(1, NUM_PLATFORM_TILE_VARIANTS));
+          for (auto col = x; col < end; ++col) {
+            mMap.setTileAt(0, col, y, tile);
+          }
+        }
+
+        x = end;
+      }
+    }
+
+    // Make sure the player has something to stand on
+    for (auto x = 1; x < MAX_SEGMENT_LENGTH / 2; ++x) {
+      mMap.setTileAt(0, x, PLATFORM_SPACING, WALL_TILE);
+    }
+
+    for (auto y = 0; y < height - 1; ++y) {
+      for (auto x = 1; x < width - 1; ++x) {
+        if (
+          mRandom.chance(mParameters.mMaskedTileDensity) &&
+          mMap.tileAt(0, x, y) == 0
+        ) {
+          mMap.setTileAt(1, x, y, data::map::TileIndex(
+            GameTraits::CZone::numSolidTiles +
+            mRandom.next(0, GameTraits::CZone::numMaskedTiles - 1)));
+        }
+      }
+    }
+  }
+
+  void placeActors() {
+    mActors.push_back(LevelData::Actor{
+      {2, PLATFORM_SPACING - 1}, ActorID::Duke_RIGHT, std::nullopt});
+
+    const auto mapSize = base::Extents{mMap.width(), mMap.height()};
+
+    if (!mParameters.mEnemyMix.empty()) {
+      const auto count = actorCountFor(mParameters.mEnemyDensity, mapSize);
+      for (auto i = 0; i < count; ++i) {
+        placeOnPlatform(mRandom.pick(mParameters.mEnemyMix));
+      }
+    }
+
+    if (!mParameters.mItemContainerMix.empty()) {
+      const auto count =
+        actorCountFor(mParameters.mItemContainerDensity, mapSize);
+      for (auto i = 0; i < count; ++i) {
+        placeOnPlatform(mRandom.pick(mParameters.mItemContainerMix));
+      }
+    }
+
+    const auto solidBodyTypes = std::vector<ActorID>{
+      ActorID::Rocket_elevator,
+      ActorID::Sliding_door_vertical,
+      ActorID::Sliding_door_horizontal
+    };
+    const auto numSolidBodies =
+      actorCountFor(mParameters.mSolidBodyDensity, mapSize);
+    for (auto i = 0; i < numSolidBodies; ++i) {
+      placeOnPlatform(mRandom.pick(solidBodyTypes));
+    }
+
+    const auto numWaterAreas =
+      actorCountFor(mParameters.mWaterAreaDensity, mapSize);
+    for (auto i = 0; i < numWaterAreas; ++i) {
+      placeWaterArea();
+    }
+  }
+
+  LevelData finish() {
+    return LevelData{
+      makePlaceholderTileSet(),
+      makePlaceholderBackdrop(),
+      std::nullopt,
+      std::move(mMap),
+      std::move(mActors),
+      data::map::BackdropScrollMode::None,
+      data::map::BackdropSwitchCondition::None,
+      false,
+      {}};
+  }
+
+private:
+  void placeOnPlatform(const ActorID id) {
+    const auto row = mRandom.pick(mPlatformRows);
+    const auto x = mRandom.next(1, mMap.width() - 2);
+    mActors.push_back(LevelData::Actor{{x, row - 1}, id, std::nullopt});
+  }
+
+  void placeWaterArea() {
+    // Water areas are made up of water actors covering 2 by 2 tiles each
+    const auto width = std::min(mRandom.next(4, 16) * 2, mMap.width() - 2);
+    const auto height = std::min(mRandom.next(2, 6) * 2, mMap.height() - 2);
+    const auto left = mRandom.next(1, mMap.width() - 1 - width);
+    const auto top = mRandom.next(0, mMap.height() - 1 - height);
+
+    for (auto y = top; y < top + height; y += 2) {
+      for (auto x = left; x < left + width; x += 2) {
+        mActors.push_back(
+          LevelData::Actor{{x, y}, ActorID::Water_body, std::nullopt});
+      }
+    }
+  }
+
+  const StressScenarioParameters& mParameters;
+  ScenarioRandom mRandom;
+  data::map::Map mMap;
+  std::vector<LevelData::Actor> mActors;
+  std::vector<int> mPlatformRows;
+};
+
+}
+
+
+data::map::LevelData generateStressScenario(
+  const StressScenarioParameters& parameters
+) {
+  ScenarioBuilder builder{parameters};
+  builder.buildMap();
+  builder.placeActors();
+  return builder.finish();
+}
+
+
+ActorImagePackage createPlaceholderActorImagePackage() {
+  using T = data::TileImageType;
+
+  // Each row of a masked tile consists of the mask, followed by the four
+  // color planes. This gives an opaque square in color 5.
+  const auto numFrameTiles =
+    PLACEHOLDER_FRAME_SIZE.width * PLACEHOLDER_FRAME_SIZE.height;
+  ByteBuffer imageData;
+  for (auto i = 0; i < numFrameTiles * GameTraits::tileSize; ++i) {
+    imageData.insert(imageData.end(), {0x00, 0xFF, 0x00, 0xFF, 0x00});
+  }
+  static_assert(GameTraits::bytesPerTile(T::Masked) == 5 * 8);
+
+  ByteBuffer actorInfo;
+  auto writeU16 = [&](const int value) {
+    actorInfo.push_back(std::uint8_t(value & 0xFF));
+    actorInfo.push_back(std::uint8_t((value >> 8) & 0xFF));
+  };
+
+  // All actors share the same entry, which follows the offset table. Offsets
+  // are given in words, the first one also determines the number of actors.
+  for (auto i = 0; i < NUM_ACTOR_IDS; ++i) {
+    writeU16(NUM_ACTOR_IDS);
+  }
+
+  writeU16(NUM_PLACEHOLDER_FRAMES);
+  writeU16(0); // draw index
+  for (auto frame = 0; frame < NUM_PLACEHOLDER_FRAMES; ++frame) {
+    writeU16(0); // draw offset x
+    writeU16(0); // draw offset y
+    writeU16(PLACEHOLDER_FRAME_SIZE.height);
+    writeU16(PLACEHOLDER_FRAME_SIZE.width);
+    writeU16(0); // image data offset, lower word
+    writeU16(0); // image data offset, upper word
+    writeU16(0); // padding
+    writeU16(0);
+  }
+
+  return ActorImagePackage{std::move(imageData), actorInfo};
+}
+
+}
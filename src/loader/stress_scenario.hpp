@@ -0,0 +1,108 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/spatial_types.hpp"
+#include "data/actor_ids.hpp"
+#include "data/map.hpp"
+#include "loader/actor_image_package.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+namespace rigel::loader {
+
+/** Parameters for generating a synthetic level
+ *
+ * Actor amounts are given as densities (number of actors per 1000 tiles), so
+ * that changing the map size alone produces a consistently populated level.
+ */
+struct StressScenarioParameters {
+  base::Extents mMapSize{256, 128};
+  std::uint32_t mSeed = 0;
+
+  /** Fraction of tiles covered by solid platforms */
+  float mSolidTileDensity = 0.1f;
+
+  /** Fraction of tiles with a masked (foreground layer) tile */
+  float mMaskedTileDensity = 0.02f;
+
+  float mEnemyDensity = 4.0f;
+  float mItemContainerDensity = 4.0f;
+
+  /** Elevators and sliding doors */
+  float mSolidBodyDensity = 0.5f;
+
+  /** Rectangular areas filled with water */
+  float mWaterAreaDensity = 0.05f;
+
+  /** Enemy types to choose from, with equal probability */
+  std::vector<data::ActorID> mEnemyMix = {
+    data::ActorID::Hoverbot,
+    data::ActorID::Watchbot,
+    data::ActorID::Skeleton,
+    data::ActorID::Spider,
+    data::ActorID::Blue_guard_RIGHT,
+    data::ActorID::Laser_turret,
+    data::ActorID::Rocket_launcher_turret,
+    data::ActorID::Snake,
+    data::ActorID::Wall_walker,
+    data::ActorID::Green_slime_blob,
+    data::ActorID::Unicycle_bot,
+    data::ActorID::Rigelatin_soldier
+  };
+
+  /** Item container types to choose from, with equal probability */
+  std::vector<data::ActorID> mItemContainerMix = {
+    data::ActorID::Red_box_cola,
+    data::ActorID::Red_box_turkey,
+    data::ActorID::Red_box_bomb,
+    data::ActorID::Green_box_laser,
+    data::ActorID::Green_box_rocket_launcher,
+    data::ActorID::Blue_box_health_molecule,
+    data::ActorID::Blue_box_camera,
+    data::ActorID::White_box_rapid_fire,
+    data::ActorID::Blue_box_empty
+  };
+};
+
+
+/** Generate a level for stress and scalability testing
+ *
+ * The level consists of horizontal platforms enclosed by solid walls, with
+ * actors distributed randomly on top of the platforms. The player is placed
+ * in the top-left corner. The same parameters always produce the same level,
+ * on all platforms.
+ *
+ * No game files are needed: the tile set and backdrop are placeholder
+ * images generated on the fly. Actor sprites can be provided by
+ * createPlaceholderActorImagePackage().
+ */
+data::map::LevelData generateStressScenario(
+  const StressScenarioParameters& parameters);
+
+
+/** Create an actor image package containing placeholder sprites
+ *
+ * Every actor ID has the same number of frames, each showing a filled square
+ * of 2 by 2 tiles. The frame count is high enough for all frames referenced
+ * by the game logic.
+ */
+ActorImagePackage createPlaceholderActorImagePackage();
+
+}
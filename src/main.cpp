@@ -137,6 +137,40 @@ int main(int argc, char** argv) {
     ("debug-mode,d",
      po::bool_switch(&config.mDebugModeEnabled),
      "Enable debugging features")
+    ("render-thread",
+     po::bool_switch(&config.mUseRenderThread),
+     "Execute OpenGL commands on a separate thread (experimental, might not "
+     "work on all platforms)")
+    ("texture-budget",
+     po::value<std::size_t>(),
+     "Maximum amount of GPU memory in MB to use for textures. Allocations "
+     "exceeding the budget are logged")
+    ("reject-over-budget-textures",
+     po::bool_switch(&config.mRejectTexturesOverBudget),
+     "Treat exceeding the texture budget as an error instead of only logging "
+     "it")
+    ("hitch-threshold",
+     po::value<float>(),
+     "Whenever a frame or game logic update takes longer than the given "
+     "number of milliseconds, write a report containing recent timings and "
+     "everything needed to replay the level up to that point")
+    ("replay-hitch",
+     po::value<std::string>(&config.mHitchReportToReplay),
+     "Replay the level captured in the given hitch report. Gameplay continues "
+     "normally afterwards, or pauses in single-step mode if debug mode is "
+     "enabled")
+    ("compare-with-options",
+     po::value<std::string>(&config.mComparisonOptionOverrides),
+     "To be used with 'replay-hitch'. Instead of replaying normally, run the "
+     "level twice side by side, once with the current options and once with "
+     "the given changes applied (JSON object using the profile's option "
+     "names, e.g. '{\"widescreenModeOn\": true}'). Checks that gameplay "
+     "stays identical, and prints a comparison of per-system timings")
+    ("exit-after-startup",
+     po::bool_switch(&config.mExitAfterStartup),
+     "Quit right after the first frame has been presented. Combined with the "
+     "startup timeline that's always printed, this allows measuring startup "
+     "time in an automated way")
     ("game-path",
      po::value<std::string>(&config.mGamePath)->default_value(""),
      "Path to original game's installation. Can also be given as positional "
@@ -189,6 +223,27 @@ int main(int argc, char** argv) {
         options["player-pos"].as<std::string>());
     }
 
+    if (options.count("texture-budget")) {
+      config.mTextureMemoryBudgetMb =
+        options["texture-budget"].as<std::size_t>();
+    }
+
+    if (options.count("hitch-threshold")) {
+      config.mHitchThresholdMs = options["hitch-threshold"].as<float>();
+    }
+
+    if (options.count("replay-hitch") && options.count("play-level")) {
+      throw std::invalid_argument(
+        "The replay-hitch and play-level options can't be combined");
+    }
+
+    if (
+      options.count("compare-with-options") && !options.count("replay-hitch")
+    ) {
+      throw std::invalid_argument(
+        "The compare-with-options option requires replay-hitch");
+    }
+
     if (!config.mGamePath.empty() && config.mGamePath.back() != '/') {
       config.mGamePath += "/";
     }
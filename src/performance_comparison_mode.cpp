@@ -0,0 +1,200 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "performance_comparison_mode.hpp"
+
+#include "common/game_service_provider.hpp"
+#include "game_logic/update_timings.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+
+namespace rigel {
+
+namespace {
+
+UserProfile withOptions(
+  const UserProfile& profile,
+  const data::GameOptions& options
+) {
+  auto result = profile;
+  result.mOptions = options;
+  return result;
+}
+
+
+GameMode::Context withProfile(
+  GameMode::Context context,
+  UserProfile* pProfile
+) {
+  context.mpUserProfile = pProfile;
+  return context;
+}
+
+
+double msSince(const std::chrono::high_resolution_clock::time_point start) {
+  using namespace std::chrono;
+  return duration<double, std::milli>(high_resolution_clock::now() - start)
+    .count();
+}
+
+}
+
+
+PerformanceComparisonMode::Instance::Instance(
+  const game_logic::LevelReplayData& replayData,
+  const data::GameOptions& options,
+  Context context
+)
+  : mProfile(withOptions(*context.mpUserProfile, options))
+  , mPlayerModel(replayData.mPlayerModelAtLevelStart)
+  , mWorld(
+      &mPlayerModel,
+      replayData.mSessionId,
+      withProfile(context, &mProfile),
+      replayData.mPlayerPositionOverride)
+{
+}
+
+
+PerformanceComparisonMode::PerformanceComparisonMode(
+  const game_logic::LevelReplayData& replayData,
+  const data::GameOptions& variantOptions,
+  Context context
+)
+  : mContext(context)
+  , mTicks(replayData.mTicks)
+  , mpBaseline(std::make_unique<Instance>(
+      replayData, context.mpUserProfile->mOptions, context))
+  , mpVariant(std::make_unique<Instance>(replayData, variantOptions, context))
+  , mComparison("baseline", "variant")
+{
+  std::cout << "Comparing performance over " << mTicks.size()
+    << " recorded updates\n";
+}
+
+
+std::unique_ptr<GameMode> PerformanceComparisonMode::updateAndRender(
+  engine::TimeDelta,
+  const std::vector<SDL_Event>&
+) {
+  if (mFinished) {
+    return nullptr;
+  }
+
+  auto endOfFrame = mNextTick;
+  while (endOfFrame < mTicks.size()) {
+    if (mTicks[endOfFrame++].mEndsFrame) {
+      break;
+    }
+  }
+
+  // Alternate which world goes first, so that neither one consistently
+  // benefits from caches warmed up by the other
+  if (mNumFramesCompared % 2 == 0) {
+    const auto baselineCost = runFrame(*mpBaseline, endOfFrame);
+    addSamples(baselineCost, runFrame(*mpVariant, endOfFrame));
+  } else {
+    const auto variantCost = runFrame(*mpVariant, endOfFrame);
+    addSamples(runFrame(*mpBaseline, endOfFrame), variantCost);
+  }
+
+  mNextTick = endOfFrame;
+  ++mNumFramesCompared;
+
+  const auto baselineState = mpBaseline->mWorld.gameplayState();
+  const auto variantState = mpVariant->mWorld.gameplayState();
+  if (baselineState != variantState) {
+    std::cout
+      << "Gameplay diverged after " << mNextTick << " updates:\n"
+      << "  baseline: " << baselineState << '\n'
+      << "  variant:  " << variantState << '\n';
+    finish();
+  } else if (
+    mNextTick == mTicks.size() || mpBaseline->mWorld.levelFinished()
+  ) {
+    std::cout << "Gameplay was identical for all compared updates\n";
+    finish();
+  }
+
+  return nullptr;
+}
+
+
+auto PerformanceComparisonMode::runFrame(
+  Instance& instance,
+  const std::size_t endOfFrame
+) -> FrameCost {
+  using std::chrono::high_resolution_clock;
+
+  FrameCost cost;
+
+  for (auto i = mNextTick; i < endOfFrame; ++i) {
+    const auto startOfUpdate = high_resolution_clock::now();
+    instance.mWorld.updateGameLogic(mTicks[i].mInput);
+    cost.mUpdateTimeMs += msSince(startOfUpdate);
+
+    const auto& stageTimes = instance.mWorld.lastUpdateTimings();
+    for (auto stage = 0u; stage < game_logic::NUM_UPDATE_STAGES; ++stage) {
+      cost.mStageTimesMs[stage] += stageTimes[stage];
+    }
+  }
+
+  // Submitting the batch makes sure that the cost of issuing the draw calls
+  // is attributed to the world which requested them
+  const auto startOfRender = high_resolution_clock::now();
+  instance.mWorld.render();
+  mContext.mpRenderer->submitBatch();
+  cost.mRenderTimeMs = msSince(startOfRender);
+
+  instance.mWorld.processEndOfFrameActions();
+
+  return cost;
+}
+
+
+void PerformanceComparisonMode::addSamples(
+  const FrameCost& baseline,
+  const FrameCost& variant
+) {
+  mComparison.addSamples(
+    "update", baseline.mUpdateTimeMs, variant.mUpdateTimeMs);
+
+  for (auto stage = 0u; stage < game_logic::NUM_UPDATE_STAGES; ++stage) {
+    const auto stageName =
+      game_logic::updateStageName(static_cast<game_logic::UpdateStage>(stage));
+    mComparison.addSamples(
+      std::string{"  "} + stageName,
+      baseline.mStageTimesMs[stage],
+      variant.mStageTimesMs[stage]);
+  }
+
+  mComparison.addSamples(
+    "render", baseline.mRenderTimeMs, variant.mRenderTimeMs);
+}
+
+
+void PerformanceComparisonMode::finish() {
+  std::cout << "Compared " << mNumFramesCompared << " frames\n";
+  mComparison.print(std::cout);
+
+  mContext.mpServiceProvider->scheduleGameQuit();
+  mFinished = true;
+}
+
+}
@@ -0,0 +1,91 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/game_mode.hpp"
+#include "common/timing_comparison.hpp"
+#include "common/user_profile.hpp"
+#include "data/player_model.hpp"
+#include "game_logic/game_world.hpp"
+#include "game_logic/hitch_recorder.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+namespace rigel {
+
+/** Runs a recorded level in two differently configured worlds side by side
+ *
+ * Both worlds are created from the same replay data (see
+ * game_logic::LevelReplayData), one using the current options, the other
+ * using the given variant options. They are then fed the recorded input in
+ * lockstep, one recorded frame at a time and as fast as possible. After
+ * each frame, their gameplay state is compared, and the time taken by each
+ * update stage and by rendering is recorded for both.
+ *
+ * Once the recording is exhausted, the level ends, or gameplay diverges, a
+ * comparison of the timings is printed and the game quits. Note that
+ * options which change the size of the view port, like widescreen mode,
+ * also change which enemies are active, and thus usually lead to diverging
+ * gameplay after a while.
+ */
+class PerformanceComparisonMode : public GameMode {
+public:
+  PerformanceComparisonMode(
+    const game_logic::LevelReplayData& replayData,
+    const data::GameOptions& variantOptions,
+    Context context);
+
+  std::unique_ptr<GameMode> updateAndRender(
+    engine::TimeDelta dt,
+    const std::vector<SDL_Event>& events) override;
+
+private:
+  struct Instance {
+    Instance(
+      const game_logic::LevelReplayData& replayData,
+      const data::GameOptions& options,
+      Context context);
+
+    UserProfile mProfile;
+    data::PlayerModel mPlayerModel;
+    game_logic::GameWorld mWorld;
+  };
+
+  struct FrameCost {
+    game_logic::UpdateStageTimings mStageTimesMs{};
+    double mUpdateTimeMs = 0.0;
+    double mRenderTimeMs = 0.0;
+  };
+
+  FrameCost runFrame(Instance& instance, std::size_t endOfFrame);
+  void addSamples(const FrameCost& baseline, const FrameCost& variant);
+  void finish();
+
+  Context mContext;
+  std::vector<game_logic::RecordedTick> mTicks;
+  std::unique_ptr<Instance> mpBaseline;
+  std::unique_ptr<Instance> mpVariant;
+  TimingComparison mComparison;
+  std::size_t mNextTick = 0;
+  std::size_t mNumFramesCompared = 0;
+  bool mFinished = false;
+};
+
+}
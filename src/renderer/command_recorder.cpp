@@ -0,0 +1,206 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "command_recorder.hpp"
+
+#include "base/match.hpp"
+
+#include <utility>
+
+
+namespace rigel::renderer {
+
+CommandRecorder::CommandRecorder(const RecordedState& initialState)
+  : mState(initialState)
+{
+}
+
+
+void CommandRecorder::setOverlayColor(const base::Color& color) {
+  mCommands.emplace_back(commands::SetOverlayColor{color});
+}
+
+
+void CommandRecorder::setColorModulation(const base::Color& colorModulation) {
+  mCommands.emplace_back(commands::SetColorModulation{colorModulation});
+}
+
+
+void CommandRecorder::drawTexture(
+  const Renderer::TextureData& textureData,
+  const base::Rect<int>& sourceRect,
+  const base::Rect<int>& destRect,
+  const bool repeat
+) {
+  mCommands.emplace_back(
+    commands::DrawTexture{textureData, sourceRect, destRect, repeat});
+}
+
+
+void CommandRecorder::drawRectangle(
+  const base::Rect<int>& rect,
+  const base::Color& color
+) {
+  mCommands.emplace_back(commands::DrawRectangle{rect, color});
+}
+
+
+void CommandRecorder::drawLine(
+  const base::Vector& start,
+  const base::Vector& end,
+  const base::Color& color
+) {
+  mCommands.emplace_back(commands::DrawLine{start, end, color});
+}
+
+
+void CommandRecorder::drawPoint(
+  const base::Vector& position,
+  const base::Color& color
+) {
+  mCommands.emplace_back(commands::DrawPoint{position, color});
+}
+
+
+void CommandRecorder::drawWaterEffect(
+  const base::Rect<int>& area,
+  const Renderer::TextureData& unprocessedScreen,
+  const std::optional<int> surfaceAnimationStep
+) {
+  mCommands.emplace_back(
+    commands::DrawWaterEffect{area, unprocessedScreen, surfaceAnimationStep});
+}
+
+
+void CommandRecorder::setGlobalTranslation(const base::Vector& translation) {
+  if (translation != mState.mGlobalTranslation) {
+    mState.mGlobalTranslation = translation;
+    mCommands.emplace_back(commands::SetGlobalTranslation{translation});
+  }
+}
+
+
+void CommandRecorder::setGlobalScale(const base::Point<float>& scale) {
+  if (scale != mState.mGlobalScale) {
+    mState.mGlobalScale = scale;
+    mCommands.emplace_back(commands::SetGlobalScale{scale});
+  }
+}
+
+
+void CommandRecorder::setClipRect(
+  const std::optional<base::Rect<int>>& clipRect
+) {
+  if (clipRect != mState.mClipRect) {
+    mState.mClipRect = clipRect;
+    mCommands.emplace_back(commands::SetClipRect{clipRect});
+  }
+}
+
+
+void CommandRecorder::setRenderTarget(const Renderer::RenderTarget& target) {
+  if (target.mFbo == mState.mRenderTarget.mFbo) {
+    return;
+  }
+
+  // Mirrors Renderer::setRenderTarget(): The size of the default render
+  // target is always the window size, regardless of what's passed in.
+  mState.mRenderTarget = target.isDefault()
+    ? Renderer::RenderTarget{mState.mWindowSize, 0}
+    : target;
+  mCommands.emplace_back(commands::SetRenderTarget{target});
+}
+
+
+void CommandRecorder::clear(const base::Color& clearColor) {
+  mCommands.emplace_back(commands::Clear{clearColor});
+}
+
+
+void CommandRecorder::submitBatch() {
+  mCommands.emplace_back(commands::SubmitBatch{});
+}
+
+
+void CommandRecorder::setDrawCommandReorderingEnabled(const bool enabled) {
+  mCommands.emplace_back(commands::SetDrawCommandReorderingEnabled{enabled});
+}
+
+
+void CommandRecorder::swapBuffers() {
+  mCommands.emplace_back(commands::SwapBuffers{});
+}
+
+
+void CommandRecorder::setRenderPhase(const RenderPhase phase) {
+  if (phase != mState.mRenderPhase) {
+    mState.mRenderPhase = phase;
+    mCommands.emplace_back(commands::SetRenderPhase{phase});
+  }
+}
+
+
+void CommandRecorder::addCustomCommand(std::function<void()> function) {
+  mCommands.emplace_back(commands::Custom{std::move(function)});
+}
+
+
+void CommandRecorder::setWindowSize(const base::Size<int>& size) {
+  mState.mWindowSize = size;
+
+  if (mState.mRenderTarget.isDefault()) {
+    mState.mRenderTarget.mSize = size;
+  }
+}
+
+
+void executeCommands(const CommandList& commands, Renderer& renderer) {
+  using namespace commands;
+
+  for (const auto& command : commands) {
+    base::match(command,
+      [&](const SetOverlayColor& c) { renderer.setOverlayColor(c.mColor); },
+      [&](const SetColorModulation& c) {
+        renderer.setColorModulation(c.mColor);
+      },
+      [&](const DrawTexture& c) {
+        renderer.drawTexture(c.mTexture, c.mSourceRect, c.mDestRect, c.mRepeat);
+      },
+      [&](const DrawRectangle& c) { renderer.drawRectangle(c.mRect, c.mColor); },
+      [&](const DrawLine& c) { renderer.drawLine(c.mStart, c.mEnd, c.mColor); },
+      [&](const DrawPoint& c) { renderer.drawPoint(c.mPosition, c.mColor); },
+      [&](const DrawWaterEffect& c) {
+        renderer.drawWaterEffect(
+          c.mArea, c.mUnprocessedScreen, c.mSurfaceAnimationStep);
+      },
+      [&](const SetGlobalTranslation& c) {
+        renderer.setGlobalTranslation(c.mTranslation);
+      },
+      [&](const SetGlobalScale& c) { renderer.setGlobalScale(c.mScale); },
+      [&](const SetClipRect& c) { renderer.setClipRect(c.mClipRect); },
+      [&](const SetRenderTarget& c) { renderer.setRenderTarget(c.mTarget); },
+      [&](const Clear& c) { renderer.clear(c.mColor); },
+      [&](const SubmitBatch&) { renderer.submitBatch(); },
+      [&](const SetDrawCommandReorderingEnabled& c) {
+        renderer.setDrawCommandReorderingEnabled(c.mEnabled);
+      },
+      [&](const SwapBuffers&) { renderer.swapBuffers(); },
+      [&](const SetRenderPhase& c) { renderer.setRenderPhase(c.mPhase); },
+      [&](const Custom& c) { c.mFunction(); });
+  }
+}
+
+}
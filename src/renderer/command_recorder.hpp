@@ -0,0 +1,225 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/color.hpp"
+#include "base/spatial_types.hpp"
+#include "renderer/renderer.hpp"
+
+#include <functional>
+#include <optional>
+#include <variant>
+#include <vector>
+
+
+namespace rigel::renderer {
+
+namespace commands {
+
+struct SetOverlayColor {
+  base::Color mColor;
+};
+
+struct SetColorModulation {
+  base::Color mColor;
+};
+
+struct DrawTexture {
+  Renderer::TextureData mTexture;
+  base::Rect<int> mSourceRect;
+  base::Rect<int> mDestRect;
+  bool mRepeat;
+};
+
+struct DrawRectangle {
+  base::Rect<int> mRect;
+  base::Color mColor;
+};
+
+struct DrawLine {
+  base::Vector mStart;
+  base::Vector mEnd;
+  base::Color mColor;
+};
+
+struct DrawPoint {
+  base::Vector mPosition;
+  base::Color mColor;
+};
+
+struct DrawWaterEffect {
+  base::Rect<int> mArea;
+  Renderer::TextureData mUnprocessedScreen;
+  std::optional<int> mSurfaceAnimationStep;
+};
+
+struct SetGlobalTranslation {
+  base::Vector mTranslation;
+};
+
+struct SetGlobalScale {
+  base::Point<float> mScale;
+};
+
+struct SetClipRect {
+  std::optional<base::Rect<int>> mClipRect;
+};
+
+struct SetRenderTarget {
+  Renderer::RenderTarget mTarget;
+};
+
+struct Clear {
+  base::Color mColor;
+};
+
+struct SubmitBatch {};
+
+struct SetDrawCommandReorderingEnabled {
+  bool mEnabled;
+};
+
+struct SwapBuffers {};
+
+struct SetRenderPhase {
+  RenderPhase mPhase;
+};
+
+/** Arbitrary function to be invoked with the GL context current
+ *
+ * Used for things which don't fit the regular renderer API, like deleting
+ * textures or drawing the debug UI.
+ */
+struct Custom {
+  std::function<void()> mFunction;
+};
+
+}
+
+
+using RenderCommand = std::variant<
+  commands::SetOverlayColor,
+  commands::SetColorModulation,
+  commands::DrawTexture,
+  commands::DrawRectangle,
+  commands::DrawLine,
+  commands::DrawPoint,
+  commands::DrawWaterEffect,
+  commands::SetGlobalTranslation,
+  commands::SetGlobalScale,
+  commands::SetClipRect,
+  commands::SetRenderTarget,
+  commands::Clear,
+  commands::SubmitBatch,
+  commands::SetDrawCommandReorderingEnabled,
+  commands::SwapBuffers,
+  commands::SetRenderPhase,
+  commands::Custom>;
+
+using CommandList = std::vector<RenderCommand>;
+
+
+/** Renderer state which can be queried while recording */
+struct RecordedState {
+  base::Size<int> mWindowSize;
+  Renderer::RenderTarget mRenderTarget;
+  std::optional<base::Rect<int>> mClipRect;
+  base::Vector mGlobalTranslation;
+  base::Point<float> mGlobalScale{1.0f, 1.0f};
+  RenderPhase mRenderPhase = RenderPhase::Other;
+};
+
+
+/** Records renderer commands into a CommandList without touching OpenGL
+ *
+ * Offers the same drawing and state interface as the Renderer. State
+ * changes are tracked, so that queries like clipRect() or
+ * currentRenderTarget() return the same values that the Renderer would
+ * return at the corresponding point when executing the commands. Redundant
+ * state changes are not recorded.
+ */
+class CommandRecorder {
+public:
+  explicit CommandRecorder(const RecordedState& initialState);
+
+  void setOverlayColor(const base::Color& color);
+  void setColorModulation(const base::Color& colorModulation);
+
+  void drawTexture(
+    const Renderer::TextureData& textureData,
+    const base::Rect<int>& sourceRect,
+    const base::Rect<int>& destRect,
+    bool repeat);
+  void drawRectangle(const base::Rect<int>& rect, const base::Color& color);
+  void drawLine(
+    const base::Vector& start,
+    const base::Vector& end,
+    const base::Color& color);
+  void drawPoint(const base::Vector& position, const base::Color& color);
+  void drawWaterEffect(
+    const base::Rect<int>& area,
+    const Renderer::TextureData& unprocessedScreen,
+    std::optional<int> surfaceAnimationStep);
+
+  void setGlobalTranslation(const base::Vector& translation);
+  void setGlobalScale(const base::Point<float>& scale);
+  void setClipRect(const std::optional<base::Rect<int>>& clipRect);
+  void setRenderTarget(const Renderer::RenderTarget& target);
+
+  void clear(const base::Color& clearColor);
+  void submitBatch();
+  void setDrawCommandReorderingEnabled(bool enabled);
+  void swapBuffers();
+  void setRenderPhase(RenderPhase phase);
+  void addCustomCommand(std::function<void()> function);
+
+  /** Update the window size used for the default render target
+   *
+   * Should be called at the beginning of a frame, since the Renderer only
+   * picks up window size changes when swapping buffers.
+   */
+  void setWindowSize(const base::Size<int>& size);
+
+  const RecordedState& state() const {
+    return mState;
+  }
+
+  base::Rect<int> fullScreenRect() const {
+    return {{0, 0}, mState.mRenderTarget.mSize};
+  }
+
+  CommandList& commands() {
+    return mCommands;
+  }
+
+  const CommandList& commands() const {
+    return mCommands;
+  }
+
+private:
+  RecordedState mState;
+  CommandList mCommands;
+};
+
+
+/** Execute all commands in the given list using the given renderer
+ *
+ * Must be called on the thread which owns the renderer's GL context.
+ */
+void executeCommands(const CommandList& commands, Renderer& renderer);
+
+}
@@ -0,0 +1,153 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "draw_command_reordering.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+
+namespace rigel::renderer {
+
+namespace {
+
+// Limits how far back we look for a group to add a command to. This keeps
+// the cost of reordering linear in the number of commands, even for frames
+// with lots of different textures.
+constexpr auto MAX_GROUPS_TO_SEARCH = 64;
+
+
+struct Group {
+  int mStateId;
+  int mFirstCommand;
+  int mLastCommand;
+  base::Rect<int> mBounds;
+};
+
+
+bool overlap(const base::Rect<int>& lhs, const base::Rect<int>& rhs) {
+  return
+    lhs.topLeft.x < rhs.topLeft.x + rhs.size.width &&
+    rhs.topLeft.x < lhs.topLeft.x + lhs.size.width &&
+    lhs.topLeft.y < rhs.topLeft.y + rhs.size.height &&
+    rhs.topLeft.y < lhs.topLeft.y + lhs.size.height;
+}
+
+
+base::Rect<int> unite(const base::Rect<int>& lhs, const base::Rect<int>& rhs) {
+  const auto left = std::min(lhs.topLeft.x, rhs.topLeft.x);
+  const auto top = std::min(lhs.topLeft.y, rhs.topLeft.y);
+  const auto right = std::max(
+    lhs.topLeft.x + lhs.size.width, rhs.topLeft.x + rhs.size.width);
+  const auto bottom = std::max(
+    lhs.topLeft.y + lhs.size.height, rhs.topLeft.y + rhs.size.height);
+  return {{left, top}, {right - left, bottom - top}};
+}
+
+}
+
+
+int determineReorderedSequence(
+  const std::vector<ReorderableCommand>& commands,
+  std::vector<int>& order
+) {
+  const auto numCommands = static_cast<int>(commands.size());
+
+  // Commands in a group form a linked list, so that we don't need to
+  // allocate a separate container for each group
+  std::vector<Group> groups;
+  std::vector<int> nextInGroup(commands.size(), -1);
+
+  const auto overlapsAnyIn = [&](const Group& group, const int commandIndex) {
+    const auto& rect = commands[commandIndex].mDestRect;
+    if (!overlap(group.mBounds, rect)) {
+      return false;
+    }
+
+    for (auto i = group.mFirstCommand; i != -1; i = nextInGroup[i]) {
+      if (overlap(commands[i].mDestRect, rect)) {
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  for (auto i = 0; i < numCommands; ++i) {
+    const auto& command = commands[i];
+
+    // Walk backwards through the groups, looking for one with the same
+    // state. Stop as soon as we find a group containing a command which
+    // overlaps the current one, since we can't move the current command in
+    // front of that.
+    auto targetGroup = -1;
+    const auto lastGroupToSearch =
+      std::max(0, static_cast<int>(groups.size()) - MAX_GROUPS_TO_SEARCH);
+    for (
+      auto groupIndex = static_cast<int>(groups.size()) - 1;
+      groupIndex >= lastGroupToSearch;
+      --groupIndex
+    ) {
+      const auto& group = groups[groupIndex];
+      if (group.mStateId == command.mStateId) {
+        targetGroup = groupIndex;
+        break;
+      }
+
+      if (overlapsAnyIn(group, i)) {
+        break;
+      }
+    }
+
+    if (targetGroup == -1) {
+      groups.push_back(Group{command.mStateId, i, i, command.mDestRect});
+    } else {
+      auto& group = groups[targetGroup];
+      nextInGroup[group.mLastCommand] = i;
+      group.mLastCommand = i;
+      group.mBounds = unite(group.mBounds, command.mDestRect);
+    }
+  }
+
+  order.clear();
+  order.reserve(commands.size());
+  for (const auto& group : groups) {
+    for (auto i = group.mFirstCommand; i != -1; i = nextInGroup[i]) {
+      order.push_back(i);
+    }
+  }
+
+  assert(order.size() == commands.size());
+  return static_cast<int>(groups.size());
+}
+
+
+int countBatches(const std::vector<ReorderableCommand>& commands) {
+  if (commands.empty()) {
+    return 0;
+  }
+
+  auto numBatches = 1;
+  for (auto i = 1u; i < commands.size(); ++i) {
+    if (commands[i].mStateId != commands[i - 1].mStateId) {
+      ++numBatches;
+    }
+  }
+
+  return numBatches;
+}
+
+}
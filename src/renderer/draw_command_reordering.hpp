@@ -0,0 +1,56 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/spatial_types.hpp"
+
+#include <vector>
+
+
+namespace rigel::renderer {
+
+/** Draw command as seen by the reordering algorithm
+ *
+ * Commands with the same state id can be drawn with a single batch, as long
+ * as they end up adjacent to each other in the final order.
+ */
+struct ReorderableCommand {
+  int mStateId;
+  base::Rect<int> mDestRect;
+};
+
+
+/** Determine an order for drawing the given commands with fewer batches
+ *
+ * Commands are grouped by state id, so that commands with identical state
+ * can be drawn in one batch. A command is only moved in front of another one
+ * if their destination rectangles don't overlap, so the painter's order is
+ * kept wherever it's relevant for the result.
+ *
+ * The resulting order is written to `order`, as a list of indices into
+ * `commands`. Returns the number of batches needed for drawing the commands
+ * in that order, i.e. the number of state changes plus one.
+ */
+int determineReorderedSequence(
+  const std::vector<ReorderableCommand>& commands,
+  std::vector<int>& order);
+
+
+/** Returns number of batches needed to draw commands in the given order */
+int countBatches(const std::vector<ReorderableCommand>& commands);
+
+}
@@ -25,6 +25,63 @@ RIGEL_RESTORE_WARNINGS
 #include <stdexcept>
 
 
+namespace {
+
+template <typename FuncT>
+FuncT loadOptionalFunction(const char* name) {
+  return reinterpret_cast<FuncT>(SDL_GL_GetProcAddress(name));
+}
+
+
+// APIENTRY has been undefined by opengl.hpp at this point, see there
+#if defined(_WIN32)
+  #define RIGEL_NULL_GL_CALL __stdcall
+#else
+  #define RIGEL_NULL_GL_CALL
+#endif
+
+GLuint gNextNullGlName = 1;
+
+template <typename ResultT, typename... Args>
+ResultT RIGEL_NULL_GL_CALL nullGlFunction(Args...) {
+  return ResultT();
+}
+
+
+template <typename ResultT, typename... Args>
+void installNullGlFunction(ResultT (RIGEL_NULL_GL_CALL*& pFunction)(Args...)) {
+  pFunction = &nullGlFunction<ResultT, Args...>;
+}
+
+
+void RIGEL_NULL_GL_CALL nullGlGenNames(const GLsizei count, GLuint* pNames) {
+  for (GLsizei i = 0; i < count; ++i) {
+    pNames[i] = gNextNullGlName++;
+  }
+}
+
+
+GLuint RIGEL_NULL_GL_CALL nullGlCreateShader(GLenum) {
+  return gNextNullGlName++;
+}
+
+
+GLuint RIGEL_NULL_GL_CALL nullGlCreateProgram() {
+  return gNextNullGlName++;
+}
+
+
+void RIGEL_NULL_GL_CALL nullGlGetStatus(
+  GLuint,
+  const GLenum parameter,
+  GLint* pValue
+) {
+  *pValue = parameter == GL_INFO_LOG_LENGTH ? 0 : GL_TRUE;
+}
+
+}
+
+
 void rigel::renderer::loadGlFunctions() {
   int result = 0;
 #ifdef RIGEL_USE_GL_ES
@@ -41,3 +98,103 @@ void rigel::renderer::loadGlFunctions() {
     throw std::runtime_error("Failed to load OpenGL function pointers");
   }
 }
+
+
+void rigel::renderer::loadNullGlFunctions() {
+  installNullGlFunction(glad_glActiveTexture);
+  installNullGlFunction(glad_glAttachShader);
+  installNullGlFunction(glad_glBindAttribLocation);
+  installNullGlFunction(glad_glBindBuffer);
+  installNullGlFunction(glad_glBindFramebuffer);
+  installNullGlFunction(glad_glBindTexture);
+  installNullGlFunction(glad_glBlendFunc);
+  installNullGlFunction(glad_glBufferData);
+  installNullGlFunction(glad_glClear);
+  installNullGlFunction(glad_glClearColor);
+  installNullGlFunction(glad_glCompileShader);
+  installNullGlFunction(glad_glDeleteBuffers);
+  installNullGlFunction(glad_glDeleteFramebuffers);
+  installNullGlFunction(glad_glDeleteProgram);
+  installNullGlFunction(glad_glDeleteShader);
+  installNullGlFunction(glad_glDeleteTextures);
+  installNullGlFunction(glad_glDisable);
+  installNullGlFunction(glad_glDisableVertexAttribArray);
+  installNullGlFunction(glad_glDrawArrays);
+  installNullGlFunction(glad_glDrawElements);
+  installNullGlFunction(glad_glEnable);
+  installNullGlFunction(glad_glEnableVertexAttribArray);
+  installNullGlFunction(glad_glFramebufferTexture2D);
+  installNullGlFunction(glad_glGetProgramInfoLog);
+  installNullGlFunction(glad_glGetShaderInfoLog);
+  installNullGlFunction(glad_glGetUniformLocation);
+  installNullGlFunction(glad_glLinkProgram);
+  installNullGlFunction(glad_glPixelStorei);
+  installNullGlFunction(glad_glScissor);
+  installNullGlFunction(glad_glShaderSource);
+  installNullGlFunction(glad_glTexImage2D);
+  installNullGlFunction(glad_glTexParameteri);
+  installNullGlFunction(glad_glUniform1f);
+  installNullGlFunction(glad_glUniform1i);
+  installNullGlFunction(glad_glUniform2fv);
+  installNullGlFunction(glad_glUniform3fv);
+  installNullGlFunction(glad_glUniform4fv);
+  installNullGlFunction(glad_glUniformMatrix4fv);
+  installNullGlFunction(glad_glUseProgram);
+  installNullGlFunction(glad_glVertexAttribPointer);
+  installNullGlFunction(glad_glViewport);
+
+  glad_glGenBuffers = nullGlGenNames;
+  glad_glGenFramebuffers = nullGlGenNames;
+  glad_glGenTextures = nullGlGenNames;
+  glad_glCreateShader = nullGlCreateShader;
+  glad_glCreateProgram = nullGlCreateProgram;
+  glad_glGetShaderiv = nullGlGetStatus;
+  glad_glGetProgramiv = nullGlGetStatus;
+
+#ifndef RIGEL_USE_GL_ES
+  installNullGlFunction(glad_glBindVertexArray);
+  installNullGlFunction(glad_glDeleteVertexArrays);
+  glad_glGenVertexArrays = nullGlGenNames;
+#endif
+}
+
+
+auto rigel::renderer::loadInstancingFunctions()
+  -> std::optional<InstancingFunctions>
+{
+#ifdef RIGEL_USE_GL_ES
+  return std::nullopt;
+#else
+  auto functions = InstancingFunctions{};
+
+  const auto hasVersion3_3 =
+    GLVersion.major > 3 || (GLVersion.major == 3 && GLVersion.minor >= 3);
+  if (hasVersion3_3) {
+    functions = InstancingFunctions{
+      loadOptionalFunction<DrawArraysInstancedFunc>("glDrawArraysInstanced"),
+      loadOptionalFunction<VertexAttribDivisorFunc>("glVertexAttribDivisor")};
+  } else if (SDL_GL_ExtensionSupported("GL_ARB_instanced_arrays")) {
+    // glDrawArraysInstanced is core since 3.1. On a 3.0 context, we need the
+    // corresponding extension as well.
+    const auto hasCoreDrawInstanced =
+      GLVersion.major == 3 && GLVersion.minor >= 1;
+    if (
+      hasCoreDrawInstanced ||
+      SDL_GL_ExtensionSupported("GL_ARB_draw_instanced")
+    ) {
+      functions = InstancingFunctions{
+        loadOptionalFunction<DrawArraysInstancedFunc>(
+          hasCoreDrawInstanced
+            ? "glDrawArraysInstanced" : "glDrawArraysInstancedARB"),
+        loadOptionalFunction<VertexAttribDivisorFunc>(
+          "glVertexAttribDivisorARB")};
+    }
+  }
+
+  if (!functions.mDrawArraysInstanced || !functions.mVertexAttribDivisor) {
+    return std::nullopt;
+  }
+
+  return functions;
+#endif
+}
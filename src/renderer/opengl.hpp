@@ -22,6 +22,22 @@ RIGEL_DISABLE_WARNINGS
 #include <glad/glad.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <optional>
+
+
+namespace rigel::renderer {
+
+// Instanced drawing is not part of OpenGL 3.0, which is what our function
+// loader targets. The corresponding entry points are therefore declared here
+// and loaded separately, see loadInstancingFunctions(). This needs to happen
+// before APIENTRY is undefined below.
+using DrawArraysInstancedFunc =
+  void (APIENTRYP)(GLenum mode, GLint first, GLsizei count, GLsizei instances);
+using VertexAttribDivisorFunc =
+  void (APIENTRYP)(GLuint index, GLuint divisor);
+
+}
+
 #ifdef APIENTRY
 #undef APIENTRY
 #endif
@@ -31,4 +47,28 @@ namespace rigel::renderer {
 
 void loadGlFunctions();
 
+/** Install no-op implementations of the OpenGL functions used by the renderer
+ *
+ * Makes it possible to use a Renderer without an OpenGL context, e.g. for
+ * checking rendering statistics in tests. Functions creating objects hand out
+ * unique names, and shaders always compile and link successfully. Instancing
+ * is not available with these functions.
+ */
+void loadNullGlFunctions();
+
+
+struct InstancingFunctions {
+  DrawArraysInstancedFunc mDrawArraysInstanced;
+  VertexAttribDivisorFunc mVertexAttribDivisor;
+};
+
+/** Load entry points for instanced drawing, if the current context has them
+ *
+ * Instancing is available with OpenGL 3.3, or on older versions via the
+ * ARB_instanced_arrays extension. Returns nothing if that's not the case,
+ * which is always true for OpenGL ES 2 (and WebGL 1). Must be called after
+ * loadGlFunctions().
+ */
+std::optional<InstancingFunctions> loadInstancingFunctions();
+
 }
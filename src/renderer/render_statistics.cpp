@@ -0,0 +1,91 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "render_statistics.hpp"
+
+#include <numeric>
+
+
+namespace rigel::renderer {
+
+const char* renderPhaseName(const RenderPhase phase) {
+  switch (phase) {
+    case RenderPhase::Other: return "Other";
+    case RenderPhase::Backdrop: return "Backdrop";
+    case RenderPhase::MapLayers: return "Map layers";
+    case RenderPhase::Sprites: return "Sprites";
+    case RenderPhase::WaterEffects: return "Water";
+    case RenderPhase::Particles: return "Particles";
+    case RenderPhase::Hud: return "HUD";
+    case RenderPhase::Menus: return "Menus";
+  }
+
+  return "";
+}
+
+
+const char* flushReasonName(const FlushReason reason) {
+  switch (reason) {
+    case FlushReason::Explicit: return "Explicit";
+    case FlushReason::BatchFull: return "Batch full";
+    case FlushReason::RenderModeChange: return "Mode change";
+    case FlushReason::TextureChange: return "Texture";
+    case FlushReason::TextureRepeatChange: return "Repeat";
+    case FlushReason::TextureSizeChange: return "Texture size";
+    case FlushReason::OverlayColorChange: return "Overlay color";
+    case FlushReason::ColorModulationChange: return "Color mod";
+    case FlushReason::GlobalTransformChange: return "Transform";
+    case FlushReason::ClipRectChange: return "Clip rect";
+    case FlushReason::RenderTargetChange: return "Render target";
+    case FlushReason::TextureDestroyed: return "Texture destroyed";
+    case FlushReason::Clear: return "Clear";
+    case FlushReason::SwapBuffers: return "Swap";
+  }
+
+  return "";
+}
+
+
+int RenderStatistics::totalFlushes() const {
+  return std::accumulate(mFlushesByReason.begin(), mFlushesByReason.end(), 0);
+}
+
+
+RenderStatistics& RenderStatistics::operator+=(const RenderStatistics& other) {
+  mDrawCalls += other.mDrawCalls;
+  mVertices += other.mVertices;
+  mTextureBinds += other.mTextureBinds;
+  mUniformUpdates += other.mUniformUpdates;
+  mRenderTargetSwitches += other.mRenderTargetSwitches;
+
+  for (auto i = 0; i < NUM_FLUSH_REASONS; ++i) {
+    mFlushesByReason[i] += other.mFlushesByReason[i];
+  }
+
+  return *this;
+}
+
+
+RenderStatistics FrameStatistics::total() const {
+  auto result = RenderStatistics{};
+  for (const auto& phaseStatistics : mPhases) {
+    result += phaseStatistics;
+  }
+
+  return result;
+}
+
+}
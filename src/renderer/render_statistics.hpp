@@ -0,0 +1,106 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+
+
+namespace rigel::renderer {
+
+/** Part of a frame which rendering statistics are attributed to
+ *
+ * Used for finding out which part of the game is responsible for how much
+ * rendering work. See Renderer::setRenderPhase().
+ */
+enum class RenderPhase {
+  Other,
+  Backdrop,
+  MapLayers,
+  Sprites,
+  WaterEffects,
+  Particles,
+  Hud,
+  Menus
+};
+
+constexpr auto NUM_RENDER_PHASES = static_cast<int>(RenderPhase::Menus) + 1;
+
+
+/** Cause of a batch being submitted to the GPU */
+enum class FlushReason {
+  Explicit,
+  BatchFull,
+  RenderModeChange,
+  TextureChange,
+  TextureRepeatChange,
+  TextureSizeChange,
+  OverlayColorChange,
+  ColorModulationChange,
+  GlobalTransformChange,
+  ClipRectChange,
+  RenderTargetChange,
+  TextureDestroyed,
+  Clear,
+  SwapBuffers
+};
+
+constexpr auto NUM_FLUSH_REASONS = static_cast<int>(FlushReason::SwapBuffers) + 1;
+
+
+const char* renderPhaseName(RenderPhase phase);
+const char* flushReasonName(FlushReason reason);
+
+
+/** Amount of work done by the renderer */
+struct RenderStatistics {
+  int mDrawCalls = 0;
+  int mVertices = 0;
+  int mTextureBinds = 0;
+  int mUniformUpdates = 0;
+  int mRenderTargetSwitches = 0;
+  std::array<int, NUM_FLUSH_REASONS> mFlushesByReason{};
+
+  int& flushes(const FlushReason reason) {
+    return mFlushesByReason[static_cast<int>(reason)];
+  }
+
+  int flushes(const FlushReason reason) const {
+    return mFlushesByReason[static_cast<int>(reason)];
+  }
+
+  int totalFlushes() const;
+
+  RenderStatistics& operator+=(const RenderStatistics& other);
+};
+
+
+/** Rendering statistics for one frame, broken down by render phase */
+struct FrameStatistics {
+  std::array<RenderStatistics, NUM_RENDER_PHASES> mPhases;
+
+  RenderStatistics& operator[](const RenderPhase phase) {
+    return mPhases[static_cast<int>(phase)];
+  }
+
+  const RenderStatistics& operator[](const RenderPhase phase) const {
+    return mPhases[static_cast<int>(phase)];
+  }
+
+  RenderStatistics total() const;
+};
+
+}
@@ -0,0 +1,136 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "render_thread.hpp"
+
+#include <utility>
+
+
+namespace rigel::renderer {
+
+RenderThread::RenderThread(
+  std::function<void()> onStart,
+  Executor executor,
+  std::function<void()> onStop
+)
+  : mOnStart(std::move(onStart))
+  , mExecutor(std::move(executor))
+  , mOnStop(std::move(onStop))
+  , mThread([this]() { run(); })
+{
+}
+
+
+RenderThread::~RenderThread() {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopRequested = true;
+  }
+
+  mCondition.notify_all();
+  mThread.join();
+}
+
+
+void RenderThread::submitFrame(CommandList& commands) {
+  {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]() { return !mHasFrame; });
+    rethrowPendingError();
+
+    // mFrame now holds the list of the previously executed frame, which is
+    // recycled for recording the next one.
+    std::swap(commands, mFrame);
+    mHasFrame = true;
+  }
+
+  mCondition.notify_all();
+  commands.clear();
+}
+
+
+void RenderThread::invoke(const std::function<void()>& function) {
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCondition.wait(lock, [this]() { return mpTask == nullptr; });
+
+  mpTask = &function;
+  mCondition.notify_all();
+  mCondition.wait(lock, [this]() { return mpTask == nullptr; });
+
+  rethrowPendingError();
+}
+
+
+void RenderThread::waitUntilIdle() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  mCondition.wait(lock, [this]() { return !mHasFrame && !mpTask; });
+  rethrowPendingError();
+}
+
+
+void RenderThread::rethrowPendingError() {
+  if (mpError) {
+    std::rethrow_exception(std::exchange(mpError, nullptr));
+  }
+}
+
+
+void RenderThread::run() {
+  const auto runGuarded = [this](const auto& function) {
+    try {
+      function();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mpError = std::current_exception();
+    }
+  };
+
+  runGuarded(mOnStart);
+
+  std::unique_lock<std::mutex> lock(mMutex);
+  for (;;) {
+    mCondition.wait(lock, [this]() {
+      return mHasFrame || mpTask || mStopRequested;
+    });
+
+    // Tasks and frames are executed without holding the lock, so that the
+    // main thread can keep recording in the meantime. The corresponding
+    // flags are only reset once execution is complete, the main thread
+    // doesn't touch mFrame or the task while they are set.
+    if (mpTask) {
+      lock.unlock();
+      runGuarded(*mpTask);
+      lock.lock();
+
+      mpTask = nullptr;
+      mCondition.notify_all();
+    } else if (mHasFrame) {
+      lock.unlock();
+      runGuarded([this]() { mExecutor(mFrame); });
+      lock.lock();
+
+      mHasFrame = false;
+      mCondition.notify_all();
+    } else {
+      break;
+    }
+  }
+
+  lock.unlock();
+  runGuarded(mOnStop);
+}
+
+}
@@ -0,0 +1,105 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "renderer/command_recorder.hpp"
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+namespace rigel::renderer {
+
+/** Executes recorded command lists on a dedicated thread
+ *
+ * The thread is started on construction. It first invokes the given start
+ * function, which is meant for making the GL context current on the new
+ * thread. Afterwards, it waits for submitted frames and hands them to the
+ * given executor function. On destruction, any outstanding frame is
+ * executed, the stop function is invoked, and the thread is joined.
+ *
+ * Frames are double-buffered: While the render thread is executing one
+ * frame, the submitting thread can already record the next one. Submitting
+ * blocks until the previous frame has been fully executed, so the render
+ * thread is never more than one frame behind.
+ *
+ * Exceptions thrown on the render thread are forwarded to the submitting
+ * thread, and rethrown from the next call to submitFrame(), invoke() or
+ * waitUntilIdle().
+ */
+class RenderThread {
+public:
+  using Executor = std::function<void(const CommandList&)>;
+
+  RenderThread(
+    std::function<void()> onStart,
+    Executor executor,
+    std::function<void()> onStop);
+  ~RenderThread();
+
+  RenderThread(const RenderThread&) = delete;
+  RenderThread& operator=(const RenderThread&) = delete;
+
+  /** Hand over a recorded frame for execution
+   *
+   * Waits until the previous frame has been executed. Afterwards, the given
+   * list is swapped with the internal one, and the render thread starts
+   * executing the new frame. `commands` is empty when this function returns,
+   * but keeps the capacity of a previous frame's list, so that recording
+   * the next frame doesn't need to reallocate.
+   */
+  void submitFrame(CommandList& commands);
+
+  /** Run the given function on the render thread, and wait for completion
+   *
+   * Used for operations which need a result from OpenGL, like creating a
+   * texture. The function is run once the frame which is currently being
+   * executed (if any) is done.
+   */
+  void invoke(const std::function<void()>& function);
+
+  /** Wait until all previously submitted frames have been executed */
+  void waitUntilIdle();
+
+  std::thread::id threadId() const {
+    return mThread.get_id();
+  }
+
+private:
+  void run();
+  void rethrowPendingError();
+
+private:
+  std::function<void()> mOnStart;
+  Executor mExecutor;
+  std::function<void()> mOnStop;
+
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  CommandList mFrame;
+  bool mHasFrame = false;
+  const std::function<void()>* mpTask = nullptr;
+  bool mStopRequested = false;
+  std::exception_ptr mpError;
+
+  std::thread mThread;
+};
+
+}
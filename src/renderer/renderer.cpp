@@ -16,9 +16,12 @@
 
 #include "renderer.hpp"
 
+#include "base/defer.hpp"
 #include "data/game_options.hpp"
 #include "data/game_traits.hpp"
 #include "loader/palette.hpp"
+#include "renderer/command_recorder.hpp"
+#include "renderer/render_thread.hpp"
 #include "sdl_utils/error.hpp"
 
 RIGEL_DISABLE_WARNINGS
@@ -27,6 +30,11 @@ RIGEL_RESTORE_WARNINGS
 
 #include <array>
 #include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
 
 
 namespace rigel::renderer {
@@ -35,12 +43,34 @@ namespace {
 
 const GLushort QUAD_INDICES[] = { 0, 1, 2, 2, 3, 1 };
 
+// Corner positions for instanced quads, in the same order as produced by
+// fillVertexData(). Drawn as a triangle strip.
+const GLfloat UNIT_QUAD_VERTICES[] = { 0, 1, 0, 0, 1, 1, 1, 0 };
+
+constexpr auto FLOATS_PER_QUAD = 4 * (2 + 2);
+
+// Vertex indices need to fit into a GLushort, which limits how many quads
+// we can draw with a single call when not using instancing. Batches are
+// submitted whenever this limit is reached. The same limit is used for
+// instanced batches, to keep the size of the streaming buffer bounded.
+constexpr auto MAX_QUADS_PER_BATCH = 65536 / 4;
+
 
 constexpr auto WATER_MASK_WIDTH = 8;
 constexpr auto WATER_MASK_HEIGHT = 8;
 constexpr auto WATER_NUM_MASKS = 5;
 constexpr auto WATER_MASK_INDEX_FILLED = 4;
 
+// Indexed textures only need a single channel. GL ES 2.0 doesn't support
+// GL_RED, so we use luminance textures there instead.
+#ifdef RIGEL_USE_GL_ES
+constexpr GLint INDEXED_TEXTURE_INTERNAL_FORMAT = GL_LUMINANCE;
+constexpr GLenum INDEXED_TEXTURE_FORMAT = GL_LUMINANCE;
+#else
+constexpr GLint INDEXED_TEXTURE_INTERNAL_FORMAT = GL_R8;
+constexpr GLenum INDEXED_TEXTURE_FORMAT = GL_RED;
+#endif
+
 
 #ifdef RIGEL_USE_GL_ES
 
@@ -108,6 +138,25 @@ void main() {
 }
 )shd";
 
+const auto VERTEX_SOURCE_INSTANCED = R"shd(
+ATTRIBUTE vec2 corner;
+ATTRIBUTE vec4 destRect;
+ATTRIBUTE vec4 sourceRect;
+
+OUT vec2 texCoordFrag;
+
+uniform mat4 transform;
+uniform vec2 textureSize;
+
+void main() {
+  vec2 position = destRect.xy + corner * destRect.zw;
+  vec2 texCoord = (sourceRect.xy + corner * sourceRect.zw) / textureSize;
+
+  gl_Position = transform * vec4(position, 0.0, 1.0);
+  texCoordFrag = vec2(texCoord.x, 1.0 - texCoord.y);
+}
+)shd";
+
 const auto FRAGMENT_SOURCE = R"shd(
 OUTPUT_COLOR_DECLARATION
 
@@ -119,6 +168,23 @@ uniform vec4 overlayColor;
 uniform vec4 colorModulation;
 uniform bool enableRepeat;
 
+uniform sampler2D paletteData;
+uniform bool indexedColors;
+
+
+vec4 indexedColor(vec2 texCoords) {
+  // Indices are stored as normalized bytes. Values of 16 and above have the
+  // masked pixel flag set, and are thus fully transparent.
+  float index = floor(TEXTURE_LOOKUP(textureData, texCoords).r * 255.0 + 0.5);
+  if (index >= 16.0) {
+    return vec4(0.0);
+  }
+
+  vec2 paletteCoords = vec2((index + 0.5) / 16.0, 0.5);
+  return vec4(TEXTURE_LOOKUP(paletteData, paletteCoords).rgb, 1.0);
+}
+
+
 void main() {
   vec2 texCoords = texCoordFrag;
   if (enableRepeat) {
@@ -126,7 +192,9 @@ void main() {
     texCoords.y = fract(texCoords.y);
   }
 
-  vec4 baseColor = TEXTURE_LOOKUP(textureData, texCoords);
+  vec4 baseColor = indexedColors
+    ? indexedColor(texCoords)
+    : TEXTURE_LOOKUP(textureData, texCoords);
   vec4 modulated = baseColor * colorModulation;
   float targetAlpha = modulated.a;
 
@@ -408,10 +476,33 @@ auto getSize(SDL_Window* pWindow) {
   return base::Size<int>{windowWidth, windowHeight};
 }
 
+
+auto getDesktopSize() {
+  SDL_DisplayMode displayMode;
+  sdl_utils::check(SDL_GetDesktopDisplayMode(0, &displayMode));
+  return base::Size<int>{displayMode.w, displayMode.h};
+}
+
 }
 
 
 Renderer::Renderer(SDL_Window* pWindow)
+  : Renderer(pWindow, getSize(pWindow), getDesktopSize())
+{
+}
+
+
+Renderer::Renderer(const base::Size<int>& windowSize)
+  : Renderer(nullptr, windowSize, windowSize)
+{
+}
+
+
+Renderer::Renderer(
+  SDL_Window* pWindow,
+  const base::Size<int>& windowSize,
+  const base::Size<int>& maxWindowSize
+)
   : mpWindow(pWindow)
   , mTexturedQuadShader(
       SHADER_PREAMBLE,
@@ -432,13 +523,8 @@ Renderer::Renderer(SDL_Window* pWindow)
   , mLastUsedTexture(0)
   , mRenderMode(RenderMode::SpriteBatch)
   , mCurrentFbo(0)
-  , mWindowSize(getSize(pWindow))
-  , mMaxWindowSize(
-      [pWindow]() {
-        SDL_DisplayMode displayMode;
-        sdl_utils::check(SDL_GetDesktopDisplayMode(0, &displayMode));
-        return base::Size<int>{displayMode.w, displayMode.h};
-      }())
+  , mWindowSize(windowSize)
+  , mMaxWindowSize(maxWindowSize)
   , mCurrentFramebufferSize(mWindowSize)
   , mGlobalTranslation(0.0f, 0.0f)
   , mGlobalScale(1.0f, 1.0f)
@@ -449,36 +535,89 @@ Renderer::Renderer(SDL_Window* pWindow)
   glDisable(GL_DEPTH_TEST);
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  SDL_GL_SetSwapInterval(data::ENABLE_VSYNC_DEFAULT ? 1 : 0);
+
+  // Rows of indexed textures are not padded to a multiple of 4 bytes
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+  if (mpWindow) {
+    SDL_GL_SetSwapInterval(data::ENABLE_VSYNC_DEFAULT ? 1 : 0);
+  }
 
   // Setup a VBO for streaming data to the GPU, stays bound all the time
   glGenBuffers(1, &mStreamVbo);
   glBindBuffer(GL_ARRAY_BUFFER, mStreamVbo);
-  glGenBuffers(1, &mStreamEbo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mStreamEbo);
+
+  // Quads always use the same index pattern, so we can prepare indices for
+  // the largest possible batch once. Also stays bound all the time.
+  {
+    std::vector<GLushort> indices;
+    indices.reserve(MAX_QUADS_PER_BATCH * std::size(QUAD_INDICES));
+    for (int quad = 0; quad < MAX_QUADS_PER_BATCH; ++quad) {
+      for (const auto index : QUAD_INDICES) {
+        indices.push_back(GLushort(quad * 4 + index));
+      }
+    }
+
+    glGenBuffers(1, &mQuadIndexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mQuadIndexBuffer);
+    glBufferData(
+      GL_ELEMENT_ARRAY_BUFFER,
+      sizeof(GLushort) * indices.size(),
+      indices.data(),
+      GL_STATIC_DRAW);
+  }
 
   glEnableVertexAttribArray(0);
   glEnableVertexAttribArray(1);
 
+  // If possible, sprites are drawn using instancing. Otherwise, we fall back
+  // to expanding each sprite into 4 vertices on the CPU.
+  mInstancing = loadInstancingFunctions();
+  if (mInstancing) {
+    mInstancedQuadShader.emplace(
+      SHADER_PREAMBLE,
+      VERTEX_SOURCE_INSTANCED,
+      FRAGMENT_SOURCE,
+      std::initializer_list<std::string>{"corner", "destRect", "sourceRect"});
+
+    glGenBuffers(1, &mUnitQuadVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mUnitQuadVbo);
+    glBufferData(
+      GL_ARRAY_BUFFER,
+      sizeof(UNIT_QUAD_VERTICES),
+      UNIT_QUAD_VERTICES,
+      GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, mStreamVbo);
+  }
+
   // One-time setup for water effect shader
   useShaderIfChanged(mWaterEffectShader);
-  mWaterEffectShader.setUniform("textureData", 0);
-  mWaterEffectShader.setUniform("maskData", 1);
-  mWaterEffectShader.setUniform("paletteData", 2);
+  setUniform(mWaterEffectShader, "textureData", 0);
+  setUniform(mWaterEffectShader, "maskData", 1);
+  setUniform(mWaterEffectShader, "paletteData", 2);
 
-  mWaterSurfaceAnimTexture = createTexture(createWaterSurfaceAnimImage());
-  mPaletteTexture = createTexture(createPaletteImage());
+  mWaterSurfaceAnimTexture = createTexture(
+    createWaterSurfaceAnimImage(), TextureCategory::Internal);
+  mPaletteTexture =
+    createTexture(createPaletteImage(), TextureCategory::Internal);
 
   glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, mWaterSurfaceAnimTexture.mHandle);
+  bindTexture(mWaterSurfaceAnimTexture.mHandle);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   glActiveTexture(GL_TEXTURE2);
-  glBindTexture(GL_TEXTURE_2D, mPaletteTexture.mHandle);
+  bindTexture(mPaletteTexture.mHandle);
   glActiveTexture(GL_TEXTURE0);
 
-  // One-time setup for textured quad shader
+  // One-time setup for textured quad shader(s)
   useShaderIfChanged(mTexturedQuadShader);
-  mTexturedQuadShader.setUniform("textureData", 0);
+  setUniform(mTexturedQuadShader, "textureData", 0);
+  setUniform(mTexturedQuadShader, "paletteData", 2);
+
+  if (mInstancedQuadShader) {
+    useShaderIfChanged(*mInstancedQuadShader);
+    setUniform(*mInstancedQuadShader, "textureData", 0);
+    setUniform(*mInstancedQuadShader, "paletteData", 2);
+  }
 
   // Remaining setup
   onRenderTargetChanged();
@@ -488,35 +627,85 @@ Renderer::Renderer(SDL_Window* pWindow)
 
 
 Renderer::~Renderer() {
+  // Errors happening on the render thread can't be reported anymore at
+  // this point, but we still need to get the GL context back.
+  try {
+    stopRenderThread();
+  } catch (const std::exception&) {
+  }
+
   glDeleteBuffers(1, &mStreamVbo);
+  glDeleteBuffers(1, &mQuadIndexBuffer);
+  glDeleteBuffers(1, &mUnitQuadVbo);
   glDeleteTextures(1, &mWaterSurfaceAnimTexture.mHandle);
   glDeleteTextures(1, &mPaletteTexture.mHandle);
 }
 
 
 base::Rect<int> Renderer::fullScreenRect() const {
+  if (isRecordingCommands()) {
+    return mpRecorder->fullScreenRect();
+  }
+
   return {{0, 0}, mCurrentFramebufferSize};
 }
 
 
+base::Size<int> Renderer::windowSize() const {
+  if (isRecordingCommands()) {
+    return mpRecorder->state().mWindowSize;
+  }
+
+  return mWindowSize;
+}
+
+
 void Renderer::setOverlayColor(const base::Color& color) {
+  if (isRecordingCommands()) {
+    mpRecorder->setOverlayColor(color);
+    return;
+  }
+
+  mRequestedOverlayColor = color;
+
+  if (!mReorderingEnabled) {
+    applyOverlayColor(color);
+  }
+}
+
+
+void Renderer::applyOverlayColor(const base::Color& color) {
   if (color != mLastOverlayColor) {
-    submitBatch();
+    flushBatch(FlushReason::OverlayColorChange);
 
     setRenderModeIfChanged(RenderMode::SpriteBatch);
-    mTexturedQuadShader.setUniform("overlayColor", toGlColor(color));
+    setUniform(spriteShader(), "overlayColor", toGlColor(color));
     mLastOverlayColor = color;
   }
 }
 
 
 void Renderer::setColorModulation(const base::Color& colorModulation) {
+  if (isRecordingCommands()) {
+    mpRecorder->setColorModulation(colorModulation);
+    return;
+  }
+
+  mRequestedColorModulation = colorModulation;
+
+  if (!mReorderingEnabled) {
+    applyColorModulation(colorModulation);
+  }
+}
+
+
+void Renderer::applyColorModulation(const base::Color& colorModulation) {
   if (colorModulation != mLastColorModulation) {
-    submitBatch();
+    flushBatch(FlushReason::ColorModulationChange);
 
     setRenderModeIfChanged(RenderMode::SpriteBatch);
-    mTexturedQuadShader.setUniform(
-      "colorModulation", toGlColor(colorModulation));
+    setUniform(
+      spriteShader(), "colorModulation", toGlColor(colorModulation));
     mLastColorModulation = colorModulation;
   }
 }
@@ -528,26 +717,73 @@ void Renderer::drawTexture(
   const base::Rect<int>& destRect,
   const bool repeat
 ) {
+  if (isRecordingCommands()) {
+    mpRecorder->drawTexture(textureData, sourceRect, destRect, repeat);
+    return;
+  }
+
   if (!isVisible(destRect)) {
     return;
   }
 
+  if (mReorderingEnabled) {
+    const auto stateId = deferredStateId(DeferredDrawState{
+      textureData, mRequestedOverlayColor, mRequestedColorModulation, repeat});
+    mDeferredCommands.push_back(DeferredDrawCommand{sourceRect, stateId});
+    mReorderableCommands.push_back(ReorderableCommand{stateId, destRect});
+    return;
+  }
+
+  drawTextureImmediate(textureData, sourceRect, destRect, repeat);
+}
+
+
+void Renderer::drawTextureImmediate(
+  const TextureData& textureData,
+  const base::Rect<int>& sourceRect,
+  const base::Rect<int>& destRect,
+  const bool repeat
+) {
   setRenderModeIfChanged(RenderMode::SpriteBatch);
 
   if (textureData.mHandle != mLastUsedTexture) {
-    submitBatch();
+    flushBatch(FlushReason::TextureChange);
 
-    glBindTexture(GL_TEXTURE_2D, textureData.mHandle);
+    bindTexture(textureData.mHandle);
     mLastUsedTexture = textureData.mHandle;
   }
 
+  if (textureData.mIsIndexed != mIndexedColorsOn) {
+    flushBatch(FlushReason::TextureChange);
+
+    setUniform(spriteShader(), "indexedColors", textureData.mIsIndexed);
+    mIndexedColorsOn = textureData.mIsIndexed;
+  }
+
   if (repeat != mTextureRepeatOn) {
-    submitBatch();
+    flushBatch(FlushReason::TextureRepeatChange);
 
-    mTexturedQuadShader.setUniform("enableRepeat", repeat);
+    setUniform(spriteShader(), "enableRepeat", repeat);
     mTextureRepeatOn = repeat;
   }
 
+  if (mInstancing) {
+    const auto textureSize =
+      base::Size<int>{textureData.mWidth, textureData.mHeight};
+    if (textureSize != mInstancedTextureSize) {
+      flushBatch(FlushReason::TextureSizeChange);
+
+      setUniform(
+        *mInstancedQuadShader,
+        "textureSize",
+        glm::vec2{float(textureData.mWidth), float(textureData.mHeight)});
+      mInstancedTextureSize = textureSize;
+    }
+
+    batchQuadInstance(sourceRect, destRect);
+    return;
+  }
+
   // x, y, tex_u, tex_v
   GLfloat vertices[4 * (2 + 2)];
   fillVertexPositions(destRect, std::begin(vertices), 0, 4);
@@ -557,31 +793,122 @@ void Renderer::drawTexture(
 }
 
 
-void Renderer::submitBatch() {
-  if (mBatchData.empty()) {
+void Renderer::setDrawCommandReorderingEnabled(const bool enabled) {
+  if (isRecordingCommands()) {
+    mpRecorder->setDrawCommandReorderingEnabled(enabled);
     return;
   }
 
-  auto submitBatchedQuads = [this]() {
-    glBufferData(
-      GL_ARRAY_BUFFER,
-      sizeof(float) * mBatchData.size(),
-      mBatchData.data(),
-      GL_STREAM_DRAW);
-    glBufferData(
-      GL_ELEMENT_ARRAY_BUFFER,
-      sizeof(GLushort) * mBatchIndices.size(),
-      mBatchIndices.data(),
-      GL_STREAM_DRAW);
-    glDrawElements(
-      GL_TRIANGLES,
-      GLsizei(mBatchIndices.size()),
-      GL_UNSIGNED_SHORT,
-      nullptr);
+  if (enabled == mReorderingEnabled) {
+    return;
+  }
+
+  submitDeferredCommands();
+  mReorderingEnabled = enabled;
+
+  // While reordering, color changes are only applied as part of submitting
+  // deferred draws. Make sure the most recently requested ones are active
+  // when going back to immediate drawing.
+  if (!enabled) {
+    applyOverlayColor(mRequestedOverlayColor);
+    applyColorModulation(mRequestedColorModulation);
+  }
+}
+
+
+int Renderer::deferredStateId(const DeferredDrawState& state) {
+  const auto isSame = [&](const DeferredDrawState& other) {
+    return
+      other.mTexture.mHandle == state.mTexture.mHandle &&
+      other.mOverlayColor == state.mOverlayColor &&
+      other.mColorModulation == state.mColorModulation &&
+      other.mRepeat == state.mRepeat;
   };
 
+  // Consecutive draws very often use the same state, so check the most
+  // recently used one first.
+  if (!mReorderableCommands.empty()) {
+    const auto lastId = mReorderableCommands.back().mStateId;
+    if (isSame(mDeferredStates[lastId])) {
+      return lastId;
+    }
+  }
+
+  const auto iState =
+    std::find_if(mDeferredStates.begin(), mDeferredStates.end(), isSame);
+  if (iState != mDeferredStates.end()) {
+    return static_cast<int>(std::distance(mDeferredStates.begin(), iState));
+  }
+
+  mDeferredStates.push_back(state);
+  return static_cast<int>(mDeferredStates.size()) - 1;
+}
+
+
+void Renderer::submitDeferredCommands() {
+  if (!mReorderingEnabled || mDeferredCommands.empty()) {
+    return;
+  }
+
+  // Drawing the commands below ends up calling this function again (via
+  // submitBatch() etc.). Temporarily turning off reordering makes sure the
+  // draws are actually executed, and avoids recursion.
+  mReorderingEnabled = false;
+
+  const auto numBatchesReordered =
+    determineReorderedSequence(mReorderableCommands, mReorderedSequence);
+  mReorderingStats.mBatchesInOrder += countBatches(mReorderableCommands);
+  mReorderingStats.mBatchesReordered += numBatchesReordered;
+
+  for (const auto index : mReorderedSequence) {
+    const auto& command = mDeferredCommands[index];
+    const auto& state = mDeferredStates[command.mStateId];
+
+    applyOverlayColor(state.mOverlayColor);
+    applyColorModulation(state.mColorModulation);
+    drawTextureImmediate(
+      state.mTexture,
+      command.mSourceRect,
+      mReorderableCommands[index].mDestRect,
+      state.mRepeat);
+  }
+
+  mDeferredCommands.clear();
+  mReorderableCommands.clear();
+  mDeferredStates.clear();
+
+  mReorderingEnabled = true;
+}
+
+
+void Renderer::submitBatch() {
+  if (isRecordingCommands()) {
+    mpRecorder->submitBatch();
+    return;
+  }
+
+  flushBatch(FlushReason::Explicit);
+}
+
+
+void Renderer::flushBatch(const FlushReason reason) {
+  submitDeferredCommands();
+
+  if (mBatchData.empty() && mQuadInstances.empty()) {
+    return;
+  }
+
+  ++currentStatistics().flushes(reason);
+
   switch (mRenderMode) {
     case RenderMode::SpriteBatch:
+      if (mInstancing) {
+        submitInstancedQuads();
+      } else {
+        submitBatchedQuads();
+      }
+      break;
+
     case RenderMode::WaterEffect:
       submitBatchedQuads();
       break;
@@ -593,6 +920,7 @@ void Renderer::submitBatch() {
         mBatchData.data(),
         GL_STREAM_DRAW);
       glDrawArrays(GL_POINTS, 0, GLsizei(mBatchData.size() / 6));
+      recordDrawCall(mBatchPhase, int(mBatchData.size() / 6));
       break;
 
     case RenderMode::NonTexturedRender:
@@ -602,7 +930,36 @@ void Renderer::submitBatch() {
   }
 
   mBatchData.clear();
-  mBatchIndices.clear();
+  mQuadInstances.clear();
+}
+
+
+void Renderer::submitBatchedQuads() {
+  const auto numQuads = mBatchData.size() / FLOATS_PER_QUAD;
+
+  glBufferData(
+    GL_ARRAY_BUFFER,
+    sizeof(float) * mBatchData.size(),
+    mBatchData.data(),
+    GL_STREAM_DRAW);
+  glDrawElements(
+    GL_TRIANGLES,
+    GLsizei(numQuads * std::size(QUAD_INDICES)),
+    GL_UNSIGNED_SHORT,
+    nullptr);
+  recordDrawCall(mBatchPhase, int(numQuads * 4));
+}
+
+
+void Renderer::submitInstancedQuads() {
+  glBufferData(
+    GL_ARRAY_BUFFER,
+    sizeof(QuadInstance) * mQuadInstances.size(),
+    mQuadInstances.data(),
+    GL_STREAM_DRAW);
+  mInstancing->mDrawArraysInstanced(
+    GL_TRIANGLE_STRIP, 0, 4, GLsizei(mQuadInstances.size()));
+  recordDrawCall(mBatchPhase, int(mQuadInstances.size() * 4));
 }
 
 
@@ -610,6 +967,11 @@ void Renderer::drawRectangle(
   const base::Rect<int>& rect,
   const base::Color& color
 ) {
+  if (isRecordingCommands()) {
+    mpRecorder->drawRectangle(rect, color);
+    return;
+  }
+
   // Note: No batching for now, drawRectangle is only used for debugging at
   // the moment
   if (!isVisible(rect)) {
@@ -634,6 +996,7 @@ void Renderer::drawRectangle(
 
   glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STREAM_DRAW);
   glDrawArrays(GL_LINE_STRIP, 0, 5);
+  recordDrawCall(mRenderPhase, 5);
 }
 
 
@@ -644,6 +1007,11 @@ void Renderer::drawLine(
   const int y2,
   const base::Color& color
 ) {
+  if (isRecordingCommands()) {
+    mpRecorder->drawLine({x1, y1}, {x2, y2}, color);
+    return;
+  }
+
   // Note: No batching for now, drawLine is only used for debugging at the
   // moment
   setRenderModeIfChanged(RenderMode::NonTexturedRender);
@@ -657,6 +1025,7 @@ void Renderer::drawLine(
 
   glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STREAM_DRAW);
   glDrawArrays(GL_LINE_STRIP, 0, 2);
+  recordDrawCall(mRenderPhase, 2);
 }
 
 
@@ -664,6 +1033,11 @@ void Renderer::drawPoint(
   const base::Vector& position,
   const base::Color& color
 ) {
+  if (isRecordingCommands()) {
+    mpRecorder->drawPoint(position, color);
+    return;
+  }
+
   const auto& visibleRect = fullScreenRect();
   if (!visibleRect.containsPoint(position)) {
     return;
@@ -671,6 +1045,10 @@ void Renderer::drawPoint(
 
   setRenderModeIfChanged(RenderMode::Points);
 
+  if (mBatchData.empty()) {
+    mBatchPhase = mRenderPhase;
+  }
+
   float vertices[] = {
     float(position.x),
     float(position.y),
@@ -693,6 +1071,11 @@ void Renderer::drawWaterEffect(
     !surfaceAnimationStep ||
     (*surfaceAnimationStep >= 0 && *surfaceAnimationStep < 4));
 
+  if (isRecordingCommands()) {
+    mpRecorder->drawWaterEffect(area, textureData, surfaceAnimationStep);
+    return;
+  }
+
   using namespace std;
 
   if (!isVisible(area)) {
@@ -722,8 +1105,8 @@ void Renderer::drawWaterEffect(
   setRenderModeIfChanged(RenderMode::WaterEffect);
 
   if (mLastUsedTexture != textureData.mHandle) {
-    submitBatch();
-    glBindTexture(GL_TEXTURE_2D, textureData.mHandle);
+    flushBatch(FlushReason::TextureChange);
+    bindTexture(textureData.mHandle);
     mLastUsedTexture = textureData.mHandle;
   }
 
@@ -747,9 +1130,14 @@ void Renderer::drawWaterEffect(
 
 
 void Renderer::setGlobalTranslation(const base::Vector& translation) {
+  if (isRecordingCommands()) {
+    mpRecorder->setGlobalTranslation(translation);
+    return;
+  }
+
   const auto glTranslation = glm::vec2{translation.x, translation.y};
   if (glTranslation != mGlobalTranslation) {
-    submitBatch();
+    flushBatch(FlushReason::GlobalTransformChange);
 
     mGlobalTranslation = glTranslation;
     updateProjectionMatrix();
@@ -758,6 +1146,10 @@ void Renderer::setGlobalTranslation(const base::Vector& translation) {
 
 
 base::Vector Renderer::globalTranslation() const {
+  if (isRecordingCommands()) {
+    return mpRecorder->state().mGlobalTranslation;
+  }
+
   return base::Vector{
     static_cast<int>(mGlobalTranslation.x),
     static_cast<int>(mGlobalTranslation.y)};
@@ -765,9 +1157,14 @@ base::Vector Renderer::globalTranslation() const {
 
 
 void Renderer::setGlobalScale(const base::Point<float>& scale) {
+  if (isRecordingCommands()) {
+    mpRecorder->setGlobalScale(scale);
+    return;
+  }
+
   const auto glScale = glm::vec2{scale.x, scale.y};
   if (glScale != mGlobalScale) {
-    submitBatch();
+    flushBatch(FlushReason::GlobalTransformChange);
 
     mGlobalScale = glScale;
     updateProjectionMatrix();
@@ -776,16 +1173,25 @@ void Renderer::setGlobalScale(const base::Point<float>& scale) {
 
 
 base::Point<float> Renderer::globalScale() const {
+  if (isRecordingCommands()) {
+    return mpRecorder->state().mGlobalScale;
+  }
+
   return {mGlobalScale.x, mGlobalScale.y};
 }
 
 
 void Renderer::setClipRect(const std::optional<base::Rect<int>>& clipRect) {
+  if (isRecordingCommands()) {
+    mpRecorder->setClipRect(clipRect);
+    return;
+  }
+
   if (clipRect == mClipRect) {
     return;
   }
 
-  submitBatch();
+  flushBatch(FlushReason::ClipRectChange);
 
   mClipRect = clipRect;
   if (mClipRect) {
@@ -799,21 +1205,35 @@ void Renderer::setClipRect(const std::optional<base::Rect<int>>& clipRect) {
 
 
 std::optional<base::Rect<int>> Renderer::clipRect() const {
+  if (isRecordingCommands()) {
+    return mpRecorder->state().mClipRect;
+  }
+
   return mClipRect;
 }
 
 
 Renderer::RenderTarget Renderer::currentRenderTarget() const {
+  if (isRecordingCommands()) {
+    return mpRecorder->state().mRenderTarget;
+  }
+
   return {mCurrentFramebufferSize, mCurrentFbo};
 }
 
 
 void Renderer::setRenderTarget(const RenderTarget& target) {
+  if (isRecordingCommands()) {
+    mpRecorder->setRenderTarget(target);
+    return;
+  }
+
   if (target.mFbo == mCurrentFbo) {
     return;
   }
 
-  submitBatch();
+  flushBatch(FlushReason::RenderTargetChange);
+  ++currentStatistics().mRenderTargetSwitches;
 
   if (!target.isDefault()) {
     mCurrentFramebufferSize = target.mSize;
@@ -829,9 +1249,29 @@ void Renderer::setRenderTarget(const RenderTarget& target) {
 
 
 void Renderer::swapBuffers() {
+  if (isRecordingCommands()) {
+    assert(mpRecorder->state().mRenderTarget.isDefault());
+
+    mpRecorder->swapBuffers();
+    mpRenderThread->submitFrame(mpRecorder->commands());
+    mpRecorder->setWindowSize(getSize(mpWindow));
+    return;
+  }
+
   assert(mCurrentFbo == 0);
 
-  submitBatch();
+  flushBatch(FlushReason::SwapBuffers);
+
+  {
+    std::lock_guard<std::mutex> lock(mLastFrameStatisticsMutex);
+    mLastFrameReorderingStats = std::exchange(mReorderingStats, {});
+    mLastFrameStatistics = std::exchange(mFrameStatistics, {});
+  }
+
+  if (!mpWindow) {
+    return;
+  }
+
   SDL_GL_SwapWindow(mpWindow);
 
   const auto actualWindowSize = getSize(mpWindow);
@@ -845,6 +1285,13 @@ void Renderer::swapBuffers() {
 
 
 void Renderer::clear(const base::Color& clearColor) {
+  if (isRecordingCommands()) {
+    mpRecorder->clear(clearColor);
+    return;
+  }
+
+  flushBatch(FlushReason::Clear);
+
   const auto glColor = toGlColor(clearColor);
   glClearColor(glColor.r, glColor.g, glColor.b, glColor.a);
   glClear(GL_COLOR_BUFFER_BIT);
@@ -857,31 +1304,59 @@ void Renderer::batchQuadVertices(
   VertexIter&& dataEnd,
   const std::size_t attributesPerVertex
 ) {
-  using namespace std;
+  assert(attributesPerVertex * 4 == FLOATS_PER_QUAD);
 
-  const auto currentIndex = GLushort(mBatchData.size() / attributesPerVertex);
+  const auto numQuads = mBatchData.size() / FLOATS_PER_QUAD;
+  if (numQuads == MAX_QUADS_PER_BATCH) {
+    flushBatch(FlushReason::BatchFull);
+  }
 
-  GLushort indices[6];
-  transform(
-    begin(QUAD_INDICES),
-    end(QUAD_INDICES),
-    begin(indices),
-    [&](const GLushort index) -> GLushort {
-      return index + currentIndex;
-    });
+  if (mBatchData.empty()) {
+    mBatchPhase = mRenderPhase;
+  }
 
-  // TODO: Limit maximum batch size
   mBatchData.insert(
     mBatchData.end(),
-    forward<VertexIter>(dataBegin),
-    forward<VertexIter>(dataEnd));
-  mBatchIndices.insert(mBatchIndices.end(), begin(indices), end(indices));
+    std::forward<VertexIter>(dataBegin),
+    std::forward<VertexIter>(dataEnd));
+}
+
+
+void Renderer::batchQuadInstance(
+  const base::Rect<int>& sourceRect,
+  const base::Rect<int>& destRect
+) {
+  if (mQuadInstances.size() == MAX_QUADS_PER_BATCH) {
+    flushBatch(FlushReason::BatchFull);
+  }
+
+  if (mQuadInstances.empty()) {
+    mBatchPhase = mRenderPhase;
+  }
+
+  mQuadInstances.push_back(QuadInstance{
+    {
+      GLfloat(destRect.topLeft.x),
+      GLfloat(destRect.topLeft.y),
+      GLfloat(destRect.size.width),
+      GLfloat(destRect.size.height)
+    },
+    {
+      GLshort(sourceRect.topLeft.x),
+      GLshort(sourceRect.topLeft.y),
+      GLshort(sourceRect.size.width),
+      GLshort(sourceRect.size.height)
+    }});
 }
 
 
 void Renderer::setRenderModeIfChanged(const RenderMode mode) {
+  // Anything drawn in a different way than via drawTexture() must come after
+  // all deferred texture draws.
+  submitDeferredCommands();
+
   if (mRenderMode != mode) {
-    submitBatch();
+    flushBatch(FlushReason::RenderModeChange);
 
     mRenderMode = mode;
     updateShaders();
@@ -890,31 +1365,62 @@ void Renderer::setRenderModeIfChanged(const RenderMode mode) {
 
 
 void Renderer::updateShaders() {
+  setInstanceAttributesEnabled(
+    mRenderMode == RenderMode::SpriteBatch && mInstancing);
+
   switch (mRenderMode) {
     case RenderMode::SpriteBatch:
-      useShaderIfChanged(mTexturedQuadShader);
-      mTexturedQuadShader.setUniform("enableRepeat", mTextureRepeatOn);
-      mTexturedQuadShader.setUniform("transform", mProjectionMatrix);
-      glVertexAttribPointer(
-        0,
-        2,
-        GL_FLOAT,
-        GL_FALSE,
-        sizeof(float) * 4,
-        toAttribOffset(0));
-      glVertexAttribPointer(
-        1,
-        2,
-        GL_FLOAT,
-        GL_FALSE,
-        sizeof(float) * 4,
-        toAttribOffset(2 * sizeof(float)));
+      useShaderIfChanged(spriteShader());
+      setUniform(spriteShader(), "enableRepeat", mTextureRepeatOn);
+      setUniform(spriteShader(), "indexedColors", mIndexedColorsOn);
+      setUniform(spriteShader(), "transform", mProjectionMatrix);
+
+      if (mInstancing) {
+        glBindBuffer(GL_ARRAY_BUFFER, mUnitQuadVbo);
+        glVertexAttribPointer(
+          0,
+          2,
+          GL_FLOAT,
+          GL_FALSE,
+          sizeof(float) * 2,
+          toAttribOffset(0));
+        glBindBuffer(GL_ARRAY_BUFFER, mStreamVbo);
+        glVertexAttribPointer(
+          1,
+          4,
+          GL_FLOAT,
+          GL_FALSE,
+          sizeof(QuadInstance),
+          toAttribOffset(offsetof(QuadInstance, mDestRect)));
+        glVertexAttribPointer(
+          2,
+          4,
+          GL_SHORT,
+          GL_FALSE,
+          sizeof(QuadInstance),
+          toAttribOffset(offsetof(QuadInstance, mSourceRect)));
+      } else {
+        glVertexAttribPointer(
+          0,
+          2,
+          GL_FLOAT,
+          GL_FALSE,
+          sizeof(float) * 4,
+          toAttribOffset(0));
+        glVertexAttribPointer(
+          1,
+          2,
+          GL_FLOAT,
+          GL_FALSE,
+          sizeof(float) * 4,
+          toAttribOffset(2 * sizeof(float)));
+      }
       break;
 
     case RenderMode::Points:
     case RenderMode::NonTexturedRender:
       useShaderIfChanged(mSolidColorShader);
-      mSolidColorShader.setUniform("transform", mProjectionMatrix);
+      setUniform(mSolidColorShader, "transform", mProjectionMatrix);
       glVertexAttribPointer(
         0,
         2,
@@ -933,7 +1439,7 @@ void Renderer::updateShaders() {
 
     case RenderMode::WaterEffect:
       useShaderIfChanged(mWaterEffectShader);
-      mWaterEffectShader.setUniform("transform", mProjectionMatrix);
+      setUniform(mWaterEffectShader, "transform", mProjectionMatrix);
       glVertexAttribPointer(
         0,
         2,
@@ -942,7 +1448,7 @@ void Renderer::updateShaders() {
         sizeof(float) * 4,
         toAttribOffset(0));
       glVertexAttribPointer(
-        2,
+        1,
         2,
         GL_FLOAT,
         GL_FALSE,
@@ -953,13 +1459,43 @@ void Renderer::updateShaders() {
 }
 
 
+Shader& Renderer::spriteShader() {
+  return mInstancedQuadShader ? *mInstancedQuadShader : mTexturedQuadShader;
+}
+
+
+void Renderer::setInstanceAttributesEnabled(const bool enabled) {
+  if (!mInstancing) {
+    return;
+  }
+
+  const auto divisor = GLuint(enabled ? 1 : 0);
+  mInstancing->mVertexAttribDivisor(1, divisor);
+  mInstancing->mVertexAttribDivisor(2, divisor);
+
+  if (enabled) {
+    glEnableVertexAttribArray(2);
+  } else {
+    glDisableVertexAttribArray(2);
+  }
+}
+
+
 Renderer::RenderTargetHandles Renderer::createRenderTargetTexture(
   const int width,
   const int height
 ) {
-  const auto textureHandle =
-    createGlTexture(GLsizei(width), GLsizei(height), nullptr);
-  glBindTexture(GL_TEXTURE_2D, textureHandle);
+  if (isRecordingCommands()) {
+    auto handles = RenderTargetHandles{};
+    mpRenderThread->invoke([&]() {
+      handles = createRenderTargetTexture(width, height);
+    });
+    return handles;
+  }
+
+  const auto textureHandle = createGlTexture(
+    GLsizei(width), GLsizei(height), nullptr, TextureCategory::RenderTarget);
+  bindTexture(textureHandle);
 
   GLuint fboHandle;
   glGenFramebuffers(1, &fboHandle);
@@ -972,13 +1508,24 @@ Renderer::RenderTargetHandles Renderer::createRenderTargetTexture(
     0);
 
   glBindFramebuffer(GL_FRAMEBUFFER, mCurrentFbo);
-  glBindTexture(GL_TEXTURE_2D, mLastUsedTexture);
+  bindTexture(mLastUsedTexture);
 
   return {textureHandle, fboHandle};
 }
 
 
-auto Renderer::createTexture(const data::Image& image) -> TextureData {
+auto Renderer::createTexture(
+  const data::Image& image,
+  const TextureCategory category
+) -> TextureData {
+  if (isRecordingCommands()) {
+    auto textureData = TextureData{};
+    mpRenderThread->invoke([&]() {
+      textureData = createTexture(image, category);
+    });
+    return textureData;
+  }
+
   // OpenGL wants pixel data in bottom-up format, so transform it accordingly
   std::vector<std::uint8_t> pixelData;
   pixelData.resize(image.width() * image.height() * 4);
@@ -999,20 +1546,200 @@ auto Renderer::createTexture(const data::Image& image) -> TextureData {
   auto handle = createGlTexture(
     GLsizei(image.width()),
     GLsizei(image.height()),
-    pixelData.data());
+    pixelData.data(),
+    category);
   return {int(image.width()), int(image.height()), handle};
 }
 
 
+auto Renderer::createTexture(
+  const data::IndexedImage& image,
+  const TextureCategory category
+) -> TextureData {
+  if (isRecordingCommands()) {
+    auto textureData = TextureData{};
+    mpRenderThread->invoke([&]() {
+      textureData = createTexture(image, category);
+    });
+    return textureData;
+  }
+
+  // Same as above, OpenGL wants rows in bottom-up order
+  std::vector<std::uint8_t> pixelData;
+  pixelData.resize(image.width() * image.height());
+  for (std::size_t y = 0; y < image.height(); ++y) {
+    const auto sourceRow = image.height() - (y + 1);
+    const auto iSourceRow =
+      image.pixelData().begin() + image.width() * sourceRow;
+    std::copy(
+      iSourceRow,
+      iSourceRow + image.width(),
+      pixelData.begin() + y * image.width());
+  }
+
+  auto handle = createGlTexture(
+    GLsizei(image.width()),
+    GLsizei(image.height()),
+    pixelData.data(),
+    category,
+    INDEXED_TEXTURE_INTERNAL_FORMAT,
+    INDEXED_TEXTURE_FORMAT);
+  return {int(image.width()), int(image.height()), handle, true};
+}
+
+
+void Renderer::destroyTexture(const GLuint handle) {
+  if (isRecordingCommands()) {
+    mpRecorder->addCustomCommand([this, handle]() { destroyTexture(handle); });
+    return;
+  }
+
+  // The texture might still be referenced by pending draws
+  flushBatch(FlushReason::TextureDestroyed);
+
+  glDeleteTextures(1, &handle);
+  mTextureMemory.unregisterTexture(handle);
+
+  // The name might be reused for a new texture, which then wouldn't be bound
+  // despite what mLastUsedTexture says.
+  if (handle == mLastUsedTexture) {
+    mLastUsedTexture = 0;
+  }
+}
+
+
+void Renderer::destroyRenderTarget(const GLuint fboHandle) {
+  if (isRecordingCommands()) {
+    mpRecorder->addCustomCommand(
+      [this, fboHandle]() { destroyRenderTarget(fboHandle); });
+    return;
+  }
+
+  glDeleteFramebuffers(1, &fboHandle);
+}
+
+
+void Renderer::setTextureMemoryBudget(
+  const std::optional<std::size_t> budgetInBytes,
+  const TextureBudgetPolicy policy
+) {
+  mTextureMemory.setBudget(budgetInBytes, policy);
+}
+
+
+TextureMemoryStatistics Renderer::textureMemoryStatistics() const {
+  return mTextureMemory.statistics();
+}
+
+
+auto Renderer::lastFrameReorderingStats() const -> ReorderingStats {
+  std::lock_guard<std::mutex> lock(mLastFrameStatisticsMutex);
+  return mLastFrameReorderingStats;
+}
+
+
+void Renderer::setRenderPhase(const RenderPhase phase) {
+  if (isRecordingCommands()) {
+    mpRecorder->setRenderPhase(phase);
+    return;
+  }
+
+  mRenderPhase = phase;
+}
+
+
+RenderPhase Renderer::renderPhase() const {
+  if (isRecordingCommands()) {
+    return mpRecorder->state().mRenderPhase;
+  }
+
+  return mRenderPhase;
+}
+
+
+FrameStatistics Renderer::lastFrameStatistics() const {
+  std::lock_guard<std::mutex> lock(mLastFrameStatisticsMutex);
+  return mLastFrameStatistics;
+}
+
+
+void Renderer::startRenderThread() {
+  assert(mpWindow);
+
+  if (mpRenderThread) {
+    return;
+  }
+
+  submitBatch();
+
+  mpRecorder = std::make_unique<CommandRecorder>(RecordedState{
+    mWindowSize,
+    currentRenderTarget(),
+    clipRect(),
+    globalTranslation(),
+    globalScale(),
+    mRenderPhase});
+
+  mpGlContext = SDL_GL_GetCurrentContext();
+  sdl_utils::check(SDL_GL_MakeCurrent(mpWindow, nullptr));
+
+  mpRenderThread = std::make_unique<RenderThread>(
+    [this]() { sdl_utils::check(SDL_GL_MakeCurrent(mpWindow, mpGlContext)); },
+    [this](const CommandList& commands) { executeCommands(commands, *this); },
+    [this]() { SDL_GL_MakeCurrent(mpWindow, nullptr); });
+}
+
+
+void Renderer::stopRenderThread() {
+  if (!mpRenderThread) {
+    return;
+  }
+
+  // Once the render thread is idle, it doesn't access any of our members
+  // anymore, so it's safe to reset them here. The GL context needs to be
+  // moved back even if the render thread reported an error.
+  auto guard = base::defer([this]() {
+    mpRenderThread.reset();
+    mpRecorder.reset();
+    SDL_GL_MakeCurrent(mpWindow, mpGlContext);
+  });
+
+  mpRenderThread->submitFrame(mpRecorder->commands());
+  mpRenderThread->waitUntilIdle();
+}
+
+
+bool Renderer::isRecordingCommands() const {
+  return mpRenderThread &&
+    std::this_thread::get_id() != mpRenderThread->threadId();
+}
+
+
+void Renderer::submitCustomCommand(std::function<void()> command) {
+  if (isRecordingCommands()) {
+    mpRecorder->addCustomCommand(std::move(command));
+    return;
+  }
+
+  command();
+}
+
+
 GLuint Renderer::createGlTexture(
   const GLsizei width,
   const GLsizei height,
-  const GLvoid* const pData
+  const GLvoid* const pData,
+  const TextureCategory category,
+  const GLint internalFormat,
+  const GLenum format
 ) {
+  mTextureMemory.checkAllocation(
+    textureSizeInBytes(width, height, format), category);
+
   GLuint handle = 0;
   glGenTextures(1, &handle);
 
-  glBindTexture(GL_TEXTURE_2D, handle);
+  bindTexture(handle);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -1021,20 +1748,35 @@ GLuint Renderer::createGlTexture(
   glTexImage2D(
     GL_TEXTURE_2D,
     0,
-    GL_RGBA,
+    internalFormat,
     width,
     height,
     0,
-    GL_RGBA,
+    format,
     GL_UNSIGNED_BYTE,
     pData);
-  glBindTexture(GL_TEXTURE_2D, mLastUsedTexture);
+  bindTexture(mLastUsedTexture);
+
+  mTextureMemory.registerTexture(handle, width, height, format, category);
 
   return handle;
 }
 
 
 
+void Renderer::bindTexture(const GLuint handle) {
+  glBindTexture(GL_TEXTURE_2D, handle);
+  ++currentStatistics().mTextureBinds;
+}
+
+
+void Renderer::recordDrawCall(const RenderPhase phase, const int numVertices) {
+  auto& statistics = mFrameStatistics[phase];
+  ++statistics.mDrawCalls;
+  statistics.mVertices += numVertices;
+}
+
+
 void Renderer::useShaderIfChanged(Shader& shader) {
   if (shader.handle() != mLastUsedShader) {
     shader.use();
@@ -17,10 +17,14 @@
 #pragma once
 
 #include "base/color.hpp"
+#include "base/defer.hpp"
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "data/image.hpp"
+#include "renderer/draw_command_reordering.hpp"
 #include "renderer/opengl.hpp"
+#include "renderer/render_statistics.hpp"
+#include "renderer/texture_memory.hpp"
 #include "renderer/shader.hpp"
 
 RIGEL_DISABLE_WARNINGS
@@ -29,12 +33,20 @@ RIGEL_DISABLE_WARNINGS
 RIGEL_RESTORE_WARNINGS
 
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <tuple>
+#include <vector>
 
 
 namespace rigel::renderer {
 
+class CommandRecorder;
+class RenderThread;
+
+
 class Renderer {
 public:
   // TODO: Re-evaluate how render targets work
@@ -64,16 +76,25 @@ public:
 
   struct TextureData {
     TextureData() = default;
-    TextureData(const int width, const int height, const GLuint handle)
+    TextureData(
+      const int width,
+      const int height,
+      const GLuint handle,
+      const bool isIndexed = false)
       : mWidth(width)
       , mHeight(height)
       , mHandle(handle)
+      , mIsIndexed(isIndexed)
     {
     }
 
     int mWidth = 0;
     int mHeight = 0;
     GLuint mHandle = 0;
+
+    // Indexed textures store palette indices instead of colors, see
+    // createTexture(const data::IndexedImage&, TextureCategory)
+    bool mIsIndexed = false;
   };
 
   struct RenderTargetHandles {
@@ -81,6 +102,17 @@ public:
     GLuint fbo;
   };
 
+  /** Effect of draw command reordering during the last frame
+   *
+   * Both values are the number of sprite batches needed for drawing the
+   * deferred commands, once in the order they were issued, and once after
+   * reordering.
+   */
+  struct ReorderingStats {
+    int mBatchesInOrder = 0;
+    int mBatchesReordered = 0;
+  };
+
 
   class StateSaver {
   public:
@@ -136,12 +168,18 @@ public:
 
 
   explicit Renderer(SDL_Window* pWindow);
+
+  /** Create a renderer which doesn't present anything
+   *
+   * The default render target has the given size, and swapBuffers() only
+   * finishes the frame's statistics. Meant for tests, in combination with
+   * loadNullGlFunctions().
+   */
+  explicit Renderer(const base::Size<int>& windowSize);
   ~Renderer();
 
   base::Rect<int> fullScreenRect() const;
-  base::Size<int> windowSize() const {
-    return mWindowSize;
-  }
+  base::Size<int> windowSize() const;
   base::Size<int> maxWindowSize() const {
     return mMaxWindowSize;
   }
@@ -199,7 +237,61 @@ public:
 
   void submitBatch();
 
-  TextureData createTexture(const data::Image& image);
+  /** Defer and reorder texture draws to reduce the number of batches
+   *
+   * While enabled, drawTexture() only records the draw. Recorded draws are
+   * submitted when anything happens that can't be reordered, e.g. when
+   * drawing anything else than a texture, or changing the render target,
+   * clip rect or global transformation. Before submitting, draws are grouped
+   * by texture and other state wherever that doesn't change the result (see
+   * determineReorderedSequence()).
+   *
+   * Textures must stay alive until the deferred draws are submitted.
+   * Disabling reordering submits all outstanding draws.
+   */
+  void setDrawCommandReorderingEnabled(bool enabled);
+
+  ReorderingStats lastFrameReorderingStats() const;
+
+  /** Set which phase subsequent rendering work is attributed to
+   *
+   * Batched draws count towards the phase which was active when the first
+   * draw of the batch was issued. When draw command reordering is enabled,
+   * draws are attributed to the phase active when the reordered draws are
+   * submitted. See also beginRenderPhase().
+   */
+  void setRenderPhase(RenderPhase phase);
+  RenderPhase renderPhase() const;
+
+  /** Statistics for the most recently completed frame
+   *
+   * Counts draw calls, vertices, texture binds, uniform updates, render
+   * target switches, and why batches were submitted, broken down by render
+   * phase. A frame ends with swapBuffers().
+   */
+  FrameStatistics lastFrameStatistics() const;
+
+  /** Upload image to the GPU
+   *
+   * The category is used for attributing the texture's memory usage, see
+   * textureMemoryStatistics(). Throws TextureBudgetExceeded if the texture
+   * doesn't fit into the budget and the budget policy is to reject
+   * allocations.
+   */
+  TextureData createTexture(
+    const data::Image& image,
+    TextureCategory category = TextureCategory::Other);
+
+  /** Upload indexed image to the GPU
+   *
+   * The texture stores a single byte per pixel, which is resolved to a color
+   * using the in-game palette at draw time. Pixels with the
+   * data::IndexedImage::MASKED_PIXEL_FLAG set are drawn fully transparent.
+   * Otherwise the same as createTexture(const data::Image&, TextureCategory).
+   */
+  TextureData createTexture(
+    const data::IndexedImage& image,
+    TextureCategory category = TextureCategory::Other);
 
   // TODO: Revisit the render target API and its use in RenderTargetTexture,
   // there should be a nicer way to do this.
@@ -207,6 +299,58 @@ public:
     int width,
     int height);
 
+  void destroyTexture(GLuint handle);
+  void destroyRenderTarget(GLuint fboHandle);
+
+  /** Limit the amount of GPU memory used for textures
+   *
+   * Passing std::nullopt removes the limit. Textures which already exist are
+   * not affected.
+   */
+  void setTextureMemoryBudget(
+    std::optional<std::size_t> budgetInBytes,
+    TextureBudgetPolicy policy);
+
+  /** Memory used by all currently existing textures, and the peak so far */
+  TextureMemoryStatistics textureMemoryStatistics() const;
+
+  /** Execute OpenGL commands on a dedicated render thread
+   *
+   * Moves the GL context to a new thread. Afterwards, all drawing and state
+   * changes done via the Renderer's interface are only recorded on the
+   * calling thread. swapBuffers() hands over the recorded frame to the
+   * render thread, which executes it while the next frame is being
+   * recorded. State queries like clipRect() keep working as before, they
+   * return the state as of the most recently recorded command.
+   *
+   * Creating textures needs to wait for the render thread, and is thus
+   * more expensive than when rendering directly.
+   *
+   * Must be called on the thread which currently owns the GL context, and
+   * which is going to use the Renderer afterwards. The GL context must not
+   * be used directly anymore while the render thread is active, use
+   * submitCustomCommand() instead.
+   */
+  void startRenderThread();
+
+  /** Execute all outstanding commands, and move GL context back
+   *
+   * Does nothing if the render thread isn't active.
+   */
+  void stopRenderThread();
+
+  /** True if commands are currently recorded instead of executed directly */
+  bool isRecordingCommands() const;
+
+  /** Run arbitrary code with the GL context current
+   *
+   * When rendering directly, the given function is called right away.
+   * Otherwise, it's recorded and called on the render thread, in order with
+   * the other recorded commands. In that case, the function must not refer
+   * to any data which might be modified by the recording thread.
+   */
+  void submitCustomCommand(std::function<void()> command);
+
 private:
   class DummyVao {
 #ifndef RIGEL_USE_GL_ES
@@ -235,6 +379,34 @@ private:
     WaterEffect
   };
 
+  /** Per-sprite data for instanced rendering
+   *
+   * The 4 vertices of each quad are generated on the GPU from this record.
+   * The source rectangle is given in texels, the shader normalizes it using
+   * the size of the currently bound texture.
+   */
+  struct QuadInstance {
+    GLfloat mDestRect[4];
+    GLshort mSourceRect[4];
+  };
+
+  struct DeferredDrawState {
+    TextureData mTexture;
+    base::Color mOverlayColor;
+    base::Color mColorModulation;
+    bool mRepeat;
+  };
+
+  struct DeferredDrawCommand {
+    base::Rect<int> mSourceRect;
+    int mStateId;
+  };
+
+  Renderer(
+    SDL_Window* pWindow,
+    const base::Size<int>& windowSize,
+    const base::Size<int>& maxWindowSize);
+
   template <typename VertexIter>
   void batchQuadVertices(
     VertexIter&& dataBegin,
@@ -243,6 +415,38 @@ private:
 
   bool isVisible(const base::Rect<int>& rect) const;
 
+  void batchQuadInstance(
+    const base::Rect<int>& sourceRect,
+    const base::Rect<int>& destRect);
+  void flushBatch(FlushReason reason);
+  void submitBatchedQuads();
+  void submitInstancedQuads();
+
+  void drawTextureImmediate(
+    const TextureData& textureData,
+    const base::Rect<int>& sourceRect,
+    const base::Rect<int>& destRect,
+    bool repeat);
+  void applyOverlayColor(const base::Color& color);
+  void applyColorModulation(const base::Color& colorModulation);
+  int deferredStateId(const DeferredDrawState& state);
+  void submitDeferredCommands();
+
+  RenderStatistics& currentStatistics() {
+    return mFrameStatistics[mRenderPhase];
+  }
+
+  void bindTexture(GLuint handle);
+  void recordDrawCall(RenderPhase phase, int numVertices);
+
+  template <typename T>
+  void setUniform(Shader& shader, const char* name, const T& value) {
+    shader.setUniform(name, value);
+    ++currentStatistics().mUniformUpdates;
+  }
+
+  Shader& spriteShader();
+  void setInstanceAttributesEnabled(bool enabled);
   void useShaderIfChanged(Shader& shader);
   void setRenderModeIfChanged(RenderMode mode);
   void updateShaders();
@@ -252,30 +456,56 @@ private:
   GLuint createGlTexture(
     GLsizei width,
     GLsizei height,
-    const GLvoid* const pData);
+    const GLvoid* const pData,
+    TextureCategory category,
+    GLint internalFormat = GL_RGBA,
+    GLenum format = GL_RGBA);
 
 private:
   SDL_Window* mpWindow;
 
   DummyVao mDummyVao;
   GLuint mStreamVbo;
-  GLuint mStreamEbo;
+  GLuint mQuadIndexBuffer;
+  GLuint mUnitQuadVbo = 0;
 
   Shader mTexturedQuadShader;
   Shader mSolidColorShader;
   Shader mWaterEffectShader;
 
+  std::optional<InstancingFunctions> mInstancing;
+  std::optional<Shader> mInstancedQuadShader;
+  base::Size<int> mInstancedTextureSize;
+
   GLuint mLastUsedShader;
   GLuint mLastUsedTexture;
   base::Color mLastColorModulation;
   base::Color mLastOverlayColor;
   bool mTextureRepeatOn = false;
+  bool mIndexedColorsOn = false;
 
   RenderMode mRenderMode;
 
   std::vector<GLfloat> mBatchData;
-  std::vector<GLushort> mBatchIndices;
-
+  std::vector<QuadInstance> mQuadInstances;
+
+  bool mReorderingEnabled = false;
+  base::Color mRequestedOverlayColor;
+  base::Color mRequestedColorModulation;
+  std::vector<DeferredDrawState> mDeferredStates;
+  std::vector<DeferredDrawCommand> mDeferredCommands;
+  std::vector<ReorderableCommand> mReorderableCommands;
+  std::vector<int> mReorderedSequence;
+  ReorderingStats mReorderingStats;
+  ReorderingStats mLastFrameReorderingStats;
+
+  RenderPhase mRenderPhase = RenderPhase::Other;
+  RenderPhase mBatchPhase = RenderPhase::Other;
+  FrameStatistics mFrameStatistics;
+  FrameStatistics mLastFrameStatistics;
+  mutable std::mutex mLastFrameStatisticsMutex;
+
+  TextureMemoryAccountant mTextureMemory;
   TextureData mWaterSurfaceAnimTexture;
   TextureData mPaletteTexture;
 
@@ -288,6 +518,26 @@ private:
   std::optional<base::Rect<int>> mClipRect;
   glm::vec2 mGlobalTranslation;
   glm::vec2 mGlobalScale;
+
+  SDL_GLContext mpGlContext = nullptr;
+  std::unique_ptr<CommandRecorder> mpRecorder;
+  std::unique_ptr<RenderThread> mpRenderThread;
 };
 
+
+/** Attribute rendering work to the given phase until the guard is destroyed
+ *
+ * The previously active phase is restored afterwards.
+ */
+[[nodiscard]] inline auto beginRenderPhase(
+  Renderer* pRenderer,
+  const RenderPhase phase
+) {
+  const auto previousPhase = pRenderer->renderPhase();
+  pRenderer->setRenderPhase(phase);
+  return base::defer([pRenderer, previousPhase]() {
+    pRenderer->setRenderPhase(previousPhase);
+  });
+}
+
 }
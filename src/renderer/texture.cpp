@@ -78,14 +78,36 @@ void TextureBase::render(
 }
 
 
-OwningTexture::OwningTexture(renderer::Renderer* pRenderer, const Image& image)
-  : TextureBase(pRenderer->createTexture(image))
+OwningTexture::OwningTexture(
+  renderer::Renderer* pRenderer,
+  const Image& image,
+  const TextureCategory category
+)
+  : OwningTexture(pRenderer, pRenderer->createTexture(image, category))
+{
+}
+
+
+OwningTexture::OwningTexture(
+  renderer::Renderer* pRenderer,
+  const data::IndexedImage& image,
+  const TextureCategory category
+)
+  : OwningTexture(pRenderer, pRenderer->createTexture(image, category))
 {
 }
 
 
 OwningTexture::~OwningTexture() {
-  glDeleteTextures(1, &mData.mHandle);
+  destroy();
+}
+
+
+void OwningTexture::destroy() {
+  if (mpRenderer && mData.mHandle != 0) {
+    mpRenderer->destroyTexture(mData.mHandle);
+    mData.mHandle = 0;
+  }
 }
 
 
@@ -95,6 +117,7 @@ RenderTargetTexture::RenderTargetTexture(
   const std::size_t height
 )
   : RenderTargetTexture(
+      pRenderer,
       pRenderer->createRenderTargetTexture(int(width), int(height)),
       static_cast<int>(width),
       static_cast<int>(height))
@@ -103,18 +126,27 @@ RenderTargetTexture::RenderTargetTexture(
 
 
 RenderTargetTexture::RenderTargetTexture(
+  renderer::Renderer* pRenderer,
   const Renderer::RenderTargetHandles& handles,
   const int width,
   const int height
 )
-  : OwningTexture({width, height, handles.texture})
+  : OwningTexture(pRenderer, {width, height, handles.texture})
   , mFboHandle(handles.fbo)
 {
 }
 
 
 RenderTargetTexture::~RenderTargetTexture() {
-  glDeleteFramebuffers(1, &mFboHandle);
+  destroyFramebuffer();
+}
+
+
+void RenderTargetTexture::destroyFramebuffer() {
+  if (mpRenderer && mFboHandle != 0) {
+    mpRenderer->destroyRenderTarget(mFboHandle);
+    mFboHandle = 0;
+  }
 }
 
 
@@ -104,11 +104,19 @@ protected:
 class OwningTexture : public detail::TextureBase {
 public:
   OwningTexture() = default;
-  OwningTexture(Renderer* renderer, const data::Image& image);
+  OwningTexture(
+    Renderer* renderer,
+    const data::Image& image,
+    TextureCategory category = TextureCategory::Other);
+  OwningTexture(
+    Renderer* renderer,
+    const data::IndexedImage& image,
+    TextureCategory category = TextureCategory::Other);
   ~OwningTexture();
 
   OwningTexture(OwningTexture&& other) noexcept
     : TextureBase(other.mData)
+    , mpRenderer(other.mpRenderer)
   {
     other.mData.mHandle = 0;
   }
@@ -117,18 +125,27 @@ public:
   OwningTexture& operator=(const OwningTexture&) = delete;
 
   OwningTexture& operator=(OwningTexture&& other) noexcept {
-    mData = other.mData;
-    other.mData.mHandle = 0;
+    if (this != &other) {
+      destroy();
+      mData = other.mData;
+      mpRenderer = other.mpRenderer;
+      other.mData.mHandle = 0;
+    }
     return *this;
   }
 
   friend class NonOwningTexture;
 
 protected:
-  explicit OwningTexture(Renderer::TextureData data)
+  OwningTexture(Renderer* pRenderer, Renderer::TextureData data)
     : TextureBase(data)
+    , mpRenderer(pRenderer)
   {
   }
+
+  void destroy();
+
+  Renderer* mpRenderer = nullptr;
 };
 
 
@@ -234,18 +251,24 @@ public:
 
 
   RenderTargetTexture& operator=(RenderTargetTexture&& other) noexcept {
-    static_cast<OwningTexture&>(*this) = std::move(other);
-    mFboHandle = other.mFboHandle;
-    other.mFboHandle = 0;
+    if (this != &other) {
+      destroyFramebuffer();
+      static_cast<OwningTexture&>(*this) = std::move(other);
+      mFboHandle = other.mFboHandle;
+      other.mFboHandle = 0;
+    }
     return *this;
   }
 
 private:
   RenderTargetTexture(
+    Renderer* pRenderer,
     const Renderer::RenderTargetHandles& handles,
     int width,
     int height);
 
+  void destroyFramebuffer();
+
 private:
   GLuint mFboHandle;
 };
@@ -0,0 +1,189 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "texture_memory.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+
+namespace rigel::renderer {
+
+namespace {
+
+constexpr auto BYTES_PER_MB = 1024.0 * 1024.0;
+
+
+int bytesPerPixel(const GLenum format) {
+  switch (format) {
+    case GL_RGBA: return 4;
+    case GL_RGB: return 3;
+#ifdef RIGEL_USE_GL_ES
+    case GL_LUMINANCE: return 1;
+#else
+    case GL_RED: return 1;
+#endif
+
+    default:
+      assert(false);
+      return 4;
+  }
+}
+
+
+void addBytes(TextureMemoryUsage& usage, const std::size_t bytes) {
+  usage.mBytes += bytes;
+  usage.mPeakBytes = std::max(usage.mPeakBytes, usage.mBytes);
+  ++usage.mTextureCount;
+}
+
+
+void removeBytes(TextureMemoryUsage& usage, const std::size_t bytes) {
+  assert(usage.mBytes >= bytes && usage.mTextureCount > 0);
+  usage.mBytes -= bytes;
+  --usage.mTextureCount;
+}
+
+}
+
+
+const char* textureCategoryName(const TextureCategory category) {
+  switch (category) {
+    case TextureCategory::Other: return "Other";
+    case TextureCategory::Internal: return "Internal";
+    case TextureCategory::Map: return "Map";
+    case TextureCategory::Sprites: return "Sprites";
+    case TextureCategory::Hud: return "HUD";
+    case TextureCategory::Ui: return "UI";
+    case TextureCategory::FullScreenImage: return "Images";
+    case TextureCategory::Movie: return "Movie";
+    case TextureCategory::RenderTarget: return "Targets";
+  }
+
+  return "";
+}
+
+
+std::size_t textureSizeInBytes(
+  const int width,
+  const int height,
+  const GLenum format
+) {
+  return
+    static_cast<std::size_t>(width) * static_cast<std::size_t>(height) *
+    bytesPerPixel(format);
+}
+
+
+void TextureMemoryAccountant::setBudget(
+  const std::optional<std::size_t> budgetInBytes,
+  const TextureBudgetPolicy policy
+) {
+  std::lock_guard<std::mutex> lock(mMutex);
+  mStatistics.mBudget = budgetInBytes;
+  mPolicy = policy;
+  mIsOverBudget = false;
+}
+
+
+void TextureMemoryAccountant::checkAllocation(
+  const std::size_t sizeInBytes,
+  const TextureCategory category
+) {
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  const auto& budget = mStatistics.mBudget;
+  if (!budget || mStatistics.mTotal.mBytes + sizeInBytes <= *budget) {
+    mIsOverBudget = false;
+    return;
+  }
+
+  std::stringstream message;
+  message
+    << "Texture allocation of " << sizeInBytes / BYTES_PER_MB
+    << " MB (" << textureCategoryName(category) << ") exceeds budget: "
+    << mStatistics.mTotal.mBytes / BYTES_PER_MB << " MB of "
+    << *budget / BYTES_PER_MB << " MB in use";
+
+  if (mPolicy == TextureBudgetPolicy::Reject) {
+    ++mStatistics.mRejectedAllocations;
+    throw TextureBudgetExceeded(message.str());
+  }
+
+  ++mStatistics.mOverBudgetAllocations;
+
+  // Only log once when going over budget, not for every single allocation
+  // afterwards. Some textures are created on every frame, which would flood
+  // the log otherwise.
+  if (!mIsOverBudget) {
+    std::cerr << "WARNING: " << message.str() << '\n';
+    mIsOverBudget = true;
+  }
+}
+
+
+void TextureMemoryAccountant::registerTexture(
+  const GLuint handle,
+  const int width,
+  const int height,
+  const GLenum format,
+  const TextureCategory category
+) {
+  const auto sizeInBytes = textureSizeInBytes(width, height, format);
+
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  const auto inserted =
+    mAllocations.emplace(handle, Allocation{sizeInBytes, category}).second;
+  assert(inserted);
+  static_cast<void>(inserted);
+
+  addBytes(usage(category), sizeInBytes);
+  addBytes(mStatistics.mTotal, sizeInBytes);
+}
+
+
+void TextureMemoryAccountant::unregisterTexture(const GLuint handle) {
+  std::lock_guard<std::mutex> lock(mMutex);
+
+  const auto iAllocation = mAllocations.find(handle);
+  if (iAllocation == mAllocations.end()) {
+    return;
+  }
+
+  const auto [sizeInBytes, category] = iAllocation->second;
+  removeBytes(usage(category), sizeInBytes);
+  removeBytes(mStatistics.mTotal, sizeInBytes);
+
+  mAllocations.erase(iAllocation);
+}
+
+
+TextureMemoryStatistics TextureMemoryAccountant::statistics() const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mStatistics;
+}
+
+
+TextureMemoryUsage& TextureMemoryAccountant::usage(
+  const TextureCategory category
+) {
+  return mStatistics.mByCategory[static_cast<int>(category)];
+}
+
+}
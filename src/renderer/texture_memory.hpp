@@ -0,0 +1,146 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "renderer/opengl.hpp"
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+
+namespace rigel::renderer {
+
+/** Which part of the game a texture belongs to
+ *
+ * Used for attributing GPU memory usage, see TextureMemoryAccountant.
+ */
+enum class TextureCategory {
+  Other,
+  Internal,
+  Map,
+  Sprites,
+  Hud,
+  Ui,
+  FullScreenImage,
+  Movie,
+  RenderTarget
+};
+
+constexpr auto NUM_TEXTURE_CATEGORIES =
+  static_cast<int>(TextureCategory::RenderTarget) + 1;
+
+const char* textureCategoryName(TextureCategory category);
+
+
+/** What to do when a texture allocation would exceed the memory budget */
+enum class TextureBudgetPolicy {
+  Log,
+  Reject
+};
+
+
+/** Approximate amount of GPU memory needed for a texture
+ *
+ * Only considers the texture's pixel storage, not any driver overhead.
+ */
+std::size_t textureSizeInBytes(int width, int height, GLenum format);
+
+
+struct TextureMemoryUsage {
+  std::size_t mBytes = 0;
+  std::size_t mPeakBytes = 0;
+  int mTextureCount = 0;
+};
+
+
+struct TextureMemoryStatistics {
+  const TextureMemoryUsage& operator[](const TextureCategory category) const {
+    return mByCategory[static_cast<int>(category)];
+  }
+
+  std::array<TextureMemoryUsage, NUM_TEXTURE_CATEGORIES> mByCategory;
+  TextureMemoryUsage mTotal;
+  std::optional<std::size_t> mBudget;
+  int mOverBudgetAllocations = 0;
+  int mRejectedAllocations = 0;
+};
+
+
+/** Thrown when creating a texture would exceed the memory budget
+ *
+ * Only happens when using TextureBudgetPolicy::Reject.
+ */
+class TextureBudgetExceeded : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+
+/** Keeps track of all textures currently allocated on the GPU
+ *
+ * Each texture is registered with its size, pixel format and category when
+ * created, and unregistered on destruction. This gives current and peak
+ * memory usage, both in total and per category.
+ *
+ * Optionally, a budget can be set. Allocations which would go over the
+ * budget are then either logged or rejected, depending on the policy.
+ *
+ * All member functions are thread-safe.
+ */
+class TextureMemoryAccountant {
+public:
+  void setBudget(
+    std::optional<std::size_t> budgetInBytes,
+    TextureBudgetPolicy policy);
+
+  /** Check if an allocation of the given size fits into the budget
+   *
+   * Must be called before creating the texture. Throws TextureBudgetExceeded
+   * if the allocation doesn't fit and the policy is to reject allocations.
+   */
+  void checkAllocation(std::size_t sizeInBytes, TextureCategory category);
+
+  void registerTexture(
+    GLuint handle,
+    int width,
+    int height,
+    GLenum format,
+    TextureCategory category);
+  void unregisterTexture(GLuint handle);
+
+  TextureMemoryStatistics statistics() const;
+
+private:
+  struct Allocation {
+    std::size_t mSizeInBytes;
+    TextureCategory mCategory;
+  };
+
+  TextureMemoryUsage& usage(TextureCategory category);
+
+  mutable std::mutex mMutex;
+  std::unordered_map<GLuint, Allocation> mAllocations;
+  TextureMemoryStatistics mStatistics;
+  TextureBudgetPolicy mPolicy = TextureBudgetPolicy::Log;
+  bool mIsOverBudget = false;
+};
+
+}
@@ -57,6 +57,20 @@ const auto GAME_SPEED_SLOT = 8;
 const auto INITIAL_SKILL_SELECTION = 1;
 const auto INITIAL_GAME_SPEED = 3;
 
+
+bool isStaticDrawingAction(const data::script::Action& action) {
+  using namespace data::script;
+
+  return
+    std::holds_alternative<DrawBigText>(action) ||
+    std::holds_alternative<DrawSprite>(action) ||
+    std::holds_alternative<DrawText>(action) ||
+    std::holds_alternative<ShowFullScreenImage>(action) ||
+    std::holds_alternative<ShowKeyBindings>(action) ||
+    std::holds_alternative<ShowMessageBox>(action) ||
+    std::holds_alternative<ShowSaveSlots>(action);
+}
+
 }
 
 
@@ -94,7 +108,8 @@ void DukeScriptRunner::executeScript(const data::script::Script& script) {
   mDisableMenuFunctionalityForNextPagesDefinition = false;
   mTextBoxOffsetEnabled = false;
 
-  startExecution(script);
+  mScriptProgram = compile(script);
+  startExecution(mScriptProgram);
 }
 
 
@@ -106,8 +121,54 @@ void DukeScriptRunner::clearCanvas() {
 }
 
 
-void DukeScriptRunner::startExecution(const data::script::Script& script) {
-  mCurrentInstructions = script;
+/** Turn a script into a program which can be replayed cheaply
+ *
+ * Consecutive drawing actions are grouped into static layers, and palette
+ * changes are resolved up front so that no files need to be loaded when
+ * replaying the program. Everything else (waits, fades, menu selection,
+ * news reporter etc.) is kept as is and interpreted on each execution.
+ */
+DukeScriptRunner::CompiledScript DukeScriptRunner::compile(
+  const data::script::Script& script
+) const {
+  using namespace data::script;
+
+  CompiledScript program;
+
+  const auto appendToLayer = [&program](const Action& action) {
+    if (
+      program.empty() ||
+      !std::holds_alternative<StaticLayer>(program.back())
+    ) {
+      program.emplace_back(StaticLayer{});
+    }
+
+    std::get<StaticLayer>(program.back()).mActions.push_back(action);
+  };
+
+  for (const auto& action : script) {
+    if (const auto pSetPalette = std::get_if<SetPalette>(&action)) {
+      program.emplace_back(PaletteChange{loader::load6bitPalette16(
+        mpResourceBundle->file(pSetPalette->paletteFile))});
+    } else if (
+      const auto pShowImage = std::get_if<ShowFullScreenImage>(&action)
+    ) {
+      program.emplace_back(PaletteChange{
+        mpResourceBundle->loadPaletteFromFullScreenImage(pShowImage->image)});
+      appendToLayer(action);
+    } else if (isStaticDrawingAction(action)) {
+      appendToLayer(action);
+    } else {
+      program.emplace_back(action);
+    }
+  }
+
+  return program;
+}
+
+
+void DukeScriptRunner::startExecution(CompiledScript& program) {
+  mpCurrentProgram = &program;
   mProgramCounter = 0u;
   mState = State::ExecutingScript;
 
@@ -201,6 +262,9 @@ void DukeScriptRunner::handleEvent(const SDL_Event& event) {
 
 
 void DukeScriptRunner::updateAndRender(engine::TimeDelta dt) {
+  const auto phase =
+    renderer::beginRenderPhase(mpRenderer, renderer::RenderPhase::Menus);
+
   if (mDelayState) {
     updateDelayState(*mDelayState, dt);
   }
@@ -329,16 +393,153 @@ void DukeScriptRunner::drawBigText(
 
 
 void DukeScriptRunner::interpretNextAction() {
-  using namespace data::script;
+  auto& program = *mpCurrentProgram;
 
-  if (mProgramCounter >= mCurrentInstructions.size()) {
+  if (mProgramCounter >= program.size()) {
     mState = State::FinishedExecution;
     hideMenuSelectionIndicator();
     return;
   }
 
   base::match(
-    mCurrentInstructions[mProgramCounter++],
+    program[mProgramCounter++],
+
+    [this](const data::script::Action& action) {
+      interpretAction(action);
+    },
+
+    [this](const PaletteChange& change) {
+      updatePalette(change.mPalette);
+    },
+
+    [this](StaticLayer& layer) {
+      drawStaticLayer(layer);
+    });
+}
+
+
+void DukeScriptRunner::drawStaticLayer(StaticLayer& layer) {
+  const auto needsRendering =
+    !layer.mTexture ||
+    layer.mRenderedPalette != mCurrentPalette ||
+    layer.mRenderedWithTextOffset != mTextBoxOffsetEnabled;
+
+  if (needsRendering) {
+    if (!layer.mTexture) {
+      layer.mTexture.emplace(
+        mpRenderer,
+        data::GameTraits::viewPortWidthPx,
+        data::GameTraits::viewPortHeightPx);
+    }
+
+    const auto binder = CanvasBinder{*layer.mTexture, mpRenderer};
+    mpRenderer->clear({0, 0, 0, 0});
+
+    for (const auto& action : layer.mActions) {
+      drawStaticAction(action);
+    }
+
+    layer.mRenderedPalette = mCurrentPalette;
+    layer.mRenderedWithTextOffset = mTextBoxOffsetEnabled;
+  }
+
+  layer.mTexture->render(mpRenderer, 0, 0);
+}
+
+
+void DukeScriptRunner::drawStaticAction(
+  const data::script::Action& scriptAction
+) {
+  using namespace data::script;
+
+  base::match(
+    scriptAction,
+
+    [this](const ShowFullScreenImage& showImage) {
+      const auto imageTexture = fullScreenImageAsTexture(
+        mpRenderer,
+        *mpResourceBundle,
+        showImage.image);
+      imageTexture.render(mpRenderer, 0, 0);
+      mpRenderer->submitBatch();
+    },
+
+    [this](const DrawBigText& action) {
+      drawBigText(
+        action.x + 2,
+        action.y,
+        action.colorIndex,
+        action.text);
+    },
+
+    [this](const DrawText& action) {
+      mMenuElementRenderer.drawText(action.x, action.y, action.text);
+    },
+
+    [this](const DrawSprite& action) {
+      drawSprite(
+        static_cast<data::ActorID>(action.spriteId),
+        action.frameNumber,
+        action.x,
+        action.y);
+    },
+
+    [this](const ShowMessageBox& messageBoxDefinition) {
+      const auto xOffset = mTextBoxOffsetEnabled ? 3 : 0;
+      const auto xPos = (40 - messageBoxDefinition.width) / 2 - xOffset;
+      mMenuElementRenderer.drawMessageBox(
+        xPos,
+        messageBoxDefinition.y,
+        messageBoxDefinition.width,
+        messageBoxDefinition.height);
+
+      auto yPos = messageBoxDefinition.y + 1;
+      const auto availableWidth = messageBoxDefinition.width - 1;
+      for (const auto& line : messageBoxDefinition.messageLines) {
+        const auto lineLength = static_cast<int>(line.size());
+        const auto offsetToCenter = (availableWidth - lineLength) / 2;
+
+        mMenuElementRenderer.drawText(xPos + 1 + offsetToCenter, yPos, line);
+        ++yPos;
+      }
+    },
+
+    [this](const ShowKeyBindings&) {
+      drawCurrentKeyBindings();
+    },
+
+    [this](const ShowSaveSlots& action) {
+      drawSaveSlotNames(action.mSelectedSlot);
+    },
+
+    // Only actions matched by isStaticDrawingAction() end up in a static
+    // layer. The others are still listed explicitly, so that adding a new
+    // action type causes a compile error here.
+    [](const AnimateNewsReporter&) { assert(false); },
+    [](const std::shared_ptr<PagesDefinition>&) { assert(false); },
+    [](const ConfigurePersistentMenuSelection&) { assert(false); },
+    [](const Delay&) { assert(false); },
+    [](const DisableMenuFunctionality&) { assert(false); },
+    [](const EnableTextOffset&) { assert(false); },
+    [](const EnableTimeOutToDemo&) { assert(false); },
+    [](const FadeIn&) { assert(false); },
+    [](const FadeOut&) { assert(false); },
+    [](const ScheduleFadeInBeforeNextWaitState&) { assert(false); },
+    [](const SetPalette&) { assert(false); },
+    [](const SetupCheckBoxes&) { assert(false); },
+    [](const ShowMenuSelectionIndicator&) { assert(false); },
+    [](const StopNewsReporterAnimation&) { assert(false); },
+    [](const WaitForUserInput&) { assert(false); });
+}
+
+
+void DukeScriptRunner::interpretAction(
+  const data::script::Action& scriptAction
+) {
+  using namespace data::script;
+
+  base::match(
+    scriptAction,
 
     [this](const AnimateNewsReporter& action) {
       mNewsReporterAnimationState = NewsReporterState{action.talkDuration};
@@ -372,18 +573,6 @@ void DukeScriptRunner::interpretNextAction() {
       stopNewsReporterAnimation();
     },
 
-    [this](const ShowFullScreenImage& showImage) {
-      updatePalette(
-        mpResourceBundle->loadPaletteFromFullScreenImage(showImage.image));
-
-      const auto imageTexture = fullScreenImageAsTexture(
-        mpRenderer,
-        *mpResourceBundle,
-        showImage.image);
-      imageTexture.render(mpRenderer, 0, 0);
-      mpRenderer->submitBatch();
-    },
-
     [this](const Delay& delay) {
       mDelayState = DelayState{delay.amount};
       mState = State::AwaitingUserInput;
@@ -393,31 +582,6 @@ void DukeScriptRunner::interpretNextAction() {
       mState = State::AwaitingUserInput;
     },
 
-    [this](const DrawBigText& action) {
-      drawBigText(
-        action.x + 2,
-        action.y,
-        action.colorIndex,
-        action.text);
-    },
-
-    [this](const DrawText& action) {
-      mMenuElementRenderer.drawText(action.x, action.y, action.text);
-    },
-
-    [this](const DrawSprite& action) {
-      drawSprite(
-        static_cast<data::ActorID>(action.spriteId),
-        action.frameNumber,
-        action.x,
-        action.y);
-    },
-
-    [this](const SetPalette& action) {
-      updatePalette(loader::load6bitPalette16(
-        mpResourceBundle->file(action.paletteFile)));
-    },
-
     [this](const SetupCheckBoxes& action) {
       CheckBoxesState state;
       state.mPosX = action.xPos;
@@ -435,26 +599,6 @@ void DukeScriptRunner::interpretNextAction() {
       displayCheckBoxes(state);
     },
 
-    [this](const ShowMessageBox& messageBoxDefinition) {
-      const auto xOffset = mTextBoxOffsetEnabled ? 3 : 0;
-      const auto xPos = (40 - messageBoxDefinition.width) / 2 - xOffset;
-      mMenuElementRenderer.drawMessageBox(
-        xPos,
-        messageBoxDefinition.y,
-        messageBoxDefinition.width,
-        messageBoxDefinition.height);
-
-      auto yPos = messageBoxDefinition.y + 1;
-      const auto availableWidth = messageBoxDefinition.width - 1;
-      for (const auto& line : messageBoxDefinition.messageLines) {
-        const auto lineLength = static_cast<int>(line.size());
-        const auto offsetToCenter = (availableWidth - lineLength) / 2;
-
-        mMenuElementRenderer.drawText(xPos + 1 + offsetToCenter, yPos, line);
-        ++yPos;
-      }
-    },
-
     [this](const ScheduleFadeInBeforeNextWaitState&) {
       mFadeInBeforeNextWaitStateScheduled = true;
     },
@@ -476,6 +620,7 @@ void DukeScriptRunner::interpretNextAction() {
 
       mPagerState = PagerState{
         definition.pages,
+        std::vector<std::optional<CompiledScript>>(definition.pages.size()),
         PagingMode::Menu,
         0,
         static_cast<int>(definition.pages.size() - 1)
@@ -502,13 +647,16 @@ void DukeScriptRunner::interpretNextAction() {
       // TODO
     },
 
-    [this](const ShowKeyBindings&) {
-      drawCurrentKeyBindings();
-    },
-
-    [this](const ShowSaveSlots& action) {
-      drawSaveSlotNames(action.mSelectedSlot);
-    }
+    // Drawing actions and palette changes are turned into static layers
+    // and PaletteChange entries by compile(), so they never end up here.
+    [](const DrawBigText&) { assert(false); },
+    [](const DrawSprite&) { assert(false); },
+    [](const DrawText&) { assert(false); },
+    [](const SetPalette&) { assert(false); },
+    [](const ShowFullScreenImage&) { assert(false); },
+    [](const ShowKeyBindings&) { assert(false); },
+    [](const ShowMessageBox&) { assert(false); },
+    [](const ShowSaveSlots&) { assert(false); }
   );
 }
 
@@ -534,7 +682,8 @@ void DukeScriptRunner::drawSprite(
   const auto drawOffsetPx =
     data::tileVectorToPixelVector(frameData.mDrawOffset);
 
-  renderer::OwningTexture spriteTexture(mpRenderer, image);
+  renderer::OwningTexture spriteTexture(
+    mpRenderer, image, renderer::TextureCategory::Ui);
   spriteTexture.render(mpRenderer, topLeftPx + drawOffsetPx);
   mpRenderer->submitBatch();
 }
@@ -595,7 +744,12 @@ void DukeScriptRunner::onPageChanged(PagerState& state) {
 
 
 void DukeScriptRunner::executeCurrentPageScript(PagerState& state) {
-  startExecution(state.mPageScripts[state.mCurrentPageIndex]);
+  auto& compiledPage = state.mCompiledPages[state.mCurrentPageIndex];
+  if (!compiledPage) {
+    compiledPage = compile(state.mPageScripts[state.mCurrentPageIndex]);
+  }
+
+  startExecution(*compiledPage);
 }
 
 
@@ -675,10 +829,12 @@ void DukeScriptRunner::drawCurrentKeyBindings() {
 
 
 void DukeScriptRunner::updatePalette(const loader::Palette16& palette) {
-  // TODO think about optimizing this maybe, to only update if actually
-  // changed, e.g. if (palette != mCurrentPalette) or maybe have a
-  // 'paletteSource' string (name of palette file or fullscreen image file),
-  // which can be compared to determine if update needed.
+  // Replaying a page re-applies its palette, which is usually the one
+  // that's already active. Rebuilding the sprite sheet is costly, so skip it
+  // in that case.
+  if (palette == mCurrentPalette) {
+    return;
+  }
 
   mCurrentPalette = palette;
   mUiSpriteSheetRenderer =
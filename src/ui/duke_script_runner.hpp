@@ -29,6 +29,8 @@
 
 #include <cstddef>
 #include <optional>
+#include <variant>
+#include <vector>
 
 
 namespace rigel::ui {
@@ -134,8 +136,31 @@ private:
     PagingOnly
   };
 
+  /** Run of consecutive drawing actions, cached as a transparent layer
+   *
+   * The actions are rendered into the layer the first time it's reached,
+   * afterwards, the layer is composited onto the canvas without
+   * re-interpreting them. The layer is re-rendered if the state which
+   * the drawing actions depend on has changed since.
+   */
+  struct StaticLayer {
+    std::vector<data::script::Action> mActions;
+    std::optional<renderer::RenderTargetTexture> mTexture;
+    loader::Palette16 mRenderedPalette;
+    bool mRenderedWithTextOffset = false;
+  };
+
+  struct PaletteChange {
+    loader::Palette16 mPalette;
+  };
+
+  using CompiledAction =
+    std::variant<data::script::Action, PaletteChange, StaticLayer>;
+  using CompiledScript = std::vector<CompiledAction>;
+
   struct PagerState {
     std::vector<data::script::Script> mPageScripts;
+    std::vector<std::optional<CompiledScript>> mCompiledPages;
     PagingMode mMode;
     int mCurrentPageIndex;
     int mMaxPageIndex;
@@ -153,8 +178,13 @@ private:
     int mCurrentMenuPosY;
   };
 
-  void startExecution(const data::script::Script& script);
+  CompiledScript compile(const data::script::Script& script) const;
+
+  void startExecution(CompiledScript& program);
   void interpretNextAction();
+  void interpretAction(const data::script::Action& action);
+  void drawStaticLayer(StaticLayer& layer);
+  void drawStaticAction(const data::script::Action& action);
 
   bool isInWaitState() const;
   void clearWaitState();
@@ -209,7 +239,8 @@ private:
   renderer::RenderTargetTexture mCanvas;
   std::optional<CanvasBinder> mBoundCanvasState;
 
-  data::script::Script mCurrentInstructions;
+  CompiledScript mScriptProgram;
+  CompiledScript* mpCurrentProgram = nullptr;
   std::size_t mProgramCounter;
   State mState = State::ReadyToExecute;
 
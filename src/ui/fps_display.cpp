@@ -32,10 +32,16 @@ namespace {
 const auto PRE_FILTER_WEIGHT = 0.7f;
 const auto FILTER_WEIGHT = 0.9f;
 
+const auto BYTES_PER_MB = 1024.0 * 1024.0;
+
 }
 
 
-void FpsDisplay::updateAndRender(const engine::TimeDelta totalElapsed) {
+void FpsDisplay::updateAndRender(
+  const engine::TimeDelta totalElapsed,
+  const CpuUsageReport& cpuUsage,
+  const renderer::TextureMemoryStatistics& textureMemory
+) {
   mPreFilteredFrameTime = base::lerp(
     static_cast<float>(totalElapsed), mPreFilteredFrameTime, PRE_FILTER_WEIGHT);
   mFilteredFrameTime = base::lerp(
@@ -47,7 +53,18 @@ void FpsDisplay::updateAndRender(const engine::TimeDelta totalElapsed) {
   statsReport
     << smoothedFps << " FPS, "
     << std::setw(4) << std::fixed << std::setprecision(2)
-    << totalElapsed * 1000.0 << " ms";
+    << totalElapsed * 1000.0 << " ms\n"
+    << std::setprecision(0)
+    << "CPU: " << cpuUsage.mForeground << "% active, "
+    << cpuUsage.mBackgroundLowRefreshRate << "% background, "
+    << cpuUsage.mBackgroundPaused << "% paused\n"
+    << std::setprecision(1)
+    << "VRAM: " << textureMemory.mTotal.mBytes / BYTES_PER_MB << " MB, peak "
+    << textureMemory.mTotal.mPeakBytes / BYTES_PER_MB << " MB";
+
+  if (textureMemory.mBudget) {
+    statsReport << ", budget " << *textureMemory.mBudget / BYTES_PER_MB << " MB";
+  }
 
   const auto reportString = statsReport.str();
   drawText(reportString, 0, 0, {255, 255, 255, 255});
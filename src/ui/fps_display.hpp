@@ -17,13 +17,30 @@
 #pragma once
 
 #include "engine/timing.hpp"
+#include "renderer/texture_memory.hpp"
 
 
 namespace rigel::ui {
 
+/** Average process CPU usage, in percent of a single core
+ *
+ * There is one value for each of the states the game can be in with regards
+ * to the window being active or not (see data::BackgroundMode). A state's
+ * value is 0 until the game has spent some time in it.
+ */
+struct CpuUsageReport {
+  float mForeground = 0.0f;
+  float mBackgroundLowRefreshRate = 0.0f;
+  float mBackgroundPaused = 0.0f;
+};
+
+
 class FpsDisplay {
 public:
-  void updateAndRender(engine::TimeDelta elapsed);
+  void updateAndRender(
+    engine::TimeDelta elapsed,
+    const CpuUsageReport& cpuUsage,
+    const renderer::TextureMemoryStatistics& textureMemory);
 
 
 private:
@@ -20,6 +20,7 @@
 #include "loader/palette.hpp"
 #include "loader/resource_loader.hpp"
 
+#include <cassert>
 #include <cmath>
 #include <string>
 
@@ -34,6 +35,8 @@ using namespace rigel::renderer;
 namespace {
 
 constexpr auto NUM_HEALTH_SLICES = 8;
+constexpr auto SCORE_DIGITS = 7;
+constexpr auto LEVEL_NUMBER_DIGITS = 1;
 
 constexpr auto RADAR_SIZE_PX = 32;
 constexpr auto RADAR_CENTER_POS_X = 288;
@@ -55,34 +58,58 @@ constexpr auto RADAR_BLINK_START_COLOR_INDEX = 3;
 const auto RADAR_DOT_COLOR = loader::INGAME_PALETTE[15];
 
 
-void drawNumbersBig(
-  const int number,
-  const int maxDigits,
-  const base::Vector& tlPosition,
-  const TiledTexture& spriteSheet
-) {
+/** Determine sprite sheet tile indices for drawing a number
+ *
+ * Leading positions are filled with -1 (nothing to draw) if the number has
+ * fewer digits than maxDigits. If it has more, only the last maxDigits
+ * digits are used.
+ */
+HudRenderer::DigitTiles toDigitTiles(const int number, const int maxDigits) {
+  assert(maxDigits <= HudRenderer::MAX_DIGITS);
+
   const auto printed = std::to_string(number);
 
   const auto overflow = maxDigits - static_cast<int>(printed.size());
   const auto inputToSkip = std::max(0, -overflow);
   const auto positionsToSkip = std::max(0, overflow);
 
-  for (auto digit=0; digit<maxDigits; ++digit) {
-    const auto tlPositionForDigit = tlPosition + base::Vector{digit*2, 0};
+  HudRenderer::DigitTiles result;
+  result.fill(-1);
 
+  for (auto digit=0; digit<maxDigits; ++digit) {
     if (digit >= positionsToSkip) {
       const auto numeralIndex =
         printed[digit - positionsToSkip + inputToSkip] - 0x30;
-      spriteSheet.renderTileQuad(numeralIndex*2 + 7*40, tlPositionForDigit);
+      result[digit] = numeralIndex*2 + 7*40;
     }
   }
+
+  return result;
 }
 
 
-void drawScore(const int score, const TiledTexture& spriteSheet) {
+void drawNumbersBig(
+  const HudRenderer::DigitTiles& digitTiles,
+  const int maxDigits,
+  const base::Vector& tlPosition,
+  const TiledTexture& spriteSheet
+) {
+  for (auto digit=0; digit<maxDigits; ++digit) {
+    if (digitTiles[digit] >= 0) {
+      const auto tlPositionForDigit = tlPosition + base::Vector{digit*2, 0};
+      spriteSheet.renderTileQuad(digitTiles[digit], tlPositionForDigit);
+    }
+  }
+}
+
+
+void drawScore(
+  const HudRenderer::DigitTiles& scoreDigitTiles,
+  const TiledTexture& spriteSheet
+) {
   drawNumbersBig(
-    score,
-    7,
+    scoreDigitTiles,
+    SCORE_DIGITS,
     base::Vector{2, GameTraits::mapViewPortSize.height + 1},
     spriteSheet);
 }
@@ -96,28 +123,31 @@ void drawWeaponIcon(const WeaponType type, const TiledTexture& spriteSheet) {
 }
 
 
-void drawAmmoBar(
-  const int currentAmmo,
-  const int maxAmmo,
-  const TiledTexture& spriteSheet
-) {
+int ammoBarTileIndex(const int currentAmmo, const int maxAmmo) {
   // The sprite sheet has 17 bar sizes; index 0 is full, 16 is empty.
   // Starting at col 0, row 23. Each bar is 2 tiles high
 
   const auto quantizedAmmoCount = static_cast<int>(std::ceil(
     static_cast<float>(currentAmmo) / maxAmmo * 16.0f));
 
-  const auto ammoBarIndex = 16 - quantizedAmmoCount;
+  return 16 - quantizedAmmoCount;
+}
+
+
+void drawAmmoBar(const int ammoBarIndex, const TiledTexture& spriteSheet) {
   spriteSheet.renderTileSlice(
     ammoBarIndex + 23*40,
     base::Vector{22, GameTraits::mapViewPortSize.height + 1});
 }
 
 
-void drawLevelNumber(const int number, const TiledTexture& spriteSheet) {
+void drawLevelNumber(
+  const HudRenderer::DigitTiles& levelNumberDigitTiles,
+  const TiledTexture& spriteSheet
+) {
   drawNumbersBig(
-    number,
-    1,
+    levelNumberDigitTiles,
+    LEVEL_NUMBER_DIGITS,
     base::Vector{
       GameTraits::mapViewPortSize.width + 2,
       GameTraits::mapViewPortSize.height},
@@ -129,7 +159,8 @@ OwningTexture actorToTexture(
   renderer::Renderer* pRenderer,
   const loader::ActorData& data
 ) {
-  return OwningTexture(pRenderer, data.mFrames[0].mFrameImage);
+  return OwningTexture(
+    pRenderer, data.mFrames[0].mFrameImage, renderer::TextureCategory::Hud);
 }
 
 
@@ -230,11 +261,20 @@ HudRenderer::HudRenderer(
   CollectedLetterIndicatorMap&& collectedLetterTextures,
   engine::TiledTexture* pStatusSpriteSheet
 )
-  : mLevelNumber(levelNumber)
+  : mLevelNumberDigitTiles(toDigitTiles(levelNumber, LEVEL_NUMBER_DIGITS))
   , mpRenderer(pRenderer)
-  , mTopRightTexture(mpRenderer, actorData.mFrames[0].mFrameImage)
-  , mBottomLeftTexture(mpRenderer, actorData.mFrames[1].mFrameImage)
-  , mBottomRightTexture(mpRenderer, actorData.mFrames[2].mFrameImage)
+  , mTopRightTexture(
+      mpRenderer,
+      actorData.mFrames[0].mFrameImage,
+      renderer::TextureCategory::Hud)
+  , mBottomLeftTexture(
+      mpRenderer,
+      actorData.mFrames[1].mFrameImage,
+      renderer::TextureCategory::Hud)
+  , mBottomRightTexture(
+      mpRenderer,
+      actorData.mFrames[2].mFrameImage,
+      renderer::TextureCategory::Hud)
   , mInventoryTexturesByType(std::move(inventoryItemTextures))
   , mCollectedLetterIndicatorsByType(std::move(collectedLetterTextures))
   , mpStatusSpriteSheetRenderer(pStatusSpriteSheet)
@@ -252,6 +292,8 @@ void HudRenderer::render(
   const data::PlayerModel& playerModel,
   const base::ArrayView<base::Vector> radarPositions
 ) {
+  updateCachedState(playerModel);
+
   // Hud background
   // --------------------------------------------------------------------------
   const auto maxX = GameTraits::inGameViewPortSize.width;
@@ -273,36 +315,69 @@ void HudRenderer::render(
   const auto inventoryStartPos = base::Vector{
     topRightTexturePosX + GameTraits::tileSize,
     2*GameTraits::tileSize};
-  auto inventoryIter = playerModel.inventory().begin();
+  auto iTexture = mInventoryItemTextures.begin();
   for (int row = 0; row < 3; ++row) {
     for (int col = 0; col < 2; ++col) {
-      if (inventoryIter != playerModel.inventory().end()) {
-        const auto itemType = *inventoryIter++;
+      if (iTexture != mInventoryItemTextures.end()) {
         const auto drawPos =
           inventoryStartPos + base::Vector{col, row} * GameTraits::tileSize*2;
-
-        const auto textureIt = mInventoryTexturesByType.find(itemType);
-        assert(textureIt != mInventoryTexturesByType.end());
-        textureIt->second.render(mpRenderer, drawPos);
+        (*iTexture++)->render(mpRenderer, drawPos);
       }
     }
   }
 
   // Player state and remaining HUD elements
   // --------------------------------------------------------------------------
-  drawScore(playerModel.score(), *mpStatusSpriteSheetRenderer);
+  drawScore(mScoreDigitTiles, *mpStatusSpriteSheetRenderer);
   drawWeaponIcon(playerModel.weapon(), *mpStatusSpriteSheetRenderer);
-  drawAmmoBar(
-    playerModel.ammo(),
-    playerModel.currentMaxAmmo(),
-    *mpStatusSpriteSheetRenderer);
+  drawAmmoBar(mAmmoBarIndex, *mpStatusSpriteSheetRenderer);
   drawHealthBar(playerModel);
-  drawLevelNumber(mLevelNumber, *mpStatusSpriteSheetRenderer);
-  drawCollectedLetters(playerModel);
+  drawLevelNumber(mLevelNumberDigitTiles, *mpStatusSpriteSheetRenderer);
+  drawCollectedLetters();
   drawRadar(radarPositions);
 }
 
 
+void HudRenderer::updateCachedState(const data::PlayerModel& playerModel) {
+  const auto& generations = playerModel.changeGenerations();
+  const auto hasChanged = [&](auto member) {
+    return !mLastSeenGenerations ||
+      (*mLastSeenGenerations).*member != generations.*member;
+  };
+
+  using G = data::PlayerModel::ChangeGenerations;
+
+  if (hasChanged(&G::mScore)) {
+    mScoreDigitTiles = toDigitTiles(playerModel.score(), SCORE_DIGITS);
+  }
+
+  if (hasChanged(&G::mAmmo)) {
+    mAmmoBarIndex =
+      ammoBarTileIndex(playerModel.ammo(), playerModel.currentMaxAmmo());
+  }
+
+  if (hasChanged(&G::mInventory)) {
+    mInventoryItemTextures.clear();
+    for (const auto itemType : playerModel.inventory()) {
+      const auto textureIt = mInventoryTexturesByType.find(itemType);
+      assert(textureIt != mInventoryTexturesByType.end());
+      mInventoryItemTextures.push_back(&textureIt->second);
+    }
+  }
+
+  if (hasChanged(&G::mLetters)) {
+    mCollectedLetterIndicators.clear();
+    for (const auto letter : playerModel.collectedLetters()) {
+      const auto it = mCollectedLetterIndicatorsByType.find(letter);
+      assert(it != mCollectedLetterIndicatorsByType.end());
+      mCollectedLetterIndicators.push_back(&it->second);
+    }
+  }
+
+  mLastSeenGenerations = generations;
+}
+
+
 void HudRenderer::drawHealthBar(const data::PlayerModel& playerModel) const {
   // Health slices start at col 20, row 4. The first 9 are for the "0 health"
   // animation
@@ -330,13 +405,9 @@ void HudRenderer::drawHealthBar(const data::PlayerModel& playerModel) const {
 }
 
 
-void HudRenderer::drawCollectedLetters(
-  const data::PlayerModel& playerModel
-) const {
-  for (const auto letter : playerModel.collectedLetters()) {
-    const auto it = mCollectedLetterIndicatorsByType.find(letter);
-    assert(it != mCollectedLetterIndicatorsByType.end());
-    it->second.mTexture.render(mpRenderer, it->second.mPxPosition);
+void HudRenderer::drawCollectedLetters() const {
+  for (const auto pIndicator : mCollectedLetterIndicators) {
+    pIndicator->mTexture.render(mpRenderer, pIndicator->mPxPosition);
   }
 }
 
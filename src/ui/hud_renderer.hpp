@@ -21,8 +21,11 @@
 #include "engine/tiled_texture.hpp"
 #include "renderer/texture.hpp"
 
+#include <array>
 #include <cstdint>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 
 namespace rigel {
@@ -50,6 +53,9 @@ inline bool isVisibleOnRadar(const base::Vector& position) {
 
 class HudRenderer {
 public:
+  static constexpr auto MAX_DIGITS = 7;
+  using DigitTiles = std::array<int, MAX_DIGITS>;
+
   HudRenderer(
     int levelNumber,
     renderer::Renderer* pRenderer,
@@ -88,11 +94,18 @@ private:
     renderer::Renderer* pRenderer,
     const loader::ActorImagePackage& imagePack);
 
+  /** Re-derive what's displayed for aspects of the model that have changed
+   *
+   * Uses the model's change generations to skip work for anything that's
+   * the same as last frame.
+   */
+  void updateCachedState(const data::PlayerModel& playerModel);
+
   void drawHealthBar(const data::PlayerModel& playerModel) const;
-  void drawCollectedLetters(const data::PlayerModel& playerModel) const;
+  void drawCollectedLetters() const;
   void drawRadar(base::ArrayView<base::Vector> positions) const;
 
-  const int mLevelNumber;
+  const DigitTiles mLevelNumberDigitTiles;
   renderer::Renderer* mpRenderer;
 
   std::uint32_t mElapsedFrames = 0;
@@ -104,6 +117,12 @@ private:
   CollectedLetterIndicatorMap mCollectedLetterIndicatorsByType;
   engine::TiledTexture* mpStatusSpriteSheetRenderer;
   mutable renderer::RenderTargetTexture mRadarSurface;
+
+  std::optional<data::PlayerModel::ChangeGenerations> mLastSeenGenerations;
+  DigitTiles mScoreDigitTiles{};
+  int mAmmoBarIndex = 0;
+  std::vector<const renderer::OwningTexture*> mInventoryItemTextures;
+  std::vector<const CollectedLetterIndicator*> mCollectedLetterIndicators;
 };
 
 }}
@@ -16,6 +16,8 @@
 
 #include "imgui_integration.hpp"
 
+#include "renderer/renderer.hpp"
+
 RIGEL_DISABLE_WARNINGS
 #include <imgui.h>
 #include <imgui_impl_sdl.h>
@@ -23,6 +25,8 @@ RIGEL_DISABLE_WARNINGS
 RIGEL_RESTORE_WARNINGS
 
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 
 namespace rigel::ui::imgui_integration {
@@ -72,6 +76,39 @@ void updateUiScale(const int, const int newHeight) {
   ImGui::GetStyle().ScaleAllSizes(scaleFactor * INITIAL_UI_SCALE);
 }
 
+
+/** Copy of a frame's draw data, which stays valid after the next NewFrame() */
+class DrawDataSnapshot {
+public:
+  explicit DrawDataSnapshot(const ImDrawData& drawData)
+    : mDrawData(drawData)
+  {
+    mDrawLists.reserve(drawData.CmdListsCount);
+    for (int i = 0; i < drawData.CmdListsCount; ++i) {
+      mDrawLists.push_back(drawData.CmdLists[i]->CloneOutput());
+    }
+
+    mDrawData.CmdLists = mDrawLists.data();
+  }
+
+  ~DrawDataSnapshot() {
+    for (auto pDrawList : mDrawLists) {
+      IM_DELETE(pDrawList);
+    }
+  }
+
+  DrawDataSnapshot(const DrawDataSnapshot&) = delete;
+  DrawDataSnapshot& operator=(const DrawDataSnapshot&) = delete;
+
+  ImDrawData* get() {
+    return &mDrawData;
+  }
+
+private:
+  ImDrawData mDrawData;
+  std::vector<ImDrawList*> mDrawLists;
+};
+
 }
 
 
@@ -106,6 +143,10 @@ void init(
   // GL ES as well as regular GL.
   ImGui_ImplOpenGL3_Init(nullptr);
 
+  // The OpenGL backend would otherwise create its resources lazily in
+  // beginFrame(), which doesn't work when using a render thread.
+  ImGui_ImplOpenGL3_CreateDeviceObjects();
+
   if (preferencesPath) {
     const auto iniFilePath = *preferencesPath / "ImGui.ini";
     gIniFilePath = iniFilePath.u8string();
@@ -152,4 +193,19 @@ void endFrame() {
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
 
+
+void endFrame(renderer::Renderer* pRenderer) {
+  ImGui::Render();
+
+  if (!pRenderer->isRecordingCommands()) {
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    return;
+  }
+
+  auto pSnapshot = std::make_shared<DrawDataSnapshot>(*ImGui::GetDrawData());
+  pRenderer->submitCustomCommand([pSnapshot]() {
+    ImGui_ImplOpenGL3_RenderDrawData(pSnapshot->get());
+  });
+}
+
 }
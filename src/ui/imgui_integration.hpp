@@ -26,6 +26,9 @@ RIGEL_RESTORE_WARNINGS
 #include <optional>
 
 
+namespace rigel::renderer { class Renderer; }
+
+
 namespace rigel::ui::imgui_integration {
 
 void init(
@@ -38,4 +41,12 @@ bool handleEvent(const SDL_Event& event);
 void beginFrame(SDL_Window* pWindow);
 void endFrame();
 
+/** Finish the frame, drawing the UI via the given renderer
+ *
+ * Unlike endFrame(), this also works when the renderer is using a render
+ * thread. The UI's draw data is copied in that case, since Dear ImGui
+ * reuses it for the next frame.
+ */
+void endFrame(renderer::Renderer* pRenderer);
+
 }
@@ -166,7 +166,8 @@ renderer::OwningTexture createFontTexture(
     insertPosX += characterWidth;
   }
 
-  return renderer::OwningTexture{pRenderer, combinedBitmaps};
+  return renderer::OwningTexture{
+    pRenderer, combinedBitmaps, renderer::TextureCategory::Ui};
 }
 
 }
@@ -51,15 +51,18 @@ void MoviePlayer::playMovie(
     auto binder = renderer::RenderTargetTexture::Binder{mCanvas, mpRenderer};
     auto saved = renderer::setupDefaultState(mpRenderer);
 
-    auto baseImage = renderer::OwningTexture(mpRenderer, movie.mBaseImage);
+    auto baseImage = renderer::OwningTexture(
+      mpRenderer, movie.mBaseImage, renderer::TextureCategory::Movie);
     baseImage.render(mpRenderer, 0, 0);
     mpRenderer->submitBatch();
   }
 
   mAnimationFrames = utils::transformed(movie.mFrames,
     [this](const auto& frame) {
-      auto texture =
-        renderer::OwningTexture(mpRenderer, frame.mReplacementImage);
+      auto texture = renderer::OwningTexture(
+        mpRenderer,
+        frame.mReplacementImage,
+        renderer::TextureCategory::Movie);
       return FrameData{std::move(texture), frame.mStartRow};
     });
 
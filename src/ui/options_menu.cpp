@@ -166,6 +166,26 @@ void OptionsMenu::updateAndRender(engine::TimeDelta dt) {
       ImGui::NewLine();
 
       ImGui::Checkbox("Show FPS", &mpOptions->mShowFpsCounter);
+      ImGui::NewLine();
+
+#ifndef __EMSCRIPTEN__
+      {
+        auto backgroundModeIndex =
+          static_cast<int>(mpOptions->mBackgroundMode);
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 20);
+        ImGui::Combo(
+          "When in background",
+          &backgroundModeIndex,
+          "Pause game\0Keep running (low refresh rate)\0");
+        mpOptions->mBackgroundMode =
+          static_cast<data::BackgroundMode>(backgroundModeIndex);
+      }
+      ImGui::NewLine();
+#endif
+
+      ImGui::Checkbox(
+        "Indexed color textures (applies on next level load)",
+        &mpOptions->mEnableIndexedColorTextures);
       ImGui::EndTabItem();
     }
 
@@ -186,6 +206,18 @@ void OptionsMenu::updateAndRender(engine::TimeDelta dt) {
       ImGui::Checkbox("Sound on", &mpOptions->mSoundOn);
       ImGui::NewLine();
 
+      {
+        auto emulatorTypeIndex =
+          static_cast<int>(mpOptions->mAdlibEmulatorType);
+        ImGui::SetNextItemWidth(ImGui::GetFontSize() * 20);
+        ImGui::Combo(
+          "Adlib emulator",
+          &emulatorTypeIndex,
+          "DOSBox (most accurate)\0Fast\0");
+        mpOptions->mAdlibEmulatorType =
+          static_cast<data::AdlibEmulatorType>(emulatorTypeIndex);
+      }
+
       ImGui::EndTabItem();
     }
 
@@ -44,7 +44,8 @@ renderer::OwningTexture fullScreenImageAsTexture(
 ) {
   return renderer::OwningTexture(
     pRenderer,
-    resources.loadStandaloneFullscreenImage(imageName));
+    resources.loadStandaloneFullscreenImage(imageName),
+    renderer::TextureCategory::FullScreenImage);
 }
 
 
@@ -57,7 +58,8 @@ engine::TiledTexture makeUiSpriteSheet(
     renderer::OwningTexture{
       pRenderer,
       resourceLoader.loadTiledFullscreenImage(
-        "STATUS.MNI", palette)},
+        "STATUS.MNI", palette),
+      renderer::TextureCategory::Ui},
     pRenderer};
 }
 
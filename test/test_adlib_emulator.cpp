@@ -0,0 +1,213 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <loader/adlib_emulator.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+
+using namespace rigel;
+using data::AdlibEmulatorType;
+
+
+namespace {
+
+constexpr auto SAMPLE_RATE = 44100;
+
+
+void setUpSineTone(loader::AdlibEmulator& emulator, const int channel) {
+  constexpr int OPERATOR_OFFSETS[] = {0, 1, 2, 8, 9, 10, 16, 17, 18};
+  const auto offset = OPERATOR_OFFSETS[channel];
+
+  // Silent modulator, carrier with instant attack and full sustain
+  emulator.writeRegister(0x20 + offset, 0x21);
+  emulator.writeRegister(0x23 + offset, 0x21);
+  emulator.writeRegister(0x40 + offset, 0x3F);
+  emulator.writeRegister(0x43 + offset, 0x00);
+  emulator.writeRegister(0x60 + offset, 0xF0);
+  emulator.writeRegister(0x63 + offset, 0xF0);
+  emulator.writeRegister(0x80 + offset, 0x0F);
+  emulator.writeRegister(0x83 + offset, 0x0F);
+}
+
+
+void keyOn(loader::AdlibEmulator& emulator, const int channel) {
+  // Roughly 243 Hz
+  emulator.writeRegister(0xA0 + channel, 0x41);
+  emulator.writeRegister(0xB0 + channel, 0x20 | (4 << 2) | 0x01);
+}
+
+
+void keyOff(loader::AdlibEmulator& emulator, const int channel) {
+  emulator.writeRegister(0xB0 + channel, (4 << 2) | 0x01);
+}
+
+
+std::vector<std::int16_t> render(
+  loader::AdlibEmulator& emulator,
+  const std::size_t numSamples
+) {
+  std::vector<std::int16_t> samples;
+  emulator.render(numSamples, std::back_inserter(samples));
+  return samples;
+}
+
+
+std::vector<std::int16_t> renderSineTone(const AdlibEmulatorType type) {
+  loader::AdlibEmulator emulator{SAMPLE_RATE, type};
+  setUpSineTone(emulator, 0);
+  keyOn(emulator, 0);
+  return render(emulator, SAMPLE_RATE);
+}
+
+
+int countZeroCrossings(const std::vector<std::int16_t>& samples) {
+  auto count = 0;
+  for (auto i = 1u; i < samples.size(); ++i) {
+    if (samples[i - 1] < 0 && samples[i] >= 0) {
+      ++count;
+    }
+  }
+
+  return count;
+}
+
+
+double rmsLevel(const std::vector<std::int16_t>& samples) {
+  auto sum = 0.0;
+  for (const auto sample : samples) {
+    sum += double(sample) * sample;
+  }
+
+  return std::sqrt(sum / samples.size());
+}
+
+}
+
+
+TEST_CASE("Fast OPL2 emulator matches DBOPL for a sine tone") {
+  const auto reference = renderSineTone(AdlibEmulatorType::DBOPL);
+  const auto fast = renderSineTone(AdlibEmulatorType::Fast);
+
+  REQUIRE(fast.size() == reference.size());
+
+  CHECK(countZeroCrossings(fast) == countZeroCrossings(reference));
+  CHECK(countZeroCrossings(fast) == 243);
+
+  const auto levelDifference =
+    20.0 * std::log10(rmsLevel(fast) / rmsLevel(reference));
+  CHECK(std::abs(levelDifference) < 0.25);
+
+  const auto [referenceMin, referenceMax] =
+    std::minmax_element(reference.begin(), reference.end());
+  const auto [fastMin, fastMax] = std::minmax_element(fast.begin(), fast.end());
+  CHECK(std::abs(*fastMax - *referenceMax) < 50);
+  CHECK(std::abs(*fastMin - *referenceMin) < 50);
+}
+
+
+TEST_CASE("Fast OPL2 emulator goes silent after key off") {
+  loader::AdlibEmulator emulator{SAMPLE_RATE, AdlibEmulatorType::Fast};
+  setUpSineTone(emulator, 4);
+
+  SECTION("Before key on") {
+    const auto samples = render(emulator, 1000);
+    CHECK(std::all_of(
+      samples.begin(), samples.end(), [](const auto s) { return s == 0; }));
+  }
+
+  SECTION("After key off") {
+    keyOn(emulator, 4);
+    CHECK(rmsLevel(render(emulator, 1000)) > 1000.0);
+
+    keyOff(emulator, 4);
+
+    // Release rate 15 takes a few milliseconds to reach silence
+    render(emulator, SAMPLE_RATE / 10);
+
+    const auto samples = render(emulator, 1000);
+    CHECK(std::all_of(
+      samples.begin(), samples.end(), [](const auto s) { return s == 0; }));
+  }
+}
+
+
+TEST_CASE("Adlib emulator type can be changed during playback") {
+  loader::AdlibEmulator emulator{SAMPLE_RATE, AdlibEmulatorType::DBOPL};
+  CHECK(emulator.type() == AdlibEmulatorType::DBOPL);
+
+  setUpSineTone(emulator, 0);
+  keyOn(emulator, 0);
+  const auto before = render(emulator, SAMPLE_RATE / 10);
+
+  emulator.setType(AdlibEmulatorType::Fast);
+  CHECK(emulator.type() == AdlibEmulatorType::Fast);
+
+  // Register state is carried over, so the tone keeps playing
+  const auto after = render(emulator, SAMPLE_RATE / 10);
+  CHECK(rmsLevel(after) == Approx(rmsLevel(before)).epsilon(0.05));
+  CHECK(
+    std::abs(countZeroCrossings(after) - countZeroCrossings(before)) <= 1);
+}
+
+
+TEST_CASE("Adlib emulator throughput", "[.][benchmark]") {
+  constexpr auto SECONDS_OF_AUDIO = 60;
+
+  using Clock = std::chrono::high_resolution_clock;
+
+  const auto measure = [](const AdlibEmulatorType type) {
+    loader::AdlibEmulator emulator{SAMPLE_RATE, type};
+    for (auto channel = 0; channel < 9; ++channel) {
+      setUpSineTone(emulator, channel);
+    }
+
+    // Keep all channels busy, but alternate key on and off to also exercise
+    // envelopes.
+    std::vector<std::int16_t> samples(SAMPLE_RATE / 4);
+    const auto start = Clock::now();
+    for (auto i = 0; i < SECONDS_OF_AUDIO * 4; ++i) {
+      for (auto channel = 0; channel < 9; ++channel) {
+        if (i % 2 == 0) {
+          keyOn(emulator, channel);
+        } else {
+          keyOff(emulator, channel);
+        }
+      }
+
+      emulator.render(samples.size(), samples.begin());
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start);
+  };
+
+  const auto dbOplTime = measure(AdlibEmulatorType::DBOPL);
+  const auto fastTime = measure(AdlibEmulatorType::Fast);
+
+  WARN(
+    "Rendering " << SECONDS_OF_AUDIO << " s of 9-channel audio - DBOPL: "
+    << dbOplTime.count() << " ms, fast: " << fastTime.count()
+    << " ms, speed ratio: " << dbOplTime / fastTime);
+}
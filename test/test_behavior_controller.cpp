@@ -0,0 +1,350 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <engine/random_number_generator.hpp>
+#include <game_logic/behavior_controller.hpp>
+#include <game_logic/dynamic_geometry_components.hpp>
+#include <game_logic/effect_actor_components.hpp>
+#include <game_logic/enemies/big_green_cat.hpp>
+#include <game_logic/enemies/bomber_plane.hpp>
+#include <game_logic/enemies/boss_episode_1.hpp>
+#include <game_logic/enemies/boss_episode_2.hpp>
+#include <game_logic/enemies/boss_episode_3.hpp>
+#include <game_logic/enemies/boss_episode_4.hpp>
+#include <game_logic/enemies/ceiling_sucker.hpp>
+#include <game_logic/enemies/dying_boss.hpp>
+#include <game_logic/enemies/enemy_rocket.hpp>
+#include <game_logic/enemies/eyeball_thrower.hpp>
+#include <game_logic/enemies/flame_thrower_bot.hpp>
+#include <game_logic/enemies/floating_laser_bot.hpp>
+#include <game_logic/enemies/grabber_claw.hpp>
+#include <game_logic/enemies/green_bird.hpp>
+#include <game_logic/enemies/red_bird.hpp>
+#include <game_logic/enemies/rigelatin_soldier.hpp>
+#include <game_logic/enemies/security_camera.hpp>
+#include <game_logic/enemies/small_flying_ship.hpp>
+#include <game_logic/enemies/snake.hpp>
+#include <game_logic/enemies/spiked_green_creature.hpp>
+#include <game_logic/enemies/unicycle_bot.hpp>
+#include <game_logic/enemies/wall_walker.hpp>
+#include <game_logic/enemies/watch_bot.hpp>
+#include <game_logic/hazards/lava_fountain.hpp>
+#include <game_logic/hazards/slime_pipe.hpp>
+#include <game_logic/hazards/smash_hammer.hpp>
+#include <game_logic/interactive/blowing_fan.hpp>
+#include <game_logic/interactive/missile.hpp>
+#include <game_logic/interactive/respawn_checkpoint.hpp>
+#include <game_logic/interactive/super_force_field.hpp>
+#include <game_logic/interactive/tile_burner.hpp>
+#include <game_logic/player/ship.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+
+using namespace rigel;
+using namespace game_logic;
+using namespace game_logic::components;
+
+namespace ex = entityx;
+
+
+namespace {
+
+struct Counter {
+  void update(
+    GlobalDependencies&,
+    GlobalState&,
+    bool,
+    ex::Entity
+  ) {
+    ++mUpdates;
+  }
+
+  void onHit(
+    GlobalDependencies&,
+    GlobalState&,
+    const engine::Velocity&,
+    ex::Entity
+  ) {
+    ++mHits;
+  }
+
+  int mUpdates = 0;
+  int mHits = 0;
+};
+
+
+// Too large to be stored inline
+struct LargeCounter : Counter {
+  std::array<char, BehaviorController::INLINE_STORAGE_SIZE> mPadding{};
+};
+
+
+// Reference implementation of the type erasure previously used by
+// BehaviorController, based on a shared_ptr and virtual functions.
+class SharedBehaviorController {
+public:
+  template<typename T>
+  explicit SharedBehaviorController(T controller)
+    : mpSelf(std::make_shared<Model<T>>(std::move(controller)))
+  {
+  }
+
+  void update(
+    GlobalDependencies& dependencies,
+    GlobalState& state,
+    const bool isOnScreen,
+    ex::Entity entity
+  ) {
+    mpSelf->update(dependencies, state, isOnScreen, entity);
+  }
+
+  template<typename T>
+  T& get() {
+    return dynamic_cast<Model<T>*>(mpSelf.get())->mData;
+  }
+
+private:
+  struct Concept {
+    virtual ~Concept() = default;
+    virtual void update(
+      GlobalDependencies& dependencies,
+      GlobalState& state,
+      bool isOnScreen,
+      ex::Entity entity) = 0;
+  };
+
+  template<typename T>
+  struct Model : Concept {
+    explicit Model(T data)
+      : mData(std::move(data))
+    {
+    }
+
+    void update(
+      GlobalDependencies& dependencies,
+      GlobalState& state,
+      const bool isOnScreen,
+      ex::Entity entity
+    ) override {
+      updateBehaviorController(
+        mData, dependencies, state, isOnScreen, entity);
+    }
+
+    T mData;
+  };
+
+  std::shared_ptr<Concept> mpSelf;
+};
+
+
+using Clock = std::chrono::high_resolution_clock;
+
+template<typename Func>
+double measureMs(Func&& func) {
+  const auto start = Clock::now();
+  func();
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+    .count();
+}
+
+}
+
+
+TEST_CASE("Behavior controller stores controllers by value") {
+  GlobalDependencies dependencies{};
+  GlobalState state{nullptr, nullptr, nullptr, nullptr, nullptr};
+
+  static_assert(BehaviorController::isStoredInline<Counter>());
+  static_assert(!BehaviorController::isStoredInline<LargeCounter>());
+
+  const auto runTestsFor = [&](auto controllerPrototype) {
+    using T = decltype(controllerPrototype);
+
+    BehaviorController controller{controllerPrototype};
+    controller.update(dependencies, state, true, ex::Entity{});
+    controller.onHit(dependencies, state, {}, ex::Entity{});
+    CHECK(controller.get<T>().mUpdates == 1);
+    CHECK(controller.get<T>().mHits == 1);
+
+    SECTION("Copies are independent") {
+      auto copy = controller;
+      copy.update(dependencies, state, true, ex::Entity{});
+
+      CHECK(copy.get<T>().mUpdates == 2);
+      CHECK(controller.get<T>().mUpdates == 1);
+
+      copy = controller;
+      CHECK(copy.get<T>().mUpdates == 1);
+    }
+
+    SECTION("Moving preserves state") {
+      auto moved = std::move(controller);
+      CHECK(moved.get<T>().mUpdates == 1);
+
+      BehaviorController assigned{Counter{}};
+      assigned = std::move(moved);
+      CHECK(assigned.get<T>().mHits == 1);
+    }
+  };
+
+  SECTION("Inline storage") {
+    runTestsFor(Counter{});
+  }
+
+  SECTION("Heap storage") {
+    runTestsFor(LargeCounter{});
+  }
+}
+
+
+TEST_CASE("Behavior controller performance", "[.][benchmark]") {
+  using namespace behaviors;
+
+  constexpr auto NUM_REPETITIONS = 2000;
+  constexpr auto NUM_UPDATES = 500;
+
+  engine::RandomNumberGenerator randomGenerator;
+
+  // One factory per controller type in the game. Each assigns a controller
+  // of its type to an entity, using either the current or the previous
+  // implementation of type erasure.
+  const auto assignersFor = [&](auto makeController) {
+    return std::make_pair(
+      std::function<void(ex::Entity)>{[=](ex::Entity entity) {
+        entity.assign<BehaviorController>(makeController());
+      }},
+      std::function<void(ex::Entity)>{[=](ex::Entity entity) {
+        entity.assign<SharedBehaviorController>(makeController());
+      }});
+  };
+
+  const std::vector<
+    std::pair<std::function<void(ex::Entity)>, std::function<void(ex::Entity)>>
+  > assigners{
+    assignersFor([]() { return AirLockDeathTrigger{}; }),
+    assignersFor([]() { return BigBomb{}; }),
+    assignersFor([]() { return BigGreenCat{}; }),
+    assignersFor([]() { return BlowingFan{}; }),
+    assignersFor([]() { return BomberPlane{}; }),
+    assignersFor([]() { return BossEpisode1{}; }),
+    assignersFor([]() { return BossEpisode2{}; }),
+    assignersFor([]() { return BossEpisode3{}; }),
+    assignersFor([]() { return BossEpisode4{}; }),
+    assignersFor([]() { return BrokenMissile{}; }),
+    assignersFor([]() { return CeilingSucker{}; }),
+    assignersFor([]() { return DyingBoss{}; }),
+    assignersFor([]() {
+      return DynamicGeometryController{
+        DynamicGeometryController::Type::FallDownAfterDelayThenSinkIntoGround};
+    }),
+    assignersFor([]() { return EnemyRocket{{1, 0}}; }),
+    assignersFor([]() { return ExplosionEffect{}; }),
+    assignersFor([]() { return EyeballThrower{}; }),
+    assignersFor([]() { return FlameThrowerBot{}; }),
+    assignersFor([]() { return FloatingLaserBot{}; }),
+    assignersFor([]() { return GrabberClaw{}; }),
+    assignersFor([]() { return GreenBird{}; }),
+    assignersFor([]() { return LavaFountain{}; }),
+    assignersFor([]() { return Missile{}; }),
+    assignersFor([]() { return PlayerShip{false}; }),
+    assignersFor([]() { return RedBird{}; }),
+    assignersFor([]() { return interaction::RespawnCheckpoint{}; }),
+    assignersFor([]() { return RigelatinSoldier{}; }),
+    assignersFor([]() { return SecurityCamera{}; }),
+    assignersFor([]() { return SlimeDrop{}; }),
+    assignersFor([]() { return SlimePipe{}; }),
+    assignersFor([]() { return SmallFlyingShip{}; }),
+    assignersFor([]() { return SmashHammer{}; }),
+    assignersFor([]() { return Snake{}; }),
+    assignersFor([]() { return SpikedGreenCreature{}; }),
+    assignersFor([]() { return SuperForceField{}; }),
+    assignersFor([]() { return TileBurner{}; }),
+    assignersFor([]() { return UnicycleBot{}; }),
+    assignersFor([&randomGenerator]() {
+      return WallWalker{randomGenerator};
+    }),
+    assignersFor([]() { return WatchBot{}; }),
+    assignersFor([]() { return WatchBotCarrier{}; }),
+    assignersFor([]() { return WaterDropGenerator{}; }),
+    assignersFor([]() { return WindBlownSpiderGenerator{}; })
+  };
+
+  ex::EntityX entityx;
+
+  const auto measureCreation = [&](const bool useReference) {
+    return measureMs([&]() {
+      for (int i = 0; i < NUM_REPETITIONS; ++i) {
+        for (const auto& [assign, assignReference] : assigners) {
+          auto entity = entityx.entities.create();
+          if (useReference) {
+            assignReference(entity);
+          } else {
+            assign(entity);
+          }
+        }
+
+        entityx.entities.reset();
+      }
+    });
+  };
+
+  const auto creationTime = measureCreation(false);
+  const auto referenceCreationTime = measureCreation(true);
+
+  WARN(
+    "Creating " << NUM_REPETITIONS << " x " << assigners.size()
+    << " entities with controllers - value semantics: " << creationTime
+    << " ms, shared_ptr: " << referenceCreationTime << " ms");
+
+  // Controller logic needs a fully set up game world, so dispatch overhead
+  // is measured using a trivial controller instead
+  GlobalDependencies dependencies{};
+  GlobalState state{nullptr, nullptr, nullptr, nullptr, nullptr};
+
+  const auto measureDispatch = [&](auto controllerPrototype) {
+    using ControllerT = decltype(controllerPrototype);
+
+    std::vector<ControllerT> controllers(
+      assigners.size() * 64, controllerPrototype);
+    return measureMs([&]() {
+      for (int i = 0; i < NUM_UPDATES; ++i) {
+        for (auto& controller : controllers) {
+          controller.update(dependencies, state, true, ex::Entity{});
+        }
+      }
+    });
+  };
+
+  const auto inlineTime = measureDispatch(BehaviorController{Counter{}});
+  const auto heapTime = measureDispatch(BehaviorController{LargeCounter{}});
+  const auto referenceTime =
+    measureDispatch(SharedBehaviorController{Counter{}});
+
+  WARN(
+    "Dispatching " << NUM_UPDATES << " x " << assigners.size() * 64
+    << " updates - inline: " << inlineTime << " ms, heap: " << heapTime
+    << " ms, shared_ptr: " << referenceTime << " ms");
+}
@@ -0,0 +1,117 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <renderer/draw_command_reordering.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+using namespace renderer;
+
+
+namespace {
+
+ReorderableCommand command(const int stateId, const int x, const int y) {
+  return ReorderableCommand{stateId, {{x, y}, {8, 8}}};
+}
+
+
+std::vector<int> reorder(
+  const std::vector<ReorderableCommand>& commands,
+  int* pNumBatches = nullptr
+) {
+  std::vector<int> order;
+  const auto numBatches = determineReorderedSequence(commands, order);
+  if (pNumBatches) {
+    *pNumBatches = numBatches;
+  }
+  return order;
+}
+
+}
+
+
+TEST_CASE("Draw command reordering") {
+  SECTION("Empty input") {
+    int numBatches = -1;
+    CHECK(reorder({}, &numBatches).empty());
+    CHECK(numBatches == 0);
+    CHECK(countBatches({}) == 0);
+  }
+
+  SECTION("Non-overlapping commands are grouped by state") {
+    const auto commands = std::vector<ReorderableCommand>{
+      command(0, 0, 0),
+      command(1, 10, 0),
+      command(0, 20, 0),
+      command(1, 30, 0),
+      command(0, 40, 0)
+    };
+
+    int numBatches = 0;
+    const auto expectedOrder = std::vector<int>{0, 2, 4, 1, 3};
+    CHECK(reorder(commands, &numBatches) == expectedOrder);
+    CHECK(numBatches == 2);
+    CHECK(countBatches(commands) == 5);
+  }
+
+  SECTION("Overlapping commands keep their relative order") {
+    // Command 2 overlaps command 1, so it can't be moved in front of it
+    const auto commands = std::vector<ReorderableCommand>{
+      command(0, 0, 0),
+      command(1, 10, 0),
+      command(0, 14, 4),
+    };
+
+    int numBatches = 0;
+    const auto expectedOrder = std::vector<int>{0, 1, 2};
+    CHECK(reorder(commands, &numBatches) == expectedOrder);
+    CHECK(numBatches == 3);
+  }
+
+  SECTION("Commands can be moved past non-overlapping ones only") {
+    const auto commands = std::vector<ReorderableCommand>{
+      command(0, 0, 0),
+      command(1, 0, 0), // overlaps 0
+      command(2, 20, 0),
+      command(1, 40, 0), // doesn't overlap 2, joins 1
+      command(2, 4, 4),  // joins 2, which is the most recent group
+      command(0, 4, 0),  // overlaps 4, can't join 0
+    };
+
+    int numBatches = 0;
+    const auto expectedOrder = std::vector<int>{0, 1, 3, 2, 4, 5};
+    CHECK(reorder(commands, &numBatches) == expectedOrder);
+    CHECK(numBatches == 4);
+  }
+
+  SECTION("Touching rectangles don't count as overlapping") {
+    const auto commands = std::vector<ReorderableCommand>{
+      command(0, 0, 0),
+      command(1, 8, 0),
+      command(0, 16, 0),
+    };
+
+    const auto expectedOrder = std::vector<int>{0, 2, 1};
+    CHECK(reorder(commands) == expectedOrder);
+  }
+}
@@ -0,0 +1,196 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/fixed_point.hpp>
+#include <base/spatial_types_printing.hpp>
+#include <base/warnings.hpp>
+
+#include <data/map.hpp>
+#include <engine/collision_checker.hpp>
+#include <engine/physical_components.hpp>
+#include <engine/physics_system.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+namespace ex = entityx;
+
+
+static_assert(MotionValue{0.5f}.raw() == MotionValue::ONE / 2);
+static_assert(MotionValue{-2}.raw() == -2 * MotionValue::ONE);
+static_assert(MotionValue{1.5f} + MotionValue{0.5f} == MotionValue{2});
+static_assert(-MotionValue{0.5f} == MotionValue{-0.5f});
+static_assert(MotionValue{1.5f} * 2 == MotionValue{3});
+static_assert(static_cast<int>(MotionValue{1.5f}) == 1);
+static_assert(static_cast<int>(MotionValue{-1.5f}) == -1);
+
+
+namespace {
+
+// Reference implementation of the physics previously used by PhysicsSystem,
+// based on floats. Only valid for bodies which are not colliding with
+// anything.
+struct FloatBody {
+  float mVelocityX;
+  float mVelocityY;
+  base::Vector mPosition;
+};
+
+
+void stepFloatReference(FloatBody& body) {
+  body.mPosition.x += static_cast<std::int16_t>(body.mVelocityX);
+
+  if (body.mVelocityY == 0.0f) {
+    body.mVelocityY = 0.5f;
+  } else if (body.mVelocityY < 2.0f) {
+    body.mVelocityY += 0.5f;
+  } else {
+    body.mVelocityY = 2.0f;
+  }
+
+  body.mPosition.y += static_cast<std::int16_t>(body.mVelocityY);
+}
+
+}
+
+
+TEST_CASE("Fixed-point truncation matches float to int conversion") {
+  for (int raw = -16 * MotionValue::ONE; raw <= 16 * MotionValue::ONE; ++raw) {
+    const auto value = MotionValue::fromRaw(raw);
+    const auto asFloat = value.toFloat();
+
+    REQUIRE(MotionValue{asFloat} == value);
+    REQUIRE(
+      static_cast<std::int16_t>(value) == static_cast<std::int16_t>(asFloat));
+  }
+}
+
+
+TEST_CASE("Fixed-point motion produces deterministic trajectories") {
+  ex::EntityX entityx;
+
+  data::map::Map map{200, 200, data::map::TileAttributeDict{{0x0, 0xF}}};
+
+  CollisionChecker collisionChecker{&map, entityx.entities, entityx.events};
+  PhysicsSystem physicsSystem{&collisionChecker, &map, &entityx.events};
+
+  auto body = entityx.entities.create();
+  body.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 2}});
+  body.assign<WorldPosition>(WorldPosition{10, 10});
+  body.assign<Active>();
+
+  const auto runFramesAndCollect = [&](const int numFrames) {
+    std::vector<base::Vector> positions;
+    for (int i = 0; i < numFrames; ++i) {
+      physicsSystem.update(entityx.entities);
+      positions.push_back(*body.component<WorldPosition>());
+    }
+    return positions;
+  };
+
+  SECTION("Recorded trajectory is reproduced exactly") {
+    body.assign<MovingBody>(Velocity{1.5f, 0}, true);
+
+    const auto expectedPositions = std::vector<base::Vector>{
+      {11, 10},
+      {12, 11},
+      {13, 12},
+      {14, 14},
+      {15, 16},
+      {16, 18}
+    };
+
+    CHECK(runFramesAndCollect(6) == expectedPositions);
+  }
+
+  SECTION("Trajectories are identical to previous float-based physics") {
+    const float startVelocitiesX[] = {-2.5f, -1.5f, -0.5f, 0.0f, 0.5f, 2.0f};
+    const float startVelocitiesY[] = {-2.0f, -1.5f, -0.5f, 0.0f, 1.0f, 2.0f};
+
+    for (const auto velocityX : startVelocitiesX) {
+      for (const auto velocityY : startVelocitiesY) {
+        const auto startPosition = base::Vector{100, 60};
+        *body.component<WorldPosition>() = startPosition;
+        body.replace<MovingBody>(Velocity{velocityX, velocityY}, true);
+
+        auto reference = FloatBody{velocityX, velocityY, startPosition};
+        for (int i = 0; i < 30; ++i) {
+          physicsSystem.update(entityx.entities);
+          stepFloatReference(reference);
+
+          REQUIRE(*body.component<WorldPosition>() == reference.mPosition);
+        }
+      }
+    }
+  }
+}
+
+
+TEST_CASE("Batch motion integration throughput", "[.][benchmark]") {
+  constexpr auto NUM_BODIES = 1 << 16;
+  constexpr auto NUM_ITERATIONS = 200;
+
+  using Clock = std::chrono::high_resolution_clock;
+
+  const auto measure = [](auto&& integrate) {
+    const auto start = Clock::now();
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+      integrate();
+    }
+    return std::chrono::duration<double, std::milli>(Clock::now() - start);
+  };
+
+  std::vector<int> positions(NUM_BODIES, 0);
+
+  std::vector<float> floatVelocities(NUM_BODIES);
+  std::vector<MotionValue::Storage> fixedVelocities(NUM_BODIES);
+  for (auto i = 0; i < NUM_BODIES; ++i) {
+    const auto velocity = MotionValue::fromRaw((i % 9 - 4) * 128);
+    floatVelocities[i] = velocity.toFloat();
+    fixedVelocities[i] = velocity.raw();
+  }
+
+  const auto floatTime = measure([&]() {
+    for (auto i = 0; i < NUM_BODIES; ++i) {
+      positions[i] += static_cast<std::int16_t>(floatVelocities[i]);
+    }
+  });
+  const auto floatChecksum = positions[NUM_BODIES - 1];
+
+  std::fill(positions.begin(), positions.end(), 0);
+  const auto fixedTime = measure([&]() {
+    for (auto i = 0; i < NUM_BODIES; ++i) {
+      positions[i] += fixedVelocities[i] / MotionValue::ONE;
+    }
+  });
+
+  CHECK(positions[NUM_BODIES - 1] == floatChecksum);
+
+  WARN(
+    "Integrating " << NUM_BODIES << " bodies " << NUM_ITERATIONS
+    << " times - float: " << floatTime.count() << " ms, fixed-point: "
+    << fixedTime.count() << " ms");
+}
@@ -0,0 +1,217 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/defer.hpp>
+#include <base/warnings.hpp>
+#include <common/json_utils.hpp>
+#include <data/player_model.hpp>
+#include <game_logic/hitch_recorder.hpp>
+#include <loader/file_utils.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <filesystem>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+constexpr auto THRESHOLD_MS = 10.0f;
+constexpr auto FAST_MS = 1.0f;
+constexpr auto SLOW_MS = 20.0f;
+
+
+PlayerInput makeInput(const int tick) {
+  PlayerInput input;
+  input.mLeft = tick % 2 == 0;
+  input.mRight = tick % 2 != 0;
+  input.mJump.mIsPressed = tick % 3 == 0;
+  input.mJump.mWasTriggered = tick % 6 == 0;
+  input.mFire.mWasTriggered = tick % 5 == 0;
+  return input;
+}
+
+
+bool inputsEqual(const PlayerInput& lhs, const PlayerInput& rhs) {
+  const auto buttonsEqual = [](const Button& lhs, const Button& rhs) {
+    return
+      lhs.mIsPressed == rhs.mIsPressed &&
+      lhs.mWasTriggered == rhs.mWasTriggered;
+  };
+
+  return
+    lhs.mLeft == rhs.mLeft &&
+    lhs.mRight == rhs.mRight &&
+    lhs.mUp == rhs.mUp &&
+    lhs.mDown == rhs.mDown &&
+    buttonsEqual(lhs.mInteract, rhs.mInteract) &&
+    buttonsEqual(lhs.mJump, rhs.mJump) &&
+    buttonsEqual(lhs.mFire, rhs.mFire);
+}
+
+
+nlohmann::json loadReport(const fs::path& path) {
+  return nlohmann::json::parse(loader::asText(loader::loadFile(path)));
+}
+
+}
+
+
+TEST_CASE("Hitch recorder") {
+  const auto outputPath = fs::temp_directory_path() / "rigel_test_hitches";
+  fs::remove_all(outputPath);
+  auto cleanup = base::defer([&]() { fs::remove_all(outputPath); });
+
+  HitchRecorder recorder{THRESHOLD_MS, outputPath};
+
+  const auto sessionId = data::GameSessionId{1, 4, data::Difficulty::Hard};
+  auto playerModel = data::PlayerModel{};
+  playerModel.giveScore(1234);
+  playerModel.switchToWeapon(data::WeaponType::Laser);
+  playerModel.tutorialMessages().markAsShown(
+    data::TutorialMessageId::FoundRapidFire);
+
+  const auto recordUpdates = [&](const int count, const float timeMs) {
+    for (int i = 0; i < count; ++i) {
+      const auto tick = static_cast<int>(recorder.replayData().mTicks.size());
+      recorder.recordUpdate(makeInput(tick), timeMs, {}, 100);
+    }
+  };
+
+  SECTION("Updates before level start are ignored") {
+    recordUpdates(1, SLOW_MS);
+    recorder.recordFrame(SLOW_MS, SLOW_MS);
+
+    CHECK(recorder.replayData().mTicks.empty());
+    CHECK(recorder.writtenReports().empty());
+  }
+
+  recorder.beginLevel(
+    sessionId, playerModel, base::Vector{12, 34}, base::Extents{32, 20});
+
+  SECTION("Nothing is written below threshold") {
+    for (int i = 0; i < 20; ++i) {
+      recordUpdates(1, FAST_MS);
+      recorder.recordFrame(16.0f, FAST_MS);
+    }
+
+    CHECK(recorder.writtenReports().empty());
+    CHECK(!fs::exists(outputPath));
+  }
+
+  SECTION("Frame boundaries are recorded") {
+    recordUpdates(2, FAST_MS);
+    recorder.recordFrame(16.0f, FAST_MS);
+    recorder.recordFrame(16.0f, FAST_MS);
+    recordUpdates(1, FAST_MS);
+    recorder.recordFrame(16.0f, FAST_MS);
+
+    const auto& ticks = recorder.replayData().mTicks;
+    REQUIRE(ticks.size() == 3);
+    CHECK(!ticks[0].mEndsFrame);
+    CHECK(ticks[1].mEndsFrame);
+    CHECK(ticks[2].mEndsFrame);
+  }
+
+  SECTION("Starting a level discards recorded input") {
+    recordUpdates(5, FAST_MS);
+    recorder.beginLevel(sessionId, playerModel, {}, base::Extents{32, 20});
+
+    CHECK(recorder.replayData().mTicks.empty());
+  }
+
+  SECTION("Slow update writes a report which can be replayed") {
+    for (int i = 0; i < 10; ++i) {
+      recordUpdates(1, FAST_MS);
+      recorder.recordFrame(16.0f, FAST_MS);
+    }
+    recordUpdates(1, SLOW_MS);
+
+    REQUIRE(recorder.writtenReports().size() == 1);
+    const auto& reportFile = recorder.writtenReports().front();
+    REQUIRE(fs::exists(reportFile));
+
+    const auto report = loadReport(reportFile);
+    CHECK(report.at("trigger").at("source") == "update");
+    CHECK(report.at("updates").size() == 11);
+    CHECK(report.at("frames").size() == 10);
+
+    const auto replayData = loadHitchReplayData(reportFile);
+    CHECK(replayData.mSessionId.mEpisode == 1);
+    CHECK(replayData.mSessionId.mLevel == 4);
+    CHECK(replayData.mSessionId.mDifficulty == data::Difficulty::Hard);
+    CHECK(replayData.mPlayerPositionOverride == (base::Vector{12, 34}));
+    CHECK(replayData.mViewPortSize == (base::Extents{32, 20}));
+
+    const auto& savedModel = replayData.mPlayerModelAtLevelStart;
+    CHECK(savedModel.mScore == 1234);
+    CHECK(savedModel.mWeapon == data::WeaponType::Laser);
+    CHECK(savedModel.mTutorialMessagesAlreadySeen.hasBeenShown(
+      data::TutorialMessageId::FoundRapidFire));
+    CHECK(!savedModel.mTutorialMessagesAlreadySeen.hasBeenShown(
+      data::TutorialMessageId::FoundLaser));
+
+    const auto& recordedTicks = recorder.replayData().mTicks;
+    REQUIRE(replayData.mTicks.size() == recordedTicks.size());
+    for (auto i = 0u; i < recordedTicks.size(); ++i) {
+      CHECK(inputsEqual(
+        replayData.mTicks[i].mInput, makeInput(static_cast<int>(i))));
+      CHECK(replayData.mTicks[i].mEndsFrame == recordedTicks[i].mEndsFrame);
+    }
+  }
+
+  SECTION("Slow frame writes a report") {
+    recordUpdates(1, FAST_MS);
+    recorder.recordFrame(40.0f, SLOW_MS);
+
+    REQUIRE(recorder.writtenReports().size() == 1);
+    const auto report = loadReport(recorder.writtenReports().front());
+    CHECK(report.at("trigger").at("source") == "frame");
+    CHECK(report.at("trigger").at("durationMs") == SLOW_MS);
+  }
+
+  SECTION("History only keeps the most recent updates") {
+    recordUpdates(100, FAST_MS);
+    recordUpdates(1, SLOW_MS);
+
+    REQUIRE(recorder.writtenReports().size() == 1);
+    const auto report = loadReport(recorder.writtenReports().front());
+    const auto& updates = report.at("updates");
+    REQUIRE(updates.size() == HitchRecorder::TICK_HISTORY_SIZE);
+    CHECK(updates.front().at("tick") == 101 - HitchRecorder::TICK_HISTORY_SIZE);
+    CHECK(updates.back().at("tick") == 100);
+    CHECK(updates.back().at("entities") == 100);
+
+    // The replay always covers everything since level start
+    CHECK(report.at("replay").at("ticks").size() == 101);
+  }
+
+  SECTION("Sustained slowdown doesn't flood the output") {
+    recordUpdates(1, SLOW_MS);
+    recordUpdates(HitchRecorder::TICK_HISTORY_SIZE - 1, SLOW_MS);
+    CHECK(recorder.writtenReports().size() == 1);
+
+    recordUpdates(1, SLOW_MS);
+    CHECK(recorder.writtenReports().size() == 2);
+  }
+}
@@ -0,0 +1,303 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/job_system.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace rigel;
+using base::JobHandle;
+using base::JobSystem;
+
+
+namespace {
+
+class ExecutionLog {
+public:
+  void add(const std::string& entry) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.push_back(entry);
+  }
+
+  std::vector<std::string> entries() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries;
+  }
+
+  int indexOf(const std::string& entry) const {
+    const auto entries = this->entries();
+    const auto iEntry = std::find(entries.begin(), entries.end(), entry);
+    return iEntry != entries.end()
+      ? static_cast<int>(std::distance(entries.begin(), iEntry))
+      : -1;
+  }
+
+private:
+  mutable std::mutex mMutex;
+  std::vector<std::string> mEntries;
+};
+
+
+// Catch only enters one leaf section per run, so the behavior sections are
+// nested inside each of the worker count sections via this function
+void checkJobExecution(const int numWorkers) {
+  JobSystem jobSystem{numWorkers};
+  CHECK(jobSystem.workerCount() == numWorkers);
+
+  SECTION("All submitted jobs are executed") {
+    std::atomic<int> counter{0};
+
+    std::vector<JobHandle> jobs;
+    for (int i = 0; i < 1000; ++i) {
+      jobs.push_back(jobSystem.submit([&counter]() { ++counter; }));
+    }
+
+    jobSystem.waitAll(jobs);
+    CHECK(counter == 1000);
+  }
+
+  SECTION("Jobs can wait for other jobs") {
+    std::atomic<int> counter{0};
+
+    const auto outer = jobSystem.submit([&]() {
+      std::vector<JobHandle> inner;
+      for (int i = 0; i < 50; ++i) {
+        inner.push_back(jobSystem.submit([&counter]() { ++counter; }));
+      }
+
+      jobSystem.waitAll(inner);
+    });
+
+    jobSystem.wait(outer);
+    CHECK(counter == 50);
+  }
+
+  SECTION("Dependencies are respected") {
+    ExecutionLog log;
+
+    const auto a = jobSystem.submit([&]() { log.add("a"); });
+    const auto b = jobSystem.submit([&]() { log.add("b"); }, {a});
+    const auto c = jobSystem.submit([&]() { log.add("c"); }, {a});
+    const auto d = jobSystem.submit([&]() { log.add("d"); }, {b, c});
+
+    jobSystem.wait(d);
+
+    CHECK(log.entries().size() == 4);
+    CHECK(log.indexOf("a") < log.indexOf("b"));
+    CHECK(log.indexOf("a") < log.indexOf("c"));
+    CHECK(log.indexOf("b") < log.indexOf("d"));
+    CHECK(log.indexOf("c") < log.indexOf("d"));
+  }
+
+  SECTION("Already finished dependencies don't block") {
+    const auto first = jobSystem.submit([]() {});
+    jobSystem.wait(first);
+
+    auto ran = false;
+    const auto second = jobSystem.submit([&]() { ran = true; }, {first, {}});
+    jobSystem.wait(second);
+    CHECK(ran);
+  }
+
+  SECTION("Parallel for visits each index exactly once") {
+    std::vector<int> visits(1003, 0);
+
+    SECTION("Grain size 1") {
+      jobSystem.parallelFor(
+        0, int(visits.size()), [&](const int i) { ++visits[i]; });
+    }
+
+    SECTION("Larger grain size") {
+      jobSystem.parallelFor(
+        0, int(visits.size()), [&](const int i) { ++visits[i]; }, 64);
+    }
+
+    CHECK(std::all_of(
+      visits.begin(), visits.end(), [](const int v) { return v == 1; }));
+  }
+
+  SECTION("Exceptions are forwarded to waiting thread") {
+    const auto failing =
+      jobSystem.submit([]() { throw std::runtime_error("Failed"); });
+    const auto dependent = jobSystem.submit([]() {}, {failing});
+
+    CHECK_THROWS_AS(jobSystem.wait(failing), const std::runtime_error&);
+    CHECK_NOTHROW(jobSystem.wait(dependent));
+  }
+
+  SECTION("Continuations run on main thread") {
+    std::thread::id continuationThread;
+    const auto job = jobSystem.submit([]() {});
+    jobSystem.continueOnMainThread(
+      job, [&]() { continuationThread = std::this_thread::get_id(); });
+
+    while (jobSystem.hasPendingContinuations()) {
+      jobSystem.runMainThreadContinuations();
+    }
+
+    CHECK(continuationThread == std::this_thread::get_id());
+  }
+}
+
+}
+
+
+TEST_CASE("Job system executes jobs") {
+  SECTION("Single-threaded") {
+    checkJobExecution(0);
+  }
+
+  SECTION("With worker threads") {
+    checkJobExecution(4);
+  }
+}
+
+
+TEST_CASE("Job system continuations follow requested order") {
+  JobSystem jobSystem{2};
+
+  std::atomic<bool> releaseSlowJob{false};
+  const auto slowJob = jobSystem.submit([&]() {
+    while (!releaseSlowJob) {
+      std::this_thread::yield();
+    }
+  });
+  const auto fastJob = jobSystem.submit([]() {});
+  jobSystem.wait(fastJob);
+
+  ExecutionLog log;
+
+  SECTION("Submission order") {
+    jobSystem.continueOnMainThread(slowJob, [&]() { log.add("slow"); });
+    jobSystem.continueOnMainThread(fastJob, [&]() { log.add("fast"); });
+
+    CHECK(jobSystem.runMainThreadContinuations() == 0);
+
+    releaseSlowJob = true;
+    jobSystem.wait(slowJob);
+    CHECK(jobSystem.runMainThreadContinuations() == 2);
+
+    const auto expected = std::vector<std::string>{"slow", "fast"};
+    CHECK(log.entries() == expected);
+  }
+
+  SECTION("Completion order") {
+    using Order = JobSystem::ContinuationOrder;
+
+    jobSystem.continueOnMainThread(
+      slowJob, [&]() { log.add("slow"); }, Order::Completion);
+    jobSystem.continueOnMainThread(
+      fastJob, [&]() { log.add("fast"); }, Order::Completion);
+
+    CHECK(jobSystem.runMainThreadContinuations() == 1);
+
+    releaseSlowJob = true;
+    jobSystem.wait(slowJob);
+    CHECK(jobSystem.runMainThreadContinuations() == 1);
+
+    const auto expected = std::vector<std::string>{"fast", "slow"};
+    CHECK(log.entries() == expected);
+  }
+
+  releaseSlowJob = true;
+}
+
+
+TEST_CASE("Single-threaded job system is deterministic") {
+  JobSystem jobSystem{0};
+  CHECK(jobSystem.isSingleThreaded());
+
+  ExecutionLog log;
+  std::vector<std::thread::id> threads;
+
+  for (int i = 0; i < 5; ++i) {
+    jobSystem.submit([&, i]() {
+      log.add(std::to_string(i));
+      threads.push_back(std::this_thread::get_id());
+    });
+  }
+
+  // Nothing runs until the main thread asks for it
+  CHECK(log.entries().empty());
+
+  jobSystem.runMainThreadContinuations();
+
+  const auto expected = std::vector<std::string>{"0", "1", "2", "3", "4"};
+  CHECK(log.entries() == expected);
+  CHECK(std::all_of(threads.begin(), threads.end(), [](const auto id) {
+    return id == std::this_thread::get_id();
+  }));
+}
+
+
+TEST_CASE("Job system per-task overhead", "[.][benchmark]") {
+  constexpr auto NUM_TASKS = 100000;
+
+  using Clock = std::chrono::high_resolution_clock;
+
+  const auto measure = [](auto&& function) {
+    const auto start = Clock::now();
+    function();
+    return std::chrono::duration<double, std::micro>(Clock::now() - start);
+  };
+
+  std::atomic<int> counter{0};
+  const auto task = [&counter]() { ++counter; };
+
+  const auto directTime = measure([&]() {
+    for (int i = 0; i < NUM_TASKS; ++i) {
+      task();
+    }
+  });
+
+  const auto measureJobSystem = [&](const int numWorkers) {
+    JobSystem jobSystem{numWorkers};
+
+    return measure([&]() {
+      std::vector<JobHandle> jobs;
+      jobs.reserve(NUM_TASKS);
+      for (int i = 0; i < NUM_TASKS; ++i) {
+        jobs.push_back(jobSystem.submit(task));
+      }
+      jobSystem.waitAll(jobs);
+    });
+  };
+
+  const auto singleThreadedTime = measureJobSystem(0);
+  const auto workersTime = measureJobSystem(base::defaultWorkerCount());
+
+  CHECK(counter == 3 * NUM_TASKS);
+
+  WARN(
+    "Per task - direct call: " << directTime.count() / NUM_TASKS
+    << " us, single-threaded: " << singleThreadedTime.count() / NUM_TASKS
+    << " us, " << base::defaultWorkerCount() << " workers: "
+    << workersTime.count() / NUM_TASKS << " us");
+}
@@ -0,0 +1,761 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/game_traits.hpp>
+#include <data/unit_conversions.hpp>
+#include <engine/spatial_entity_index.hpp>
+#include <loader/level_loader.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+
+using namespace rigel;
+using namespace loader;
+
+using data::ActorID;
+using data::GameTraits;
+
+
+namespace {
+
+constexpr auto HEADER_SIZE = 47u;
+constexpr auto MAP_DATA_SIZE = GameTraits::mapDataWords * 2u;
+constexpr auto NUM_EXTRA_BIT_BYTES = (GameTraits::mapDataWords + 3u) / 4u;
+
+
+std::uint16_t simpleTile(const int index) {
+  return std::uint16_t(index * 8);
+}
+
+
+std::uint16_t extendedTile(const int solidIndex, const int maskedIndex) {
+  return std::uint16_t(0x8000 | solidIndex | ((maskedIndex & 0x1F) << 10));
+}
+
+
+/** Random number in [min, max], identical with every standard library
+ *
+ * The standard distributions are implementation-defined, so only the raw
+ * engine output is used.
+ */
+int randomInRange(std::mt19937& engine, const int min, const int max) {
+  const auto range = static_cast<std::uint32_t>(max - min + 1);
+  return min + static_cast<int>(static_cast<std::uint32_t>(engine()) % range);
+}
+
+
+/** Produces level files in the original game's format */
+struct LevelFileBuilder {
+  struct Actor {
+    std::uint16_t mType;
+    std::uint16_t mX;
+    std::uint16_t mY;
+  };
+
+  explicit LevelFileBuilder(const int width)
+    : mWidth(width)
+    , mTiles(GameTraits::mapDataWords, 0)
+    , mExtraMaskedBits(NUM_EXTRA_BIT_BYTES, 0)
+  {
+  }
+
+  std::size_t actorListOffset() const {
+    return HEADER_SIZE;
+  }
+
+  std::size_t widthOffset() const {
+    return actorListOffset() + mActors.size() * 6;
+  }
+
+  std::size_t tileDataOffset() const {
+    return widthOffset() + 2;
+  }
+
+  std::size_t extraInfoSizeOffset() const {
+    return tileDataOffset() + MAP_DATA_SIZE;
+  }
+
+  void setTile(const int x, const int y, const std::uint16_t tileSpec) {
+    mTiles[x + y*mWidth] = tileSpec;
+  }
+
+  void setExtraMaskedBits(const int x, const int y, const int bits) {
+    const auto index = x/4 + y*(mWidth/4);
+    const auto shift = (x % 4) * 2;
+    mExtraMaskedBits[index] &= std::uint8_t(~(0x3 << shift));
+    mExtraMaskedBits[index] |= std::uint8_t(bits << shift);
+  }
+
+  ByteBuffer build() const {
+    ByteBuffer data;
+    data.reserve(HEADER_SIZE + mActors.size() * 6 + MAP_DATA_SIZE + 10000);
+
+    auto writeU8 = [&](const int value) {
+      data.push_back(std::uint8_t(value));
+    };
+    auto writeU16 = [&](const int value) {
+      writeU8(value & 0xFF);
+      writeU8((value >> 8) & 0xFF);
+    };
+    auto writeString = [&](const std::string& str) {
+      for (auto i = 0u; i < 13u; ++i) {
+        writeU8(i < str.size() ? str[i] : 0);
+      }
+    };
+
+    const auto numActorWords = int(mActors.size() * 3);
+    writeU16(int(HEADER_SIZE) + numActorWords * 2);
+    writeString(mCZone);
+    writeString(mBackdrop);
+    writeString(mMusic);
+    writeU8(mFlags);
+    writeU8(mAlternativeBackdrop);
+    writeU16(0);
+    writeU16(numActorWords);
+
+    for (const auto& actor : mActors) {
+      writeU16(actor.mType);
+      writeU16(actor.mX);
+      writeU16(actor.mY);
+    }
+
+    writeU16(mWidth);
+    for (const auto tileSpec : mTiles) {
+      writeU16(tileSpec);
+    }
+
+    // Extra masked tile bits, RLE compressed as a sequence of literal runs
+    ByteBuffer rleData;
+    for (auto i = 0u; i < mExtraMaskedBits.size(); i += 127u) {
+      const auto runLength =
+        std::min<std::size_t>(127u, mExtraMaskedBits.size() - i);
+      rleData.push_back(std::uint8_t(-std::int8_t(runLength)));
+      rleData.insert(
+        rleData.end(),
+        mExtraMaskedBits.begin() + i,
+        mExtraMaskedBits.begin() + i + runLength);
+    }
+    rleData.push_back(0);
+
+    writeU16(int(rleData.size()));
+    data.insert(data.end(), rleData.begin(), rleData.end());
+
+    return data;
+  }
+
+  int mWidth;
+  std::string mCZone = "CZONE1.MNI";
+  std::string mBackdrop = "DROP1.MNI";
+  std::string mMusic = "NEVRENDA.IMF";
+  std::uint8_t mFlags = 0;
+  std::uint8_t mAlternativeBackdrop = 0;
+  std::vector<Actor> mActors;
+  std::vector<std::uint16_t> mTiles;
+  ByteBuffer mExtraMaskedBits;
+};
+
+
+LevelFileContents parse(const ByteBuffer& data) {
+  const auto header = parseLevelHeader(data);
+  return parseLevelContents(data, header, data::map::TileAttributeDict{});
+}
+
+
+void setU16(ByteBuffer& data, const std::size_t offset, const int value) {
+  data[offset] = std::uint8_t(value & 0xFF);
+  data[offset + 1] = std::uint8_t((value >> 8) & 0xFF);
+}
+
+
+std::size_t errorOffsetFor(const ByteBuffer& data) {
+  try {
+    parse(data);
+  } catch (const LevelParseError& error) {
+    return error.offset();
+  }
+
+  FAIL("No LevelParseError was thrown");
+  return 0;
+}
+
+
+LevelFileBuilder makeSyntheticLevel(
+  const int width,
+  const int numActors,
+  const std::uint32_t seed
+) {
+  std::mt19937 randomGenerator{seed};
+  auto randomInt = [&](const int min, const int max) {
+    return randomInRange(randomGenerator, min, max);
+  };
+
+  const auto height = int(GameTraits::mapHeightForWidth(width));
+
+  auto builder = LevelFileBuilder{width};
+  for (int i = 0; i < numActors; ++i) {
+    builder.mActors.push_back({
+      std::uint16_t(ActorID::Hoverbot),
+      std::uint16_t(randomInt(0, width - 1)),
+      std::uint16_t(randomInt(0, height - 1))});
+  }
+
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      // The order of evaluation of function arguments is unspecified, so
+      // random numbers are drawn in separate statements
+      if (randomInt(0, 3) == 0) {
+        const auto solidIndex = randomInt(0, 999);
+        const auto maskedIndex = randomInt(0, 31);
+        builder.setTile(x, y, extendedTile(solidIndex, maskedIndex));
+      } else {
+        builder.setTile(x, y, simpleTile(randomInt(0, 999)));
+      }
+    }
+  }
+
+  for (auto& bits : builder.mExtraMaskedBits) {
+    bits = std::uint8_t(randomInt(0, 255));
+  }
+
+  return builder;
+}
+
+
+LevelFileContents makeExtendedContents(const int width, const int height) {
+  return LevelFileContents{
+    data::map::Map{width, height, data::map::TileAttributeDict{}}, {}};
+}
+
+
+/** Fills the map with large empty areas and repeating structures
+ *
+ * Unlike makeSyntheticLevel(), this resembles the tile data of actual levels
+ * closely enough to give meaningful results for compression.
+ */
+void fillWithStructures(data::map::Map& map, const std::uint32_t seed) {
+  std::mt19937 randomGenerator{seed};
+  auto randomInt = [&](const int min, const int max) {
+    return randomInRange(randomGenerator, min, max);
+  };
+
+  for (int y = 0; y < map.height(); y += 8) {
+    for (int x = 0; x < map.width(); x += 16) {
+      const auto solidTile = randomInt(1, 999);
+      const auto maskedTile = 1000 + randomInt(0, 127);
+
+      for (int col = x; col < std::min(x + 16, map.width()); ++col) {
+        map.setTileAt(0, col, y, solidTile);
+        if (y + 1 < map.height() && col % 5 == 0) {
+          map.setTileAt(1, col, y + 1, maskedTile);
+        }
+      }
+    }
+  }
+}
+
+
+void requireSameContents(
+  const LevelFileContents& actual,
+  const LevelFileContents& expected
+) {
+  const auto& map = actual.mMap;
+  const auto& expectedMap = expected.mMap;
+  REQUIRE(map.width() == expectedMap.width());
+  REQUIRE(map.height() == expectedMap.height());
+
+  for (int y = 0; y < map.height(); ++y) {
+    for (int x = 0; x < map.width(); ++x) {
+      INFO("Tile at " << x << ", " << y);
+      REQUIRE(map.tileAt(0, x, y) == expectedMap.tileAt(0, x, y));
+      REQUIRE(map.tileAt(1, x, y) == expectedMap.tileAt(1, x, y));
+    }
+  }
+
+  REQUIRE(actual.mActors.size() == expected.mActors.size());
+  for (auto i = 0u; i < actual.mActors.size(); ++i) {
+    CHECK(actual.mActors[i].mID == expected.mActors[i].mID);
+    CHECK(actual.mActors[i].mPosition == expected.mActors[i].mPosition);
+  }
+}
+
+}
+
+
+TEST_CASE("Level files are parsed correctly") {
+  auto builder = LevelFileBuilder{64};
+  builder.mFlags = 0x21;
+  builder.mAlternativeBackdrop = 3;
+  builder.mActors = {
+    {std::uint16_t(ActorID::Hoverbot), 5, 10},
+    {0xFFFF, 1, 1},
+    {std::uint16_t(ActorID::Duke_LEFT), 63, 2}
+  };
+
+  builder.setTile(0, 0, simpleTile(5));
+  builder.setTile(1, 0, extendedTile(7, 3));
+  builder.setExtraMaskedBits(1, 0, 0x2);
+  builder.setTile(2, 0, simpleTile(1002));
+  builder.setTile(63, 510, simpleTile(999));
+
+  const auto data = builder.build();
+
+  SECTION("Header") {
+    const auto header = parseLevelHeader(data);
+    CHECK(header.mCZone == "CZONE1.MNI");
+    CHECK(header.mBackdrop == "DROP1.MNI");
+    CHECK(header.mMusic == "NEVRENDA.IMF");
+    CHECK(header.mAlternativeBackdropNumber == 3);
+    CHECK(header.flagBitSet(0x20));
+    CHECK(header.flagBitSet(0x1));
+    CHECK(!header.flagBitSet(0x2));
+    CHECK(header.mNumActorWords == 9);
+  }
+
+  SECTION("Actors with unknown IDs are skipped") {
+    const auto contents = parse(data);
+    REQUIRE(contents.mActors.size() == 2);
+    CHECK(contents.mActors[0].mID == ActorID::Hoverbot);
+    CHECK((contents.mActors[0].mPosition == base::Vector{5, 10}));
+    CHECK(contents.mActors[1].mID == ActorID::Duke_LEFT);
+    CHECK((contents.mActors[1].mPosition == base::Vector{63, 2}));
+  }
+
+  SECTION("Map data") {
+    const auto contents = parse(data);
+    const auto& map = contents.mMap;
+
+    REQUIRE(map.width() == 64);
+    REQUIRE(map.height() == 511);
+
+    CHECK(map.tileAt(0, 0, 0) == 5);
+    CHECK(map.tileAt(1, 0, 0) == 0);
+
+    CHECK(map.tileAt(0, 1, 0) == 7);
+    CHECK(map.tileAt(1, 1, 0) == 1000 + (3 | (0x2 << 5)));
+
+    // Masked tiles in the simple tile format are spaced 5 raw indices apart
+    CHECK(map.tileAt(0, 2, 0) == 1000);
+
+    CHECK(map.tileAt(0, 63, 510) == 999);
+  }
+}
+
+
+TEST_CASE("Level parser reports location of corrupt data") {
+  auto builder = LevelFileBuilder{32};
+  builder.mActors = {{std::uint16_t(ActorID::Hoverbot), 1, 1}};
+  builder.setTile(3, 1, extendedTile(1, 1));
+  auto data = builder.build();
+
+  SECTION("Valid data doesn't produce errors") {
+    CHECK_NOTHROW(parse(data));
+  }
+
+  SECTION("Truncated header") {
+    data.resize(20);
+    CHECK(errorOffsetFor(data) == 0);
+  }
+
+  SECTION("Actor list exceeding file size") {
+    setU16(data, HEADER_SIZE - 2, 0xFFFF);
+    CHECK(errorOffsetFor(data) == builder.actorListOffset());
+  }
+
+  SECTION("Actor outside of map") {
+    setU16(data, builder.actorListOffset() + 2, 32);
+    CHECK(errorOffsetFor(data) == builder.actorListOffset());
+  }
+
+  SECTION("Invalid map width") {
+    setU16(data, builder.widthOffset(), 0);
+    CHECK(errorOffsetFor(data) == builder.widthOffset());
+
+    setU16(data, builder.widthOffset(), int(GameTraits::mapDataWords + 1));
+    CHECK(errorOffsetFor(data) == builder.widthOffset());
+  }
+
+  SECTION("Truncated map data") {
+    data.resize(builder.tileDataOffset() + 100);
+    CHECK(errorOffsetFor(data) == builder.tileDataOffset());
+  }
+
+  SECTION("Tile index out of range") {
+    setU16(data, builder.tileDataOffset() + 2*5, simpleTile(4000));
+    CHECK(errorOffsetFor(data) == builder.tileDataOffset() + 2*5);
+  }
+
+  SECTION("RLE data without terminator") {
+    const auto rleSize = data.size() - builder.extraInfoSizeOffset() - 2;
+    setU16(data, builder.extraInfoSizeOffset(), int(rleSize - 1));
+    CHECK(errorOffsetFor(data) == data.size() - 1);
+  }
+
+  SECTION("RLE word exceeding its section") {
+    const auto rleStart = builder.extraInfoSizeOffset() + 2;
+    setU16(data, builder.extraInfoSizeOffset(), 10);
+    CHECK(errorOffsetFor(data) == rleStart);
+  }
+
+  SECTION("Missing masked tile bits") {
+    const auto rleStart = builder.extraInfoSizeOffset() + 2;
+    data.resize(rleStart);
+    data.push_back(std::uint8_t(-1));
+    data.push_back(0xFF);
+    data.push_back(0);
+    setU16(data, builder.extraInfoSizeOffset(), 3);
+
+    const auto tileOffset = builder.tileDataOffset() + 2*(3 + 1*32);
+    CHECK(errorOffsetFor(data) == tileOffset);
+  }
+}
+
+
+TEST_CASE("Level parser handles fuzzed input gracefully") {
+  const auto validData = makeSyntheticLevel(64, 20, 1234).build();
+
+  // Fixed seed, so that the corpus is the same on every run
+  std::mt19937 randomGenerator{0x5EED};
+  auto randomIndex = [&](const std::size_t size) {
+    return std::size_t(randomInRange(randomGenerator, 0, int(size) - 1));
+  };
+
+  // Mutations are biased towards the structural parts of the file, since
+  // randomly changing tile data is much less interesting.
+  const auto widthOffset = HEADER_SIZE + 20 * 6;
+  const auto interestingOffsets = std::vector<std::size_t>{
+    HEADER_SIZE - 2,
+    HEADER_SIZE - 1,
+    widthOffset,
+    widthOffset + 1,
+    widthOffset + 2 + MAP_DATA_SIZE,
+    widthOffset + 2 + MAP_DATA_SIZE + 1
+  };
+
+  constexpr auto CORPUS_SIZE = 400;
+  for (int i = 0; i < CORPUS_SIZE; ++i) {
+    auto data = validData;
+
+    const auto numMutations = 1 + randomIndex(4);
+    for (auto j = 0u; j < numMutations && !data.empty(); ++j) {
+      switch (randomIndex(4)) {
+        case 0:
+          data.resize(randomIndex(data.size()));
+          break;
+
+        case 1:
+          data[randomIndex(data.size())] = std::uint8_t(randomIndex(256));
+          break;
+
+        default:
+          {
+            const auto offset =
+              interestingOffsets[randomIndex(interestingOffsets.size())];
+            if (offset < data.size()) {
+              data[offset] = std::uint8_t(randomIndex(256));
+            }
+          }
+          break;
+      }
+    }
+
+    INFO("Corpus entry " << i);
+    try {
+      const auto contents = parse(data);
+      CHECK(
+        std::size_t(contents.mMap.width() * contents.mMap.height()) <=
+        GameTraits::mapDataWords);
+    } catch (const LevelParseError& error) {
+      CHECK(error.offset() <= data.size());
+    }
+  }
+}
+
+
+TEST_CASE("Extended level format") {
+  auto header = LevelFileHeader{};
+  header.mCZone = "CZONE2.MNI";
+  header.mBackdrop = "DROP5.MNI";
+  header.mMusic = "ZOOMIN.IMF";
+  header.mFlags = 0x42;
+  header.mAlternativeBackdropNumber = 7;
+
+  SECTION("Header") {
+    const auto data =
+      serializeExtendedLevel(header, makeExtendedContents(4, 4));
+    const auto parsedHeader = parseLevelHeader(data);
+
+    CHECK(parsedHeader.mFormat == LevelFileFormat::Extended);
+    CHECK(parsedHeader.mCZone == "CZONE2.MNI");
+    CHECK(parsedHeader.mBackdrop == "DROP5.MNI");
+    CHECK(parsedHeader.mMusic == "ZOOMIN.IMF");
+    CHECK(parsedHeader.mFlags == 0x42);
+    CHECK(parsedHeader.mAlternativeBackdropNumber == 7);
+  }
+
+  SECTION("Original levels can be converted") {
+    const auto originalData = makeSyntheticLevel(64, 50, 7).build();
+    const auto originalHeader = parseLevelHeader(originalData);
+    REQUIRE(originalHeader.mFormat == LevelFileFormat::Original);
+    const auto original = parse(originalData);
+
+    const auto data = serializeExtendedLevel(originalHeader, original);
+    requireSameContents(parse(data), original);
+  }
+
+  SECTION("Maps beyond the original size limit") {
+    auto contents = makeExtendedContents(4096, 128);
+    fillWithStructures(contents.mMap, 99);
+    contents.mMap.setTileAt(0, 4095, 127, 1002);
+    contents.mActors = {
+      {{4095, 127}, ActorID::Hoverbot, std::nullopt},
+      {{0, 0}, ActorID::Duke_LEFT, std::nullopt}
+    };
+
+    const auto data = serializeExtendedLevel(header, contents);
+    CHECK(data.size() < 4096u * 128u / 4u);
+    requireSameContents(parse(data), contents);
+  }
+
+  SECTION("Width not divisible by 4") {
+    auto contents = makeExtendedContents(1001, 3);
+    contents.mMap.setTileAt(0, 1000, 2, 12);
+    contents.mMap.setTileAt(1, 1000, 2, 1000 + 127);
+    contents.mMap.setTileAt(1, 999, 1, 1000 + 64);
+
+    requireSameContents(
+      parse(serializeExtendedLevel(header, contents)), contents);
+  }
+
+  SECTION("Actor positions beyond 16 bit") {
+    auto contents = makeExtendedContents(70000, 2);
+    contents.mActors = {{{69999, 1}, ActorID::Hoverbot, std::nullopt}};
+
+    requireSameContents(
+      parse(serializeExtendedLevel(header, contents)), contents);
+  }
+
+  SECTION("Unrepresentable tile combinations are rejected") {
+    auto contents = makeExtendedContents(4, 4);
+    contents.mMap.setTileAt(0, 1, 1, 1000);
+    contents.mMap.setTileAt(1, 1, 1, 1001);
+
+    CHECK_THROWS_AS(
+      serializeExtendedLevel(header, contents), const std::invalid_argument&);
+  }
+}
+
+
+TEST_CASE("Extended level parser reports location of corrupt data") {
+  constexpr auto VERSION_OFFSET = 8u;
+  constexpr auto DIMENSIONS_OFFSET = VERSION_OFFSET + 2u + 3u*13u + 2u;
+  constexpr auto ACTOR_LIST_OFFSET = DIMENSIONS_OFFSET + 5u*4u;
+  constexpr auto TILE_DATA_OFFSET = ACTOR_LIST_OFFSET + 10u;
+
+  auto contents = makeExtendedContents(32, 16);
+  fillWithStructures(contents.mMap, 3);
+  contents.mActors = {{{1, 1}, ActorID::Hoverbot, std::nullopt}};
+  auto data = serializeExtendedLevel(LevelFileHeader{}, contents);
+
+  SECTION("Valid data doesn't produce errors") {
+    CHECK_NOTHROW(parse(data));
+  }
+
+  SECTION("Truncated header") {
+    data.resize(DIMENSIONS_OFFSET);
+    CHECK(errorOffsetFor(data) == 0);
+  }
+
+  SECTION("Unsupported version") {
+    setU16(data, VERSION_OFFSET, 2);
+    CHECK(errorOffsetFor(data) == VERSION_OFFSET);
+  }
+
+  SECTION("Invalid map dimensions") {
+    setU16(data, DIMENSIONS_OFFSET, 0);
+    CHECK(errorOffsetFor(data) == DIMENSIONS_OFFSET);
+
+    setU16(data, DIMENSIONS_OFFSET, 0xFFFF);
+    setU16(data, DIMENSIONS_OFFSET + 4, 0xFFFF);
+    CHECK(errorOffsetFor(data) == DIMENSIONS_OFFSET);
+  }
+
+  SECTION("Actor list exceeding file size") {
+    setU16(data, DIMENSIONS_OFFSET + 8, 0xFFFF);
+    CHECK(errorOffsetFor(data) == ACTOR_LIST_OFFSET);
+
+    // Large enough to overflow the list's size in bytes on 32-bit platforms
+    setU16(data, DIMENSIONS_OFFSET + 10, 0xFFFF);
+    CHECK(errorOffsetFor(data) == ACTOR_LIST_OFFSET);
+  }
+
+  SECTION("Actor outside of map") {
+    setU16(data, ACTOR_LIST_OFFSET + 2, 32);
+    CHECK(errorOffsetFor(data) == ACTOR_LIST_OFFSET);
+  }
+
+  SECTION("Map data not matching the dimensions") {
+    setU16(data, DIMENSIONS_OFFSET + 4, 15);
+    CHECK(errorOffsetFor(data) == TILE_DATA_OFFSET);
+  }
+
+  SECTION("Truncated map data") {
+    data.resize(TILE_DATA_OFFSET + 10);
+    CHECK(errorOffsetFor(data) == TILE_DATA_OFFSET);
+  }
+}
+
+
+TEST_CASE("Level loading throughput", "[.][benchmark]") {
+  using Clock = std::chrono::high_resolution_clock;
+
+  struct Scenario {
+    int mWidth;
+    int mNumActors;
+  };
+
+  // The map data section has a fixed size in the file format, so larger
+  // levels mostly differ in the number of actors they contain.
+  const Scenario scenarios[] = {
+    {32, 16},
+    {64, 256},
+    {128, 2048},
+    {256, 8192},
+    {1024, 21845}
+  };
+
+  constexpr auto NUM_ITERATIONS = 20;
+
+  for (const auto& scenario : scenarios) {
+    const auto data =
+      makeSyntheticLevel(scenario.mWidth, scenario.mNumActors, 42).build();
+
+    const auto start = Clock::now();
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+      const auto contents = parse(data);
+      REQUIRE(contents.mMap.width() == scenario.mWidth);
+    }
+    const auto elapsed =
+      std::chrono::duration<double, std::micro>(Clock::now() - start);
+
+    WARN(
+      "Width " << scenario.mWidth << ", " << scenario.mNumActors
+      << " actors (" << data.size() << " bytes): "
+      << elapsed.count() / NUM_ITERATIONS << " us per level");
+  }
+}
+
+
+TEST_CASE("Extended level cost", "[.][benchmark]") {
+  using Clock = std::chrono::high_resolution_clock;
+
+  // Map sizes relative to the largest original level. Actor density is
+  // roughly the same as in the original game's levels.
+  struct Scenario {
+    int mScale;
+    int mWidth;
+    int mHeight;
+  };
+
+  const Scenario scenarios[] = {
+    {1, 256, 127},
+    {8, 1024, 255},
+    {16, 2048, 255}
+  };
+
+  constexpr auto NUM_LOAD_ITERATIONS = 10;
+  constexpr auto NUM_TICKS = 100;
+  constexpr auto TILES_PER_ACTOR = 64;
+
+  for (const auto& scenario : scenarios) {
+    std::mt19937 randomGenerator{42};
+    auto randomInt = [&](const int min, const int max) {
+      return randomInRange(randomGenerator, min, max);
+    };
+
+    auto contents = makeExtendedContents(scenario.mWidth, scenario.mHeight);
+    fillWithStructures(contents.mMap, 42);
+
+    const auto numTiles = scenario.mWidth * scenario.mHeight;
+    for (int i = 0; i < numTiles / TILES_PER_ACTOR; ++i) {
+      contents.mActors.push_back({
+        {randomInt(0, scenario.mWidth - 1), randomInt(0, scenario.mHeight - 1)},
+        ActorID::Hoverbot,
+        std::nullopt});
+    }
+
+    const auto data = serializeExtendedLevel(LevelFileHeader{}, contents);
+
+    auto start = Clock::now();
+    for (int i = 0; i < NUM_LOAD_ITERATIONS; ++i) {
+      const auto parsed = parse(data);
+      REQUIRE(parsed.mMap.width() == scenario.mWidth);
+    }
+    const auto loadTime =
+      std::chrono::duration<double, std::milli>(Clock::now() - start);
+
+    const auto mapMemory =
+      2u * std::size_t(numTiles) * sizeof(data::map::TileIndex);
+    const auto actorMemory =
+      contents.mActors.size() * sizeof(data::map::LevelData::Actor);
+
+    // Per-tick work which depends on the level's size: the rendering system
+    // rebuilds its spatial index of sprites every frame, which covers the
+    // whole map. All actors are spawned at level start, so every actor in
+    // the level ends up in the index.
+    entityx::EntityX entityx;
+    std::vector<std::pair<entityx::Entity, base::Rect<int>>> entities;
+    for (const auto& actor : contents.mActors) {
+      entities.emplace_back(
+        entityx.entities.create(),
+        base::Rect<int>{
+          data::tileVectorToPixelVector(actor.mPosition),
+          data::tileExtentsToPixelExtents({2, 2})});
+    }
+
+    engine::SpatialEntityIndex index{
+      data::tileExtentsToPixelExtents({scenario.mWidth, scenario.mHeight}),
+      data::tilesToPixels(16)};
+
+    start = Clock::now();
+    for (int i = 0; i < NUM_TICKS; ++i) {
+      index.clear();
+      for (const auto& [entity, bounds] : entities) {
+        index.insert(entity, bounds);
+      }
+    }
+    const auto tickTime =
+      std::chrono::duration<double, std::micro>(Clock::now() - start);
+
+    WARN(
+      scenario.mScale << "x (" << scenario.mWidth << "x" << scenario.mHeight
+      << ", " << contents.mActors.size() << " actors): file "
+      << data.size() / 1024 << " KiB, load "
+      << loadTime.count() / NUM_LOAD_ITERATIONS << " ms, map "
+      << mapMemory / 1024 << " KiB + actors " << actorMemory / 1024
+      << " KiB, sprite index rebuild " << tickTime.count() / NUM_TICKS
+      << " us per tick");
+  }
+}
@@ -0,0 +1,150 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+using namespace data::map;
+
+
+namespace {
+
+constexpr auto WIDTH = 6;
+constexpr auto HEIGHT = 5;
+
+
+Map makeNumberedMap() {
+  Map map{WIDTH, HEIGHT, TileAttributeDict{{0x0}}};
+
+  for (int y = 0; y < HEIGHT; ++y) {
+    for (int x = 0; x < WIDTH; ++x) {
+      map.setTileAt(0, x, y, TileIndex(1 + x + y * WIDTH));
+      map.setTileAt(1, x, y, TileIndex(100 + x + y * WIDTH));
+    }
+  }
+
+  return map;
+}
+
+
+std::vector<TileIndex> layerContents(const Map& map, const int layer) {
+  std::vector<TileIndex> result;
+  for (int y = 0; y < map.height(); ++y) {
+    for (int x = 0; x < map.width(); ++x) {
+      result.push_back(map.tileAt(layer, x, y));
+    }
+  }
+  return result;
+}
+
+
+// Reference implementation using per-tile access via a temporary copy
+void copySectionTileByTile(
+  Map& map,
+  const base::Rect<int>& source,
+  const base::Vector& destination
+) {
+  const auto original = map;
+  for (int layer = 0; layer < 2; ++layer) {
+    for (int row = 0; row < source.size.height; ++row) {
+      for (int col = 0; col < source.size.width; ++col) {
+        map.setTileAt(
+          layer,
+          destination.x + col,
+          destination.y + row,
+          original.tileAt(layer, source.left() + col, source.top() + row));
+      }
+    }
+  }
+}
+
+}
+
+
+TEST_CASE("Map section editing") {
+  auto map = makeNumberedMap();
+
+  SECTION("Clearing a section only affects tiles within the section") {
+    map.clearSection(1, 2, 3, 2);
+
+    for (int y = 0; y < HEIGHT; ++y) {
+      for (int x = 0; x < WIDTH; ++x) {
+        const auto isInSection = x >= 1 && x < 4 && y >= 2 && y < 4;
+        CHECK((map.tileAt(0, x, y) == 0) == isInSection);
+        CHECK((map.tileAt(1, x, y) == 0) == isInSection);
+      }
+    }
+  }
+
+  SECTION("Copying matches per-tile copy") {
+    const auto check = [&](
+      const base::Rect<int>& source,
+      const base::Vector& destination
+    ) {
+      auto expected = makeNumberedMap();
+      copySectionTileByTile(expected, source, destination);
+
+      auto actual = makeNumberedMap();
+      actual.copySection(source, destination);
+
+      CHECK(layerContents(actual, 0) == layerContents(expected, 0));
+      CHECK(layerContents(actual, 1) == layerContents(expected, 1));
+    };
+
+    // Non-overlapping
+    check({{0, 0}, {2, 2}}, {4, 3});
+
+    // Overlapping, in all directions
+    check({{1, 1}, {3, 3}}, {1, 2});
+    check({{1, 1}, {3, 3}}, {1, 0});
+    check({{1, 1}, {3, 3}}, {2, 1});
+    check({{1, 1}, {3, 3}}, {0, 1});
+    check({{1, 1}, {3, 3}}, {2, 2});
+    check({{1, 1}, {3, 3}}, {0, 0});
+
+    // Full width
+    check({{0, 0}, {WIDTH, HEIGHT - 1}}, {0, 1});
+  }
+
+  SECTION("Empty sections are ignored") {
+    map.copySection({{0, 0}, {0, 3}}, {2, 2});
+    map.clearSection(0, 0, 3, 0);
+
+    CHECK(layerContents(map, 0) == layerContents(makeNumberedMap(), 0));
+  }
+
+  SECTION("Sections exceeding the map are rejected") {
+    CHECK_THROWS_AS(
+      map.copySection({{0, 0}, {2, 2}}, {WIDTH - 1, 0}),
+      const std::invalid_argument&);
+    CHECK_THROWS_AS(
+      map.copySection({{0, HEIGHT - 1}, {2, 2}}, {0, 0}),
+      const std::invalid_argument&);
+    CHECK_THROWS_AS(
+      map.clearSection(-1, 0, 2, 2), const std::invalid_argument&);
+
+    // Nothing is modified by a rejected operation
+    CHECK(layerContents(map, 0) == layerContents(makeNumberedMap(), 0));
+  }
+}
@@ -124,7 +124,7 @@ TEST_CASE("Physics system works as expected") {
     position.y = 5;
 
     SECTION("Non-moving object") {
-      body.mVelocity = base::Point<float>{0.0f, 0.0f};
+      body.mVelocity = Velocity{0.0f, 0.0f};
       runOneFrame();
       CHECK(position.y == 5);
       CHECK(body.mVelocity.y > 0.0f);
@@ -265,7 +265,7 @@ TEST_CASE("Physics system works as expected") {
     }
 
     SECTION("SolidBody doesn't collide with itself") {
-      solidBody.assign<MovingBody>(base::Point<float>{0, 2.0f}, false);
+      solidBody.assign<MovingBody>(Velocity{0, 2.0f}, false);
       solidBody.assign<Active>();
       runOneFrame();
       CHECK(solidBody.component<WorldPosition>()->y == 10);
@@ -291,11 +291,11 @@ TEST_CASE("Physics system works as expected") {
     body.mVelocity = {42, 48};
 
     SECTION("Velocity reset after sequence") {
-      std::array<base::Point<float>, 4> sequence{
-        base::Point<float>{0.0f, -1.0f},
-        base::Point<float>{3.0f, -2.0f},
-        base::Point<float>{2.0f, 0.0f},
-        base::Point<float>{-1.0f, 1.0f}
+      std::array<Velocity, 4> sequence{
+        Velocity{0.0f, -1.0f},
+        Velocity{3.0f, -2.0f},
+        Velocity{2.0f, 0.0f},
+        Velocity{-1.0f, 1.0f}
       };
       physicalObject.assign<MovementSequence>(
         sequence, ResetAfterSequence(true));
@@ -330,11 +330,11 @@ TEST_CASE("Physics system works as expected") {
     SECTION("Velocity kept after sequence (with collision)") {
       body.mGravityAffected = false;
 
-      std::array<base::Point<float>, 4> sequence{
-        base::Point<float>{0.0f, -1.0f},
-        base::Point<float>{3.0f, -2.0f},
-        base::Point<float>{2.0f, 0.0f},
-        base::Point<float>{-1.0f, 1.0f}
+      std::array<Velocity, 4> sequence{
+        Velocity{0.0f, -1.0f},
+        Velocity{3.0f, -2.0f},
+        Velocity{2.0f, 0.0f},
+        Velocity{-1.0f, 1.0f}
       };
       physicalObject.assign<MovementSequence>(
         sequence, ResetAfterSequence(false));
@@ -362,11 +362,11 @@ TEST_CASE("Physics system works as expected") {
       body.mGravityAffected = false;
       body.mIgnoreCollisions = true;
 
-      std::array<base::Point<float>, 4> sequence{
-        base::Point<float>{0.0f, -1.0f},
-        base::Point<float>{3.0f, -2.0f},
-        base::Point<float>{2.0f, 0.0f},
-        base::Point<float>{-1.0f, 1.0f}
+      std::array<Velocity, 4> sequence{
+        Velocity{0.0f, -1.0f},
+        Velocity{3.0f, -2.0f},
+        Velocity{2.0f, 0.0f},
+        Velocity{-1.0f, 1.0f}
       };
       physicalObject.assign<MovementSequence>(
         sequence, ResetAfterSequence(false));
@@ -391,11 +391,11 @@ TEST_CASE("Physics system works as expected") {
     }
 
     SECTION("X part of sequence can be ignored") {
-      std::array<base::Point<float>, 4> sequence{
-        base::Point<float>{0.0f, -1.0f},
-        base::Point<float>{3.0f, -2.0f},
-        base::Point<float>{2.0f, 0.0f},
-        base::Point<float>{-1.0f, 1.0f}
+      std::array<Velocity, 4> sequence{
+        Velocity{0.0f, -1.0f},
+        Velocity{3.0f, -2.0f},
+        Velocity{2.0f, 0.0f},
+        Velocity{-1.0f, 1.0f}
       };
       physicalObject.assign<MovementSequence>(
         sequence,
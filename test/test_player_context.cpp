@@ -0,0 +1,115 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils.hpp"
+
+#include <base/spatial_types_printing.hpp>
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+#include <data/player_model.hpp>
+#include <engine/collision_checker.hpp>
+#include <engine/random_number_generator.hpp>
+#include <engine/visual_components.hpp>
+#include <game_logic/player.hpp>
+#include <game_logic/player_context.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace game_logic;
+
+using engine::components::BoundingBox;
+using engine::components::Orientation;
+using engine::components::Sprite;
+using engine::components::WorldPosition;
+
+namespace ex = entityx;
+
+
+TEST_CASE("Player context") {
+  ex::EntityX entityx;
+
+  data::map::Map map{100, 100, data::map::TileAttributeDict{{0x0}}};
+  engine::CollisionChecker collisionChecker{
+    &map, entityx.entities, entityx.events};
+
+  data::PlayerModel playerModel;
+  MockEntityFactory mockEntityFactory{&entityx.entities};
+  MockServiceProvider mockServiceProvider;
+  engine::RandomNumberGenerator randomGenerator;
+
+  auto playerEntity = entityx.entities.create();
+  playerEntity.assign<WorldPosition>(8, 16);
+  playerEntity.assign<Sprite>();
+  assignPlayerComponents(playerEntity, Orientation::Left);
+
+  Player player(
+    playerEntity,
+    data::Difficulty::Medium,
+    &playerModel,
+    &mockServiceProvider,
+    &collisionChecker,
+    &map,
+    &mockEntityFactory,
+    &entityx.events,
+    &randomGenerator);
+
+  // The player's hit box is only determined during update
+  player.update(PlayerInput{});
+
+  PlayerContext context{&player};
+
+  SECTION("Reflects player state") {
+    CHECK(context.position() == player.position());
+    CHECK(context.orientedPosition() == player.orientedPosition());
+    CHECK(context.orientation() == player.orientation());
+    CHECK(context.worldSpaceHitBox() == player.worldSpaceHitBox());
+    CHECK(context.isCloaked() == player.isCloaked());
+    CHECK(context.isCrouching() == player.isCrouching());
+  }
+
+  SECTION("Only changes when updated") {
+    const auto previousPosition = player.position();
+    player.position() += base::Vector{5, -2};
+    *playerEntity.component<Orientation>() = Orientation::Right;
+
+    CHECK(context.position() == previousPosition);
+    CHECK(context.orientation() == Orientation::Left);
+
+    context.update();
+
+    CHECK(context.position() == player.position());
+    CHECK(context.orientedPosition() == player.orientedPosition());
+    CHECK(context.orientation() == Orientation::Right);
+    CHECK(context.worldSpaceHitBox() == player.worldSpaceHitBox());
+  }
+
+  SECTION("Touching test") {
+    const auto& hitBox = context.worldSpaceHitBox();
+    const auto boxAt = [](const int x, const int y) {
+      return BoundingBox{{x, y}, {2, 2}};
+    };
+
+    const auto overlapping = boxAt(hitBox.left(), hitBox.top());
+    const auto threeTilesRight = boxAt(hitBox.right() + 3, hitBox.top());
+
+    CHECK(context.isTouching(overlapping));
+    CHECK(!context.isTouching(threeTilesRight));
+  }
+}
@@ -0,0 +1,144 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/player_model.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+
+using namespace rigel;
+using namespace data;
+
+
+TEST_CASE("Player model change generations") {
+  PlayerModel model;
+  const auto initial = model.changeGenerations();
+  const auto& generations = model.changeGenerations();
+
+  SECTION("Each aspect has its own generation") {
+    model.giveScore(100);
+    CHECK(generations.mScore != initial.mScore);
+    CHECK(generations.mAmmo == initial.mAmmo);
+    CHECK(generations.mHealth == initial.mHealth);
+    CHECK(generations.mInventory == initial.mInventory);
+    CHECK(generations.mLetters == initial.mLetters);
+
+    model.switchToWeapon(WeaponType::Laser);
+    CHECK(generations.mAmmo != initial.mAmmo);
+
+    model.takeDamage(1);
+    CHECK(generations.mHealth != initial.mHealth);
+
+    model.giveItem(InventoryItemType::BlueKey);
+    CHECK(generations.mInventory != initial.mInventory);
+
+    model.addLetter(CollectableLetterType::N);
+    CHECK(generations.mLetters != initial.mLetters);
+  }
+
+  SECTION("Generation stays the same when value doesn't change") {
+    model.giveHealth(1);
+    model.takeDamage(0);
+    model.removeItem(InventoryItemType::CircuitBoard);
+    model.giveScore(-10);
+    model.setAmmo(model.ammo());
+
+    CHECK(generations.mHealth == initial.mHealth);
+    CHECK(generations.mInventory == initial.mInventory);
+    CHECK(generations.mScore == initial.mScore);
+    CHECK(generations.mAmmo == initial.mAmmo);
+  }
+
+  SECTION("Restoring a snapshot advances all generations") {
+    const auto snapshot = model;
+    model.giveScore(500);
+    model.giveItem(InventoryItemType::RapidFire);
+
+    const auto beforeRestore = model.changeGenerations();
+    model.restoreFromSnapshot(snapshot);
+
+    CHECK(model.score() == 0);
+    CHECK(model.inventory().empty());
+    CHECK(generations.mScore != beforeRestore.mScore);
+    CHECK(generations.mScore != snapshot.changeGenerations().mScore);
+    CHECK(generations.mInventory != beforeRestore.mInventory);
+    CHECK(generations.mInventory != snapshot.changeGenerations().mInventory);
+  }
+}
+
+
+TEST_CASE("Player model inventory") {
+  using T = InventoryItemType;
+
+  PlayerModel model;
+
+  const auto inventoryAsVector = [&]() {
+    const auto items = model.inventory();
+    return std::vector<T>(items.begin(), items.end());
+  };
+
+  model.giveItem(T::BlueKey);
+  model.giveItem(T::RapidFire);
+  model.giveItem(T::CircuitBoard);
+
+  SECTION("Items are kept in order of collection") {
+    const auto expected = std::vector<T>{
+      T::BlueKey, T::RapidFire, T::CircuitBoard};
+    CHECK(inventoryAsVector() == expected);
+  }
+
+  SECTION("Removing an item keeps order of remaining items") {
+    model.removeItem(T::RapidFire);
+    const auto expected = std::vector<T>{T::BlueKey, T::CircuitBoard};
+    CHECK(inventoryAsVector() == expected);
+    CHECK(!model.hasItem(T::RapidFire));
+  }
+
+  SECTION("Giving an item to a full inventory fails") {
+    CHECK(!model.isInventoryFull());
+    for (int i = 3; i < MAX_INVENTORY_SIZE; ++i) {
+      CHECK(model.giveItem(T::SpecialHintGlobe));
+    }
+
+    CHECK(model.isInventoryFull());
+
+    const auto generationBefore = model.changeGenerations().mInventory;
+    CHECK(!model.giveItem(T::CloakingDevice));
+    CHECK(!model.hasItem(T::CloakingDevice));
+    CHECK(model.inventory().size() == MAX_INVENTORY_SIZE);
+    CHECK(model.changeGenerations().mInventory == generationBefore);
+
+    model.removeItem(T::RapidFire);
+    CHECK(!model.isInventoryFull());
+    CHECK(model.giveItem(T::CloakingDevice));
+  }
+
+  SECTION("Model can be copied bitwise") {
+    static_assert(std::is_trivially_copyable_v<PlayerModel>);
+
+    PlayerModel copy;
+    std::memcpy(&copy, &model, sizeof(PlayerModel));
+    CHECK(copy.hasItem(T::RapidFire));
+    CHECK(copy.inventory().size() == 3);
+  }
+}
@@ -0,0 +1,175 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/spatial_types_printing.hpp>
+#include <base/warnings.hpp>
+#include <renderer/command_recorder.hpp>
+#include <renderer/render_thread.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <variant>
+#include <vector>
+
+
+using namespace rigel;
+using namespace renderer;
+
+
+namespace {
+
+void runCustomCommands(const CommandList& commands) {
+  for (const auto& command : commands) {
+    if (const auto pCustom = std::get_if<commands::Custom>(&command)) {
+      pCustom->mFunction();
+    }
+  }
+}
+
+}
+
+
+TEST_CASE("Command recorder records commands and tracks state") {
+  const auto windowSize = base::Size<int>{640, 400};
+  CommandRecorder recorder{RecordedState{
+    windowSize,
+    Renderer::RenderTarget{windowSize, 0},
+    {},
+    {},
+    {1.0f, 1.0f},
+    RenderPhase::Other}};
+
+  SECTION("Draw commands are recorded in order") {
+    const auto texture = Renderer::TextureData{16, 16, 7};
+    recorder.drawTexture(texture, {{0, 0}, {8, 8}}, {{10, 10}, {8, 8}}, false);
+    recorder.drawRectangle({{0, 0}, {4, 4}}, {255, 0, 0, 255});
+    recorder.swapBuffers();
+
+    const auto& commands = recorder.commands();
+    REQUIRE(commands.size() == 3);
+    REQUIRE(std::holds_alternative<commands::DrawTexture>(commands[0]));
+    CHECK(std::get<commands::DrawTexture>(commands[0]).mTexture.mHandle == 7);
+    CHECK(std::holds_alternative<commands::DrawRectangle>(commands[1]));
+    CHECK(std::holds_alternative<commands::SwapBuffers>(commands[2]));
+  }
+
+  SECTION("State changes can be queried") {
+    const auto clipRect = base::Rect<int>{{10, 20}, {30, 40}};
+    recorder.setClipRect(clipRect);
+    recorder.setGlobalTranslation({5, 6});
+    recorder.setGlobalScale({2.0f, 2.0f});
+
+    const auto expectedTranslation = base::Vector{5, 6};
+    const auto expectedScale = base::Point<float>{2.0f, 2.0f};
+    CHECK(recorder.state().mClipRect == clipRect);
+    CHECK(recorder.state().mGlobalTranslation == expectedTranslation);
+    CHECK(recorder.state().mGlobalScale == expectedScale);
+    CHECK(recorder.commands().size() == 3);
+
+    SECTION("Redundant state changes are not recorded") {
+      recorder.setClipRect(clipRect);
+      recorder.setGlobalTranslation({5, 6});
+      recorder.setGlobalScale({2.0f, 2.0f});
+
+      CHECK(recorder.commands().size() == 3);
+    }
+  }
+
+  SECTION("Full screen rect follows render target") {
+    const auto target = Renderer::RenderTarget{{320, 200}, 3};
+    recorder.setRenderTarget(target);
+
+    CHECK(recorder.state().mRenderTarget == target);
+    CHECK(recorder.fullScreenRect().size == target.mSize);
+
+    const auto newWindowSize = base::Size<int>{800, 600};
+    recorder.setWindowSize(newWindowSize);
+    CHECK(recorder.fullScreenRect().size == target.mSize);
+
+    recorder.setRenderTarget({});
+    CHECK(recorder.state().mRenderTarget.isDefault());
+    CHECK(recorder.fullScreenRect().size == newWindowSize);
+  }
+}
+
+
+TEST_CASE("Render thread executes submitted frames") {
+  std::vector<int> executedFrames;
+  std::atomic<int> numFramesExecuted{0};
+  std::thread::id startedOn;
+  std::thread::id executedOn;
+
+  RenderThread renderThread{
+    [&]() { startedOn = std::this_thread::get_id(); },
+    [&](const CommandList& commands) {
+      executedOn = std::this_thread::get_id();
+      runCustomCommands(commands);
+      ++numFramesExecuted;
+    },
+    []() {}};
+
+  CommandRecorder recorder{RecordedState{}};
+
+  SECTION("Frames are executed in order on the render thread") {
+    constexpr auto NUM_FRAMES = 20;
+
+    for (int i = 0; i < NUM_FRAMES; ++i) {
+      recorder.addCustomCommand([&executedFrames, i]() {
+        executedFrames.push_back(i);
+      });
+      renderThread.submitFrame(recorder.commands());
+
+      CHECK(recorder.commands().empty());
+
+      // At most one frame may still be in flight
+      CHECK(numFramesExecuted >= i);
+    }
+
+    renderThread.waitUntilIdle();
+
+    REQUIRE(executedFrames.size() == NUM_FRAMES);
+    for (int i = 0; i < NUM_FRAMES; ++i) {
+      CHECK(executedFrames[i] == i);
+    }
+
+    CHECK(startedOn == renderThread.threadId());
+    CHECK(executedOn == renderThread.threadId());
+    CHECK(executedOn != std::this_thread::get_id());
+  }
+
+  SECTION("Invoked functions run on the render thread") {
+    std::thread::id invokedOn;
+    renderThread.invoke([&]() { invokedOn = std::this_thread::get_id(); });
+
+    CHECK(invokedOn == renderThread.threadId());
+  }
+
+  SECTION("Errors are forwarded to the submitting thread") {
+    recorder.addCustomCommand([]() { throw std::runtime_error("Failed"); });
+    renderThread.submitFrame(recorder.commands());
+
+    CHECK_THROWS_AS(renderThread.waitUntilIdle(), const std::runtime_error&);
+
+    // The error is only reported once
+    renderThread.submitFrame(recorder.commands());
+    CHECK_NOTHROW(renderThread.waitUntilIdle());
+  }
+}
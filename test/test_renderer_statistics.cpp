@@ -0,0 +1,138 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/image.hpp>
+#include <renderer/opengl.hpp>
+#include <renderer/renderer.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace renderer;
+
+
+TEST_CASE("Renderer collects per-frame statistics") {
+  loadNullGlFunctions();
+
+  Renderer renderer{base::Size<int>{320, 200}};
+
+  const auto textureA = renderer.createTexture(data::Image{16, 16});
+  const auto textureB = renderer.createTexture(data::Image{16, 16});
+
+  // Discard statistics from initialization
+  renderer.swapBuffers();
+
+  const auto sourceRect = base::Rect<int>{{0, 0}, {16, 16}};
+  const auto drawAt = [&](const Renderer::TextureData& texture, const int x) {
+    renderer.drawTexture(texture, sourceRect, {{x, 0}, {16, 16}});
+  };
+
+  const auto finishFrame = [&]() {
+    renderer.swapBuffers();
+    return renderer.lastFrameStatistics();
+  };
+
+
+  SECTION("Draws using the same texture are batched") {
+    for (int i = 0; i < 10; ++i) {
+      drawAt(textureA, i * 16);
+    }
+
+    const auto total = finishFrame().total();
+    CHECK(total.mDrawCalls == 1);
+    CHECK(total.mVertices == 40);
+    CHECK(total.flushes(FlushReason::SwapBuffers) == 1);
+    CHECK(total.totalFlushes() == 1);
+  }
+
+  SECTION("Texture changes cause flushes") {
+    for (int i = 0; i < 10; ++i) {
+      drawAt(i % 2 == 0 ? textureA : textureB, i * 16);
+    }
+
+    const auto total = finishFrame().total();
+    CHECK(total.mDrawCalls == 10);
+    CHECK(total.mTextureBinds == 10);
+    CHECK(total.flushes(FlushReason::TextureChange) == 9);
+  }
+
+  SECTION("State changes are recorded as flush reasons") {
+    drawAt(textureA, 0);
+    renderer.setClipRect(base::Rect<int>{{0, 0}, {100, 100}});
+    drawAt(textureA, 16);
+    renderer.setOverlayColor({255, 0, 0, 255});
+    drawAt(textureA, 32);
+    renderer.setRenderTarget({{64, 64}, 1234});
+    drawAt(textureA, 48);
+    renderer.setRenderTarget({});
+    renderer.setClipRect({});
+
+    const auto total = finishFrame().total();
+    CHECK(total.mDrawCalls == 4);
+    CHECK(total.flushes(FlushReason::ClipRectChange) == 1);
+    CHECK(total.flushes(FlushReason::OverlayColorChange) == 1);
+    CHECK(total.flushes(FlushReason::RenderTargetChange) == 2);
+    CHECK(total.mRenderTargetSwitches == 2);
+    CHECK(total.mUniformUpdates > 0);
+  }
+
+  SECTION("Work is attributed to render phases") {
+    {
+      const auto phase = beginRenderPhase(&renderer, RenderPhase::Backdrop);
+      drawAt(textureA, 0);
+    }
+
+    CHECK(renderer.renderPhase() == RenderPhase::Other);
+
+    {
+      const auto phase = beginRenderPhase(&renderer, RenderPhase::Sprites);
+      drawAt(textureB, 0);
+      drawAt(textureA, 16);
+    }
+
+    renderer.drawRectangle({{0, 0}, {10, 10}}, {255, 255, 255, 255});
+
+    const auto statistics = finishFrame();
+    CHECK(statistics[RenderPhase::Backdrop].mDrawCalls == 1);
+    CHECK(statistics[RenderPhase::Sprites].mDrawCalls == 2);
+    CHECK(statistics[RenderPhase::Other].mDrawCalls == 1);
+    CHECK(statistics[RenderPhase::Hud].mDrawCalls == 0);
+    CHECK(statistics.total().mDrawCalls == 4);
+  }
+
+  SECTION("Reordering keeps interleaved draws within budget") {
+    renderer.setDrawCommandReorderingEnabled(true);
+    for (int i = 0; i < 10; ++i) {
+      drawAt(i % 2 == 0 ? textureA : textureB, i * 16);
+    }
+    renderer.setDrawCommandReorderingEnabled(false);
+
+    CHECK(finishFrame().total().mDrawCalls <= 2);
+  }
+
+  SECTION("Statistics are reset for each frame") {
+    drawAt(textureA, 0);
+    finishFrame();
+
+    const auto total = finishFrame().total();
+    CHECK(total.mDrawCalls == 0);
+    CHECK(total.totalFlushes() == 0);
+  }
+}
@@ -0,0 +1,219 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/defer.hpp>
+#include <base/warnings.hpp>
+#include <loader/file_utils.hpp>
+#include <loader/resource_loader.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <set>
+#include <string>
+
+
+using namespace rigel;
+using namespace loader;
+using namespace std;
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+void writeU32(ByteBuffer& buffer, const std::uint32_t value) {
+  for (auto i = 0; i < 4; ++i) {
+    buffer.push_back(static_cast<std::uint8_t>((value >> (i * 8)) & 0xFF));
+  }
+}
+
+
+void writeTextFile(const fs::path& path, const std::string& text) {
+  saveToFile(ByteBuffer(text.begin(), text.end()), path);
+}
+
+
+ByteBuffer makeFilePackage(
+  const std::string& fileName,
+  const ByteBuffer& data
+) {
+  constexpr auto DICT_ENTRY_SIZE = 12 + 4 + 4;
+
+  ByteBuffer package;
+  auto paddedName = fileName;
+  paddedName.resize(12, '\0');
+  package.insert(package.end(), paddedName.begin(), paddedName.end());
+  writeU32(package, 2 * DICT_ENTRY_SIZE);
+  writeU32(package, static_cast<std::uint32_t>(data.size()));
+
+  package.insert(package.end(), DICT_ENTRY_SIZE, 0);
+  package.insert(package.end(), data.begin(), data.end());
+  return package;
+}
+
+
+/** Writes the bare minimum of files needed to construct a ResourceLoader
+ *
+ * Most files are provided as loose files, only STATUS.MNI is stored in the
+ * CMP package.
+ */
+void createMinimalGameData(const fs::path& path) {
+  constexpr auto NUM_AUDIO_CHUNKS = 68;
+  constexpr auto AUDIO_CHUNK_SIZE = 32;
+
+  fs::create_directories(path);
+
+  saveToFile(
+    makeFilePackage("STATUS.MNI", ByteBuffer{1, 2, 3, 4}),
+    path / "NUKEM2.CMP");
+  saveToFile(ByteBuffer{}, path / "ACTORS.MNI");
+  saveToFile(ByteBuffer{0, 0}, path / "ACTRINFO.MNI");
+
+  ByteBuffer audioDict;
+  for (auto i = 0; i <= NUM_AUDIO_CHUNKS; ++i) {
+    writeU32(audioDict, i * AUDIO_CHUNK_SIZE);
+  }
+  saveToFile(audioDict, path / "AUDIOHED.MNI");
+  saveToFile(
+    ByteBuffer(NUM_AUDIO_CHUNKS * AUDIO_CHUNK_SIZE, 0),
+    path / "AUDIOT.MNI");
+
+  writeTextFile(path / "TEXT.MNI", "Original text");
+}
+
+
+void touch(const fs::path& path) {
+  fs::last_write_time(path, fs::last_write_time(path) + std::chrono::hours{1});
+}
+
+}
+
+
+TEST_CASE("Resource reload detects changed files") {
+  const auto gamePath = fs::temp_directory_path() / "rigel_test_game_data";
+  const auto gamePathString = gamePath.u8string() + "/";
+  fs::remove_all(gamePath);
+  createMinimalGameData(gamePath);
+  auto cleanup = base::defer([&]() { fs::remove_all(gamePath); });
+
+  ResourceLoader resources{gamePathString};
+  CHECK(resources.fileAsText("TEXT.MNI") == "Original text");
+  CHECK(resources.file("STATUS.MNI") == (ByteBuffer{1, 2, 3, 4}));
+  CHECK(!resources.hasFile("SB_1.MNI"));
+
+  using Changes = std::set<std::string>;
+
+  SECTION("Nothing reported if files are untouched") {
+    CHECK(resources.reload(gamePathString).empty());
+  }
+
+  SECTION("Modified loose file is reported") {
+    writeTextFile(gamePath / "TEXT.MNI", "Modified text");
+    touch(gamePath / "TEXT.MNI");
+
+    CHECK(resources.reload(gamePathString) == Changes{"TEXT.MNI"});
+    CHECK(resources.fileAsText("TEXT.MNI") == "Modified text");
+  }
+
+  SECTION("Changes are only reported once") {
+    touch(gamePath / "TEXT.MNI");
+
+    CHECK(resources.reload(gamePathString) == Changes{"TEXT.MNI"});
+    CHECK(resources.reload(gamePathString).empty());
+  }
+
+  SECTION("Newly added loose file is reported") {
+    saveToFile(ByteBuffer{}, gamePath / "SB_1.MNI");
+
+    CHECK(resources.reload(gamePathString) == Changes{"SB_1.MNI"});
+    CHECK(resources.hasFile("SB_1.MNI"));
+  }
+
+  SECTION("Loose file overriding a packaged one is reported") {
+    saveToFile(ByteBuffer{5, 6}, gamePath / "STATUS.MNI");
+
+    CHECK(resources.reload(gamePathString) == Changes{"STATUS.MNI"});
+    CHECK(resources.file("STATUS.MNI") == (ByteBuffer{5, 6}));
+  }
+
+  SECTION("Modified package invalidates packaged files only") {
+    saveToFile(
+      makeFilePackage("STATUS.MNI", ByteBuffer{7, 8, 9}),
+      gamePath / "NUKEM2.CMP");
+    touch(gamePath / "NUKEM2.CMP");
+
+    const auto changes = resources.reload(gamePathString);
+    CHECK(changes.count("STATUS.MNI") == 1);
+    CHECK(changes.count("TEXT.MNI") == 0);
+    CHECK(resources.file("STATUS.MNI") == (ByteBuffer{7, 8, 9}));
+  }
+
+  SECTION("Modified actor info is reported") {
+    touch(gamePath / "ACTRINFO.MNI");
+
+    CHECK(resources.reload(gamePathString) == Changes{"ACTRINFO.MNI"});
+  }
+
+  SECTION("Added and removed replacement images are reported") {
+    const auto replacementsPath = gamePath / "asset_replacements";
+    fs::create_directories(replacementsPath);
+    saveToFile(ByteBuffer{}, replacementsPath / "actor159_frame0.png");
+
+    const auto expectedChanges =
+      Changes{"asset_replacements/actor159_frame0.png"};
+    CHECK(resources.reload(gamePathString) == expectedChanges);
+
+    fs::remove(replacementsPath / "actor159_frame0.png");
+    CHECK(resources.reload(gamePathString) == expectedChanges);
+  }
+
+  SECTION("Switching game path reports all files") {
+    const auto otherGamePath =
+      fs::temp_directory_path() / "rigel_test_other_game_data";
+    fs::remove_all(otherGamePath);
+    createMinimalGameData(otherGamePath);
+    auto otherCleanup = base::defer([&]() { fs::remove_all(otherGamePath); });
+
+    const auto changes = resources.reload(otherGamePath.u8string() + "/");
+    CHECK(changes.count("TEXT.MNI") == 1);
+    CHECK(changes.count("STATUS.MNI") == 1);
+    CHECK(changes.count("ACTORS.MNI") == 1);
+  }
+}
+
+
+TEST_CASE("Sound source files") {
+  const auto gamePath = fs::temp_directory_path() / "rigel_test_game_data";
+  fs::remove_all(gamePath);
+  createMinimalGameData(gamePath);
+  auto cleanup = base::defer([&]() { fs::remove_all(gamePath); });
+
+  ResourceLoader resources{gamePath.u8string() + "/"};
+
+  using Files = std::vector<std::string>;
+
+  CHECK(
+    resources.soundSourceFiles(data::SoundId::IntroGunShot) ==
+    Files{"INTRO3.MNI"});
+  CHECK(
+    resources.soundSourceFiles(data::SoundId::DukeNormalShot) ==
+    (Files{"SB_1.MNI", "AUDIOHED.MNI", "AUDIOT.MNI"}));
+}
@@ -0,0 +1,277 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <loader/rle_compression.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+
+using namespace rigel;
+using namespace loader;
+
+using Status = RleDecodingResult::Status;
+
+
+namespace {
+
+// Size of the decompressed masked tile bits section in the original game's
+// level files
+constexpr auto ORIGINAL_DECODED_SIZE = std::size_t{8188};
+
+
+/** Produces a terminated RLE stream which decodes to decodedSize bytes
+ *
+ * Mostly consists of long runs of zeroes, like the masked tile bits found in
+ * actual level files, interspersed with shorter runs and literal spans.
+ */
+ByteBuffer makeRleStream(
+  const std::size_t decodedSize,
+  const std::uint32_t seed
+) {
+  std::mt19937 randomGenerator{seed};
+  auto randomInt = [&](const int min, const int max) {
+    return std::uniform_int_distribution<int>{min, max}(randomGenerator);
+  };
+
+  ByteBuffer stream;
+  auto remaining = decodedSize;
+  while (remaining > 0) {
+    const auto maxCount = static_cast<int>(std::min<std::size_t>(
+      remaining, 128));
+
+    switch (randomInt(0, 3)) {
+      case 0:
+        {
+          const auto count = randomInt(1, maxCount);
+          stream.push_back(static_cast<std::uint8_t>(-count));
+          for (int i = 0; i < count; ++i) {
+            stream.push_back(static_cast<std::uint8_t>(randomInt(0, 255)));
+          }
+          remaining -= count;
+        }
+        break;
+
+      case 1:
+        {
+          const auto count = randomInt(1, std::min(maxCount, 127));
+          stream.push_back(static_cast<std::uint8_t>(count));
+          stream.push_back(static_cast<std::uint8_t>(randomInt(0, 255)));
+          remaining -= count;
+        }
+        break;
+
+      default:
+        {
+          const auto count = std::min(maxCount, 127);
+          stream.push_back(static_cast<std::uint8_t>(count));
+          stream.push_back(0);
+          remaining -= count;
+        }
+        break;
+    }
+  }
+
+  stream.push_back(0);
+  return stream;
+}
+
+
+ByteBuffer decodeByteWise(const ByteBuffer& stream) {
+  ByteBuffer result;
+  LeStreamReader reader(stream);
+  decompressRle(reader, [&](const std::uint8_t value) {
+    result.push_back(value);
+  });
+  return result;
+}
+
+
+ByteBuffer decodeInBulk(const ByteBuffer& stream, const std::size_t capacity) {
+  ByteBuffer result(capacity);
+  const auto decodingResult =
+    decompressRleInto(stream.data(), stream.size(), result.data(), capacity);
+  REQUIRE(decodingResult.mStatus == Status::Ok);
+  REQUIRE(decodingResult.mStopOffset == stream.size() - 1);
+
+  result.resize(std::min(decodingResult.mDecodedSize, capacity));
+  return result;
+}
+
+}
+
+
+TEST_CASE("Bulk RLE decoder matches byte-wise decoder") {
+  SECTION("Randomized streams") {
+    for (auto seed = 0u; seed < 50u; ++seed) {
+      const auto decodedSize = 1 + seed * 397 % 20000;
+      const auto stream = makeRleStream(decodedSize, seed);
+
+      INFO("Seed " << seed);
+      const auto expected = decodeByteWise(stream);
+      REQUIRE(expected.size() == decodedSize);
+      CHECK(decodeInBulk(stream, decodedSize) == expected);
+    }
+  }
+
+  SECTION("Output exceeding the destination's capacity is discarded") {
+    const auto stream = makeRleStream(1000, 7);
+    const auto expected = decodeByteWise(stream);
+
+    for (const auto capacity : {1u, 127u, 128u, 129u, 500u, 999u}) {
+      INFO("Capacity " << capacity);
+      const auto expectedPart =
+        ByteBuffer(expected.begin(), expected.begin() + capacity);
+      CHECK(decodeInBulk(stream, capacity) == expectedPart);
+    }
+  }
+
+  SECTION("Maximum length runs and literal spans") {
+    auto stream = ByteBuffer{127, 0xAB, 0x80};
+    for (int i = 0; i < 128; ++i) {
+      stream.push_back(static_cast<std::uint8_t>(i));
+    }
+    stream.push_back(0);
+
+    const auto decoded = decodeInBulk(stream, 1000);
+    CHECK(decoded.size() == 255);
+    CHECK(decoded == decodeByteWise(stream));
+  }
+}
+
+
+TEST_CASE("Bulk RLE decoder reports malformed input") {
+  ByteBuffer destination(64);
+
+  const auto decode = [&](const ByteBuffer& stream) {
+    return decompressRleInto(
+      stream.data(), stream.size(), destination.data(), destination.size());
+  };
+
+  SECTION("Empty stream") {
+    const auto result = decode({});
+    CHECK(result.mStatus == Status::MissingTerminator);
+    CHECK(result.mStopOffset == 0);
+  }
+
+  SECTION("Missing terminator") {
+    const auto result = decode({3, 0x11, 0xFE, 0x22, 0x33});
+    CHECK(result.mStatus == Status::MissingTerminator);
+    CHECK(result.mStopOffset == 5);
+    CHECK(result.mDecodedSize == 5);
+  }
+
+  SECTION("Truncated run") {
+    const auto result = decode({0xFF, 0x11, 4});
+    CHECK(result.mStatus == Status::TruncatedWord);
+    CHECK(result.mStopOffset == 2);
+  }
+
+  SECTION("Truncated literal span") {
+    const auto result = decode({2, 0x11, 0xFC, 0x22, 0x33, 0x44});
+    CHECK(result.mStatus == Status::TruncatedWord);
+    CHECK(result.mStopOffset == 2);
+    CHECK(result.mDecodedSize == 2);
+  }
+}
+
+
+TEST_CASE("RLE compression round-trips") {
+  const auto roundTrip = [](const ByteBuffer& data) {
+    const auto stream = compressRle(data.data(), data.size());
+    REQUIRE(!stream.empty());
+    CHECK(stream.back() == 0);
+    return decodeByteWise(stream);
+  };
+
+  SECTION("Empty input") {
+    CHECK(compressRle(nullptr, 0) == ByteBuffer{0});
+  }
+
+  SECTION("Randomized data") {
+    for (auto seed = 0u; seed < 20u; ++seed) {
+      const auto decodedSize = 1 + seed * 397 % 20000;
+      const auto data = decodeByteWise(makeRleStream(decodedSize, seed));
+
+      INFO("Seed " << seed);
+      CHECK(roundTrip(data) == data);
+    }
+  }
+
+  SECTION("Runs and literal spans exceeding the maximum length") {
+    auto data = ByteBuffer(1000, 0x42);
+    for (int i = 0; i < 1000; ++i) {
+      data.push_back(static_cast<std::uint8_t>(i));
+    }
+    data.insert(data.end(), {7, 7, 1, 1, 1, 2});
+
+    CHECK(roundTrip(data) == data);
+  }
+
+  SECTION("Repeated bytes are stored as runs") {
+    const auto data = ByteBuffer(127 * 100, 0);
+    CHECK(compressRle(data.data(), data.size()).size() == 2 * 100 + 1);
+  }
+}
+
+
+TEST_CASE("RLE decoding throughput", "[.][benchmark]") {
+  using Clock = std::chrono::high_resolution_clock;
+
+  constexpr auto NUM_ITERATIONS = 200;
+
+  for (const auto scale : {1u, 2u, 4u, 8u, 16u}) {
+    const auto decodedSize = ORIGINAL_DECODED_SIZE * scale;
+    const auto stream = makeRleStream(decodedSize, 42);
+
+    ByteBuffer byteWiseResult;
+    byteWiseResult.reserve(decodedSize);
+
+    auto start = Clock::now();
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+      byteWiseResult.clear();
+      LeStreamReader reader(stream);
+      decompressRle(reader, [&](const std::uint8_t value) {
+        byteWiseResult.push_back(value);
+      });
+    }
+    const auto byteWiseTime =
+      std::chrono::duration<double, std::micro>(Clock::now() - start);
+
+    ByteBuffer bulkResult(decodedSize);
+    start = Clock::now();
+    for (int i = 0; i < NUM_ITERATIONS; ++i) {
+      decompressRleInto(
+        stream.data(), stream.size(), bulkResult.data(), bulkResult.size());
+    }
+    const auto bulkTime =
+      std::chrono::duration<double, std::micro>(Clock::now() - start);
+
+    CHECK(bulkResult == byteWiseResult);
+
+    WARN(
+      scale << "x original size (" << decodedSize << " bytes) - byte-wise: "
+      << byteWiseTime.count() / NUM_ITERATIONS << " us, bulk: "
+      << bulkTime.count() / NUM_ITERATIONS << " us");
+  }
+}
@@ -0,0 +1,125 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <engine/spatial_entity_index.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+
+namespace ex = entityx;
+
+
+namespace {
+
+std::vector<ex::Entity> sorted(std::vector<ex::Entity> entities) {
+  std::sort(entities.begin(), entities.end());
+  return entities;
+}
+
+}
+
+
+TEST_CASE("Spatial entity index finds entities by bounds") {
+  ex::EntityX entityx;
+  SpatialEntityIndex index{{100, 100}, 10};
+
+  auto small = entityx.entities.create();
+  auto large = entityx.entities.create();
+  auto outside = entityx.entities.create();
+
+  index.insert(small, {{12, 12}, {4, 4}});
+  index.insert(large, {{5, 5}, {60, 30}});
+  index.insert(outside, {{-50, 120}, {20, 20}});
+
+  CHECK(index.size() == 3);
+
+  const auto query = [&](const base::Rect<int>& area) {
+    std::vector<ex::Entity> result;
+    index.query(area, result);
+    return sorted(result);
+  };
+
+  SECTION("Entities spanning multiple cells are reported once") {
+    CHECK(query({{0, 0}, {100, 100}}) == sorted({small, large}));
+  }
+
+  SECTION("Only intersecting bounds are reported") {
+    CHECK(query({{16, 16}, {10, 10}}) == std::vector<ex::Entity>{large});
+    CHECK(query({{70, 70}, {10, 10}}).empty());
+  }
+
+  SECTION("Bounds outside the covered area are found") {
+    CHECK(query({{-40, 130}, {5, 5}}) == std::vector<ex::Entity>{outside});
+  }
+
+  SECTION("Clearing removes all entities") {
+    index.clear();
+
+    CHECK(index.size() == 0);
+    CHECK(query({{-100, -100}, {300, 300}}).empty());
+  }
+}
+
+
+TEST_CASE("Spatial entity index matches testing all bounds") {
+  ex::EntityX entityx;
+  SpatialEntityIndex index{{256, 128}, 16};
+
+  std::mt19937 randomGenerator{42};
+  std::uniform_int_distribution<int> positionDistribution{-32, 288};
+  std::uniform_int_distribution<int> sizeDistribution{1, 48};
+
+  const auto randomRect = [&]() {
+    return base::Rect<int>{
+      {positionDistribution(randomGenerator),
+       positionDistribution(randomGenerator)},
+      {sizeDistribution(randomGenerator), sizeDistribution(randomGenerator)}};
+  };
+
+  std::vector<std::pair<ex::Entity, base::Rect<int>>> allBounds;
+  for (int i = 0; i < 500; ++i) {
+    const auto bounds = randomRect();
+    auto entity = entityx.entities.create();
+    index.insert(entity, bounds);
+    allBounds.emplace_back(entity, bounds);
+  }
+
+  for (int i = 0; i < 200; ++i) {
+    const auto area = randomRect();
+
+    std::vector<ex::Entity> expected;
+    for (const auto& [entity, bounds] : allBounds) {
+      if (bounds.intersects(area)) {
+        expected.push_back(entity);
+      }
+    }
+
+    std::vector<ex::Entity> result;
+    index.query(area, result);
+
+    REQUIRE(sorted(result) == sorted(expected));
+  }
+}
@@ -0,0 +1,91 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <common/startup_timeline.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <memory>
+#include <sstream>
+
+
+using namespace rigel;
+
+
+TEST_CASE("Startup timeline") {
+  StartupTimeline timeline;
+
+  SECTION("Phases are recorded in order") {
+    timeline.completePhase("First");
+    const auto result = timeline.measure("Second", []() { return 42; });
+    timeline.completePhase("Third");
+
+    CHECK(result == 42);
+
+    const auto& phases = timeline.phases();
+    REQUIRE(phases.size() == 3);
+    CHECK(phases[0].mName == "First");
+    CHECK(phases[1].mName == "Second");
+    CHECK(phases[2].mName == "Third");
+
+    // Start and duration are converted to milliseconds separately, so their
+    // sum can be off by rounding errors
+    const auto endOf = [](const StartupTimeline::Phase& phase) {
+      return phase.mStartMs + phase.mDurationMs;
+    };
+    constexpr auto TOLERANCE_MS = 1e-9;
+
+    CHECK(phases[0].mStartMs == 0.0);
+    CHECK(phases[1].mStartMs > endOf(phases[0]) - TOLERANCE_MS);
+
+    // Completing a phase attributes all time since the previous one to it
+    CHECK(phases[2].mStartMs == Approx(endOf(phases[1])));
+    CHECK(timeline.totalMs() == Approx(endOf(phases[2])));
+  }
+
+  SECTION("Non-copyable results are passed through") {
+    const auto pValue = timeline.measure(
+      "Allocation", []() { return std::make_unique<int>(5); });
+
+    REQUIRE(pValue);
+    CHECK(*pValue == 5);
+    CHECK(timeline.phases().size() == 1);
+  }
+
+  SECTION("Measuring without a timeline only invokes the function") {
+    auto invoked = false;
+    measureStartupPhase(nullptr, "Nothing", [&]() { invoked = true; });
+
+    CHECK(invoked);
+    CHECK(timeline.phases().empty());
+  }
+
+  SECTION("Report lists all phases") {
+    timeline.completePhase("Sounds");
+    measureStartupPhase(&timeline, "Scripts", []() {});
+
+    std::stringstream stream;
+    timeline.print(stream);
+    const auto report = stream.str();
+
+    CHECK(report.find("Sounds") != std::string::npos);
+    CHECK(report.find("Scripts") != std::string::npos);
+    CHECK(report.find("Total startup time") != std::string::npos);
+  }
+}
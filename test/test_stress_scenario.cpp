@@ -0,0 +1,309 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils.hpp"
+
+#include <base/warnings.hpp>
+#include <data/game_traits.hpp>
+#include <data/player_model.hpp>
+#include <engine/collision_checker.hpp>
+#include <engine/map_renderer.hpp>
+#include <engine/random_number_generator.hpp>
+#include <game_logic/entity_factory.hpp>
+#include <game_logic/ingame_systems.hpp>
+#include <game_logic/interactive/enemy_radar.hpp>
+#include <loader/stress_scenario.hpp>
+#include <renderer/opengl.hpp>
+#include <renderer/renderer.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+
+using namespace rigel;
+using namespace loader;
+
+using data::ActorID;
+using data::GameTraits;
+
+
+namespace {
+
+int countActors(
+  const data::map::LevelData& level,
+  const std::vector<ActorID>& ids
+) {
+  return static_cast<int>(std::count_if(
+    level.mActors.begin(),
+    level.mActors.end(),
+    [&](const data::map::LevelData::Actor& actor) {
+      return std::find(ids.begin(), ids.end(), actor.mID) != ids.end();
+    }));
+}
+
+
+bool sameLevel(
+  const data::map::LevelData& lhs,
+  const data::map::LevelData& rhs
+) {
+  if (
+    lhs.mMap.width() != rhs.mMap.width() ||
+    lhs.mMap.height() != rhs.mMap.height() ||
+    lhs.mActors.size() != rhs.mActors.size()
+  ) {
+    return false;
+  }
+
+  for (auto y = 0; y < lhs.mMap.height(); ++y) {
+    for (auto x = 0; x < lhs.mMap.width(); ++x) {
+      for (auto layer = 0; layer < 2; ++layer) {
+        if (lhs.mMap.tileAt(layer, x, y) != rhs.mMap.tileAt(layer, x, y)) {
+          return false;
+        }
+      }
+    }
+  }
+
+  for (auto i = 0u; i < lhs.mActors.size(); ++i) {
+    if (
+      lhs.mActors[i].mID != rhs.mActors[i].mID ||
+      lhs.mActors[i].mPosition != rhs.mActors[i].mPosition
+    ) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+/** Runs the in-game systems on a generated level, without game files
+ *
+ * Rendering goes to a renderer using null OpenGL functions, see
+ * renderer::loadNullGlFunctions().
+ */
+struct HeadlessWorld {
+  HeadlessWorld(
+    renderer::Renderer* pRenderer,
+    const StressScenarioParameters& parameters
+  )
+    : mSpriteFactory(pRenderer, &mActorImages)
+    , mEntityFactory(
+        &mSpriteFactory,
+        &mEntities,
+        &mRandomGenerator,
+        data::Difficulty::Hard)
+  {
+    auto level = generateStressScenario(parameters);
+    const auto playerEntity =
+      mEntityFactory.createEntitiesForLevel(level.mActors);
+    mMap = std::move(level.mMap);
+
+    mpSystems = std::make_unique<game_logic::IngameSystems>(
+      data::GameSessionId{0, 0, data::Difficulty::Hard},
+      playerEntity,
+      &mPlayerModel,
+      &mMap,
+      engine::MapRenderer::MapRenderData{std::move(level)},
+      &mServiceProvider,
+      &mEntityFactory,
+      &mRandomGenerator,
+      &mRadarDishCounter,
+      &mCollisionChecker,
+      pRenderer,
+      mEntities,
+      mEvents,
+      data::LevelHints{});
+  }
+
+  void update() {
+    mpSystems->update({}, mEntities, GameTraits::mapViewPortSize);
+  }
+
+  void render() {
+    mpSystems->render(mEntities, std::nullopt, GameTraits::mapViewPortSize);
+  }
+
+  MockServiceProvider mServiceProvider;
+  data::PlayerModel mPlayerModel;
+  entityx::EventManager mEvents;
+  entityx::EntityManager mEntities{mEvents};
+  engine::RandomNumberGenerator mRandomGenerator;
+  ActorImagePackage mActorImages = createPlaceholderActorImagePackage();
+  game_logic::SpriteFactory mSpriteFactory;
+  game_logic::EntityFactory mEntityFactory;
+  game_logic::RadarDishCounter mRadarDishCounter{mEntities, mEvents};
+  data::map::Map mMap;
+  engine::CollisionChecker mCollisionChecker{&mMap, mEntities, mEvents};
+  std::unique_ptr<game_logic::IngameSystems> mpSystems;
+};
+
+}
+
+
+TEST_CASE("Stress scenarios are reproducible") {
+  auto parameters = StressScenarioParameters{};
+  parameters.mMapSize = {128, 64};
+  parameters.mSeed = 1234;
+
+  const auto level = generateStressScenario(parameters);
+  CHECK(sameLevel(level, generateStressScenario(parameters)));
+
+  parameters.mSeed = 4321;
+  CHECK(!sameLevel(level, generateStressScenario(parameters)));
+}
+
+
+TEST_CASE("Stress scenario parameters are honored") {
+  auto parameters = StressScenarioParameters{};
+  parameters.mMapSize = {200, 100};
+  parameters.mEnemyDensity = 10.0f;
+  parameters.mItemContainerDensity = 5.0f;
+  parameters.mSolidBodyDensity = 1.0f;
+  parameters.mEnemyMix = {ActorID::Hoverbot, ActorID::Skeleton};
+
+  const auto level = generateStressScenario(parameters);
+
+  CHECK(level.mMap.width() == 200);
+  CHECK(level.mMap.height() == 100);
+
+  CHECK(countActors(level, {ActorID::Duke_RIGHT}) == 1);
+  CHECK(countActors(level, parameters.mEnemyMix) == 200);
+  CHECK(countActors(level, parameters.mItemContainerMix) == 100);
+  CHECK(
+    countActors(
+      level,
+      {
+        ActorID::Rocket_elevator,
+        ActorID::Sliding_door_vertical,
+        ActorID::Sliding_door_horizontal
+      }) == 20);
+  CHECK(countActors(level, {ActorID::Water_body}) > 0);
+
+  for (const auto& actor : level.mActors) {
+    CHECK(actor.mPosition.x >= 0);
+    CHECK(actor.mPosition.x < level.mMap.width());
+    CHECK(actor.mPosition.y >= 0);
+    CHECK(actor.mPosition.y < level.mMap.height());
+  }
+
+  SECTION("Tile densities") {
+    auto numSolidTiles = 0;
+    for (auto y = 0; y < level.mMap.height(); ++y) {
+      for (auto x = 0; x < level.mMap.width(); ++x) {
+        if (level.mMap.tileAt(0, x, y) != 0) {
+          ++numSolidTiles;
+        }
+      }
+    }
+
+    const auto density = float(numSolidTiles) / (200.0f * 100.0f);
+    CHECK(density > 0.05f);
+    CHECK(density < 0.2f);
+  }
+
+  SECTION("Empty scenario") {
+    parameters.mEnemyDensity = 0.0f;
+    parameters.mItemContainerDensity = 0.0f;
+    parameters.mSolidBodyDensity = 0.0f;
+    parameters.mWaterAreaDensity = 0.0f;
+
+    CHECK(generateStressScenario(parameters).mActors.size() == 1);
+  }
+}
+
+
+TEST_CASE("Placeholder sprites exist for all actors") {
+  const auto package = createPlaceholderActorImagePackage();
+
+  for (const auto id : {ActorID::Duke_LEFT, ActorID::Hoverbot}) {
+    const auto actor = package.loadIndexedActor(id);
+    REQUIRE(!actor.mFrames.empty());
+
+    const auto& image =
+      std::get<data::IndexedImage>(actor.mFrames.front().mFrameImage);
+    CHECK(image.width() == 16);
+    CHECK(image.height() == 16);
+    CHECK(image.pixelData().front() == 5);
+  }
+}
+
+
+TEST_CASE("Stress scenarios run headless") {
+  renderer::loadNullGlFunctions();
+  renderer::Renderer renderer{base::Size<int>{320, 200}};
+
+  auto parameters = StressScenarioParameters{};
+  parameters.mMapSize = {128, 64};
+
+  HeadlessWorld world{&renderer, parameters};
+  CHECK(
+    world.mEntities.size() >=
+    generateStressScenario(parameters).mActors.size());
+
+  for (auto i = 0; i < 30; ++i) {
+    world.update();
+    world.render();
+  }
+}
+
+
+TEST_CASE("Stress scenario scaling", "[.][benchmark]") {
+  using Clock = std::chrono::high_resolution_clock;
+  using Milliseconds = std::chrono::duration<double, std::milli>;
+
+  constexpr auto NUM_TICKS = 100;
+
+  renderer::loadNullGlFunctions();
+  renderer::Renderer renderer{base::Size<int>{320, 200}};
+
+  // Map sizes relative to the largest original level, which has 32750 tiles
+  for (const auto scale : {1, 2, 4, 8, 16}) {
+    auto parameters = StressScenarioParameters{};
+    parameters.mMapSize = {256 * scale, 128};
+    parameters.mSeed = 42;
+
+    auto start = Clock::now();
+    HeadlessWorld world{&renderer, parameters};
+    const auto setupTime = Milliseconds(Clock::now() - start);
+
+    const auto numEntities = world.mEntities.size();
+
+    auto updateTime = Milliseconds{};
+    auto renderTime = Milliseconds{};
+    for (auto i = 0; i < NUM_TICKS; ++i) {
+      start = Clock::now();
+      world.update();
+      const auto afterUpdate = Clock::now();
+      world.render();
+
+      updateTime += afterUpdate - start;
+      renderTime += Clock::now() - afterUpdate;
+    }
+
+    WARN(
+      "scale, tiles, entities, setup ms, update ms/tick, render ms/tick: "
+      << scale << ", " << parameters.mMapSize.width * 128 << ", "
+      << numEntities << ", " << setupTime.count() << ", "
+      << updateTime.count() / NUM_TICKS << ", "
+      << renderTime.count() / NUM_TICKS);
+  }
+}
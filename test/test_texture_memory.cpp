@@ -0,0 +1,178 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/image.hpp>
+#include <renderer/opengl.hpp>
+#include <renderer/renderer.hpp>
+#include <renderer/texture.hpp>
+#include <renderer/texture_memory.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace renderer;
+
+
+TEST_CASE("Texture memory accountant tracks usage per category") {
+  TextureMemoryAccountant accountant;
+
+  accountant.registerTexture(1, 16, 16, GL_RGBA, TextureCategory::Sprites);
+  accountant.registerTexture(2, 32, 8, GL_RGBA, TextureCategory::Sprites);
+  accountant.registerTexture(3, 320, 200, GL_RGBA, TextureCategory::Map);
+
+  SECTION("Totals and per-category usage") {
+    const auto statistics = accountant.statistics();
+    CHECK(statistics.mTotal.mTextureCount == 3);
+    CHECK(statistics.mTotal.mBytes == (16*16 + 32*8 + 320*200) * 4);
+    CHECK(statistics[TextureCategory::Sprites].mTextureCount == 2);
+    CHECK(statistics[TextureCategory::Sprites].mBytes == (16*16 + 32*8) * 4);
+    CHECK(statistics[TextureCategory::Map].mBytes == 320*200*4);
+    CHECK(statistics[TextureCategory::Hud].mTextureCount == 0);
+  }
+
+  SECTION("Peak usage is kept after unregistering") {
+    accountant.unregisterTexture(3);
+    accountant.unregisterTexture(1);
+
+    const auto statistics = accountant.statistics();
+    CHECK(statistics.mTotal.mTextureCount == 1);
+    CHECK(statistics.mTotal.mBytes == 32*8*4);
+    CHECK(statistics.mTotal.mPeakBytes == (16*16 + 32*8 + 320*200) * 4);
+    CHECK(statistics[TextureCategory::Map].mBytes == 0);
+    CHECK(statistics[TextureCategory::Map].mPeakBytes == 320*200*4);
+  }
+
+  SECTION("Unknown handles are ignored") {
+    accountant.unregisterTexture(42);
+    CHECK(accountant.statistics().mTotal.mTextureCount == 3);
+  }
+}
+
+
+TEST_CASE("Texture memory budget is enforced") {
+  TextureMemoryAccountant accountant;
+  accountant.registerTexture(1, 16, 16, GL_RGBA, TextureCategory::Other);
+
+  const auto budget = std::size_t{2048};
+
+  SECTION("Allocations within budget are accepted") {
+    accountant.setBudget(budget, TextureBudgetPolicy::Reject);
+    CHECK_NOTHROW(accountant.checkAllocation(1024, TextureCategory::Other));
+  }
+
+  SECTION("Over-budget allocations are counted when logging") {
+    accountant.setBudget(budget, TextureBudgetPolicy::Log);
+    CHECK_NOTHROW(accountant.checkAllocation(1025, TextureCategory::Other));
+    CHECK_NOTHROW(accountant.checkAllocation(4096, TextureCategory::Other));
+
+    const auto statistics = accountant.statistics();
+    CHECK(statistics.mOverBudgetAllocations == 2);
+    CHECK(statistics.mRejectedAllocations == 0);
+  }
+
+  SECTION("Over-budget allocations are rejected") {
+    accountant.setBudget(budget, TextureBudgetPolicy::Reject);
+    CHECK_THROWS_AS(
+      accountant.checkAllocation(1025, TextureCategory::Other),
+      const TextureBudgetExceeded&);
+    CHECK(accountant.statistics().mRejectedAllocations == 1);
+  }
+
+  SECTION("Budget can be removed") {
+    accountant.setBudget(budget, TextureBudgetPolicy::Reject);
+    accountant.setBudget(std::nullopt, TextureBudgetPolicy::Reject);
+    CHECK_NOTHROW(accountant.checkAllocation(4096, TextureCategory::Other));
+  }
+}
+
+
+TEST_CASE("Renderer accounts for texture memory") {
+  loadNullGlFunctions();
+
+  Renderer renderer{base::Size<int>{320, 200}};
+
+  const auto initialStatistics = renderer.textureMemoryStatistics();
+  const auto initialBytes = initialStatistics.mTotal.mBytes;
+  CHECK(initialStatistics[TextureCategory::Internal].mTextureCount > 0);
+
+  SECTION("Textures are registered until destroyed") {
+    {
+      OwningTexture texture{
+        &renderer, data::Image{16, 8}, TextureCategory::Hud};
+
+      const auto statistics = renderer.textureMemoryStatistics();
+      CHECK(statistics[TextureCategory::Hud].mTextureCount == 1);
+      CHECK(statistics[TextureCategory::Hud].mBytes == 16*8*4);
+      CHECK(statistics.mTotal.mBytes == initialBytes + 16*8*4);
+    }
+
+    const auto statistics = renderer.textureMemoryStatistics();
+    CHECK(statistics[TextureCategory::Hud].mTextureCount == 0);
+    CHECK(statistics.mTotal.mBytes == initialBytes);
+  }
+
+  SECTION("Assigning a texture releases the previous one") {
+    OwningTexture texture{&renderer, data::Image{16, 8}, TextureCategory::Hud};
+    texture = OwningTexture{
+      &renderer, data::Image{32, 8}, TextureCategory::Hud};
+
+    auto statistics = renderer.textureMemoryStatistics();
+    CHECK(statistics[TextureCategory::Hud].mTextureCount == 1);
+    CHECK(statistics[TextureCategory::Hud].mBytes == 32*8*4);
+    CHECK(statistics.mTotal.mBytes == initialBytes + 32*8*4);
+
+    RenderTargetTexture target{&renderer, 64, 32};
+    target = RenderTargetTexture{&renderer, 16, 16};
+
+    statistics = renderer.textureMemoryStatistics();
+    CHECK(statistics[TextureCategory::RenderTarget].mTextureCount == 1);
+    CHECK(statistics[TextureCategory::RenderTarget].mBytes == 16*16*4);
+  }
+
+  SECTION("Indexed textures use one byte per pixel") {
+    OwningTexture texture{
+      &renderer, data::IndexedImage{16, 8}, TextureCategory::Sprites};
+
+    CHECK(texture.data().mIsIndexed);
+
+    const auto statistics = renderer.textureMemoryStatistics();
+    CHECK(statistics[TextureCategory::Sprites].mBytes == 16*8);
+  }
+
+  SECTION("Render targets have their own category") {
+    RenderTargetTexture target{&renderer, 64, 32};
+
+    const auto statistics = renderer.textureMemoryStatistics();
+    CHECK(statistics[TextureCategory::RenderTarget].mBytes == 64*32*4);
+  }
+
+  SECTION("Rejected textures are not created") {
+    renderer.setTextureMemoryBudget(
+      initialBytes + 1024, TextureBudgetPolicy::Reject);
+
+    const auto image = data::Image{32, 32};
+    CHECK_THROWS_AS(
+      OwningTexture(&renderer, image), const TextureBudgetExceeded&);
+
+    const auto statistics = renderer.textureMemoryStatistics();
+    CHECK(statistics.mTotal.mBytes == initialBytes);
+    CHECK(statistics.mRejectedAllocations == 1);
+  }
+}
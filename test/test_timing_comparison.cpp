@@ -0,0 +1,139 @@
+/* Copyright (C) 2020, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <common/timing_comparison.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+
+using namespace rigel;
+
+
+TEST_CASE("Paired timing comparison") {
+  SECTION("Identical timings show no difference") {
+    const auto samples = std::vector<double>{1.0, 2.0, 1.5, 3.0, 2.5};
+    const auto result = comparePairedTimings(samples, samples);
+
+    CHECK(result.mNumSamples == 5);
+    CHECK(result.mMedianA == 2.0);
+    CHECK(result.mMedianB == 2.0);
+    CHECK(result.mMedianDifference == 0.0);
+    CHECK(result.mLowerBound == 0.0);
+    CHECK(result.mUpperBound == 0.0);
+    CHECK(!result.isSignificant());
+  }
+
+  SECTION("Consistent slowdown is significant despite varying workload") {
+    std::vector<double> samplesA;
+    std::vector<double> samplesB;
+    for (int i = 0; i < 100; ++i) {
+      const auto workload = 1.0 + (i % 7);
+      const auto noise = (i % 3 - 1) * 0.1;
+      samplesA.push_back(workload);
+      samplesB.push_back(workload + 0.5 + noise);
+    }
+
+    const auto result = comparePairedTimings(samplesA, samplesB);
+
+    CHECK(result.mMedianDifference == Approx(0.5));
+    CHECK(result.mLowerBound > 0.0);
+    CHECK(result.mLowerBound <= result.mMedianDifference);
+    CHECK(result.mUpperBound >= result.mMedianDifference);
+    CHECK(result.isSignificant());
+  }
+
+  SECTION("Outliers don't affect the result") {
+    auto samplesA = std::vector<double>(50, 2.0);
+    auto samplesB = std::vector<double>(50, 1.0);
+    samplesB[10] = 100.0;
+    samplesB[20] = 250.0;
+
+    const auto result = comparePairedTimings(samplesA, samplesB);
+
+    CHECK(result.mMedianB == 1.0);
+    CHECK(result.mMedianDifference == -1.0);
+    CHECK(result.mUpperBound == -1.0);
+    CHECK(result.isSignificant());
+  }
+
+  SECTION("Bounds are the k-th smallest and largest difference") {
+    // For n = 100, k = floor((100 - 1.96 * 10) / 2) = 40, so the bounds
+    // are the 40th smallest and 40th largest of the differences 0..99.
+    const auto samplesA = std::vector<double>(100, 0.0);
+    std::vector<double> samplesB;
+    for (int i = 0; i < 100; ++i) {
+      samplesB.push_back((i * 37) % 100);
+    }
+
+    const auto result = comparePairedTimings(samplesA, samplesB);
+
+    CHECK(result.mLowerBound == 39.0);
+    CHECK(result.mUpperBound == 60.0);
+  }
+
+  SECTION("Few samples give a wide confidence interval") {
+    const auto samplesA = std::vector<double>{1.0, 1.0, 1.0};
+    const auto samplesB = std::vector<double>{0.5, 1.5, 2.0};
+
+    const auto result = comparePairedTimings(samplesA, samplesB);
+
+    CHECK(result.mLowerBound == -0.5);
+    CHECK(result.mUpperBound == 1.0);
+    CHECK(!result.isSignificant());
+  }
+
+  SECTION("Samples must come in pairs") {
+    CHECK_THROWS_AS(
+      comparePairedTimings({1.0, 2.0}, {1.0}),
+      const std::invalid_argument&);
+    CHECK_THROWS_AS(
+      comparePairedTimings({}, {}),
+      const std::invalid_argument&);
+  }
+}
+
+
+TEST_CASE("Timing comparison collects named measurements") {
+  TimingComparison comparison{"before", "after"};
+
+  for (int i = 0; i < 20; ++i) {
+    comparison.addSamples("update", 2.0, 1.0);
+    comparison.addSamples("render", 3.0, 3.0);
+  }
+
+  CHECK(comparison.delta("update").mMedianDifference == -1.0);
+  CHECK(comparison.delta("update").mNumSamples == 20);
+  CHECK(comparison.delta("render").mMedianDifference == 0.0);
+  CHECK_THROWS_AS(
+    comparison.delta("physics"),
+    const std::invalid_argument&);
+
+  std::stringstream stream;
+  comparison.print(stream);
+  const auto report = stream.str();
+
+  CHECK(report.find("after - before") != std::string::npos);
+  CHECK(report.find("update") < report.find("render"));
+  CHECK(report.find("-50.0%") != std::string::npos);
+  CHECK(report.find("20 pairs") != std::string::npos);
+}